@@ -0,0 +1,291 @@
+// Headless benchmark for MainWindow::render.
+//
+// Drives the real UI code against an ImGui context with no platform or
+// renderer backend, seeded with production-scale state, and reports CPU
+// time and heap allocations per frame.
+//
+// Usage: trimora_ui_bench [--frames N]
+
+#include "gui/main_window.hpp"
+#include "config_manager.hpp"
+
+#include <imgui.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr size_t kBatchFiles = 20000;
+constexpr size_t kLogLines = 100000;
+constexpr size_t kSegments = 5000;
+constexpr int kWarmupFrames = 10;
+
+std::atomic<size_t> g_alloc_count{0};
+std::atomic<size_t> g_alloc_bytes{0};
+
+void* counted_alloc(size_t size) {
+    g_alloc_count.fetch_add(1, std::memory_order_relaxed);
+    g_alloc_bytes.fetch_add(size, std::memory_order_relaxed);
+    return std::malloc(size ? size : 1);
+}
+
+void* imgui_alloc(size_t size, void*) {
+    return counted_alloc(size);
+}
+
+void imgui_free(void* ptr, void*) {
+    std::free(ptr);
+}
+
+double thread_cpu_ms() {
+    timespec ts{};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+} // namespace
+
+// Count every heap allocation made on the frame path
+void* operator new(size_t size) {
+    void* ptr = counted_alloc(size);
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+namespace trimora {
+
+struct UiBenchAccess {
+    static void seed_log(MainWindow& window, size_t lines) {
+        // Through the sink's queue, so the console keeps only its newest lines
+        std::lock_guard<std::mutex> lock(window.log_mutex_);
+        for (size_t i = 0; i < lines; ++i) {
+            window.pending_log_.push_back({"Processing file " + std::to_string(i) +
+                ": /mnt/ingest/camera_a/clip_" + std::to_string(i) + ".mp4"});
+        }
+    }
+
+    // A running batch: a quarter done, a few failed, one in flight
+    static void seed_batch(MainWindow& window, size_t files) {
+        window.batch_mode_ = true;
+        window.batch_jobs_.reserve(files);
+
+        for (size_t i = 0; i < files; ++i) {
+            BatchJob job;
+            job.id = window.next_batch_job_id_++;
+            job.input_file = "/mnt/ingest/camera_a/clip_" + std::to_string(i) + ".mp4";
+            job.name_label = job.input_file.filename().string();
+            job.size_bytes = (200 + i % 1800) * 1024ull * 1024ull;
+
+            if (i < files / 4) {
+                job.status = (i % 97 == 0) ? BatchJobStatus::Failed : BatchJobStatus::Completed;
+                job.duration_seconds = 60.0 + i % 600;
+                job.progress = 1.0f;
+                if (job.status == BatchJobStatus::Failed) {
+                    job.error = "FFmpeg exited with code: 1";
+                }
+            } else if (i == files / 4) {
+                job.status = BatchJobStatus::Running;
+                job.duration_seconds = 120.0;
+                window.running_batch_job_id_ = job.id;
+            }
+            job.refresh_labels();
+            window.batch_jobs_.push_back(std::move(job));
+        }
+
+        window.batch_view_dirty_ = true;
+        window.is_trimming_ = true;
+        window.current_batch_index_ = files / 4;
+        window.total_batch_count_ = files;
+    }
+
+    static void seed_segments(MainWindow& window, size_t segments) {
+        window.batch_mode_ = false;
+        window.segment_mode_ = true;
+        std::strncpy(window.input_file_, "/mnt/ingest/camera_a/long_take.mp4", sizeof(window.input_file_) - 1);
+
+        for (size_t i = 0; i < segments; ++i) {
+            window.segment_manager_->add_segment(TrimSegment(
+                MainWindow::format_timestamp(i * 10.0),
+                MainWindow::format_timestamp(i * 10.0 + 5.0),
+                "Segment " + std::to_string(i + 1)
+            ));
+        }
+    }
+
+    // Same path as an FFmpeg worker's progress callback
+    static void post_progress(MainWindow& window, int frame) {
+        uint64_t job_id = window.running_batch_job_id_;
+        window.post_to_ui([&window, job_id, frame]() {
+            FFmpegProgress progress;
+            progress.percentage = (frame % 1000) / 10.0;
+            progress.current_time = MainWindow::format_timestamp(frame * 0.1);
+            progress.speed = "1.50x";
+            progress.total_duration = 120.0;
+            window.on_progress_update(progress);
+
+            if (BatchJob* job = window.find_batch_job(job_id)) {
+                job->set_progress(static_cast<float>(progress.percentage / 100.0), 1.5);
+            }
+        });
+    }
+};
+
+} // namespace trimora
+
+namespace {
+
+struct FrameStats {
+    std::vector<double> cpu_ms;
+    std::vector<size_t> allocs;
+    std::vector<size_t> alloc_bytes;
+};
+
+template <typename Fn>
+FrameStats run_frames(trimora::MainWindow& window, int frames, Fn before_frame) {
+    FrameStats stats;
+    ImGuiIO& io = ImGui::GetIO();
+
+    for (int frame = -kWarmupFrames; frame < frames; ++frame) {
+        before_frame(frame);
+
+        size_t allocs_before = g_alloc_count.load(std::memory_order_relaxed);
+        size_t bytes_before = g_alloc_bytes.load(std::memory_order_relaxed);
+        double start = thread_cpu_ms();
+
+        io.DeltaTime = 1.0f / 60.0f;
+        ImGui::NewFrame();
+        window.render();
+        ImGui::Render();
+
+        double elapsed = thread_cpu_ms() - start;
+        if (frame >= 0) {
+            stats.cpu_ms.push_back(elapsed);
+            stats.allocs.push_back(g_alloc_count.load(std::memory_order_relaxed) - allocs_before);
+            stats.alloc_bytes.push_back(g_alloc_bytes.load(std::memory_order_relaxed) - bytes_before);
+        }
+    }
+
+    return stats;
+}
+
+template <typename T>
+T percentile(std::vector<T> values, double p) {
+    if (values.empty()) {
+        return T{};
+    }
+    std::sort(values.begin(), values.end());
+    size_t index = static_cast<size_t>(p * (values.size() - 1) + 0.5);
+    return values[index];
+}
+
+template <typename T>
+double mean(const std::vector<T>& values) {
+    double total = 0.0;
+    for (T value : values) {
+        total += static_cast<double>(value);
+    }
+    return values.empty() ? 0.0 : total / values.size();
+}
+
+void report(const char* scenario, const FrameStats& stats) {
+    std::printf("%-28s %9.3f %9.3f %9.3f %9.3f %11.1f %13.1f\n",
+        scenario,
+        mean(stats.cpu_ms),
+        percentile(stats.cpu_ms, 0.50),
+        percentile(stats.cpu_ms, 0.99),
+        percentile(stats.cpu_ms, 1.0),
+        mean(stats.allocs),
+        mean(stats.alloc_bytes) / 1024.0);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int frames = 300;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frames = std::max(1, std::atoi(argv[++i]));
+        }
+    }
+
+    ImGui::SetAllocatorFunctions(imgui_alloc, imgui_free);
+    ImGui::CreateContext();
+
+    ImGuiIO& io = ImGui::GetIO();
+    io.IniFilename = nullptr;
+    io.LogFilename = nullptr;
+    io.DisplaySize = ImVec2(1920.0f, 1080.0f);
+
+    // No renderer: build the font atlas once and never upload it
+    unsigned char* pixels = nullptr;
+    int width = 0;
+    int height = 0;
+    io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+
+    trimora::ConfigManager config_manager;
+
+    std::printf("%d frames per scenario, %zu batch files, %zu log lines, %zu segments\n\n",
+        frames, kBatchFiles, kLogLines, kSegments);
+    std::printf("%-28s %9s %9s %9s %9s %11s %13s\n",
+        "scenario", "mean ms", "p50 ms", "p99 ms", "max ms", "allocs/frm", "KiB/frame");
+
+    {
+        trimora::MainWindow window(config_manager);
+        report("idle", run_frames(window, frames, [](int) {}));
+    }
+
+    {
+        trimora::MainWindow window(config_manager);
+        trimora::UiBenchAccess::seed_log(window, kLogLines);
+        report("log", run_frames(window, frames, [](int) {}));
+    }
+
+    {
+        trimora::MainWindow window(config_manager);
+        trimora::UiBenchAccess::seed_log(window, kLogLines);
+        trimora::UiBenchAccess::seed_batch(window, kBatchFiles);
+        report("batch + log", run_frames(window, frames, [](int) {}));
+        report("batch + log + progress", run_frames(window, frames, [&window](int frame) {
+            trimora::UiBenchAccess::post_progress(window, frame);
+        }));
+    }
+
+    {
+        trimora::MainWindow window(config_manager);
+        trimora::UiBenchAccess::seed_log(window, kLogLines);
+        trimora::UiBenchAccess::seed_segments(window, kSegments);
+        report("segments + log", run_frames(window, frames, [](int) {}));
+    }
+
+    ImGui::DestroyContext();
+    return 0;
+}
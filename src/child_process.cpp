@@ -0,0 +1,117 @@
+#include "child_process.hpp"
+#include "metrics.hpp"
+#include <spawn.h>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <cerrno>
+#include <csignal>
+#include <thread>
+
+extern char** environ;
+
+namespace trimora {
+
+ChildProcess::ChildProcess(const std::string& command, const std::string& label) {
+    // Close-on-exec, so children spawned meanwhile by other threads don't
+    // inherit the pipe and hold off EOF; the dup2 below clears it on stdout
+    int fds[2];
+    if (pipe2(fds, O_CLOEXEC) != 0) {
+        return;
+    }
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, fds[1], STDOUT_FILENO);
+    posix_spawn_file_actions_addclose(&actions, fds[0]);
+    posix_spawn_file_actions_addclose(&actions, fds[1]);
+
+    // "exec" so the shell is replaced and pid_ is the command itself
+    std::string script = "exec " + command;
+    const char* argv[] = {"sh", "-c", script.c_str(), nullptr};
+
+    int result = posix_spawn(&pid_, "/bin/sh", &actions, nullptr,
+        const_cast<char* const*>(argv), environ);
+    posix_spawn_file_actions_destroy(&actions);
+    close(fds[1]);
+
+    if (result != 0) {
+        close(fds[0]);
+        pid_ = -1;
+        return;
+    }
+
+    output_ = fdopen(fds[0], "r");
+    if (!output_) {
+        close(fds[0]);
+        wait();
+        return;
+    }
+
+    Metrics::instance().child_started(pid_, label);
+}
+
+ChildProcess::~ChildProcess() {
+    wait();
+}
+
+int ChildProcess::wait() {
+    if (output_) {
+        fclose(output_);
+        output_ = nullptr;
+    }
+
+    if (pid_ > 0) {
+        // Wait for the exit without reaping, so the pid stays ours until
+        // signal() can no longer use it
+        siginfo_t info {};
+        while (waitid(P_PID, pid_, &info, WEXITED | WNOWAIT) < 0 && errno == EINTR) {
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        int status = 0;
+        while (waitpid(pid_, &status, 0) < 0 && errno == EINTR) {
+        }
+        status_ = status;
+        Metrics::instance().child_exited(pid_);
+        pid_ = -1;
+    }
+
+    return status_;
+}
+
+void ChildProcess::signal(int sig) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (pid_ > 0) {
+        ::kill(pid_, sig);
+    }
+}
+
+int ChildProcess::terminate(std::chrono::milliseconds grace) {
+    // Nobody reads the output any more; a child blocked writing it gets EPIPE
+    if (output_) {
+        fclose(output_);
+        output_ = nullptr;
+    }
+    signal(SIGTERM);
+    auto deadline = std::chrono::steady_clock::now() + grace;
+    bool exited = pid_ <= 0;
+    while (!exited && std::chrono::steady_clock::now() < deadline) {
+        siginfo_t info {};
+        exited = waitid(P_PID, pid_, &info, WEXITED | WNOHANG | WNOWAIT) == 0 && info.si_pid == pid_;
+        if (!exited) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+    }
+    if (!exited) {
+        signal(SIGKILL);
+    }
+    return wait();
+}
+
+void ChildProcess::report_progress(uint64_t bytes_written, const std::string& speed) {
+    if (pid_ > 0) {
+        Metrics::instance().child_progress(pid_, bytes_written, speed);
+    }
+}
+
+} // namespace trimora
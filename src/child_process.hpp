@@ -0,0 +1,49 @@
+#pragma once
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <cstdio>
+#include <cstdint>
+#include <sys/types.h>
+
+namespace trimora {
+
+// Shell command whose stdout is read through a FILE*, like popen(), but
+// with the child's pid known. The command is exec'd by the shell, so the
+// pid is the ffmpeg process itself. Running children are registered with
+// Metrics for the performance HUD.
+class ChildProcess {
+public:
+    ChildProcess(const std::string& command, const std::string& label);
+    ~ChildProcess();
+
+    ChildProcess(const ChildProcess&) = delete;
+    ChildProcess& operator=(const ChildProcess&) = delete;
+
+    explicit operator bool() const { return output_ != nullptr; }
+    FILE* output() const { return output_; }
+    pid_t pid() const { return pid_; }
+
+    // Close the pipe and reap the child; returns the wait status like pclose()
+    int wait();
+
+    // Send sig unless the child has been reaped already (so never to a
+    // recycled pid). Safe from other threads while wait() blocks.
+    void signal(int sig);
+
+    // SIGTERM, then SIGKILL if the child is still there after grace; reaps
+    // it like wait()
+    int terminate(std::chrono::milliseconds grace);
+
+    // Record progress already parsed by the caller (for the HUD)
+    void report_progress(uint64_t bytes_written, const std::string& speed);
+
+private:
+    FILE* output_ = nullptr;
+    std::mutex mutex_;  // Orders signal() against reaping
+    pid_t pid_ = -1;
+    int status_ = -1;
+};
+
+} // namespace trimora
@@ -0,0 +1,125 @@
+#include "chunk_sequence.hpp"
+#include <algorithm>
+#include <cctype>
+#include <iomanip>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+namespace trimora {
+
+namespace {
+
+// Pieces shorter than this are rounding at a chunk boundary, not content
+constexpr double kMinPieceSeconds = 0.001;
+
+bool natural_less(const std::string& a, const std::string& b) {
+    size_t i = 0;
+    size_t j = 0;
+    while (i < a.size() && j < b.size()) {
+        if (std::isdigit(static_cast<unsigned char>(a[i])) && std::isdigit(static_cast<unsigned char>(b[j]))) {
+            size_t a_end = i;
+            size_t b_end = j;
+            while (a_end < a.size() && std::isdigit(static_cast<unsigned char>(a[a_end]))) ++a_end;
+            while (b_end < b.size() && std::isdigit(static_cast<unsigned char>(b[b_end]))) ++b_end;
+
+            // Compare by value: strip leading zeros, then length, then digits
+            size_t a_start = i;
+            size_t b_start = j;
+            while (a_start + 1 < a_end && a[a_start] == '0') ++a_start;
+            while (b_start + 1 < b_end && b[b_start] == '0') ++b_start;
+            if (a_end - a_start != b_end - b_start) {
+                return a_end - a_start < b_end - b_start;
+            }
+            int cmp = a.compare(a_start, a_end - a_start, b, b_start, b_end - b_start);
+            if (cmp != 0) {
+                return cmp < 0;
+            }
+            i = a_end;
+            j = b_end;
+            continue;
+        }
+        if (a[i] != b[j]) {
+            return a[i] < b[j];
+        }
+        ++i;
+        ++j;
+    }
+    return a.size() - i < b.size() - j;
+}
+
+std::string quote_concat_path(const std::string& path) {
+    // ffconcat quoting: close the quote, escape the apostrophe, reopen
+    std::string quoted = "'";
+    for (char c : path) {
+        if (c == '\'') {
+            quoted += "'\\''";
+        } else {
+            quoted += c;
+        }
+    }
+    return quoted + "'";
+}
+
+} // namespace
+
+ChunkSequence::ChunkSequence(std::vector<Chunk> chunks) : chunks_(std::move(chunks)) {
+    double position = 0.0;
+    for (const auto& chunk : chunks_) {
+        starts_.push_back(position);
+        position += chunk.duration_seconds;
+    }
+}
+
+double ChunkSequence::total_duration() const {
+    return chunks_.empty() ? 0.0 : starts_.back() + chunks_.back().duration_seconds;
+}
+
+std::vector<ChunkRange> ChunkSequence::map_range(double start_seconds, double end_seconds) const {
+    std::vector<ChunkRange> ranges;
+    double end = end_seconds > start_seconds ? end_seconds : total_duration();
+
+    for (size_t i = 0; i < chunks_.size(); ++i) {
+        double chunk_start = starts_[i];
+        double chunk_end = chunk_start + chunks_[i].duration_seconds;
+        if (end <= chunk_start || start_seconds >= chunk_end) {
+            continue;
+        }
+
+        ChunkRange range;
+        range.file = chunks_[i].file;
+        range.inpoint = std::max(0.0, start_seconds - chunk_start);
+        range.outpoint = std::min(chunks_[i].duration_seconds, end - chunk_start);
+        range.to_end = end >= chunk_end - kMinPieceSeconds;
+        if (range.outpoint - range.inpoint < kMinPieceSeconds) {
+            continue;
+        }
+        ranges.push_back(range);
+    }
+    return ranges;
+}
+
+std::string ChunkSequence::to_concat_script(const std::vector<ChunkRange>& ranges) {
+    std::ostringstream script;
+    script << "ffconcat version 1.0\n" << std::fixed << std::setprecision(6);
+    for (const auto& range : ranges) {
+        script << "file " << quote_concat_path(range.file.string()) << "\n";
+        if (range.inpoint > 0.0) {
+            script << "inpoint " << range.inpoint << "\n";
+        }
+        // Probed durations are rounded; a chunk taken to its end keeps its
+        // last frames by leaving the outpoint open
+        if (!range.to_end) {
+            script << "outpoint " << range.outpoint << "\n";
+        }
+    }
+    return script.str();
+}
+
+void ChunkSequence::sort_natural(std::vector<fs::path>& files) {
+    std::sort(files.begin(), files.end(), [](const fs::path& a, const fs::path& b) {
+        return natural_less(a.string(), b.string());
+    });
+}
+
+} // namespace trimora
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <filesystem>
+
+namespace trimora {
+
+// One file of a recording the camera or OBS split at its size limit
+struct Chunk {
+    std::filesystem::path file;
+    double duration_seconds = 0.0;
+};
+
+// The part of one chunk that falls in a range of the joined timeline, in
+// that chunk's own time
+struct ChunkRange {
+    std::filesystem::path file;
+    double inpoint = 0.0;
+    double outpoint = 0.0;
+    bool to_end = false;  // Runs through the end of the chunk
+};
+
+// An ordered list of chunk files presented as one continuous timeline.
+// Timeline positions map to a chunk and a time within it, so a range can be
+// cut by touching only the chunks it spans instead of merging them first.
+class ChunkSequence {
+public:
+    ChunkSequence() = default;
+    explicit ChunkSequence(std::vector<Chunk> chunks);
+
+    bool empty() const { return chunks_.empty(); }
+    size_t size() const { return chunks_.size(); }
+    const std::vector<Chunk>& chunks() const { return chunks_; }
+
+    double total_duration() const;
+
+    // Where each chunk starts on the joined timeline
+    const std::vector<double>& chunk_starts() const { return starts_; }
+
+    // Per-chunk pieces covering [start, end) of the timeline, in order.
+    // end <= start runs to the end of the last chunk.
+    std::vector<ChunkRange> map_range(double start_seconds, double end_seconds) const;
+
+    // ffconcat script that plays the pieces back to back
+    static std::string to_concat_script(const std::vector<ChunkRange>& ranges);
+
+    // Recorder numbering order: digit runs compare as numbers, so
+    // "part2" sorts before "part10"
+    static void sort_natural(std::vector<std::filesystem::path>& files);
+
+private:
+    std::vector<Chunk> chunks_;
+    std::vector<double> starts_;
+};
+
+} // namespace trimora
@@ -2,6 +2,8 @@
 #include "file_manager.hpp"
 #include <fstream>
 #include <sstream>
+#include <map>
+#include <cctype>
 
 namespace fs = std::filesystem;
 
@@ -77,16 +79,192 @@ void ConfigManager::load_defaults() {
     config_.recent_files_count = 5;
     config_.auto_open_output = false;
     config_.log_level = "info";
+    config_.log_max_file_mb = 5;
+    config_.log_max_files = 3;
     config_.theme = "dark";
+    config_.stage_inputs = false;
+    config_.staging_directory = fs::temp_directory_path() / "trimora_staging";
+    config_.staging_max_file_mb = 4096;
+    config_.staging_bandwidth_limit_mbps = 0;
+    config_.cache_prefetch_next = true;
+    config_.cache_drop_behind = false;
+    config_.cache_sync_before_drop = false;
+    config_.preflight_workers = 4;
+    config_.job_slots = 0;
+    config_.job_slots_directory.clear();
+    config_.segment_cache_enabled = true;
+    config_.segment_cache_directory.clear();
+    config_.segment_cache_max_mb = 4096;
+    config_.speculative_extraction = true;
+    config_.speculative_extraction_delay_seconds = 3;
+    config_.output_digests.clear();
+    config_.upload_enabled = false;
+    config_.upload_endpoint.clear();
+    config_.upload_region = "us-east-1";
+    config_.upload_bucket.clear();
+    config_.upload_prefix.clear();
+    config_.upload_access_key.clear();
+    config_.upload_secret_key.clear();
+    config_.upload_part_size_mb = 16;
+    config_.upload_concurrency = 4;
+    config_.upload_retries = 4;
 }
 
-bool ConfigManager::parse_json(const std::string& /*json_content*/) {
-    // Simple JSON parsing (for production, use a proper JSON library)
-    // This is a simplified implementation
+namespace {
+
+// Flat JSON object reader: collects top-level "key": value pairs as raw
+// strings (string values are unescaped, numbers/booleans are kept verbatim).
+std::map<std::string, std::string> read_flat_json(const std::string& json) {
+    std::map<std::string, std::string> values;
+    size_t pos = 0;
+    
+    auto read_string = [&json, &pos](std::string& out) -> bool {
+        if (pos >= json.size() || json[pos] != '"') {
+            return false;
+        }
+        ++pos;
+        while (pos < json.size() && json[pos] != '"') {
+            char c = json[pos++];
+            if (c == '\\' && pos < json.size()) {
+                char esc = json[pos++];
+                switch (esc) {
+                    case 'n': out += '\n'; break;
+                    case 't': out += '\t'; break;
+                    case 'r': out += '\r'; break;
+                    default: out += esc; break;
+                }
+            } else {
+                out += c;
+            }
+        }
+        ++pos;  // Closing quote
+        return true;
+    };
+    
+    auto skip_whitespace = [&json, &pos]() {
+        while (pos < json.size() && std::isspace(static_cast<unsigned char>(json[pos]))) {
+            ++pos;
+        }
+    };
+    
+    while ((pos = json.find('"', pos)) != std::string::npos) {
+        std::string key;
+        if (!read_string(key)) {
+            break;
+        }
+        
+        skip_whitespace();
+        if (pos >= json.size() || json[pos] != ':') {
+            continue;
+        }
+        ++pos;
+        skip_whitespace();
+        
+        std::string value;
+        if (pos < json.size() && json[pos] == '"') {
+            read_string(value);
+        } else {
+            while (pos < json.size() && json[pos] != ',' && json[pos] != '}' &&
+                   !std::isspace(static_cast<unsigned char>(json[pos]))) {
+                value += json[pos++];
+            }
+        }
+        values[key] = value;
+    }
     
-    // For now, just load defaults and return true
-    // In production, parse the JSON properly
+    return values;
+}
+
+std::string escape_json(const std::string& value) {
+    std::string escaped;
+    for (char c : value) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+
+} // namespace
+
+bool ConfigManager::parse_json(const std::string& json_content) {
+    // Simple flat JSON parsing (for production, use a proper JSON library).
+    // Unknown keys are ignored and missing keys keep their defaults.
     load_defaults();
+    
+    auto values = read_flat_json(json_content);
+    
+    auto get_string = [&values](const char* key, std::string& out) {
+        auto it = values.find(key);
+        if (it != values.end()) {
+            out = it->second;
+        }
+    };
+    auto get_path = [&values](const char* key, fs::path& out) {
+        auto it = values.find(key);
+        if (it != values.end() && !it->second.empty()) {
+            out = it->second;
+        }
+    };
+    auto get_bool = [&values](const char* key, bool& out) {
+        auto it = values.find(key);
+        if (it != values.end()) {
+            out = (it->second == "true");
+        }
+    };
+    auto get_size = [&values](const char* key, size_t& out) {
+        auto it = values.find(key);
+        if (it != values.end()) {
+            try {
+                out = static_cast<size_t>(std::stoull(it->second));
+            } catch (...) {
+                // Keep default on malformed numbers
+            }
+        }
+    };
+    
+    try {
+        get_path("ffmpeg_path", config_.ffmpeg_path);
+        get_path("output_directory", config_.output_directory);
+        get_string("output_naming_pattern", config_.output_naming_pattern);
+        get_size("recent_files_count", config_.recent_files_count);
+        get_bool("auto_open_output", config_.auto_open_output);
+        get_string("log_level", config_.log_level);
+        get_size("log_max_file_mb", config_.log_max_file_mb);
+        get_size("log_max_files", config_.log_max_files);
+        get_string("theme", config_.theme);
+        get_bool("stage_inputs", config_.stage_inputs);
+        get_path("staging_directory", config_.staging_directory);
+        get_size("staging_max_file_mb", config_.staging_max_file_mb);
+        get_size("staging_bandwidth_limit_mbps", config_.staging_bandwidth_limit_mbps);
+        get_bool("cache_prefetch_next", config_.cache_prefetch_next);
+        get_bool("cache_drop_behind", config_.cache_drop_behind);
+        get_bool("cache_sync_before_drop", config_.cache_sync_before_drop);
+        get_size("preflight_workers", config_.preflight_workers);
+        get_size("job_slots", config_.job_slots);
+        get_path("job_slots_directory", config_.job_slots_directory);
+        get_bool("segment_cache_enabled", config_.segment_cache_enabled);
+        get_path("segment_cache_directory", config_.segment_cache_directory);
+        get_size("segment_cache_max_mb", config_.segment_cache_max_mb);
+        get_bool("speculative_extraction", config_.speculative_extraction);
+        get_size("speculative_extraction_delay_seconds", config_.speculative_extraction_delay_seconds);
+        get_string("output_digests", config_.output_digests);
+        get_bool("upload_enabled", config_.upload_enabled);
+        get_string("upload_endpoint", config_.upload_endpoint);
+        get_string("upload_region", config_.upload_region);
+        get_string("upload_bucket", config_.upload_bucket);
+        get_string("upload_prefix", config_.upload_prefix);
+        get_string("upload_access_key", config_.upload_access_key);
+        get_string("upload_secret_key", config_.upload_secret_key);
+        get_size("upload_part_size_mb", config_.upload_part_size_mb);
+        get_size("upload_concurrency", config_.upload_concurrency);
+        get_size("upload_retries", config_.upload_retries);
+    } catch (...) {
+        load_defaults();
+        return false;
+    }
+    
     return true;
 }
 
@@ -94,13 +272,41 @@ std::string ConfigManager::to_json() const {
     std::ostringstream json;
     
     json << "{\n";
-    json << "  \"ffmpeg_path\": \"" << config_.ffmpeg_path.string() << "\",\n";
-    json << "  \"output_directory\": \"" << config_.output_directory.string() << "\",\n";
-    json << "  \"output_naming_pattern\": \"" << config_.output_naming_pattern << "\",\n";
+    json << "  \"ffmpeg_path\": \"" << escape_json(config_.ffmpeg_path.string()) << "\",\n";
+    json << "  \"output_directory\": \"" << escape_json(config_.output_directory.string()) << "\",\n";
+    json << "  \"output_naming_pattern\": \"" << escape_json(config_.output_naming_pattern) << "\",\n";
     json << "  \"recent_files_count\": " << config_.recent_files_count << ",\n";
     json << "  \"auto_open_output\": " << (config_.auto_open_output ? "true" : "false") << ",\n";
-    json << "  \"log_level\": \"" << config_.log_level << "\",\n";
-    json << "  \"theme\": \"" << config_.theme << "\"\n";
+    json << "  \"log_level\": \"" << escape_json(config_.log_level) << "\",\n";
+    json << "  \"log_max_file_mb\": " << config_.log_max_file_mb << ",\n";
+    json << "  \"log_max_files\": " << config_.log_max_files << ",\n";
+    json << "  \"theme\": \"" << escape_json(config_.theme) << "\",\n";
+    json << "  \"stage_inputs\": " << (config_.stage_inputs ? "true" : "false") << ",\n";
+    json << "  \"staging_directory\": \"" << escape_json(config_.staging_directory.string()) << "\",\n";
+    json << "  \"staging_max_file_mb\": " << config_.staging_max_file_mb << ",\n";
+    json << "  \"staging_bandwidth_limit_mbps\": " << config_.staging_bandwidth_limit_mbps << ",\n";
+    json << "  \"cache_prefetch_next\": " << (config_.cache_prefetch_next ? "true" : "false") << ",\n";
+    json << "  \"cache_drop_behind\": " << (config_.cache_drop_behind ? "true" : "false") << ",\n";
+    json << "  \"cache_sync_before_drop\": " << (config_.cache_sync_before_drop ? "true" : "false") << ",\n";
+    json << "  \"preflight_workers\": " << config_.preflight_workers << ",\n";
+    json << "  \"job_slots\": " << config_.job_slots << ",\n";
+    json << "  \"job_slots_directory\": \"" << escape_json(config_.job_slots_directory.string()) << "\",\n";
+    json << "  \"segment_cache_enabled\": " << (config_.segment_cache_enabled ? "true" : "false") << ",\n";
+    json << "  \"segment_cache_directory\": \"" << escape_json(config_.segment_cache_directory.string()) << "\",\n";
+    json << "  \"segment_cache_max_mb\": " << config_.segment_cache_max_mb << ",\n";
+    json << "  \"speculative_extraction\": " << (config_.speculative_extraction ? "true" : "false") << ",\n";
+    json << "  \"speculative_extraction_delay_seconds\": " << config_.speculative_extraction_delay_seconds << ",\n";
+    json << "  \"output_digests\": \"" << escape_json(config_.output_digests) << "\",\n";
+    json << "  \"upload_enabled\": " << (config_.upload_enabled ? "true" : "false") << ",\n";
+    json << "  \"upload_endpoint\": \"" << escape_json(config_.upload_endpoint) << "\",\n";
+    json << "  \"upload_region\": \"" << escape_json(config_.upload_region) << "\",\n";
+    json << "  \"upload_bucket\": \"" << escape_json(config_.upload_bucket) << "\",\n";
+    json << "  \"upload_prefix\": \"" << escape_json(config_.upload_prefix) << "\",\n";
+    json << "  \"upload_access_key\": \"" << escape_json(config_.upload_access_key) << "\",\n";
+    json << "  \"upload_secret_key\": \"" << escape_json(config_.upload_secret_key) << "\",\n";
+    json << "  \"upload_part_size_mb\": " << config_.upload_part_size_mb << ",\n";
+    json << "  \"upload_concurrency\": " << config_.upload_concurrency << ",\n";
+    json << "  \"upload_retries\": " << config_.upload_retries << "\n";
     json << "}\n";
     
     return json.str();
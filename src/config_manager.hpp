@@ -12,8 +12,56 @@ struct Config {
     std::string output_naming_pattern = "{name}_trimmed_{timestamp}";
     size_t recent_files_count = 5;
     bool auto_open_output = false;
-    std::string log_level = "info";
+    std::string log_level = "info";          // trace, debug, info, warning, error, off
+    size_t log_max_file_mb = 5;              // Rotate trimora.log beyond this size
+    size_t log_max_files = 3;                // Rotated files to keep
     std::string theme = "dark";
+
+    // Batch input staging (copy inputs on slow media to local scratch)
+    bool stage_inputs = false;
+    std::filesystem::path staging_directory;
+    size_t staging_max_file_mb = 4096;       // Larger inputs are read in place
+    size_t staging_bandwidth_limit_mbps = 0; // MB/s, 0 = unlimited
+
+    // Page cache management for batch I/O
+    bool cache_prefetch_next = true;     // Readahead the next queued input
+    bool cache_drop_behind = false;      // Evict finished inputs/outputs
+    bool cache_sync_before_drop = false; // fdatasync outputs before evicting
+
+    // Input validation, probing and output naming before jobs start
+    size_t preflight_workers = 4;
+
+    // Jobs running at once across all trimora instances on the machine
+    // that share job_slots_directory; 0 = half the logical CPUs
+    size_t job_slots = 0;
+    std::filesystem::path job_slots_directory;  // Empty: per-user runtime directory
+
+    // Merge pieces kept between exports, so re-exporting an edited segment
+    // list only extracts the segments that changed
+    bool segment_cache_enabled = true;
+    std::filesystem::path segment_cache_directory;  // Empty: trimora_segment_cache in the temp directory
+    size_t segment_cache_max_mb = 4096;
+    // Extract segments into the cache in the background once they have been
+    // left unchanged for the delay, so Export is mostly a concat
+    bool speculative_extraction = true;
+    size_t speculative_extraction_delay_seconds = 3;
+
+    // Checksums taken while outputs are written: "sha256", "xxh3" or both,
+    // comma-separated; saved as <output>.sha256 / <output>.xxh3
+    std::string output_digests;
+
+    // Copy finished outputs to an S3-compatible bucket in the background.
+    // Empty keys fall back to AWS_ACCESS_KEY_ID / AWS_SECRET_ACCESS_KEY.
+    bool upload_enabled = false;
+    std::string upload_endpoint;             // http(s)://host[:port]
+    std::string upload_region = "us-east-1";
+    std::string upload_bucket;
+    std::string upload_prefix;               // Key prefix, e.g. "trims/"
+    std::string upload_access_key;
+    std::string upload_secret_key;
+    size_t upload_part_size_mb = 16;
+    size_t upload_concurrency = 4;           // Part uploads in flight
+    size_t upload_retries = 4;               // Per request
 };
 
 class ConfigManager {
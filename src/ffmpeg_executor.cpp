@@ -1,5 +1,12 @@
 #include "ffmpeg_executor.hpp"
-#include <iostream>
+#include "file_manager.hpp"
+#include "logger.hpp"
+#include "child_process.hpp"
+#include "ts_cutter.hpp"
+#include "mkv_cutter.hpp"
+#include "in_place_trim.hpp"
+#include "upload_sink.hpp"
+#include "segment_cache.hpp"
 #include <sstream>
 #include <fstream>
 #include <iomanip>
@@ -7,14 +14,28 @@
 #include <thread>
 #include <atomic>
 #include <cstdlib>
+#include <cerrno>
 #include <array>
+#include <chrono>
 #include <memory>
 #include <algorithm>
+#include <cctype>
+#include <csignal>
+#include <poll.h>
+#include <sys/resource.h>
+#include <unistd.h>
 
 namespace fs = std::filesystem;
 
 namespace trimora {
 
+namespace {
+
+// How long a cancelled FFmpeg gets to close its output before SIGKILL
+constexpr auto kCancelGrace = std::chrono::seconds(5);
+
+} // namespace
+
 FFmpegExecutor::FFmpegExecutor() {
     // Try to find ffmpeg in PATH - simple check
     // Check common locations
@@ -55,18 +76,7 @@ FFmpegExecutor::FFmpegExecutor() {
     
     // Get version if found
     if (!ffmpeg_path_.empty()) {
-        FILE* pipe = popen((ffmpeg_path_.string() + " -version 2>&1").c_str(), "r");
-        if (pipe) {
-            std::array<char, 512> buffer;
-            if (fgets(buffer.data(), buffer.size(), pipe) != nullptr) {
-                ffmpeg_version_ = buffer.data();
-                // Remove trailing newline
-                if (!ffmpeg_version_.empty() && ffmpeg_version_.back() == '\n') {
-                    ffmpeg_version_.pop_back();
-                }
-            }
-            pclose(pipe);
-        }
+        set_ffmpeg_path(ffmpeg_path_);
     }
 }
 
@@ -85,6 +95,38 @@ std::optional<std::string> FFmpegExecutor::get_ffmpeg_path() const {
     return ffmpeg_path_.string();
 }
 
+bool FFmpegExecutor::set_ffmpeg_path(const fs::path& path) {
+    if (!validate_ffmpeg_binary(path)) {
+        return false;
+    }
+    
+    ffmpeg_path_ = path;
+    
+    // Prefer the ffprobe shipped alongside this ffmpeg, else whatever is in PATH
+    fs::path ffprobe = path.parent_path() / ("ffprobe" + path.extension().string());
+    ffprobe_path_ = fs::exists(ffprobe) ? ffprobe : fs::path("ffprobe");
+    
+    query_ffmpeg_version();
+    return true;
+}
+
+void FFmpegExecutor::query_ffmpeg_version() {
+    ffmpeg_version_.clear();
+    
+    FILE* pipe = popen((ffmpeg_path_.string() + " -version 2>&1").c_str(), "r");
+    if (pipe) {
+        std::array<char, 512> buffer;
+        if (fgets(buffer.data(), buffer.size(), pipe) != nullptr) {
+            ffmpeg_version_ = buffer.data();
+            // Remove trailing newline
+            if (!ffmpeg_version_.empty() && ffmpeg_version_.back() == '\n') {
+                ffmpeg_version_.pop_back();
+            }
+        }
+        pclose(pipe);
+    }
+}
+
 std::optional<std::string> FFmpegExecutor::get_ffmpeg_version() const {
     if (ffmpeg_version_.empty()) {
         return std::nullopt;
@@ -95,22 +137,265 @@ std::optional<std::string> FFmpegExecutor::get_ffmpeg_version() const {
 std::string FFmpegExecutor::build_ffmpeg_command(const TrimOptions& options) const {
     std::ostringstream cmd;
     
-    // FFmpeg command: ffmpeg -ss START -to END -i INPUT -c copy OUTPUT
+    // FFmpeg command: ffmpeg -y -progress pipe:1 -ss START -to END -i INPUT -c copy OUTPUT [EXTRA OUTPUTS...]
     cmd << ffmpeg_path_.string() << " ";
-    cmd << "-ss " << options.start_time << " ";
-    cmd << "-to " << options.end_time << " ";
-    cmd << "-i \"" << options.input_file.string() << "\" ";
+    cmd << "-y ";  // Overwrite output files without asking
+    cmd << "-progress pipe:1 ";  // Output progress to stdout
+    
+    std::string input_args = build_input_args(options.input_file, options.chunks,
+        options.start_time, options.end_time, chunk_list_path(options.output_file));
+    if (input_args.empty()) {
+        return "";
+    }
+    cmd << input_args;
     
+    // Every encoded video rendition takes one branch of a single decoded
+    // video stream; copy outputs never touch the decoder
+    std::vector<size_t> encoded;
+    for (size_t i = 0; i < options.additional_outputs.size(); ++i) {
+        if (options.additional_outputs[i].kind == OutputSpec::Kind::VideoEncode) {
+            encoded.push_back(i);
+        }
+    }
+    
+    if (!encoded.empty()) {
+        std::ostringstream graph;
+        graph << "[0:v:0]";
+        if (encoded.size() > 1) {
+            graph << "split=" << encoded.size();
+            for (size_t n = 0; n < encoded.size(); ++n) {
+                graph << "[s" << n << "]";
+            }
+            graph << ";";
+        }
+        
+        for (size_t n = 0; n < encoded.size(); ++n) {
+            const auto& spec = options.additional_outputs[encoded[n]];
+            if (encoded.size() > 1) {
+                graph << (n > 0 ? ";" : "") << "[s" << n << "]";
+            }
+            if (spec.max_height > 0) {
+                graph << "scale=-2:" << spec.max_height;
+            } else {
+                graph << "null";
+            }
+            graph << "[v" << n << "]";
+        }
+        
+        cmd << "-filter_complex \"" << graph.str() << "\" ";
+    }
+    
+    // Main output
     if (options.use_copy_codec) {
         cmd << "-c copy ";
+        if (options.reencode_audio) {
+            double duration = parse_time_to_seconds(options.end_time) - parse_time_to_seconds(options.start_time);
+            cmd << build_audio_fade_args("aac", duration, options.audio_fade_seconds);
+        }
+    }
+    cmd << "\"" << options.output_file.string() << "\" ";
+    
+    // Additional outputs
+    size_t encoded_index = 0;
+    for (const auto& spec : options.additional_outputs) {
+        switch (spec.kind) {
+            case OutputSpec::Kind::StreamCopy:
+                cmd << "-c copy ";
+                break;
+            case OutputSpec::Kind::VideoEncode:
+                cmd << "-map \"[v" << encoded_index++ << "]\" -map 0:a? ";
+                cmd << "-c:v " << spec.video_codec << " -c:a " << spec.audio_codec << " ";
+                break;
+            case OutputSpec::Kind::AudioOnly:
+                cmd << "-map 0:a -vn -c:a " << spec.audio_codec << " ";
+                break;
+        }
+        cmd << "\"" << spec.output_file.string() << "\" ";
     }
     
-    cmd << "\"" << options.output_file.string() << "\"";
+    cmd << "2>&1";  // Redirect stderr to stdout
     
     return cmd.str();
 }
 
+std::string FFmpegExecutor::build_input_args(
+    const fs::path& input_file,
+    const ChunkSequence& chunks,
+    const std::string& start_time,
+    const std::string& end_time,
+    const fs::path& list_file
+) const {
+    std::ostringstream args;
+    if (chunks.empty()) {
+        args << "-ss " << start_time << " ";
+        args << "-to " << end_time << " ";
+        args << "-i \"" << input_file.string() << "\" ";
+        return args.str();
+    }
+    
+    auto ranges = chunks.map_range(parse_time_to_seconds(start_time), parse_time_to_seconds(end_time));
+    if (ranges.empty()) {
+        TRIMORA_LOG_ERROR("Time range is outside the chunked recording");
+        return "";
+    }
+    
+    args << std::fixed << std::setprecision(6);
+    if (ranges.size() == 1) {
+        args << "-ss " << ranges.front().inpoint << " ";
+        if (!ranges.front().to_end) {
+            args << "-to " << ranges.front().outpoint << " ";
+        }
+        args << "-i \"" << ranges.front().file.string() << "\" ";
+        return args.str();
+    }
+    
+    // The concat demuxer opens each listed chunk in turn and seeks inside
+    // it, so only the spanned chunks are read and nothing is merged first
+    std::error_code ec;
+    fs::create_directories(list_file.parent_path(), ec);
+    std::ofstream list(list_file);
+    list << ChunkSequence::to_concat_script(ranges);
+    list.close();
+    if (!list) {
+        TRIMORA_LOG_ERROR("Cannot write chunk list: " + list_file.string());
+        return "";
+    }
+    TRIMORA_LOG_DEBUG("Range spans " + std::to_string(ranges.size()) + " of " +
+                      std::to_string(chunks.size()) + " chunks");
+    
+    args << "-f concat -safe 0 -i \"" << list_file.string() << "\" ";
+    return args.str();
+}
+
+fs::path FFmpegExecutor::segment_output_file(const MultiSegmentTrimOptions& options, size_t index) {
+    const auto& segment = options.segments[index];
+    std::string segment_name = segment.name.empty() ? "segment_" + std::to_string(index + 1) : segment.name;
+    const fs::path& output = options.output_file;
+    return output.parent_path() / (output.stem().string() + "_" + segment_name + output.extension().string());
+}
+
+fs::path FFmpegExecutor::chunk_list_path(const fs::path& output_file) {
+    // Same-named outputs in other directories, or of other instances, get
+    // their own list; the name is derived again when the list is removed
+    std::error_code ec;
+    fs::path absolute = fs::absolute(output_file, ec);
+    std::ostringstream name;
+    name << output_file.filename().string() << '.' << ::getpid() << '-' << std::hex
+         << std::hash<std::string>{}(ec ? output_file.string() : absolute.lexically_normal().string()) << ".ffconcat";
+    return fs::temp_directory_path() / "trimora_chunks" / name.str();
+}
+
+fs::path FFmpegExecutor::make_merge_dir(std::error_code& ec) {
+    // Each merge owns its directory, so cleanup never touches another job's
+    // pieces, whether of this instance or another
+    fs::path parent = fs::temp_directory_path(ec) / "trimora_segments";
+    if (!ec) {
+        fs::create_directories(parent, ec);
+    }
+    if (ec) {
+        return {};
+    }
+    std::string pattern = (parent / "merge-XXXXXX").string();
+    if (::mkdtemp(pattern.data()) == nullptr) {
+        ec = std::error_code(errno, std::generic_category());
+        return {};
+    }
+    return pattern;
+}
+
+TrimOptions FFmpegExecutor::resolve_single_chunk(const TrimOptions& options) const {
+    if (options.chunks.empty()) {
+        return options;
+    }
+    auto ranges = options.chunks.map_range(parse_time_to_seconds(options.start_time),
+                                           parse_time_to_seconds(options.end_time));
+    if (ranges.size() != 1) {
+        return options;
+    }
+    
+    std::ostringstream start;
+    std::ostringstream end;
+    start << std::fixed << std::setprecision(6) << ranges.front().inpoint;
+    end << std::fixed << std::setprecision(6) << ranges.front().outpoint;
+    
+    TrimOptions resolved = options;
+    resolved.input_file = ranges.front().file;
+    resolved.start_time = start.str();
+    resolved.end_time = end.str();
+    resolved.chunks = ChunkSequence();
+    return resolved;
+}
+
+std::vector<fs::path> FFmpegExecutor::get_output_files(const TrimOptions& options) const {
+    std::vector<fs::path> outputs = {options.output_file};
+    for (const auto& spec : options.additional_outputs) {
+        outputs.push_back(spec.output_file);
+    }
+    return outputs;
+}
+
+std::optional<JobSlots::Lease> FFmpegExecutor::wait_for_job_slot(const StatusCallback& status_cb) {
+    if (!job_slots_) {
+        return JobSlots::Lease();
+    }
+    
+    // Background work backs off while a job waits
+    waiting_for_slot_ = true;
+    auto lease = job_slots_->acquire([this] { return !cancel_requested_; }, [this, &status_cb] {
+        status_cb(FFmpegStatus::Running, "Waiting for a job slot (" + std::to_string(job_slots_->slots()) +
+                  " shared by all jobs on this machine)...");
+    });
+    waiting_for_slot_ = false;
+    // A cancel that came in just as the slot was granted counts too
+    if (!lease || cancel_requested_) {
+        status_cb(FFmpegStatus::Cancelled, "Operation cancelled");
+        return std::nullopt;
+    }
+    return lease;
+}
+
+std::vector<std::unique_ptr<OutputDigester>> FFmpegExecutor::start_digests(
+    const std::vector<fs::path>& outputs,
+    const std::vector<DigestAlgorithm>& algorithms,
+    bool written_in_order
+) {
+    std::vector<std::unique_ptr<OutputDigester>> digesters;
+    if (algorithms.empty()) {
+        return digesters;
+    }
+    for (const auto& output : outputs) {
+        std::error_code ec;
+        fs::remove(output, ec);
+        bool append_only = written_in_order || OutputDigester::is_append_only(output);
+        digesters.push_back(std::make_unique<OutputDigester>(output, algorithms, append_only));
+    }
+    return digesters;
+}
+
+bool FFmpegExecutor::finish_digests(
+    std::vector<std::unique_ptr<OutputDigester>>& digesters,
+    std::vector<std::vector<OutputDigest>>& digests,
+    std::string& error_message
+) {
+    for (auto& digester : digesters) {
+        std::vector<OutputDigest> file_digests;
+        if (!digester->finish(file_digests, error_message) ||
+            !OutputDigester::write_sidecars(digester->file(), file_digests, error_message)) {
+            return false;
+        }
+        for (const auto& digest : file_digests) {
+            TRIMORA_LOG_INFO(std::string(digest_name(digest.algorithm)) + " " + digest.hex + "  " +
+                             digester->file().filename().string());
+        }
+        digests.push_back(std::move(file_digests));
+    }
+    digesters.clear();
+    return true;
+}
+
 bool FFmpegExecutor::execute_trim(const TrimOptions& options, std::string& error_message) {
+    cancel_requested_ = false;
+    
     if (!is_ffmpeg_available()) {
         error_message = "FFmpeg not found in PATH";
         return false;
@@ -121,14 +406,16 @@ bool FFmpegExecutor::execute_trim(const TrimOptions& options, std::string& error
         return false;
     }
     
-    // Create output directory if it doesn't exist
-    auto output_dir = options.output_file.parent_path();
-    if (!output_dir.empty() && !fs::exists(output_dir)) {
-        try {
-            fs::create_directories(output_dir);
-        } catch (const std::exception& e) {
-            error_message = "Failed to create output directory: " + std::string(e.what());
-            return false;
+    // Create output directories if they don't exist
+    for (const auto& output : get_output_files(options)) {
+        auto output_dir = output.parent_path();
+        if (!output_dir.empty() && !fs::exists(output_dir)) {
+            try {
+                fs::create_directories(output_dir);
+            } catch (const std::exception& e) {
+                error_message = "Failed to create output directory: " + std::string(e.what());
+                return false;
+            }
         }
     }
     
@@ -138,72 +425,742 @@ bool FFmpegExecutor::execute_trim(const TrimOptions& options, std::string& error
     double target_duration = end_seconds - start_seconds;
     (void)target_duration;  // Unused in blocking version
     
+    auto slot = wait_for_job_slot([](FFmpegStatus, const std::string&) {});
+    if (!slot) {
+        error_message = "Cancelled while waiting for a job slot";
+        return false;
+    }
+    
     is_running_ = true;
     
     try {
         // Build command string with progress output
-        std::ostringstream cmd;
-        cmd << ffmpeg_path_.string() << " ";
-        cmd << "-y ";  // Overwrite output files without asking
-        cmd << "-progress pipe:1 ";  // Output progress to stdout
-        cmd << "-ss " << options.start_time << " ";
-        cmd << "-to " << options.end_time << " ";
-        cmd << "-i \"" << options.input_file.string() << "\" ";
-        
-        if (options.use_copy_codec) {
-            cmd << "-c copy ";
+        std::string cmd = build_ffmpeg_command(options);
+        if (cmd.empty()) {
+            is_running_ = false;
+            error_message = "Could not map the time range onto the input chunks";
+            return false;
         }
         
-        cmd << "\"" << options.output_file.string() << "\" ";
-        cmd << "2>&1";  // Redirect stderr to stdout
-        
-        std::cout << "Executing: " << cmd.str() << std::endl;
+        TRIMORA_LOG_DEBUG("Executing: " + cmd);
         
         // Execute command
-        FILE* pipe = popen(cmd.str().c_str(), "r");
-        if (!pipe) {
+        ChildProcess child(cmd, options.output_file.filename().string());
+        if (!child) {
             is_running_ = false;
             error_message = "Failed to execute FFmpeg command";
             return false;
         }
+        ActiveChild active(*this, child);
         
         // Read output line by line
         std::array<char, 512> buffer;
-        while (fgets(buffer.data(), buffer.size(), pipe) != nullptr && is_running_) {
+        while (fgets(buffer.data(), buffer.size(), child.output()) != nullptr && !cancel_requested_) {
             std::string line(buffer.data());
             
-            // Print all output for debugging
-            std::cout << line;
+            // Keep FFmpeg's output in the log for debugging
+            if (!line.empty() && line.back() == '\n') {
+                line.pop_back();
+            }
+            TRIMORA_LOG_TRACE(line);
             
             // Parse progress (FFmpeg progress format or stderr format)
             // Progress will be handled in async version with callbacks
         }
-        
-        int exit_code = pclose(pipe);
-        is_running_ = false;
-        
-        if (exit_code != 0) {
-            error_message = "FFmpeg exited with code: " + std::to_string(exit_code);
-            return false;
+        
+        int exit_code = finish_child(child);
+        is_running_ = false;
+        
+        std::error_code ec;
+        fs::remove(chunk_list_path(options.output_file), ec);
+        apply_drop_behind(options);
+        
+        if (exit_code != 0 && cancel_requested_) {
+            error_message = "Operation cancelled";
+            return false;
+        }
+        if (exit_code != 0) {
+            error_message = "FFmpeg exited with code: " + std::to_string(exit_code);
+            return false;
+        }
+        
+        return true;
+        
+    } catch (const std::exception& e) {
+        is_running_ = false;
+        error_message = std::string("Exception: ") + e.what();
+        return false;
+    }
+}
+
+void FFmpegExecutor::execute_trim_async(
+    const TrimOptions& options,
+    ProgressCallback progress_cb,
+    StatusCallback status_cb
+) {
+    // Cancels from here on belong to this job
+    cancel_requested_ = false;
+    
+    // Launch in separate thread
+    std::thread worker([this, options = resolve_single_chunk(options), progress_cb, status_cb]() {
+        // Held until the job is done, native cut or FFmpeg
+        auto slot = wait_for_job_slot(status_cb);
+        if (!slot) {
+            return;
+        }
+        
+        if (try_native_cut(options, progress_cb, status_cb)) {
+            return;
+        }
+        
+        status_cb(FFmpegStatus::Running, "Starting FFmpeg...");
+        
+        if (!is_ffmpeg_available()) {
+            status_cb(FFmpegStatus::Failed, "FFmpeg not found in PATH");
+            return;
+        }
+        
+        if (!fs::exists(options.input_file)) {
+            status_cb(FFmpegStatus::Failed, "Input file does not exist");
+            return;
+        }
+        
+        // Create output directories if they don't exist
+        auto outputs = get_output_files(options);
+        for (const auto& output : outputs) {
+            auto output_dir = output.parent_path();
+            if (!output_dir.empty() && !fs::exists(output_dir)) {
+                try {
+                    fs::create_directories(output_dir);
+                } catch (const std::exception& e) {
+                    status_cb(FFmpegStatus::Failed, "Failed to create output directory: " + std::string(e.what()));
+                    return;
+                }
+            }
+        }
+        
+        // Calculate target duration
+        double start_seconds = parse_time_to_seconds(options.start_time);
+        double end_seconds = parse_time_to_seconds(options.end_time);
+        double target_duration = end_seconds - start_seconds;
+        
+        is_running_ = true;
+        
+        try {
+            // Build command with progress output
+            std::string cmd = build_ffmpeg_command(options);
+            if (cmd.empty()) {
+                is_running_ = false;
+                status_cb(FFmpegStatus::Failed, "Could not map the time range onto the input chunks");
+                return;
+            }
+            TRIMORA_LOG_DEBUG("Executing: " + cmd);
+            
+            auto digesters = start_digests(outputs, options.digests);
+            PendingUploads uploads(options.upload, outputs, false, options.digests);
+            ChildProcess child(cmd, options.output_file.filename().string());
+            if (!child) {
+                is_running_ = false;
+                status_cb(FFmpegStatus::Failed, "Failed to execute FFmpeg");
+                return;
+            }
+            ActiveChild active(*this, child);
+            
+            // Read and parse output
+            std::array<char, 1024> buffer;
+            std::string accumulated_line;
+            std::string last_speed;  // -progress reports speed on its own line
+            
+            while (fgets(buffer.data(), buffer.size(), child.output()) != nullptr && !cancel_requested_) {
+                std::string line(buffer.data());
+                accumulated_line += line;
+                
+                // Check if we have a complete line
+                if (line.find('\n') != std::string::npos) {
+                    TRIMORA_LOG_TRACE(accumulated_line.substr(0, accumulated_line.size() - 1));
+                    
+                    // Parse progress
+                    auto progress = parse_progress_line(accumulated_line, target_duration);
+                    if (!progress.speed.empty()) {
+                        last_speed = progress.speed;
+                    }
+                    if (progress.percentage > 0) {
+                        progress.speed = last_speed;
+                        // All outputs advance together; report what each has written
+                        size_t total_bytes = 0;
+                        for (const auto& output : outputs) {
+                            progress.output_bytes.push_back(FileManager::get_file_size(output).value_or(0));
+                            total_bytes += progress.output_bytes.back();
+                        }
+                        child.report_progress(total_bytes, progress.speed);
+                        progress_cb(progress);
+                    }
+                    accumulated_line.clear();
+                }
+            }
+            
+            int exit_code = finish_child(child);
+            is_running_ = false;
+            
+            std::error_code ec;
+            fs::remove(chunk_list_path(options.output_file), ec);
+            
+            // Outputs are hashed while still cached, before drop-behind
+            FFmpegProgress final_progress;
+            std::string digest_error;
+            bool digested = exit_code != 0 || finish_digests(digesters, final_progress.output_digests, digest_error);
+            uploads.finish(exit_code == 0 && digested);
+            apply_drop_behind(options);
+            
+            if (exit_code != 0 && cancel_requested_) {
+                status_cb(FFmpegStatus::Cancelled, "Operation cancelled");
+            } else if (exit_code != 0) {
+                status_cb(FFmpegStatus::Failed, "FFmpeg exited with code: " + std::to_string(exit_code));
+            } else if (!digested) {
+                status_cb(FFmpegStatus::Failed, "Checksum failed: " + digest_error);
+            } else {
+                // Final progress update
+                final_progress.percentage = 100.0;
+                for (const auto& output : outputs) {
+                    final_progress.output_bytes.push_back(FileManager::get_file_size(output).value_or(0));
+                }
+                progress_cb(final_progress);
+                
+                if (outputs.size() > 1) {
+                    status_cb(FFmpegStatus::Completed, "Trim completed successfully (" +
+                        std::to_string(outputs.size()) + " outputs)");
+                } else {
+                    status_cb(FFmpegStatus::Completed, "Trim completed successfully");
+                }
+            }
+            
+        } catch (const std::exception& e) {
+            is_running_ = false;
+            status_cb(FFmpegStatus::Failed, std::string("Exception: ") + e.what());
+        }
+    });
+    
+    worker.detach();
+}
+
+bool FFmpegExecutor::try_native_cut(
+    const TrimOptions& options,
+    const ProgressCallback& progress_cb,
+    const StatusCallback& status_cb
+) {
+    // Only plain copy trims into the same container; anything that needs a
+    // muxer or encoder goes through FFmpeg
+    if (!options.use_copy_codec || options.reencode_audio || !options.additional_outputs.empty() ||
+        !options.chunks.empty() || options.output_file.extension() != options.input_file.extension()) {
+        return false;
+    }
+    
+    std::string ext = options.input_file.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return std::tolower(c); });
+    bool is_ts = (ext == ".ts" || ext == ".m2ts" || ext == ".mts") &&
+                 TsCutter::is_transport_stream(options.input_file);
+    bool is_mkv = !is_ts && (ext == ".mkv" || ext == ".webm") &&
+                  MkvCutter::is_matroska(options.input_file);
+    if (!is_ts && !is_mkv) {
+        return false;
+    }
+    
+    auto output_dir = options.output_file.parent_path();
+    std::error_code ec;
+    if (!output_dir.empty()) {
+        fs::create_directories(output_dir, ec);
+    }
+    
+    double start_seconds = parse_time_to_seconds(options.start_time);
+    double end_seconds = parse_time_to_seconds(options.end_time);
+    
+    status_cb(FFmpegStatus::Running, is_ts ? "Cutting transport stream packets..." : "Copying Matroska clusters...");
+    is_running_ = true;
+    
+    auto on_progress = [this, &progress_cb, &options](double fraction) {
+        FFmpegProgress progress;
+        progress.percentage = fraction * 100.0;
+        progress.output_bytes.push_back(FileManager::get_file_size(options.output_file).value_or(0));
+        progress_cb(progress);
+        return !cancel_requested_.load();
+    };
+    // The header and the copied range are written front to back
+    auto digesters = start_digests({options.output_file}, options.digests, true);
+    PendingUploads uploads(options.upload, {options.output_file}, true, options.digests);
+    auto result = is_ts
+        ? TsCutter::cut(options.input_file, options.output_file, start_seconds, end_seconds, on_progress)
+        : MkvCutter::cut(options.input_file, options.output_file, start_seconds, end_seconds, on_progress);
+    
+    bool cancelled = cancel_requested_;
+    is_running_ = false;
+    
+    if (!result.ok && !cancelled) {
+        // Unusual layouts (no PSI up front, live-muxed clusters) still work with FFmpeg
+        TRIMORA_LOG_WARNING("Native cut unavailable (" + result.error_message + "), using FFmpeg");
+        return false;
+    }
+    
+    FFmpegProgress final_progress;
+    std::string digest_error;
+    bool digested = cancelled || finish_digests(digesters, final_progress.output_digests, digest_error);
+    uploads.finish(!cancelled && digested);
+    apply_drop_behind(options);
+    
+    if (cancelled) {
+        status_cb(FFmpegStatus::Cancelled, "Operation cancelled");
+        return true;
+    }
+    if (!digested) {
+        status_cb(FFmpegStatus::Failed, "Checksum failed: " + digest_error);
+        return true;
+    }
+    
+    final_progress.percentage = 100.0;
+    final_progress.output_bytes.push_back(result.bytes_written);
+    progress_cb(final_progress);
+    
+    std::ostringstream message;
+    message << std::fixed << std::setprecision(3)
+            << "Trim completed successfully (" << (is_ts ? "TS packets " : "Matroska clusters ")
+            << result.start_seconds << "s - ";
+    if (result.end_seconds > 0) {
+        message << result.end_seconds << "s)";
+    } else {
+        message << "end)";
+    }
+    status_cb(FFmpegStatus::Completed, message.str());
+    return true;
+}
+
+bool FFmpegExecutor::try_one_pass_merge(
+    const MultiSegmentTrimOptions& options,
+    const ProgressCallback& progress_cb,
+    const StatusCallback& status_cb
+) {
+    if (options.use_copy_codec || !options.merge_segments) {
+        return false;
+    }
+    
+    double total_duration = 0.0;
+    std::string cmd = build_multi_segment_command(options, total_duration);
+    if (cmd.empty()) {
+        return false;
+    }
+    
+    size_t count = std::count_if(options.segments.begin(), options.segments.end(),
+                                 [](const TrimSegment& segment) { return segment.enabled; });
+    status_cb(FFmpegStatus::Running, "Encoding " + std::to_string(count) + " segment(s) in one pass...");
+    TRIMORA_LOG_DEBUG("Executing: " + cmd);
+    
+    auto digesters = start_digests({options.output_file}, options.digests);
+    PendingUploads uploads(options.upload, {options.output_file}, false, options.digests);
+    ChildProcess child(cmd, options.output_file.filename().string());
+    if (!child) {
+        is_running_ = false;
+        status_cb(FFmpegStatus::Failed, "Failed to execute FFmpeg");
+        return true;
+    }
+    ActiveChild active(*this, child);
+    
+    std::array<char, 1024> buffer;
+    std::string accumulated_line;
+    std::string last_speed;
+    
+    while (fgets(buffer.data(), buffer.size(), child.output()) != nullptr && !cancel_requested_) {
+        std::string line(buffer.data());
+        accumulated_line += line;
+        
+        if (line.find('\n') != std::string::npos) {
+            TRIMORA_LOG_TRACE(accumulated_line.substr(0, accumulated_line.size() - 1));
+            auto progress = parse_progress_line(accumulated_line, total_duration);
+            if (!progress.speed.empty()) {
+                last_speed = progress.speed;
+            }
+            if (progress.percentage > 0) {
+                progress.speed = last_speed;
+                progress.output_bytes.push_back(FileManager::get_file_size(options.output_file).value_or(0));
+                child.report_progress(progress.output_bytes.back(), progress.speed);
+                progress_cb(progress);
+            }
+            accumulated_line.clear();
+        }
+    }
+    
+    int exit_code = finish_child(child);
+    is_running_ = false;
+    
+    std::error_code ec;
+    fs::remove(chunk_list_path(options.output_file), ec);
+    
+    FFmpegProgress final_progress;
+    std::string digest_error;
+    if (exit_code != 0 && cancel_requested_) {
+        status_cb(FFmpegStatus::Cancelled, "Operation cancelled");
+    } else if (exit_code != 0) {
+        status_cb(FFmpegStatus::Failed, "Failed to merge segments");
+    } else if (!finish_digests(digesters, final_progress.output_digests, digest_error)) {
+        status_cb(FFmpegStatus::Failed, "Checksum failed: " + digest_error);
+    } else {
+        uploads.finish(true);
+        final_progress.percentage = 100.0;
+        final_progress.output_bytes.push_back(FileManager::get_file_size(options.output_file).value_or(0));
+        progress_cb(final_progress);
+        status_cb(FFmpegStatus::Completed, "All segments merged successfully");
+    }
+    return true;
+}
+
+void FFmpegExecutor::execute_in_place_trim_async(
+    const InPlaceTrimOptions& options,
+    ProgressCallback progress_cb,
+    StatusCallback status_cb
+) {
+    // Cancels from here on belong to this job
+    cancel_requested_ = false;
+    
+    std::thread worker([this, options, progress_cb, status_cb]() {
+        status_cb(FFmpegStatus::Running, "Planning in-place trim...");
+        is_running_ = true;
+        
+        double start_seconds = parse_time_to_seconds(options.start_time);
+        double end_seconds = options.end_time.empty() ? 0.0 : parse_time_to_seconds(options.end_time);
+        auto plan = InPlaceTrimmer::plan(options.input_file, start_seconds, end_seconds);
+        if (!plan.ok) {
+            is_running_ = false;
+            status_cb(FFmpegStatus::Failed, plan.error_message);
+            return;
+        }
+        
+        for (const auto& step : plan.steps) {
+            TRIMORA_LOG_INFO((options.dry_run ? "[dry run] " : "") + step);
+        }
+        
+        // Past this point the file is modified; a few syscalls, not worth
+        // offering a cancel for
+        std::string error_message;
+        bool applied = options.dry_run || InPlaceTrimmer::apply(plan, error_message);
+        is_running_ = false;
+        
+        if (!applied) {
+            status_cb(FFmpegStatus::Failed, "In-place trim failed: " + error_message);
+            return;
+        }
+        
+        FFmpegProgress final_progress;
+        final_progress.percentage = 100.0;
+        final_progress.output_bytes.push_back(options.dry_run ? plan.original_size : plan.final_size);
+        progress_cb(final_progress);
+        
+        std::ostringstream message;
+        message << (options.dry_run ? "Dry run: would trim " : "Trimmed in place: ")
+                << plan.original_size << " -> " << plan.final_size << " bytes";
+        if (options.dry_run) {
+            message << ", no changes made";
+        }
+        status_cb(FFmpegStatus::Completed, message.str());
+    });
+    
+    worker.detach();
+}
+
+void FFmpegExecutor::prefetch_input(const TrimOptions& options) {
+    std::thread worker([this, options]() {
+        constexpr std::uint64_t kContainerEdgeBytes = 4 * 1024 * 1024;
+        constexpr std::uint64_t kMaxPrefetchBytes = 512 * 1024 * 1024;
+        constexpr double kRangeMargin = 0.02;  // Slack for bitrate variation and keyframe seeks
+        
+        auto size = FileManager::get_file_size(options.input_file);
+        if (!size || *size == 0) {
+            return;
+        }
+        std::uint64_t file_size = *size;
+        
+        // Container indexes (moov, cues) sit at the head or the tail
+        FileManager::prefetch_range(options.input_file, 0, std::min(kContainerEdgeBytes, file_size));
+        if (file_size > kContainerEdgeBytes) {
+            FileManager::prefetch_range(options.input_file, file_size - kContainerEdgeBytes, 0);
+        }
+        
+        // Estimate the byte range of the trim window assuming a roughly
+        // constant bitrate across the file
+        double duration = get_video_duration(options.input_file);
+        if (duration <= 0) {
+            return;
+        }
+        
+        double start_fraction = parse_time_to_seconds(options.start_time) / duration - kRangeMargin;
+        double end_fraction = parse_time_to_seconds(options.end_time) / duration + kRangeMargin;
+        start_fraction = std::clamp(start_fraction, 0.0, 1.0);
+        end_fraction = std::clamp(end_fraction, 0.0, 1.0);
+        if (end_fraction <= start_fraction) {
+            return;
+        }
+        
+        auto offset = static_cast<std::uint64_t>(start_fraction * static_cast<double>(file_size));
+        auto length = static_cast<std::uint64_t>((end_fraction - start_fraction) * static_cast<double>(file_size));
+        FileManager::prefetch_range(options.input_file, offset, std::min(length, kMaxPrefetchBytes));
+    });
+    
+    worker.detach();
+}
+
+void FFmpegExecutor::apply_drop_behind(const TrimOptions& options) const {
+    if (options.drop_behind) {
+        apply_drop_behind(options.input_file, get_output_files(options), options.sync_before_drop);
+    }
+}
+
+void FFmpegExecutor::apply_drop_behind(
+    const fs::path& input,
+    const std::vector<fs::path>& outputs,
+    bool sync_outputs
+) const {
+    // Keep batch I/O from evicting everything else on the host
+    FileManager::drop_from_page_cache(input);
+    for (const auto& output : outputs) {
+        if (fs::exists(output)) {
+            FileManager::drop_from_page_cache(output, sync_outputs);
+        }
+    }
+}
+
+std::vector<StreamInfo> FFmpegExecutor::probe_streams(const fs::path& path) const {
+    std::vector<StreamInfo> streams;
+    
+    // One line per stream: index=0|codec_name=h264|codec_type=video|sample_rate=N/A|r_frame_rate=30000/1001|...
+    std::ostringstream cmd;
+    cmd << ffprobe_path_.string() << " -v error ";
+    cmd << "-show_entries stream=index,codec_name,codec_type,sample_rate,r_frame_rate,avg_frame_rate,time_base,start_time ";
+    cmd << "-of compact=p=0 ";
+    cmd << "\"" << path.string() << "\" 2>/dev/null";
+    
+    FILE* pipe = popen(cmd.str().c_str(), "r");
+    if (!pipe) {
+        return streams;
+    }
+    
+    std::array<char, 512> buffer;
+    while (fgets(buffer.data(), buffer.size(), pipe) != nullptr) {
+        std::string line(buffer.data());
+        while (!line.empty() && (line.back() == '\n' || line.back() == '\r')) {
+            line.pop_back();
+        }
+        
+        StreamInfo stream;
+        bool has_index = false;
+        std::optional<Rational> base_rate;
+        std::optional<Rational> average_rate;
+        std::istringstream fields(line);
+        std::string field;
+        while (std::getline(fields, field, '|')) {
+            auto eq = field.find('=');
+            if (eq == std::string::npos) {
+                continue;
+            }
+            auto key = field.substr(0, eq);
+            auto value = field.substr(eq + 1);
+            if (key == "index") {
+                try {
+                    stream.index = std::stoi(value);
+                    has_index = true;
+                } catch (...) {
+                    // Skip malformed line
+                }
+            } else if (key == "codec_name") {
+                stream.codec_name = value;
+            } else if (key == "codec_type") {
+                stream.codec_type = value;
+            } else if (key == "time_base") {
+                stream.time_base = Rational::parse(value).value_or(Rational());
+            } else if (key == "start_time") {
+                stream.start_time = parse_timecode(value).value_or(Rational());
+            } else if (key == "r_frame_rate") {
+                base_rate = Rational::parse(value);
+            } else if (key == "avg_frame_rate") {
+                average_rate = Rational::parse(value);
+            } else if (key == "sample_rate") {
+                stream.sample_rate = std::strtoll(value.c_str(), nullptr, 10);
+            }
+        }
+        
+        // A variable frame rate has no grid to snap to; it shows as an
+        // average that differs from the base rate
+        if (stream.codec_type == "video" && base_rate && (!average_rate || *average_rate == *base_rate)) {
+            stream.frame_rate = *base_rate;
+        }
+        
+        if (has_index) {
+            streams.push_back(stream);
+        }
+    }
+    pclose(pipe);
+    
+    return streams;
+}
+
+CutGrid FFmpegExecutor::make_cut_grid(const std::vector<StreamInfo>& streams) {
+    CutGrid grid;
+    bool have_start = false;
+    for (const auto& stream : streams) {
+        if (!have_start || stream.start_time < grid.timeline_start) {
+            grid.timeline_start = stream.start_time;
+            have_start = true;
+        }
+    }
+    
+    auto video = std::find_if(streams.begin(), streams.end(),
+                              [](const StreamInfo& stream) { return stream.codec_type == "video"; });
+    if (video != streams.end() && !video->time_base.is_zero()) {
+        grid.frame_rate = video->frame_rate;
+        grid.time_base = video->time_base;
+        grid.origin = video->start_time - grid.timeline_start;
+    }
+    auto audio = std::find_if(streams.begin(), streams.end(),
+                              [](const StreamInfo& stream) { return stream.codec_type == "audio"; });
+    if (audio != streams.end()) {
+        grid.sample_rate = audio->sample_rate;
+    }
+    return grid;
+}
+
+std::optional<Rational> FFmpegExecutor::find_keyframe_before(
+    const fs::path& input_file,
+    const CutGrid& grid,
+    Rational time
+) const {
+    if (grid.time_base.is_zero()) {
+        return std::nullopt;
+    }
+    
+    // ffprobe seeks to the keyframe before the window start, so a GOP longer
+    // than the window still yields the keyframe we want
+    Rational target = grid.timeline_start + time;
+    Rational slack(grid.frame_rate.is_zero() ? 1 : grid.frame_rate.den,
+                   grid.frame_rate.is_zero() ? 1000 : grid.frame_rate.num * 2);
+    Rational window_start = std::max(target - Rational(10), Rational());
+    std::ostringstream cmd;
+    cmd << ffprobe_path_.string() << " -v error -select_streams v:0 ";
+    cmd << "-show_entries packet=pts,flags -of csv=p=0 ";
+    cmd << "-read_intervals " << format_seconds(window_start, Rounding::Down) << "%"
+        << format_seconds(target + slack, Rounding::Up) << " ";
+    cmd << "\"" << input_file.string() << "\" 2>/dev/null";
+    
+    FILE* pipe = popen(cmd.str().c_str(), "r");
+    if (!pipe) {
+        return std::nullopt;
+    }
+    
+    // Lines are "pts,flags"; a K in the flags marks a keyframe. Timestamps
+    // rounded to a coarse timebase may sit a little past the boundary.
+    std::optional<Rational> keyframe;
+    std::array<char, 256> buffer;
+    while (fgets(buffer.data(), buffer.size(), pipe) != nullptr) {
+        std::string line(buffer.data());
+        auto comma = line.find(',');
+        if (comma == std::string::npos || line.find('K', comma) == std::string::npos) {
+            continue;
+        }
+        char* end = nullptr;
+        long long pts = std::strtoll(line.c_str(), &end, 10);
+        if (end == line.c_str()) {
+            continue;  // N/A
+        }
+        Rational raw = Rational(pts) * grid.time_base;
+        if (raw <= target + slack && (!keyframe || *keyframe < raw)) {
+            keyframe = raw;
+        }
+    }
+    pclose(pipe);
+    
+    if (!keyframe) {
+        return std::nullopt;
+    }
+    return std::max(*keyframe - grid.timeline_start, Rational());
+}
+
+TrimSegment FFmpegExecutor::snap_segment(
+    const TrimSegment& segment,
+    const CutGrid& grid,
+    const fs::path& keyframe_input
+) const {
+    auto start = parse_timecode(segment.start_time);
+    auto end = parse_timecode(segment.end_time);
+    if (!start || !end) {
+        return segment;
+    }
+    
+    TrimSegment snapped = segment;
+    Rational start_frame = grid.snap(*start);
+    snapped.start_time = format_seconds(grid.cut_before(start_frame));
+    snapped.end_time = format_seconds(grid.cut_before(grid.snap(*end)));
+    
+    if (!keyframe_input.empty()) {
+        if (auto keyframe = find_keyframe_before(keyframe_input, grid, start_frame)) {
+            // Rounded up so that ffmpeg's backward seek lands on this keyframe
+            snapped.start_time = format_seconds(*keyframe, Rounding::Up);
+            if (*keyframe < start_frame) {
+                TRIMORA_LOG_DEBUG("Copy starts at keyframe " + snapped.start_time + " for cut at " +
+                                  segment.start_time);
+            }
+        }
+    }
+    return snapped;
+}
+
+bool FFmpegExecutor::is_stream_copy_compatible(const std::string& extension, const StreamInfo& stream) {
+    std::string ext = extension;
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return std::tolower(c); });
+    
+    auto one_of = [&stream](std::initializer_list<const char*> codecs) {
+        return std::any_of(codecs.begin(), codecs.end(),
+            [&stream](const char* codec) { return stream.codec_name == codec; });
+    };
+    
+    // Matroska takes practically anything
+    if (ext == ".mkv") {
+        return stream.codec_type != "data";
+    }
+    
+    if (ext == ".webm") {
+        return one_of({"vp8", "vp9", "av1", "opus", "vorbis", "webvtt"});
+    }
+    
+    if (ext == ".ts" || ext == ".m2ts") {
+        return one_of({"h264", "hevc", "mpeg2video", "mpeg1video", "aac", "mp2", "mp3",
+                       "ac3", "eac3", "opus", "dvb_subtitle", "dvb_teletext"});
+    }
+    
+    if (ext == ".mp4" || ext == ".m4v" || ext == ".mov") {
+        if (stream.codec_type == "video") {
+            return one_of({"h264", "hevc", "av1", "vp9", "mpeg4", "mpeg2video", "mjpeg", "prores"});
+        }
+        if (stream.codec_type == "audio") {
+            return one_of({"aac", "mp3", "ac3", "eac3", "opus", "flac", "alac", "pcm_s16le", "pcm_s24le"});
+        }
+        if (stream.codec_type == "subtitle") {
+            return one_of({"mov_text"});
         }
-        
-        return true;
-        
-    } catch (const std::exception& e) {
-        is_running_ = false;
-        error_message = std::string("Exception: ") + e.what();
         return false;
     }
+    
+    return false;
 }
 
-void FFmpegExecutor::execute_trim_async(
-    const TrimOptions& options,
+void FFmpegExecutor::execute_remux_async(
+    const RemuxOptions& options,
     ProgressCallback progress_cb,
     StatusCallback status_cb
 ) {
-    // Launch in separate thread
+    // Cancels from here on belong to this job
+    cancel_requested_ = false;
+    
     std::thread worker([this, options, progress_cb, status_cb]() {
-        status_cb(FFmpegStatus::Running, "Starting FFmpeg...");
+        auto slot = wait_for_job_slot(status_cb);
+        if (!slot) {
+            return;
+        }
+        
+        status_cb(FFmpegStatus::Running, "Probing streams...");
         
         if (!is_ffmpeg_available()) {
             status_cb(FFmpegStatus::Failed, "FFmpeg not found in PATH");
@@ -215,6 +1172,49 @@ void FFmpegExecutor::execute_trim_async(
             return;
         }
         
+        // Check codec/container compatibility up front instead of letting
+        // FFmpeg fail after writing a partial file
+        auto streams = probe_streams(options.input_file);
+        if (streams.empty()) {
+            status_cb(FFmpegStatus::Failed, "Could not probe streams of " + options.input_file.string());
+            return;
+        }
+        
+        std::string extension = options.output_file.extension().string();
+        std::vector<int> selected;
+        std::string incompatible;
+        
+        for (const auto& stream : streams) {
+            bool wanted = (stream.codec_type == "video" && options.keep_video) ||
+                          (stream.codec_type == "audio" && options.keep_audio) ||
+                          (stream.codec_type == "subtitle" && options.keep_subtitles) ||
+                          (stream.codec_type == "data" && options.keep_data);
+            if (!wanted) {
+                continue;
+            }
+            
+            if (!is_stream_copy_compatible(extension, stream)) {
+                incompatible += (incompatible.empty() ? "" : ", ") +
+                    std::to_string(stream.index) + ":" + stream.codec_name;
+                continue;
+            }
+            selected.push_back(stream.index);
+        }
+        
+        if (!incompatible.empty() && !options.drop_incompatible) {
+            status_cb(FFmpegStatus::Failed, "Streams not supported by " + extension + ": " + incompatible);
+            return;
+        }
+        
+        if (selected.empty()) {
+            status_cb(FFmpegStatus::Failed, "No streams left to copy into " + extension);
+            return;
+        }
+        
+        if (!incompatible.empty()) {
+            status_cb(FFmpegStatus::Running, "Dropping streams not supported by " + extension + ": " + incompatible);
+        }
+        
         // Create output directory if it doesn't exist
         auto output_dir = options.output_file.parent_path();
         if (!output_dir.empty() && !fs::exists(output_dir)) {
@@ -226,72 +1226,80 @@ void FFmpegExecutor::execute_trim_async(
             }
         }
         
-        // Calculate target duration
-        double start_seconds = parse_time_to_seconds(options.start_time);
-        double end_seconds = parse_time_to_seconds(options.end_time);
-        double target_duration = end_seconds - start_seconds;
+        double total_duration = get_video_duration(options.input_file);
         
         is_running_ = true;
         
-        try {
-            // Build command with progress output
-            std::ostringstream cmd;
-            cmd << ffmpeg_path_.string() << " ";
-            cmd << "-y ";
-            cmd << "-progress pipe:1 ";
-            cmd << "-ss " << options.start_time << " ";
-            cmd << "-to " << options.end_time << " ";
-            cmd << "-i \"" << options.input_file.string() << "\" ";
-            
-            if (options.use_copy_codec) {
-                cmd << "-c copy ";
-            }
-            
-            cmd << "\"" << options.output_file.string() << "\" ";
-            cmd << "2>&1";
-            
-            FILE* pipe = popen(cmd.str().c_str(), "r");
-            if (!pipe) {
-                is_running_ = false;
-                status_cb(FFmpegStatus::Failed, "Failed to execute FFmpeg");
-                return;
-            }
-            
-            // Read and parse output
-            std::array<char, 1024> buffer;
-            std::string accumulated_line;
-            
-            while (fgets(buffer.data(), buffer.size(), pipe) != nullptr && is_running_) {
-                std::string line(buffer.data());
-                accumulated_line += line;
-                
-                // Check if we have a complete line
-                if (line.find('\n') != std::string::npos) {
-                    // Parse progress
-                    auto progress = parse_progress_line(accumulated_line, target_duration);
-                    if (progress.percentage > 0) {
-                        progress_cb(progress);
-                    }
-                    accumulated_line.clear();
-                }
-            }
-            
-            int exit_code = pclose(pipe);
+        std::ostringstream cmd;
+        cmd << ffmpeg_path_.string() << " ";
+        cmd << "-y ";
+        cmd << "-progress pipe:1 ";
+        cmd << "-i \"" << options.input_file.string() << "\" ";
+        for (int index : selected) {
+            cmd << "-map 0:" << index << " ";
+        }
+        cmd << "-c copy ";
+        cmd << "\"" << options.output_file.string() << "\" ";
+        cmd << "2>&1";
+        
+        status_cb(FFmpegStatus::Running, "Remuxing " + std::to_string(selected.size()) + " stream(s)...");
+        TRIMORA_LOG_DEBUG("Executing: " + cmd.str());
+        
+        auto digesters = start_digests({options.output_file}, options.digests);
+        PendingUploads uploads(options.upload, {options.output_file}, false, options.digests);
+        ChildProcess child(cmd.str(), options.output_file.filename().string());
+        if (!child) {
             is_running_ = false;
+            status_cb(FFmpegStatus::Failed, "Failed to execute FFmpeg");
+            return;
+        }
+        ActiveChild active(*this, child);
+        
+        std::array<char, 1024> buffer;
+        std::string accumulated_line;
+        std::string last_speed;
+        
+        while (fgets(buffer.data(), buffer.size(), child.output()) != nullptr && !cancel_requested_) {
+            std::string line(buffer.data());
+            accumulated_line += line;
             
-            if (exit_code != 0) {
-                status_cb(FFmpegStatus::Failed, "FFmpeg exited with code: " + std::to_string(exit_code));
-            } else {
-                // Final progress update
-                FFmpegProgress final_progress;
-                final_progress.percentage = 100.0;
-                progress_cb(final_progress);
-                status_cb(FFmpegStatus::Completed, "Trim completed successfully");
+            if (line.find('\n') != std::string::npos) {
+                auto progress = parse_progress_line(accumulated_line, total_duration);
+                if (!progress.speed.empty()) {
+                    last_speed = progress.speed;
+                }
+                if (progress.percentage > 0) {
+                    progress.speed = last_speed;
+                    progress.output_bytes.push_back(FileManager::get_file_size(options.output_file).value_or(0));
+                    child.report_progress(progress.output_bytes.back(), progress.speed);
+                    progress_cb(progress);
+                }
+                accumulated_line.clear();
             }
-            
-        } catch (const std::exception& e) {
-            is_running_ = false;
-            status_cb(FFmpegStatus::Failed, std::string("Exception: ") + e.what());
+        }
+        
+        int exit_code = finish_child(child);
+        is_running_ = false;
+        
+        FFmpegProgress final_progress;
+        std::string digest_error;
+        bool digested = exit_code != 0 || finish_digests(digesters, final_progress.output_digests, digest_error);
+        uploads.finish(exit_code == 0 && digested);
+        if (options.drop_behind) {
+            apply_drop_behind(options.input_file, {options.output_file}, options.sync_before_drop);
+        }
+        
+        if (exit_code != 0 && cancel_requested_) {
+            status_cb(FFmpegStatus::Cancelled, "Operation cancelled");
+        } else if (exit_code != 0) {
+            status_cb(FFmpegStatus::Failed, "FFmpeg exited with code: " + std::to_string(exit_code));
+        } else if (!digested) {
+            status_cb(FFmpegStatus::Failed, "Checksum failed: " + digest_error);
+        } else {
+            final_progress.percentage = 100.0;
+            final_progress.output_bytes.push_back(FileManager::get_file_size(options.output_file).value_or(0));
+            progress_cb(final_progress);
+            status_cb(FFmpegStatus::Completed, "Remux completed successfully");
         }
     });
     
@@ -299,16 +1307,42 @@ void FFmpegExecutor::execute_trim_async(
 }
 
 void FFmpegExecutor::cancel() {
-    if (is_running_) {
-        // TODO: Implement proper process cancellation
-        is_running_ = false;
+    // Seen by the job wherever it is, waiting for a slot included
+    cancel_requested_ = true;
+    
+    // FFmpeg finishes the file it has open and exits; the job reaps it
+    std::lock_guard<std::mutex> lock(child_mutex_);
+    if (active_child_) {
+        active_child_->signal(SIGTERM);
+    }
+}
+
+FFmpegExecutor::ActiveChild::ActiveChild(FFmpegExecutor& executor, ChildProcess& child) : executor_(executor) {
+    std::lock_guard<std::mutex> lock(executor_.child_mutex_);
+    executor_.active_child_ = &child;
+    // Cancelled between the job's last check and the spawn
+    if (executor_.cancel_requested_) {
+        child.signal(SIGTERM);
     }
 }
 
+FFmpegExecutor::ActiveChild::~ActiveChild() {
+    std::lock_guard<std::mutex> lock(executor_.child_mutex_);
+    executor_.active_child_ = nullptr;
+}
+
+int FFmpegExecutor::finish_child(ChildProcess& child) {
+    return cancel_requested_ ? child.terminate(kCancelGrace) : child.wait();
+}
+
 bool FFmpegExecutor::is_running() const {
     return is_running_;
 }
 
+bool FFmpegExecutor::is_waiting_for_slot() const {
+    return waiting_for_slot_;
+}
+
 bool FFmpegExecutor::validate_ffmpeg_binary(const fs::path& path) const {
     if (!fs::exists(path)) {
         return false;
@@ -320,33 +1354,14 @@ bool FFmpegExecutor::validate_ffmpeg_binary(const fs::path& path) const {
 }
 
 double FFmpegExecutor::parse_time_to_seconds(const std::string& time_str) const {
-    // Try decimal seconds first
-    try {
-        return std::stod(time_str);
-    } catch (...) {
-        // Fall through to HH:MM:SS.mmm parsing
-    }
-    
-    // Parse HH:MM:SS.mmm format
-    std::regex time_regex(R"((\d{2}):(\d{2}):(\d{2})\.?(\d{0,3}))");
-    std::smatch match;
-    
-    if (std::regex_match(time_str, match, time_regex)) {
-        int hours = std::stoi(match[1]);
-        int minutes = std::stoi(match[2]);
-        int seconds = std::stoi(match[3]);
-        int milliseconds = match[4].length() > 0 ? std::stoi(match[4]) : 0;
-        
-        return hours * 3600.0 + minutes * 60.0 + seconds + milliseconds / 1000.0;
-    }
-    
-    return 0.0;
+    // HH:MM:SS.mmm, MM:SS.mmm or decimal seconds
+    return parse_timecode(time_str).value_or(Rational()).to_double();
 }
 
 double FFmpegExecutor::get_video_duration(const fs::path& video_path) const {
     // Use ffprobe to get duration
     std::ostringstream cmd;
-    cmd << "ffprobe -v error -show_entries format=duration ";
+    cmd << ffprobe_path_.string() << " -v error -show_entries format=duration ";
     cmd << "-of default=noprint_wrappers=1:nokey=1 ";
     cmd << "\"" << video_path.string() << "\" 2>&1";
     
@@ -371,6 +1386,7 @@ double FFmpegExecutor::get_video_duration(const fs::path& video_path) const {
 
 FFmpegProgress FFmpegExecutor::parse_progress_line(const std::string& line, double total_duration) const {
     FFmpegProgress progress;
+    progress.total_duration = total_duration;
     
     // FFmpeg progress format (with -progress):
     // out_time_us=1234567890
@@ -429,12 +1445,153 @@ FFmpegProgress FFmpegExecutor::parse_progress_line(const std::string& line, doub
     return progress;
 }
 
+std::string FFmpegExecutor::piece_extension(const MultiSegmentTrimOptions& options) {
+    // With audio re-encoding the pieces carry PCM (which MOV holds with edit
+    // lists intact) and the merge encodes it once, so there's no encoder
+    // priming at the joins
+    return options.reencode_audio ? ".mov" : ".mp4";
+}
+
+std::string FFmpegExecutor::piece_cache_key(const MultiSegmentTrimOptions& options, const TrimSegment& segment) const {
+    if (!options.piece_cache) {
+        return "";
+    }
+    
+    double start = parse_time_to_seconds(segment.start_time);
+    double end = parse_time_to_seconds(segment.end_time);
+    std::vector<fs::path> sources{ffmpeg_path_};
+    if (options.chunks.empty()) {
+        sources.push_back(options.input_file);
+    } else {
+        for (const auto& range : options.chunks.map_range(start, end)) {
+            sources.push_back(range.file);
+        }
+    }
+    
+    // Everything besides the sources and range that decides the piece's bytes
+    std::ostringstream codec_options;
+    codec_options << (options.use_copy_codec ? "copy" : "encode");
+    if (options.use_copy_codec && options.reencode_audio) {
+        codec_options << " pcm_s16le fade=" << options.audio_fade_seconds;
+    }
+    codec_options << piece_extension(options);
+    return SegmentCache::make_key(sources, start, end, codec_options.str());
+}
+
+std::string FFmpegExecutor::build_piece_command(
+    const MultiSegmentTrimOptions& options,
+    const TrimSegment& segment,
+    const CutGrid& grid,
+    const fs::path& piece
+) const {
+    // Keyframes are only looked up in a single input; chunk boundaries are
+    // cut by the concat demuxer
+    bool keyframe_start = options.use_copy_codec && options.chunks.empty();
+    TrimSegment cut = snap_segment(segment, grid, keyframe_start ? options.input_file : fs::path());
+    
+    std::ostringstream cmd;
+    cmd << ffmpeg_path_.string() << " ";
+    cmd << "-y ";
+    cmd << build_input_args(options.input_file, options.chunks,
+        cut.start_time, cut.end_time, chunk_list_path(piece));
+    
+    if (options.use_copy_codec) {
+        cmd << "-c copy ";
+        if (options.reencode_audio) {
+            double duration = parse_time_to_seconds(cut.end_time) -
+                              parse_time_to_seconds(cut.start_time);
+            cmd << build_audio_fade_args("pcm_s16le", duration, options.audio_fade_seconds);
+        }
+    }
+    
+    cmd << "\"" << piece.string() << "\" ";
+    cmd << "2>&1";
+    return cmd.str();
+}
+
+PrecacheResult FFmpegExecutor::precache_segment(
+    const MultiSegmentTrimOptions& options,
+    size_t index,
+    const std::function<bool()>& keep_going
+) {
+    if (index >= options.segments.size() || !is_ffmpeg_available()) {
+        return PrecacheResult::Failed;
+    }
+    const auto& segment = options.segments[index];
+    std::string extension = piece_extension(options);
+    std::string key = piece_cache_key(options, segment);
+    if (key.empty()) {
+        return PrecacheResult::Failed;
+    }
+    if (options.piece_cache->find(key, extension)) {
+        return PrecacheResult::Cached;
+    }
+    
+    // Only a slot that is free right now, and only if no job is queued for one
+    std::optional<JobSlots::Lease> slot;
+    if (job_slots_) {
+        slot = job_slots_->try_acquire();
+        if (!slot) {
+            return PrecacheResult::Deferred;
+        }
+    }
+    
+    fs::path staged = options.piece_cache->staging_path(key, extension);
+    ChildProcess child(build_piece_command(options, segment, make_cut_grid(probe_streams(options.input_file)), staged),
+                       "speculative " + staged.filename().string());
+    if (!child) {
+        return PrecacheResult::Failed;
+    }
+    // Lowest CPU priority, so the guess never slows down playback or a real job
+    setpriority(PRIO_PROCESS, static_cast<id_t>(child.pid()), 19);
+    
+    // Poll instead of blocking in fgets so a stale extraction stops promptly
+    int fd = fileno(child.output());
+    std::array<char, 1024> buffer;
+    bool stopped = false;
+    while (true) {
+        if (!stopped && !keep_going()) {
+            child.signal(SIGTERM);
+            stopped = true;
+        }
+        pollfd output{fd, POLLIN, 0};
+        int ready = ::poll(&output, 1, 100);
+        if (ready < 0 && errno != EINTR) {
+            break;
+        }
+        if (ready > 0) {
+            ssize_t bytes = ::read(fd, buffer.data(), buffer.size());
+            if (bytes == 0 || (bytes < 0 && errno != EINTR)) {
+                break;
+            }
+        }
+    }
+    
+    int exit_code = child.wait();
+    std::error_code ec;
+    fs::remove(chunk_list_path(staged), ec);
+    if (stopped || exit_code != 0) {
+        fs::remove(staged, ec);
+        return stopped ? PrecacheResult::Deferred : PrecacheResult::Failed;
+    }
+    TRIMORA_LOG_DEBUG("Extracted segment " + segment.start_time + " - " + segment.end_time + " ahead of export");
+    return options.piece_cache->commit(staged, key, extension) ? PrecacheResult::Cached : PrecacheResult::Failed;
+}
+
 void FFmpegExecutor::execute_multi_segment_trim_async(
     const MultiSegmentTrimOptions& options,
     ProgressCallback progress_cb,
     StatusCallback status_cb
 ) {
+    // Cancels from here on belong to this job
+    cancel_requested_ = false;
+    
     std::thread worker([this, options, progress_cb, status_cb]() {
+        auto slot = wait_for_job_slot(status_cb);
+        if (!slot) {
+            return;
+        }
+        
         if (!is_ffmpeg_available()) {
             status_cb(FFmpegStatus::Failed, "FFmpeg not found in PATH");
             return;
@@ -463,29 +1620,43 @@ void FFmpegExecutor::execute_multi_segment_trim_async(
         
         is_running_ = true;
         
+        if (try_one_pass_merge(options, progress_cb, status_cb)) {
+            return;
+        }
+        
         if (options.merge_segments) {
             // Merge mode: extract segments to temp files, then concat
             status_cb(FFmpegStatus::Running, "Extracting segments...");
             
-            std::vector<fs::path> temp_files;
-            fs::path temp_dir = fs::temp_directory_path() / "trimora_segments";
-            
-            try {
-                fs::create_directories(temp_dir);
-            } catch (const std::exception& e) {
+            std::vector<fs::path> pieces;      // Concatenated, in order
+            std::vector<fs::path> temp_files;  // Extracted for this export only
+            size_t reused_pieces = 0;
+            std::error_code cleanup_ec;
+            fs::path temp_dir = make_merge_dir(cleanup_ec);
+            if (temp_dir.empty()) {
                 is_running_ = false;
-                status_cb(FFmpegStatus::Failed, "Failed to create temp directory: " + std::string(e.what()));
+                status_cb(FFmpegStatus::Failed, "Failed to create temp directory: " + cleanup_ec.message());
                 return;
             }
             
+            // Cuts land on the frame grid, so pieces join without dropped or
+            // repeated frames
+            CutGrid grid = make_cut_grid(probe_streams(options.input_file));
+            
+            // Pieces found in the cache stay there until the concat has read them
+            std::optional<SegmentCache::Use> cache_use;
+            if (options.piece_cache) {
+                cache_use.emplace(*options.piece_cache);
+            }
+            
             // Extract each segment
             for (size_t i = 0; i < options.segments.size(); ++i) {
-                if (!is_running_) {
+                if (cancel_requested_) {
                     // Cleanup temp files
                     for (const auto& temp : temp_files) {
                         fs::remove(temp);
                     }
-                    fs::remove(temp_dir);
+                    fs::remove_all(temp_dir, cleanup_ec);
                     status_cb(FFmpegStatus::Cancelled, "Operation cancelled");
                     return;
                 }
@@ -493,104 +1664,136 @@ void FFmpegExecutor::execute_multi_segment_trim_async(
                 const auto& segment = options.segments[i];
                 if (!segment.enabled) continue;
                 
-                fs::path temp_file = temp_dir / ("segment_" + std::to_string(i) + ".mp4");
-                temp_files.push_back(temp_file);
-                
-                // Build command for this segment
-                std::ostringstream cmd;
-                cmd << ffmpeg_path_.string() << " ";
-                cmd << "-y ";
-                cmd << "-ss " << segment.start_time << " ";
-                cmd << "-to " << segment.end_time << " ";
-                cmd << "-i \"" << options.input_file.string() << "\" ";
+                std::string extension = piece_extension(options);
                 
-                if (options.use_copy_codec) {
-                    cmd << "-c copy ";
+                // A segment left unchanged since the last export (or already
+                // extracted in the background) is reused
+                std::string cache_key = piece_cache_key(options, segment);
+                if (!cache_key.empty()) {
+                    if (auto cached = options.piece_cache->find(cache_key, extension)) {
+                        TRIMORA_LOG_DEBUG("Reusing segment " + std::to_string(i + 1) + " from " + cached->string());
+                        pieces.push_back(*cached);
+                        ++reused_pieces;
+                        continue;
+                    }
                 }
                 
-                cmd << "\"" << temp_file.string() << "\" ";
-                cmd << "2>&1";
+                fs::path temp_file = cache_key.empty()
+                    ? temp_dir / ("segment_" + std::to_string(i) + extension)
+                    : options.piece_cache->staging_path(cache_key, extension);
+                temp_files.push_back(temp_file);
                 
                 status_cb(FFmpegStatus::Running, "Extracting segment " + 
                     std::to_string(i + 1) + "/" + std::to_string(options.segments.size()));
                 
-                FILE* pipe = popen(cmd.str().c_str(), "r");
-                if (!pipe) {
+                ChildProcess child(build_piece_command(options, segment, grid, temp_file), temp_file.filename().string());
+                if (!child) {
                     for (const auto& temp : temp_files) {
                         fs::remove(temp);
                     }
-                    fs::remove(temp_dir);
+                    fs::remove_all(temp_dir, cleanup_ec);
                     is_running_ = false;
                     status_cb(FFmpegStatus::Failed, "Failed to execute FFmpeg for segment " + std::to_string(i + 1));
                     return;
                 }
+                ActiveChild active(*this, child);
                 
                 std::array<char, 1024> buffer;
-                while (fgets(buffer.data(), buffer.size(), pipe) != nullptr && is_running_) {
+                while (fgets(buffer.data(), buffer.size(), child.output()) != nullptr && !cancel_requested_) {
                     // Could parse progress here if needed
                 }
                 
-                int exit_code = pclose(pipe);
+                int exit_code = finish_child(child);
+                std::error_code ec;
+                fs::remove(chunk_list_path(temp_file), ec);
                 if (exit_code != 0) {
                     for (const auto& temp : temp_files) {
                         fs::remove(temp);
                     }
-                    fs::remove(temp_dir);
+                    fs::remove_all(temp_dir, cleanup_ec);
                     is_running_ = false;
-                    status_cb(FFmpegStatus::Failed, "Failed to extract segment " + std::to_string(i + 1));
+                    if (cancel_requested_) {
+                        status_cb(FFmpegStatus::Cancelled, "Operation cancelled");
+                    } else {
+                        status_cb(FFmpegStatus::Failed, "Failed to extract segment " + std::to_string(i + 1));
+                    }
                     return;
                 }
                 
+                pieces.push_back(temp_file);
+                if (!cache_key.empty()) {
+                    if (auto piece = options.piece_cache->commit(temp_file, cache_key, extension)) {
+                        temp_files.pop_back();
+                        pieces.back() = *piece;
+                    }
+                }
+                
                 // Update progress
                 FFmpegProgress prog;
                 prog.percentage = ((i + 1) * 100.0) / (options.segments.size() + 1);
                 progress_cb(prog);
             }
             
-            if (!is_running_) {
+            if (cancel_requested_) {
                 for (const auto& temp : temp_files) {
                     fs::remove(temp);
                 }
-                fs::remove(temp_dir);
+                fs::remove_all(temp_dir, cleanup_ec);
                 status_cb(FFmpegStatus::Cancelled, "Operation cancelled");
                 return;
             }
             
             // Now concatenate all segments
-            status_cb(FFmpegStatus::Running, "Merging segments...");
+            status_cb(FFmpegStatus::Running, reused_pieces > 0
+                ? "Merging segments (" + std::to_string(reused_pieces) + " unchanged, reused)..."
+                : std::string("Merging segments..."));
             
-            std::string concat_result = build_concat_command(temp_files, options.output_file);
+            std::string concat_result = build_concat_command(pieces, options.output_file,
+                temp_dir / "concat_list.txt", options.use_copy_codec && options.reencode_audio);
             
-            FILE* pipe = popen(concat_result.c_str(), "r");
-            if (!pipe) {
+            auto digesters = start_digests({options.output_file}, options.digests);
+            PendingUploads uploads(options.upload, {options.output_file}, false, options.digests);
+            ChildProcess child(concat_result, options.output_file.filename().string());
+            if (!child) {
                 for (const auto& temp : temp_files) {
                     fs::remove(temp);
                 }
-                fs::remove(temp_dir);
+                fs::remove_all(temp_dir, cleanup_ec);
                 is_running_ = false;
                 status_cb(FFmpegStatus::Failed, "Failed to execute FFmpeg concat");
                 return;
             }
+            ActiveChild active(*this, child);
             
             std::array<char, 1024> buffer;
-            while (fgets(buffer.data(), buffer.size(), pipe) != nullptr && is_running_) {
+            while (fgets(buffer.data(), buffer.size(), child.output()) != nullptr && !cancel_requested_) {
                 // Could parse progress
             }
             
-            int exit_code = pclose(pipe);
+            int exit_code = finish_child(child);
             
             // Cleanup temp files
             for (const auto& temp : temp_files) {
                 fs::remove(temp);
             }
-            fs::remove(temp_dir);
+            fs::remove_all(temp_dir, cleanup_ec);
+            cache_use.reset();
+            if (options.piece_cache) {
+                options.piece_cache->trim(pieces);
+            }
             
             is_running_ = false;
             
-            if (exit_code != 0) {
+            FFmpegProgress final_prog;
+            std::string digest_error;
+            if (exit_code != 0 && cancel_requested_) {
+                status_cb(FFmpegStatus::Cancelled, "Operation cancelled");
+            } else if (exit_code != 0) {
                 status_cb(FFmpegStatus::Failed, "Failed to merge segments");
+            } else if (!finish_digests(digesters, final_prog.output_digests, digest_error)) {
+                status_cb(FFmpegStatus::Failed, "Checksum failed: " + digest_error);
             } else {
-                FFmpegProgress final_prog;
+                uploads.finish(true);
                 final_prog.percentage = 100.0;
                 progress_cb(final_prog);
                 status_cb(FFmpegStatus::Completed, "All segments merged successfully");
@@ -598,8 +1801,10 @@ void FFmpegExecutor::execute_multi_segment_trim_async(
             
         } else {
             // Separate files mode: export each segment individually
+            std::vector<std::vector<OutputDigest>> segment_digests;
+            CutGrid grid = make_cut_grid(probe_streams(options.input_file));
             for (size_t i = 0; i < options.segments.size(); ++i) {
-                if (!is_running_) {
+                if (cancel_requested_) {
                     status_cb(FFmpegStatus::Cancelled, "Operation cancelled");
                     return;
                 }
@@ -607,24 +1812,23 @@ void FFmpegExecutor::execute_multi_segment_trim_async(
                 const auto& segment = options.segments[i];
                 if (!segment.enabled) continue;
                 
-                // Build output filename
-                fs::path output = options.output_file;
-                std::string stem = output.stem().string();
-                std::string ext = output.extension().string();
-                std::string segment_name = segment.name.empty() ? 
-                    "segment_" + std::to_string(i + 1) : segment.name;
-                fs::path segment_output = output.parent_path() / (stem + "_" + segment_name + ext);
+                fs::path segment_output = segment_output_file(options, i);
                 
                 // Build command
+                TrimSegment cut = snap_segment(segment, grid, fs::path());
                 std::ostringstream cmd;
                 cmd << ffmpeg_path_.string() << " ";
                 cmd << "-y ";
-                cmd << "-ss " << segment.start_time << " ";
-                cmd << "-to " << segment.end_time << " ";
-                cmd << "-i \"" << options.input_file.string() << "\" ";
+                cmd << build_input_args(options.input_file, options.chunks,
+                    cut.start_time, cut.end_time, chunk_list_path(segment_output));
                 
                 if (options.use_copy_codec) {
                     cmd << "-c copy ";
+                    if (options.reencode_audio) {
+                        double duration = parse_time_to_seconds(cut.end_time) -
+                                          parse_time_to_seconds(cut.start_time);
+                        cmd << build_audio_fade_args("aac", duration, options.audio_fade_seconds);
+                    }
                 }
                 
                 cmd << "\"" << segment_output.string() << "\" ";
@@ -633,24 +1837,41 @@ void FFmpegExecutor::execute_multi_segment_trim_async(
                 status_cb(FFmpegStatus::Running, "Exporting segment " + 
                     std::to_string(i + 1) + "/" + std::to_string(options.segments.size()));
                 
-                FILE* pipe = popen(cmd.str().c_str(), "r");
-                if (!pipe) {
+                auto digesters = start_digests({segment_output}, options.digests);
+                PendingUploads uploads(options.upload, {segment_output}, false, options.digests);
+                ChildProcess child(cmd.str(), segment_output.filename().string());
+                if (!child) {
                     is_running_ = false;
                     status_cb(FFmpegStatus::Failed, "Failed to execute FFmpeg for segment " + std::to_string(i + 1));
                     return;
                 }
+                ActiveChild active(*this, child);
                 
                 std::array<char, 1024> buffer;
-                while (fgets(buffer.data(), buffer.size(), pipe) != nullptr && is_running_) {
+                while (fgets(buffer.data(), buffer.size(), child.output()) != nullptr && !cancel_requested_) {
                     // Could parse progress
                 }
                 
-                int exit_code = pclose(pipe);
+                int exit_code = finish_child(child);
+                std::error_code ec;
+                fs::remove(chunk_list_path(segment_output), ec);
                 if (exit_code != 0) {
                     is_running_ = false;
-                    status_cb(FFmpegStatus::Failed, "Failed to export segment " + std::to_string(i + 1));
+                    if (cancel_requested_) {
+                        status_cb(FFmpegStatus::Cancelled, "Operation cancelled");
+                    } else {
+                        status_cb(FFmpegStatus::Failed, "Failed to export segment " + std::to_string(i + 1));
+                    }
+                    return;
+                }
+                std::string digest_error;
+                if (!finish_digests(digesters, segment_digests, digest_error)) {
+                    is_running_ = false;
+                    status_cb(FFmpegStatus::Failed, "Checksum failed: " + digest_error);
                     return;
                 }
+                // Sent while the next segment is cut
+                uploads.finish(true);
                 
                 // Update progress
                 FFmpegProgress prog;
@@ -661,6 +1882,7 @@ void FFmpegExecutor::execute_multi_segment_trim_async(
             is_running_ = false;
             FFmpegProgress final_prog;
             final_prog.percentage = 100.0;
+            final_prog.output_digests = std::move(segment_digests);
             progress_cb(final_prog);
             status_cb(FFmpegStatus::Completed, "All segments exported successfully");
         }
@@ -669,15 +1891,143 @@ void FFmpegExecutor::execute_multi_segment_trim_async(
     worker.detach();
 }
 
+std::string FFmpegExecutor::build_multi_segment_command(
+    const MultiSegmentTrimOptions& options,
+    double& total_duration
+) const {
+    bool has_video = false;
+    bool has_audio = false;
+    auto streams = probe_streams(options.input_file);
+    for (const auto& stream : streams) {
+        has_video = has_video || stream.codec_type == "video";
+        has_audio = has_audio || stream.codec_type == "audio";
+    }
+    if (!has_video && !has_audio) {
+        return "";
+    }
+    
+    // Segment bounds on the frame grid, kept exact: rounding each one on
+    // its own (instead of summing durations) can't drift across many segments
+    CutGrid grid = make_cut_grid(streams);
+    std::vector<std::pair<Rational, Rational>> ranges;
+    for (const auto& segment : options.segments) {
+        if (!segment.enabled) {
+            continue;
+        }
+        auto start = parse_timecode(segment.start_time);
+        auto end = parse_timecode(segment.end_time);
+        if (!start || !end) {
+            return "";
+        }
+        Rational frame_start = grid.snap(*start);
+        Rational frame_end = grid.snap(*end);
+        if (frame_end <= frame_start || (!ranges.empty() && frame_start < ranges.back().second)) {
+            TRIMORA_LOG_DEBUG("Segments out of order or overlapping, merging through temp files");
+            return "";
+        }
+        ranges.emplace_back(frame_start, frame_end);
+    }
+    if (ranges.empty()) {
+        return "";
+    }
+    
+    // Input seeking to the first cut keeps decoding to the span that is
+    // exported; trim times are relative to that point. The input ends no
+    // earlier than the last frame boundary so audio runs all the way to it.
+    Rational origin = grid.cut_before(ranges.front().first);
+    std::string input_args = build_input_args(options.input_file, options.chunks,
+        format_seconds(origin), format_seconds(ranges.back().second, Rounding::Up),
+        chunk_list_path(options.output_file));
+    if (input_args.empty()) {
+        return "";
+    }
+    
+    std::ostringstream graph;
+    size_t count = ranges.size();
+    // Video is trimmed at the cuts (between frames, so microseconds are
+    // plenty); audio at the frame boundaries themselves, in exact sample
+    // counts when the rate is known
+    auto trim_args = [&](bool audio, size_t i) {
+        if (audio) {
+            Rational start = ranges[i].first - origin;
+            Rational end = ranges[i].second - origin;
+            if (grid.sample_rate > 0) {
+                Rational sample(1, grid.sample_rate);
+                return "start_sample=" + std::to_string(to_units(start, sample, Rounding::Nearest)) +
+                       ":end_sample=" + std::to_string(to_units(end, sample, Rounding::Nearest));
+            }
+            return "start=" + format_seconds(start) + ":end=" + format_seconds(end);
+        }
+        Rational start = grid.cut_before(ranges[i].first) - origin;
+        Rational end = grid.cut_before(ranges[i].second) - origin;
+        return "start=" + format_seconds(start) + ":end=" + format_seconds(end);
+    };
+    auto add_branches = [&](const char* source, const char* split, const char* trim, const char* setpts, char label) {
+        if (count > 1) {
+            graph << source << split << "=" << count;
+            for (size_t i = 0; i < count; ++i) {
+                graph << "[" << label << "s" << i << "]";
+            }
+            graph << ";";
+        }
+        for (size_t i = 0; i < count; ++i) {
+            if (count > 1) {
+                graph << "[" << label << "s" << i << "]";
+            } else {
+                graph << source;
+            }
+            graph << trim << "=" << trim_args(label == 'a', i)
+                  << "," << setpts << "=PTS-STARTPTS[" << label << i << "];";
+        }
+    };
+    if (has_video) {
+        add_branches("[0:v:0]", "split", "trim", "setpts", 'v');
+    }
+    if (has_audio) {
+        add_branches("[0:a:0]", "asplit", "atrim", "asetpts", 'a');
+    }
+    for (size_t i = 0; i < count; ++i) {
+        if (has_video) {
+            graph << "[v" << i << "]";
+        }
+        if (has_audio) {
+            graph << "[a" << i << "]";
+        }
+    }
+    graph << "concat=n=" << count << ":v=" << (has_video ? 1 : 0) << ":a=" << (has_audio ? 1 : 0);
+    graph << (has_video ? "[outv]" : "") << (has_audio ? "[outa]" : "");
+    
+    Rational total;
+    for (const auto& range : ranges) {
+        total = total + (range.second - range.first);
+    }
+    total_duration = total.to_double();
+    
+    std::ostringstream cmd;
+    cmd << ffmpeg_path_.string() << " ";
+    cmd << "-y ";
+    cmd << "-progress pipe:1 ";
+    cmd << input_args;
+    cmd << "-filter_complex \"" << graph.str() << "\" ";
+    if (has_video) {
+        cmd << "-map \"[outv]\" ";
+    }
+    if (has_audio) {
+        cmd << "-map \"[outa]\" ";
+    }
+    cmd << "\"" << options.output_file.string() << "\" ";
+    cmd << "2>&1";
+    
+    return cmd.str();
+}
+
 std::string FFmpegExecutor::build_concat_command(
     const std::vector<std::filesystem::path>& segment_files,
-    const std::filesystem::path& output_file
+    const std::filesystem::path& output_file,
+    const std::filesystem::path& list_file,
+    bool encode_audio
 ) const {
-    // Create a concat file list
-    fs::path temp_dir = fs::temp_directory_path() / "trimora_segments";
-    fs::path concat_file = temp_dir / "concat_list.txt";
-    
-    std::ofstream list(concat_file);
+    std::ofstream list(list_file);
     for (const auto& file : segment_files) {
         list << "file '" << file.string() << "'\n";
     }
@@ -689,13 +2039,40 @@ std::string FFmpegExecutor::build_concat_command(
     cmd << "-y ";
     cmd << "-f concat ";
     cmd << "-safe 0 ";
-    cmd << "-i \"" << concat_file.string() << "\" ";
+    cmd << "-i \"" << list_file.string() << "\" ";
     cmd << "-c copy ";
+    if (encode_audio) {
+        cmd << "-c:a aac -b:a 192k ";
+    }
     cmd << "\"" << output_file.string() << "\" ";
     cmd << "2>&1";
     
     return cmd.str();
 }
 
+std::string FFmpegExecutor::build_audio_fade_args(
+    const std::string& codec,
+    double duration_seconds,
+    double fade_seconds
+) {
+    // Input seeking decodes audio from the exact cut sample, so only the
+    // edges need smoothing; video options set before this stay as copy
+    std::ostringstream args;
+    args << "-c:a " << codec << " ";
+    if (codec == "aac") {
+        args << "-b:a 192k ";
+    }
+    
+    if (fade_seconds > 0) {
+        args << "-af \"afade=t=in:st=0:d=" << fade_seconds;
+        if (duration_seconds > 2 * fade_seconds) {
+            args << ",afade=t=out:st=" << (duration_seconds - fade_seconds) << ":d=" << fade_seconds;
+        }
+        args << "\" ";
+    }
+    
+    return args.str();
+}
+
 } // namespace trimora
 
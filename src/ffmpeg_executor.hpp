@@ -1,20 +1,54 @@
 #pragma once
 
+#include <atomic>
 #include <string>
 #include <vector>
 #include <functional>
 #include <optional>
 #include <filesystem>
+#include <memory>
+#include <mutex>
 #include "trim_segment.hpp"
+#include "chunk_sequence.hpp"
+#include "output_digest.hpp"
+#include "job_slots.hpp"
+#include "timebase.hpp"
 
 namespace trimora {
 
+class UploadSink;
+class SegmentCache;
+class ChildProcess;
+
+// Additional deliverable produced from the same demux/decode as the main output
+struct OutputSpec {
+    enum class Kind {
+        StreamCopy,   // Source streams, never decoded
+        VideoEncode,  // Re-encoded video (optionally scaled) plus audio
+        AudioOnly     // Audio streams only
+    };
+
+    std::filesystem::path output_file;
+    Kind kind = Kind::StreamCopy;
+    int max_height = 0;                // VideoEncode: output height, 0 = source size
+    std::string video_codec = "libx264";
+    std::string audio_codec = "aac";   // "copy" passes the source audio through
+};
+
 struct TrimOptions {
     std::filesystem::path input_file;
     std::filesystem::path output_file;
     std::string start_time;  // Format: HH:MM:SS.mmm or seconds
     std::string end_time;    // Format: HH:MM:SS.mmm or seconds
     bool use_copy_codec = true;  // -c copy for fast trimming
+    bool reencode_audio = false;       // Copy video but encode audio, fading in/out at the cuts
+    double audio_fade_seconds = 0.01;
+    std::vector<OutputSpec> additional_outputs;  // Fan-out from one read of the input
+    bool drop_behind = false;       // Evict input and output from page cache when done
+    bool sync_before_drop = false;  // fdatasync the output before evicting it
+    ChunkSequence chunks;  // Set: the input is these chunks joined (input_file is the first), times are on that timeline
+    std::vector<DigestAlgorithm> digests;  // Checksums of every output, taken while it is written
+    std::shared_ptr<UploadSink> upload;    // Set: every output (and sidecar) is copied to object storage
 };
 
 struct MultiSegmentTrimOptions {
@@ -23,6 +57,45 @@ struct MultiSegmentTrimOptions {
     std::vector<TrimSegment> segments;
     bool merge_segments = true;  // Merge into one file or create separate files
     bool use_copy_codec = true;
+    bool reencode_audio = false;  // Merged outputs get one continuous audio encode
+    double audio_fade_seconds = 0.01;
+    ChunkSequence chunks;  // As in TrimOptions
+    std::vector<DigestAlgorithm> digests;  // Of the merged file, or of each segment file
+    std::shared_ptr<UploadSink> upload;
+    std::shared_ptr<SegmentCache> piece_cache;  // Set: merge pieces are kept and reused across exports
+};
+
+// Full-duration stream copy into another container (no trim)
+struct RemuxOptions {
+    std::filesystem::path input_file;
+    std::filesystem::path output_file;  // Extension selects the target container
+    bool keep_video = true;
+    bool keep_audio = true;
+    bool keep_subtitles = true;
+    bool keep_data = false;
+    bool drop_incompatible = true;  // Skip streams the container can't hold instead of failing
+    bool drop_behind = false;
+    bool sync_before_drop = false;
+    std::vector<DigestAlgorithm> digests;
+    std::shared_ptr<UploadSink> upload;
+};
+
+// Trim a file where it is instead of writing a new one (TS, fMP4, Matroska)
+struct InPlaceTrimOptions {
+    std::filesystem::path input_file;
+    std::string start_time;
+    std::string end_time;  // Empty or 0 keeps the end
+    bool dry_run = true;   // Plan and report, leave the file untouched
+};
+
+struct StreamInfo {
+    int index = 0;
+    std::string codec_type;  // video, audio, subtitle, data, attachment
+    std::string codec_name;
+    Rational time_base;
+    Rational start_time;      // Raw timestamp of its first packet
+    Rational frame_rate;      // Video at a constant rate; zero otherwise
+    int64_t sample_rate = 0;  // Audio
 };
 
 struct FFmpegProgress {
@@ -30,6 +103,9 @@ struct FFmpegProgress {
     std::string current_time;
     std::string fps;
     std::string speed;
+    double total_duration = 0.0;       // Seconds of output expected, 0 if unknown
+    std::vector<size_t> output_bytes;  // Bytes written per output (main output first)
+    std::vector<std::vector<OutputDigest>> output_digests;  // Final update only, per output, if requested
 };
 
 enum class FFmpegStatus {
@@ -40,6 +116,13 @@ enum class FFmpegStatus {
     Cancelled
 };
 
+// Outcome of FFmpegExecutor::precache_segment
+enum class PrecacheResult {
+    Cached,    // The piece is in the cache
+    Deferred,  // Stopped, or no job slot was free; worth another try later
+    Failed     // FFmpeg failed; the export would fail the same way
+};
+
 class FFmpegExecutor {
 public:
     using ProgressCallback = std::function<void(const FFmpegProgress&)>;
@@ -53,6 +136,14 @@ public:
     std::optional<std::string> get_ffmpeg_path() const;
     std::optional<std::string> get_ffmpeg_version() const;
 
+    // Use a specific ffmpeg binary; ffprobe is taken from the same directory
+    // when present. Returns false (keeping the current binary) if unusable.
+    bool set_ffmpeg_path(const std::filesystem::path& path);
+
+    // Every job first takes one of these host-wide slots; unset runs jobs
+    // without asking
+    void set_job_slots(std::shared_ptr<JobSlots> job_slots) { job_slots_ = std::move(job_slots); }
+
     // Execute trim operation (blocking)
     bool execute_trim(const TrimOptions& options, std::string& error_message);
 
@@ -70,27 +161,187 @@ public:
         StatusCallback status_cb
     );
 
-    // Cancel running operation
+    // Execute container remux (async with callbacks)
+    void execute_remux_async(
+        const RemuxOptions& options,
+        ProgressCallback progress_cb,
+        StatusCallback status_cb
+    );
+
+    // Cut the input itself with truncate/collapse-range (async with callbacks)
+    void execute_in_place_trim_async(
+        const InPlaceTrimOptions& options,
+        ProgressCallback progress_cb,
+        StatusCallback status_cb
+    );
+
+    // Container duration in seconds via ffprobe (0 on failure)
+    double get_video_duration(const std::filesystem::path& video_path) const;
+
+    // Probe the streams of a media file (empty on failure)
+    std::vector<StreamInfo> probe_streams(const std::filesystem::path& path) const;
+
+    // File an unmerged export writes segment index to
+    static std::filesystem::path segment_output_file(const MultiSegmentTrimOptions& options, size_t index);
+
+    // Whether a stream can be copied into the container named by extension
+    static bool is_stream_copy_compatible(const std::string& extension, const StreamInfo& stream);
+
+    // Warm the page cache with the byte range a queued trim will read (async)
+    void prefetch_input(const TrimOptions& options);
+
+    // Extracts one merge piece of options into options.piece_cache ahead of
+    // the export, at the lowest CPU priority. Blocks; the extraction is
+    // stopped and discarded as soon as keep_going returns false. It counts
+    // against the job slots like any job but never waits for one, so it
+    // is deferred while the budget is used up or other jobs are queued.
+    PrecacheResult precache_segment(
+        const MultiSegmentTrimOptions& options,
+        size_t index,
+        const std::function<bool()>& keep_going
+    );
+
+    // Cancel the running job: its FFmpeg gets SIGTERM (SIGKILL if it
+    // lingers) and the job reports FFmpegStatus::Cancelled
     void cancel();
 
     // Check if operation is running
     bool is_running() const;
 
+    // A submitted job is queued for a job slot and not running yet
+    bool is_waiting_for_slot() const;
+
 private:
+    // Makes a job's FFmpeg the one cancel() signals, for the guard's scope
+    class ActiveChild {
+    public:
+        ActiveChild(FFmpegExecutor& executor, ChildProcess& child);
+        ~ActiveChild();
+
+        ActiveChild(const ActiveChild&) = delete;
+        ActiveChild& operator=(const ActiveChild&) = delete;
+
+    private:
+        FFmpegExecutor& executor_;
+    };
+
+    // Reaps a job's FFmpeg; after a cancel it is terminated rather than
+    // waited for
+    int finish_child(ChildProcess& child);
+
     std::string build_ffmpeg_command(const TrimOptions& options) const;
-    std::string build_multi_segment_command(const MultiSegmentTrimOptions& options) const;
+    // Input arguments for a range of the source. A chunked input becomes a
+    // seek into the one chunk holding the range, or a concat list (written
+    // to list_file) of only the chunks it spans. Empty if that fails.
+    std::string build_input_args(
+        const std::filesystem::path& input_file,
+        const ChunkSequence& chunks,
+        const std::string& start_time,
+        const std::string& end_time,
+        const std::filesystem::path& list_file
+    ) const;
+    static std::filesystem::path chunk_list_path(const std::filesystem::path& output_file);
+    // A fresh directory of its own for one merge's pieces and list; empty
+    // (with ec set) if it cannot be made
+    static std::filesystem::path make_merge_dir(std::error_code& ec);
+    // A range inside one chunk is an ordinary trim of that chunk
+    TrimOptions resolve_single_chunk(const TrimOptions& options) const;
+    // Re-encoded merge in one FFmpeg run: a single input spanning the
+    // segments, split into trim/atrim branches and joined with concat, so one
+    // encoder session writes the output. Empty when the segments are out of
+    // order or overlap (the branches would have to buffer decoded frames).
+    std::string build_multi_segment_command(const MultiSegmentTrimOptions& options, double& total_duration) const;
+    // Frame grid of an input's first video stream (from probe_streams), for placing cuts
+    static CutGrid make_cut_grid(const std::vector<StreamInfo>& streams);
+    // Timeline time of the last video keyframe at or before time, from a
+    // short packet scan (no decoding)
+    std::optional<Rational> find_keyframe_before(
+        const std::filesystem::path& input_file,
+        const CutGrid& grid,
+        Rational time
+    ) const;
+    // The segment with its cut points moved onto frame boundaries and
+    // formatted exactly for ffmpeg. For stream copy the start moves back to
+    // the keyframe the copy really starts at (only keyframe_input is scanned;
+    // empty skips that), so pieces joined by concat neither overlap nor gap.
+    TrimSegment snap_segment(
+        const TrimSegment& segment,
+        const CutGrid& grid,
+        const std::filesystem::path& keyframe_input
+    ) const;
+    // Merge pieces: one segment cut to its own file, and how it's cached
+    static std::string piece_extension(const MultiSegmentTrimOptions& options);
+    std::string piece_cache_key(const MultiSegmentTrimOptions& options, const TrimSegment& segment) const;
+    std::string build_piece_command(
+        const MultiSegmentTrimOptions& options,
+        const TrimSegment& segment,
+        const CutGrid& grid,
+        const std::filesystem::path& piece
+    ) const;
+    // Concat of segment_files, listed in list_file
     std::string build_concat_command(
         const std::vector<std::filesystem::path>& segment_files,
-        const std::filesystem::path& output_file
+        const std::filesystem::path& output_file,
+        const std::filesystem::path& list_file,
+        bool encode_audio = false
     ) const;
+    static std::string build_audio_fade_args(
+        const std::string& codec,
+        double duration_seconds,
+        double fade_seconds
+    );
     bool validate_ffmpeg_binary(const std::filesystem::path& path) const;
+    void query_ffmpeg_version();
     FFmpegProgress parse_progress_line(const std::string& line, double total_duration) const;
-    double get_video_duration(const std::filesystem::path& video_path) const;
     double parse_time_to_seconds(const std::string& time_str) const;
+    void apply_drop_behind(const TrimOptions& options) const;
+    void apply_drop_behind(
+        const std::filesystem::path& input,
+        const std::vector<std::filesystem::path>& outputs,
+        bool sync_outputs
+    ) const;
+    std::vector<std::filesystem::path> get_output_files(const TrimOptions& options) const;
+    // Blocks until a job slot is free, reporting the wait; nullopt if the
+    // job was cancelled meanwhile
+    std::optional<JobSlots::Lease> wait_for_job_slot(const StatusCallback& status_cb);
+    // One digester per output, started before the writer. A leftover file
+    // of the same name is removed first so it can't be hashed instead.
+    static std::vector<std::unique_ptr<OutputDigester>> start_digests(
+        const std::vector<std::filesystem::path>& outputs,
+        const std::vector<DigestAlgorithm>& algorithms,
+        bool written_in_order = false
+    );
+    // Completes the digests (before drop-behind), writes the sidecars and
+    // logs the sums
+    static bool finish_digests(
+        std::vector<std::unique_ptr<OutputDigester>>& digesters,
+        std::vector<std::vector<OutputDigest>>& digests,
+        std::string& error_message
+    );
+    // Container-level cut for copy trims of MPEG-TS and Matroska; false to
+    // fall back to FFmpeg
+    bool try_native_cut(
+        const TrimOptions& options,
+        const ProgressCallback& progress_cb,
+        const StatusCallback& status_cb
+    );
+    // One-pass merge for re-encoded multi-segment exports (see
+    // build_multi_segment_command); false to use temp files and concat
+    bool try_one_pass_merge(
+        const MultiSegmentTrimOptions& options,
+        const ProgressCallback& progress_cb,
+        const StatusCallback& status_cb
+    );
 
     std::filesystem::path ffmpeg_path_;
+    std::filesystem::path ffprobe_path_ = "ffprobe";
     std::string ffmpeg_version_;
-    bool is_running_ = false;
+    std::atomic<bool> is_running_{false};  // Read by the speculative extractor's thread
+    std::atomic<bool> waiting_for_slot_{false};  // Likewise
+    std::atomic<bool> cancel_requested_{false};  // Set by cancel(), cleared when the next job is submitted
+    std::mutex child_mutex_;
+    ChildProcess* active_child_ = nullptr;  // FFmpeg of the running job, if any
+    std::shared_ptr<JobSlots> job_slots_;
 };
 
 } // namespace trimora
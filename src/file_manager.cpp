@@ -4,6 +4,9 @@
 #include <sstream>
 #include <fstream>
 #include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
 
 namespace fs = std::filesystem;
 
@@ -12,9 +15,12 @@ namespace trimora {
 fs::path FileManager::generate_output_filename(
     const fs::path& input_file,
     const fs::path& output_dir,
-    const std::string& pattern
+    const std::string& pattern,
+    const std::string& extension,
+    const std::function<bool(const fs::path&)>& claim
 ) {
     std::string filename = pattern;
+    std::string output_extension = extension.empty() ? input_file.extension().string() : extension;
     
     // Replace {name} with input filename (without extension)
     auto input_stem = input_file.stem().string();
@@ -31,17 +37,17 @@ fs::path FileManager::generate_output_filename(
     }
     
     // Add extension
-    filename += input_file.extension().string();
+    filename += output_extension;
     
     // Combine with output directory
     auto output_path = output_dir / filename;
     
     // Handle duplicates
     int counter = 1;
-    while (fs::exists(output_path)) {
+    while (fs::exists(output_path) || (claim && !claim(output_path))) {
         std::ostringstream oss;
         oss << input_stem << "_trimmed_" << timestamp << "_" << counter;
-        oss << input_file.extension().string();
+        oss << output_extension;
         output_path = output_dir / oss.str();
         counter++;
     }
@@ -74,6 +80,117 @@ std::optional<size_t> FileManager::get_available_space(const fs::path& path) {
     }
 }
 
+void FileManager::prefetch_range(const fs::path& path, std::uint64_t offset, std::uint64_t length) {
+#ifdef __linux__
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return;
+    }
+    
+    // Asynchronous readahead; the kernel queues the reads and returns
+    ::posix_fadvise(fd, static_cast<off_t>(offset), static_cast<off_t>(length), POSIX_FADV_WILLNEED);
+    ::close(fd);
+#else
+    (void)path;
+    (void)offset;
+    (void)length;
+#endif
+}
+
+void FileManager::drop_from_page_cache(const fs::path& path, bool sync_first) {
+#ifdef __linux__
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return;
+    }
+    
+    // DONTNEED only drops clean pages, so flush freshly written data first
+    // when the caller wants the cache fully released
+    if (sync_first) {
+        ::fdatasync(fd);
+    }
+    ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    ::close(fd);
+#else
+    (void)path;
+    (void)sync_first;
+#endif
+}
+
+bool FileManager::write_fd_all(int fd, const void* data, size_t size) {
+    auto bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t n = ::write(fd, bytes, size);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        bytes += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool FileManager::copy_fd_range(
+    int in_fd,
+    int out_fd,
+    std::uint64_t offset,
+    std::uint64_t length,
+    const std::function<bool(std::uint64_t copied)>& progress
+) {
+    constexpr std::uint64_t kReportInterval = 64 * 1024 * 1024;
+    std::uint64_t copied = 0;
+    std::uint64_t next_report = kReportInterval;
+    
+    auto report = [&]() {
+        if (!progress || (copied < next_report && copied < length)) {
+            return true;
+        }
+        next_report = copied + kReportInterval;
+        return progress(copied);
+    };
+    
+#ifdef __linux__
+    while (copied < length) {
+        loff_t in_offset = static_cast<loff_t>(offset + copied);
+        size_t chunk = static_cast<size_t>(std::min<std::uint64_t>(kReportInterval, length - copied));
+        ssize_t n = ::copy_file_range(in_fd, &in_offset, out_fd, nullptr, chunk, 0);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0 && (errno == EXDEV || errno == ENOSYS || errno == EINVAL || errno == EOPNOTSUPP)) {
+            break;  // Not supported between these files; copy the rest by hand
+        }
+        if (n <= 0) {
+            return false;
+        }
+        copied += static_cast<std::uint64_t>(n);
+        if (!report()) {
+            return false;
+        }
+    }
+#endif
+    
+    std::vector<char> buffer(1024 * 1024);
+    while (copied < length) {
+        size_t chunk = static_cast<size_t>(std::min<std::uint64_t>(buffer.size(), length - copied));
+        ssize_t n = ::pread(in_fd, buffer.data(), chunk, static_cast<off_t>(offset + copied));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0 || !write_fd_all(out_fd, buffer.data(), static_cast<size_t>(n))) {
+            return false;
+        }
+        copied += static_cast<std::uint64_t>(n);
+        if (!report()) {
+            return false;
+        }
+    }
+    return true;
+}
+
 void FileManager::add_recent_file(const fs::path& path) {
     auto recent_path = recent_files_path();
     
@@ -2,18 +2,24 @@
 
 #include <string>
 #include <filesystem>
+#include <functional>
 #include <vector>
 #include <optional>
+#include <cstdint>
 
 namespace trimora {
 
 class FileManager {
 public:
-    // Generate output filename with pattern
+    // Generate output filename with pattern. claim, if set, is called for
+    // each candidate that doesn't exist yet; returning false skips it (the
+    // name was already handed to another pending job).
     static std::filesystem::path generate_output_filename(
         const std::filesystem::path& input_file,
         const std::filesystem::path& output_dir,
-        const std::string& pattern = "{name}_trimmed_{timestamp}"
+        const std::string& pattern = "{name}_trimmed_{timestamp}",
+        const std::string& extension = "",  // Empty keeps the input's extension
+        const std::function<bool(const std::filesystem::path&)>& claim = {}
     );
 
     // Check if file exists and handle overwrite
@@ -25,6 +31,29 @@ public:
     // Get available disk space
     static std::optional<size_t> get_available_space(const std::filesystem::path& path);
 
+    // Page cache hints (no-ops on platforms without posix_fadvise)
+    static void prefetch_range(
+        const std::filesystem::path& path,
+        std::uint64_t offset,
+        std::uint64_t length  // 0 = to end of file
+    );
+    static void drop_from_page_cache(const std::filesystem::path& path, bool sync_first = false);
+
+    // write() until everything is written; false on error
+    static bool write_fd_all(int fd, const void* data, size_t size);
+
+    // Append length bytes of in_fd, starting at offset, at out_fd's current
+    // position. Uses copy_file_range where the filesystems allow it and
+    // pread/write otherwise. progress gets the bytes copied so far and
+    // returns false to stop; the result is false on error or stop.
+    static bool copy_fd_range(
+        int in_fd,
+        int out_fd,
+        std::uint64_t offset,
+        std::uint64_t length,
+        const std::function<bool(std::uint64_t copied)>& progress = {}
+    );
+
     // Recent files management
     static void add_recent_file(const std::filesystem::path& path);
     static std::vector<std::filesystem::path> get_recent_files(size_t max_count = 5);
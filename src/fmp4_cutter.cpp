@@ -0,0 +1,315 @@
+#include "fmp4_cutter.hpp"
+#include "mp4_box.hpp"
+#include "mp4_reader.hpp"
+#include <algorithm>
+#include <optional>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace trimora {
+
+namespace {
+
+using mp4::Box;
+using mp4::fourcc;
+using mp4::read_be;
+using mp4::write_be;
+using mp4::child_boxes;
+using mp4::find_child;
+
+constexpr uint64_t kMaxMoovBytes = 64 * 1024 * 1024;
+
+struct MovieInfo {
+    uint32_t track_id = 0;        // Track whose fragment times are used
+    uint64_t track_timescale = 0;
+    uint64_t movie_timescale = 0;
+    std::optional<size_t> mehd_offset;  // Offset of mehd's duration field within moov
+    size_t mehd_width = 0;
+};
+
+// tfhd flag: the track's data offsets are absolute file positions
+constexpr uint32_t kBaseDataOffsetPresent = 0x1;
+
+// A field of a full box whose place and width depend on its version (the
+// time fields in front of it are 64-bit in version 1); nullopt if the box
+// is too short to hold it
+std::optional<uint64_t> full_box_field(
+    const uint8_t* fields,
+    uint64_t size,
+    size_t offset_v0,
+    size_t width_v0,
+    size_t offset_v1,
+    size_t width_v1
+) {
+    if (size < 4) {
+        return std::nullopt;
+    }
+    bool v1 = fields[0] == 1;
+    size_t offset = v1 ? offset_v1 : offset_v0;
+    size_t width = v1 ? width_v1 : width_v0;
+    if (size < offset + width) {
+        return std::nullopt;
+    }
+    return read_be(fields + offset, width);
+}
+
+std::optional<uint64_t> full_box_field(
+    const uint8_t* data,
+    const Box& box,
+    size_t offset_v0,
+    size_t width_v0,
+    size_t offset_v1,
+    size_t width_v1
+) {
+    return full_box_field(data + box.offset + box.header_size, box.size - box.header_size,
+                          offset_v0, width_v0, offset_v1, width_v1);
+}
+
+// Prefers the first video track; mehd is in movie timescale units
+std::optional<MovieInfo> read_movie_info(const std::vector<uint8_t>& moov, size_t header_size) {
+    const uint8_t* data = moov.data() + header_size;
+    size_t size = moov.size() - header_size;
+
+    MovieInfo info;
+    bool have_video = false;
+    for (const auto& box : child_boxes(data, size)) {
+        const uint8_t* payload = data + box.offset + box.header_size;
+        size_t payload_size = box.size - box.header_size;
+
+        if (box.type == fourcc("mvhd")) {
+            info.movie_timescale = full_box_field(data, box, 12, 4, 20, 4).value_or(0);
+        } else if (box.type == fourcc("mvex")) {
+            auto mehd = find_child(payload, payload_size, fourcc("mehd"));
+            if (mehd && mehd->size >= mehd->header_size + 4) {
+                const uint8_t* fields = payload + mehd->offset + mehd->header_size;
+                info.mehd_width = fields[0] == 1 ? 8 : 4;
+                if (mehd->size >= mehd->header_size + 4 + info.mehd_width) {
+                    info.mehd_offset = static_cast<size_t>(fields + 4 - moov.data());
+                }
+            }
+        } else if (box.type == fourcc("trak") && !have_video) {
+            auto tkhd = find_child(payload, payload_size, fourcc("tkhd"));
+            auto mdia = find_child(payload, payload_size, fourcc("mdia"));
+            if (!tkhd || !mdia) {
+                continue;
+            }
+            auto track_id = full_box_field(payload, *tkhd, 12, 4, 20, 4);
+
+            const uint8_t* mdia_data = payload + mdia->offset + mdia->header_size;
+            size_t mdia_size = mdia->size - mdia->header_size;
+            auto mdhd = find_child(mdia_data, mdia_size, fourcc("mdhd"));
+            auto hdlr = find_child(mdia_data, mdia_size, fourcc("hdlr"));
+            auto timescale = mdhd ? full_box_field(mdia_data, *mdhd, 12, 4, 20, 4) : std::nullopt;
+            if (!track_id || !timescale) {
+                continue;
+            }
+            bool is_video = hdlr && full_box_field(mdia_data, *hdlr, 8, 4, 8, 4) == fourcc("vide");
+
+            if (info.track_id == 0 || is_video) {
+                info.track_id = static_cast<uint32_t>(*track_id);
+                info.track_timescale = *timescale;
+                have_video = is_video;
+            }
+        }
+    }
+
+    if (info.track_id == 0 || info.track_timescale == 0) {
+        return std::nullopt;
+    }
+    return info;
+}
+
+// Whether any traf of a moof addresses its samples by absolute file
+// offset. Those offsets go stale once the kept range moves to the front of
+// the file. Without the flag, data offsets count from the moof (or from the
+// end of the previous traf's data) and move along with it.
+bool has_absolute_offsets(const mp4::BoxRef& moof) {
+    for (const auto& traf : moof.children()) {
+        if (traf.type() != fourcc("traf")) {
+            continue;
+        }
+        auto tfhd = traf.child(fourcc("tfhd"));
+        if (tfhd && tfhd->payload_size() >= 4 && (tfhd->flags() & kBaseDataOffsetPresent) != 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// baseMediaDecodeTime of the track's traf in a moof
+std::optional<uint64_t> fragment_time(const mp4::BoxRef& moof, uint32_t track_id) {
+    for (const auto& traf : moof.children()) {
+        if (traf.type() != fourcc("traf")) {
+            continue;
+        }
+        auto tfhd = traf.child(fourcc("tfhd"));
+        auto tfdt = traf.child(fourcc("tfdt"));
+        if (!tfhd || !tfdt || tfhd->payload_size() < 8 || read_be(tfhd->payload() + 4, 4) != track_id) {
+            continue;
+        }
+        return full_box_field(tfdt->payload(), tfdt->payload_size(), 4, 4, 4, 8);
+    }
+    return std::nullopt;
+}
+
+struct Fragment {
+    uint64_t offset = 0;  // styp or moof
+    uint64_t time = 0;    // Track timescale
+};
+
+} // namespace
+
+bool Fmp4Cutter::is_fragmented_mp4(const fs::path& path) {
+    mp4::Reader reader(path);
+    if (!reader) {
+        return false;
+    }
+
+    for (const auto& box : reader.top_level()) {
+        if (box.type() == fourcc("moov")) {
+            return box.child(fourcc("mvex")).has_value();
+        }
+        if (box.type() == fourcc("mdat") || box.type() == fourcc("moof")) {
+            return false;  // moov must come first
+        }
+    }
+    return false;
+}
+
+NativeCutPlan Fmp4Cutter::plan(const fs::path& input_file, double start_seconds, double end_seconds) {
+    NativeCutPlan plan;
+    plan.input_file = input_file;
+
+    // Only moov and the moof boxes are read; the mapping leaves media
+    // data alone
+    mp4::Reader reader(input_file);
+    if (!reader) {
+        plan.error_message = "Cannot open input: " + input_file.string();
+        return plan;
+    }
+
+    std::vector<uint8_t> ftyp;
+    std::vector<uint8_t> moov;
+    size_t moov_header = 0;
+    std::optional<MovieInfo> info;
+    std::vector<Fragment> fragments;
+    uint64_t fragments_end = 0;
+    uint64_t styp_offset = 0;  // Segment type box opening the next fragment, 0 = none
+
+    // Top level: ftyp, moov, then (styp) moof mdat pairs until mfra or EOF
+    for (const auto& box : reader.top_level()) {
+        const uint8_t* bytes = reader.data() + box.offset();
+        if (box.type() == fourcc("ftyp") && fragments.empty()) {
+            ftyp.assign(bytes, bytes + box.size());
+        } else if (box.type() == fourcc("moov")) {
+            if (box.size() > kMaxMoovBytes) {
+                plan.error_message = "Cannot read moov";
+                return plan;
+            }
+            moov.assign(bytes, bytes + box.size());
+            moov_header = box.box().header_size;
+            info = read_movie_info(moov, moov_header);
+            if (!info) {
+                plan.error_message = "No track with a timescale in moov";
+                return plan;
+            }
+        } else if (box.type() == fourcc("styp")) {
+            styp_offset = box.offset();
+        } else if (box.type() == fourcc("moof")) {
+            if (!info) {
+                plan.error_message = "Cannot read movie fragment";
+                return plan;
+            }
+            if (has_absolute_offsets(box)) {
+                plan.error_message = "Fragments address their data by absolute file offset, which the trim "
+                                     "would invalidate (remux with -movflags +default_base_moof first)";
+                return plan;
+            }
+            auto time = fragment_time(box, info->track_id);
+            if (!time) {
+                plan.error_message = "Fragment without a decode time for the main track";
+                return plan;
+            }
+            fragments.push_back({styp_offset > 0 ? styp_offset : box.offset(), *time});
+            styp_offset = 0;
+        } else if (box.type() == fourcc("mdat") && !fragments.empty()) {
+            fragments_end = box.box().end();
+        } else if (box.type() == fourcc("mfra")) {
+            break;  // Random access index with absolute offsets; dropped
+        }
+    }
+
+    if (!info || fragments.empty() || fragments_end == 0) {
+        plan.error_message = "Not a fragmented MP4 (no moov/moof)";
+        return plan;
+    }
+
+    // Fragments start on sync samples (CMAF and every common muxer), so any
+    // fragment boundary is a valid start
+    double timescale = static_cast<double>(info->track_timescale);
+    uint64_t base_time = fragments.front().time;
+    auto to_time = [&](double seconds) { return base_time + static_cast<uint64_t>(std::max(0.0, seconds) * timescale); };
+
+    size_t first = 0;
+    for (size_t i = 0; i < fragments.size() && fragments[i].time <= to_time(start_seconds); ++i) {
+        first = i;
+    }
+    size_t last = fragments.size();  // Exclusive
+    if (end_seconds > start_seconds) {
+        for (size_t i = first + 1; i < fragments.size(); ++i) {
+            if (fragments[i].time > to_time(end_seconds)) {
+                last = i;
+                break;
+            }
+        }
+    }
+
+    plan.range_offset = fragments[first].offset;
+    uint64_t range_end = last < fragments.size() ? fragments[last].offset : fragments_end;
+    plan.range_length = range_end - plan.range_offset;
+    plan.start_seconds = (fragments[first].time - base_time) / timescale;
+    if (last < fragments.size()) {
+        plan.end_seconds = (fragments[last].time - base_time) / timescale;
+    }
+
+    // Fragment duration in mehd, in movie timescale; when running to the end
+    // only the removed head is subtracted
+    if (info->mehd_offset && info->movie_timescale > 0) {
+        uint64_t old_duration = read_be(moov.data() + *info->mehd_offset, info->mehd_width);
+        double kept_seconds = last < fragments.size()
+            ? (fragments[last].time - fragments[first].time) / timescale
+            : std::max(0.0, old_duration / static_cast<double>(info->movie_timescale) - plan.start_seconds);
+        uint64_t duration = static_cast<uint64_t>(kept_seconds * info->movie_timescale);
+        if (info->mehd_width == 4) {
+            duration = std::min<uint64_t>(duration, 0xffffffffu);
+        }
+        write_be(moov.data() + *info->mehd_offset, info->mehd_width, duration);
+    }
+
+    std::vector<uint8_t> header = ftyp;
+    header.insert(header.end(), moov.begin(), moov.end());
+
+    // Padding is a free box, which needs at least its 8-byte header
+    plan.min_prefix_size = header.size();
+    plan.build_prefix = [header](uint64_t size) {
+        std::vector<uint8_t> prefix;
+        uint64_t padding = size - std::min<uint64_t>(size, header.size());
+        if (size < header.size() || (padding > 0 && padding < 8) || padding > 0xffffffffu) {
+            return prefix;
+        }
+        prefix = header;
+        if (padding > 0) {
+            size_t at = prefix.size();
+            prefix.resize(size, 0);
+            write_be(prefix.data() + at, 4, padding);
+            write_be(prefix.data() + at + 4, 4, fourcc("free"));
+        }
+        return prefix;
+    };
+
+    plan.ok = true;
+    return plan;
+}
+
+} // namespace trimora
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "native_cut.hpp"
+#include <filesystem>
+
+namespace trimora {
+
+// Fragment-level planning for fragmented MP4 (moov with mvex, then moof/mdat
+// pairs). Fragments are located by their tfdt decode time on the main
+// track; the kept range runs from the fragment at or before the start time
+// to the last one that starts before the end time. The prefix is ftyp and
+// moov, with the movie-extends duration updated; the global sidx and mfra
+// are dropped because their offsets no longer hold. Files whose fragments
+// use absolute data offsets (tfhd base-data-offset, FFmpeg's default without
+// +default_base_moof) are refused for the same reason.
+class Fmp4Cutter {
+public:
+    static bool is_fragmented_mp4(const std::filesystem::path& path);
+
+    // Where the cut lands and what goes in front of it; nothing is written
+    static NativeCutPlan plan(const std::filesystem::path& input_file, double start_seconds, double end_seconds);
+};
+
+} // namespace trimora
@@ -1,13 +1,14 @@
 #include "application.hpp"
 #include "main_window.hpp"
 #include "../config_manager.hpp"
+#include "../file_manager.hpp"
+#include "../logger.hpp"
 
 #include <imgui.h>
 #include <imgui_impl_glfw.h>
 #include <imgui_impl_opengl3.h>
 
 #include <GLFW/glfw3.h>
-#include <iostream>
 
 namespace trimora {
 
@@ -18,25 +19,35 @@ Application::~Application() {
 }
 
 bool Application::initialize() {
+    // Create config manager
+    config_manager_ = std::make_unique<ConfigManager>();
+    config_manager_->load();
+    
+    // Logging follows the config from here on
+    const auto& config = config_manager_->get_config();
+    auto& logger = Logger::instance();
+    logger.set_level(Logger::parse_level(config.log_level));
+    auto config_dir = FileManager::get_config_dir();
+    if (!config_dir.empty()) {
+        logger.add_file_sink(config_dir / "logs", config.log_max_file_mb * 1024 * 1024, config.log_max_files);
+    }
+    TRIMORA_LOG_INFO("Trimora starting (log level: " + config.log_level + ")");
+    
     if (!init_glfw()) {
-        std::cerr << "Failed to initialize GLFW" << std::endl;
+        TRIMORA_LOG_ERROR("Failed to initialize GLFW");
         return false;
     }
     
     if (!init_opengl()) {
-        std::cerr << "Failed to initialize OpenGL context" << std::endl;
+        TRIMORA_LOG_ERROR("Failed to initialize OpenGL context");
         return false;
     }
     
     if (!init_imgui()) {
-        std::cerr << "Failed to initialize ImGui" << std::endl;
+        TRIMORA_LOG_ERROR("Failed to initialize ImGui");
         return false;
     }
     
-    // Create config manager
-    config_manager_ = std::make_unique<ConfigManager>();
-    config_manager_->load();
-    
     // Create main window
     main_window_ = std::make_unique<MainWindow>(*config_manager_);
     
@@ -80,6 +91,8 @@ void Application::shutdown() {
         window_ = nullptr;
     }
     glfwTerminate();
+    
+    Logger::instance().flush();
 }
 
 bool Application::init_glfw() {
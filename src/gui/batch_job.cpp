@@ -0,0 +1,104 @@
+#include "batch_job.hpp"
+#include <cstdio>
+#include <cmath>
+
+namespace fs = std::filesystem;
+
+namespace trimora {
+
+bool BatchJob::load(const fs::path& path, uint64_t job_id) {
+    id = job_id;
+    input_file = path;
+    name_label = path.filename().string();
+
+    std::error_code ec;
+    size_bytes = fs::file_size(path, ec);
+    if (ec) {
+        size_bytes = 0;
+    }
+
+    reset();
+    return !ec;
+}
+
+void BatchJob::refresh_labels() {
+    char buffer[64];
+
+    if (duration_seconds > 0) {
+        auto total_ms = static_cast<long long>(duration_seconds * 1000.0 + 0.5);
+        snprintf(buffer, sizeof(buffer), "%02lld:%02lld:%02lld",
+            total_ms / 3600000, (total_ms / 60000) % 60, (total_ms / 1000) % 60);
+        duration_label = buffer;
+    } else {
+        duration_label = "-";
+    }
+
+    double mb = size_bytes / (1024.0 * 1024.0);
+    if (mb >= 1024.0) {
+        snprintf(buffer, sizeof(buffer), "%.2f GB", mb / 1024.0);
+    } else {
+        snprintf(buffer, sizeof(buffer), "%.1f MB", mb);
+    }
+    size_label = buffer;
+
+    snprintf(buffer, sizeof(buffer), "%d%%", static_cast<int>(progress * 100.0f));
+    progress_label = buffer;
+
+    if (status == BatchJobStatus::Running && speed > 0) {
+        snprintf(buffer, sizeof(buffer), "%.2fx", speed);
+        speed_label = buffer;
+    } else {
+        speed_label.clear();
+    }
+}
+
+void BatchJob::set_progress(float new_progress, double new_speed) {
+    bool changed = static_cast<int>(new_progress * 100.0f) != static_cast<int>(progress * 100.0f) ||
+                   std::lround(new_speed * 100.0) != std::lround(speed * 100.0);
+    progress = new_progress;
+    speed = new_speed;
+
+    if (changed) {
+        refresh_labels();
+    }
+}
+
+void BatchJob::set_digests(const std::vector<OutputDigest>& digests) {
+    digest_report.clear();
+    for (const auto& digest : digests) {
+        if (!digest_report.empty()) {
+            digest_report += '\n';
+        }
+        digest_report += std::string(digest_name(digest.algorithm)) + " " + digest.hex;
+    }
+}
+
+void BatchJob::reset() {
+    status = BatchJobStatus::Pending;
+    output_file.clear();
+    progress = 0.0f;
+    speed = 0.0;
+    error.clear();
+    digest_report.clear();
+    refresh_labels();
+}
+
+bool BatchJob::is_finished() const {
+    return status == BatchJobStatus::Completed ||
+           status == BatchJobStatus::Failed ||
+           status == BatchJobStatus::Cancelled;
+}
+
+const char* BatchJob::status_name(BatchJobStatus status) {
+    switch (status) {
+        case BatchJobStatus::Checking: return "Checking";
+        case BatchJobStatus::Pending: return "Pending";
+        case BatchJobStatus::Running: return "Running";
+        case BatchJobStatus::Completed: return "Done";
+        case BatchJobStatus::Failed: return "Failed";
+        case BatchJobStatus::Cancelled: return "Cancelled";
+    }
+    return "";
+}
+
+} // namespace trimora
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "../output_digest.hpp"
+#include <string>
+#include <vector>
+#include <filesystem>
+#include <cstdint>
+
+namespace trimora {
+
+enum class BatchJobStatus {
+    Checking,   // Pre-flight running
+    Pending,
+    Running,
+    Completed,
+    Failed,
+    Cancelled
+};
+
+// One input in the batch list. The display strings are cached and only
+// rebuilt through refresh_labels() when the job changes, so drawing a row
+// doesn't allocate.
+struct BatchJob {
+    uint64_t id = 0;
+    std::filesystem::path input_file;
+    std::filesystem::path output_file;  // Named by pre-flight, empty until then
+    BatchJobStatus status = BatchJobStatus::Pending;
+    double duration_seconds = 0.0;  // Output duration, 0 until known
+    uintmax_t size_bytes = 0;
+    float progress = 0.0f;          // 0.0 - 1.0
+    double speed = 0.0;             // Encode speed as a multiple of realtime
+    std::string error;
+    std::string digest_report;  // Checksums of the output, one per line
+    bool selected = false;
+
+    // Cached labels
+    std::string name_label;
+    std::string duration_label;
+    std::string size_label;
+    std::string progress_label;
+    std::string speed_label;
+
+    // Returns false if the file couldn't be stat'ed
+    bool load(const std::filesystem::path& path, uint64_t job_id);
+
+    void refresh_labels();
+
+    // Update progress and speed; labels are only rebuilt when the displayed
+    // value changes
+    void set_progress(float new_progress, double new_speed);
+
+    void set_digests(const std::vector<OutputDigest>& digests);
+
+    void reset();
+    bool is_finished() const;
+
+    static const char* status_name(BatchJobStatus status);
+};
+
+} // namespace trimora
@@ -1,16 +1,58 @@
 #include "main_window.hpp"
 #include "../file_manager.hpp"
 #include "../validator.hpp"
+#include "../logger.hpp"
+#include "../metrics.hpp"
 
 #include <imgui.h>
 #include <nfd.h>
-#include <iostream>
 #include <iomanip>
 #include <sstream>
 #include <cstring>
+#include <cstdlib>
+#include <cctype>
+#include <algorithm>
+#include <string_view>
+#include <chrono>
+
+namespace fs = std::filesystem;
 
 namespace trimora {
 
+namespace {
+
+// Target containers offered by batch remux mode
+const char* const kRemuxContainers[] = {".mp4", ".mkv", ".mov"};
+
+// Oldest console lines are dropped past this many
+constexpr size_t kMaxLogLines = 5000;
+
+// Rotation choices for the metadata editor; the first keeps the file's own
+const char* const kRotationChoices[] = {"Keep", "0", "90", "180", "270"};
+
+// Batch table columns, used as column user IDs for sorting
+enum BatchColumn {
+    BatchColumn_Queue,
+    BatchColumn_Name,
+    BatchColumn_Status,
+    BatchColumn_Duration,
+    BatchColumn_Size,
+    BatchColumn_Progress,
+    BatchColumn_Speed,
+    BatchColumn_Error,
+    BatchColumn_Count
+};
+
+bool contains_ignore_case(std::string_view haystack, std::string_view needle) {
+    auto it = std::search(haystack.begin(), haystack.end(), needle.begin(), needle.end(),
+        [](char a, char b) {
+            return std::tolower(static_cast<unsigned char>(a)) == std::tolower(static_cast<unsigned char>(b));
+        });
+    return it != haystack.end();
+}
+
+} // namespace
+
 MainWindow::MainWindow(ConfigManager& config_manager)
     : config_manager_(config_manager)
 {
@@ -18,6 +60,76 @@ MainWindow::MainWindow(ConfigManager& config_manager)
     NFD_Init();
     
     ffmpeg_executor_ = std::make_unique<FFmpegExecutor>();
+    const auto& ffmpeg_path = config_manager_.get_config().ffmpeg_path;
+    if (!ffmpeg_path.empty() && !ffmpeg_executor_->set_ffmpeg_path(ffmpeg_path)) {
+        TRIMORA_LOG_WARNING("Configured ffmpeg_path is not usable, using " + 
+            ffmpeg_executor_->get_ffmpeg_path().value_or("none"));
+    }
+    // Shared with other trimora instances on this machine
+    const auto& slots_config = config_manager_.get_config();
+    auto job_slots = std::make_shared<JobSlots>(slots_config.job_slots_directory, slots_config.job_slots);
+    TRIMORA_LOG_DEBUG("Job slots: " + std::to_string(job_slots->slots()) + " in " + job_slots->directory().string());
+    ffmpeg_executor_->set_job_slots(std::move(job_slots));
+    if (config_manager_.get_config().segment_cache_enabled) {
+        segment_cache_ = std::make_shared<SegmentCache>(config_manager_.get_config().segment_cache_directory,
+            static_cast<uint64_t>(config_manager_.get_config().segment_cache_max_mb) * 1024 * 1024);
+        if (config_manager_.get_config().speculative_extraction) {
+            speculative_extractor_ = std::make_unique<SpeculativeExtractor>(*ffmpeg_executor_,
+                std::chrono::seconds(config_manager_.get_config().speculative_extraction_delay_seconds));
+        }
+    }
+    segment_manager_ = std::make_unique<SegmentManager>();
+    
+    // Input checks and output naming can block on slow mounts; keep them off
+    // the render thread
+    preflight_ = std::make_unique<Preflight>(
+        config_manager_.get_config().preflight_workers,
+        [this](const fs::path& input_file) { return ffmpeg_executor_->get_video_duration(input_file); }
+    );
+    
+    std::string digest_error;
+    output_digests_ = parse_digest_list(config_manager_.get_config().output_digests, digest_error);
+    if (!digest_error.empty()) {
+        TRIMORA_LOG_WARNING("output_digests: " + digest_error);
+    }
+    
+    if (config_manager_.get_config().upload_enabled) {
+        const auto& config = config_manager_.get_config();
+        UploadTarget target;
+        target.endpoint = config.upload_endpoint;
+        target.region = config.upload_region;
+        target.bucket = config.upload_bucket;
+        target.prefix = config.upload_prefix;
+        target.access_key = config.upload_access_key;
+        target.secret_key = config.upload_secret_key;
+        if (target.access_key.empty() && std::getenv("AWS_ACCESS_KEY_ID")) {
+            target.access_key = std::getenv("AWS_ACCESS_KEY_ID");
+        }
+        if (target.secret_key.empty() && std::getenv("AWS_SECRET_ACCESS_KEY")) {
+            target.secret_key = std::getenv("AWS_SECRET_ACCESS_KEY");
+        }
+        target.part_size_mb = config.upload_part_size_mb;
+        target.concurrency = config.upload_concurrency;
+        target.max_retries = config.upload_retries;
+        
+        // Results are only logged; the job that wrote the file is long done
+        std::string bucket = target.bucket;
+        auto sink = std::make_shared<UploadSink>(target, [bucket](const UploadResult& result) {
+            if (result.ok) {
+                TRIMORA_LOG_INFO("Uploaded " + result.file.filename().string() + " to s3://" + bucket + "/" +
+                                 result.key + " (" + std::to_string(result.parts) + " part(s))");
+            } else {
+                TRIMORA_LOG_ERROR("Upload of " + result.file.filename().string() + " failed: " +
+                                  result.error_message);
+            }
+        });
+        std::string upload_error;
+        if (sink->is_valid(upload_error)) {
+            upload_sink_ = std::move(sink);
+        } else {
+            TRIMORA_LOG_WARNING("Uploads disabled: " + upload_error);
+        }
+    }
     
     // Initialize output directory from config
     auto output_dir = config_manager_.get_config().output_directory.string();
@@ -28,13 +140,37 @@ MainWindow::MainWindow(ConfigManager& config_manager)
     for (const auto& file : recent) {
         recent_files_.push_back(file.string());
     }
+    
+    // Mirror the application log into the console panel
+    console_sink_id_ = Logger::instance().add_sink([this](const LogRecord& record) {
+        std::string text = record.level == LogLevel::Error ? "Error: " + record.message : record.message;
+        std::lock_guard<std::mutex> lock(log_mutex_);
+        pending_log_.push_back({std::move(text)});
+    });
 }
 
 MainWindow::~MainWindow() {
+    // Workers post back into this window; join them first
+    preflight_.reset();
+    speculative_extractor_.reset();
+    if (metadata_thread_.joinable()) {
+        metadata_thread_.join();
+    }
+    upload_sink_.reset();
+    Logger::instance().remove_sink(console_sink_id_);
     NFD_Quit();
 }
 
 void MainWindow::render() {
+    auto render_start = std::chrono::steady_clock::now();
+    
+    run_ui_tasks();
+    drain_log();
+    
+    if (ImGui::IsKeyPressed(ImGuiKey_F3, false)) {
+        show_performance_hud_ = !show_performance_hud_;
+    }
+    
     ImGui::SetNextWindowPos(ImVec2(0, 0));
     ImGui::SetNextWindowSize(ImGui::GetIO().DisplaySize);
     
@@ -53,6 +189,10 @@ void MainWindow::render() {
             }
             ImGui::EndMenu();
         }
+        if (ImGui::BeginMenu("View")) {
+            ImGui::MenuItem("Performance HUD", "F3", &show_performance_hud_);
+            ImGui::EndMenu();
+        }
         if (ImGui::BeginMenu("Help")) {
             if (ImGui::MenuItem("About")) {
                 // TODO: Show about dialog
@@ -80,9 +220,26 @@ void MainWindow::render() {
     
     // Main content
     render_input_section();
-    render_time_inputs();
+    
+    if (!batch_mode_) {
+        ImGui::Checkbox("Show Player", &show_player_);
+        if (show_player_) {
+            render_video_player();
+        }
+    }
+    
+    if (!(batch_mode_ && remux_only_)) {
+        render_time_inputs();
+    }
+    
+    if (!batch_mode_) {
+        render_segment_mode();
+    }
+    update_speculative_extraction();
+    
     render_batch_mode();
     render_control_buttons();
+    render_metadata_editor();
     
     ImGui::Separator();
     
@@ -90,6 +247,13 @@ void MainWindow::render() {
     render_recent_files();
     
     ImGui::End();
+    
+    if (show_performance_hud_) {
+        render_performance_hud();
+    }
+    
+    Metrics::instance().record_frame(ImGui::GetIO().DeltaTime * 1000.0f,
+        std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - render_start).count());
 }
 
 void MainWindow::render_input_section() {
@@ -102,26 +266,51 @@ void MainWindow::render_input_section() {
         if (ImGui::Button("Browse...##input")) {
             browse_input_file();
         }
+        
+        // Editing the input field leaves the chunked recording
+        if (!input_chunks_.empty() && !chunks_active()) {
+            input_chunks_ = ChunkSequence();
+        }
+        
+        if (chunks_left_to_probe_ > 0) {
+            ImGui::TextDisabled("Reading %zu chunk(s)...", chunks_left_to_probe_);
+        } else if (chunks_active()) {
+            ImGui::Text("Split recording: %zu chunks, %s total", input_chunks_.size(),
+                        format_timestamp(input_chunks_.total_duration()).c_str());
+            ImGui::SameLine();
+            if (ImGui::SmallButton("Use first chunk only")) {
+                input_chunks_ = ChunkSequence();
+                player_file_.clear();
+            }
+        } else if (ImGui::SmallButton("Open split recording...")) {
+            browse_input_chunks();
+        }
+        if (ImGui::IsItemHovered() && input_chunks_.empty()) {
+            ImGui::SetTooltip("Select every chunk of a recording the camera or OBS split into several files;\n"
+                              "they play and trim as one timeline, reading only the chunks a cut spans");
+        }
     } else {
-        ImGui::Text("Batch Mode - %zu file(s) selected", batch_files_.size());
+        ImGui::Text("Batch Mode - %zu file(s) selected", batch_jobs_.size());
         if (ImGui::Button("Add Files...##batch")) {
             browse_input_files_batch();
         }
         ImGui::SameLine();
+        if (is_trimming_) {
+            ImGui::BeginDisabled();
+        }
         if (ImGui::Button("Clear All##batch")) {
-            batch_files_.clear();
-            std::lock_guard<std::mutex> lock(log_mutex_);
-            log_messages_.push_back("Batch list cleared.");
+            batch_jobs_.clear();
+            batch_view_dirty_ = true;
+            update_queue_depth();
+            TRIMORA_LOG_INFO("Batch list cleared.");
+        }
+        if (is_trimming_) {
+            ImGui::EndDisabled();
         }
         
         // Show batch file list
-        if (!batch_files_.empty()) {
-            ImGui::BeginChild("BatchFileList", ImVec2(0, 80), true);
-            for (size_t i = 0; i < batch_files_.size(); ++i) {
-                std::string label = std::to_string(i + 1) + ". " + batch_files_[i];
-                ImGui::Text("%s", label.c_str());
-            }
-            ImGui::EndChild();
+        if (!batch_jobs_.empty()) {
+            render_batch_table();
         }
     }
     
@@ -153,9 +342,271 @@ void MainWindow::render_time_inputs() {
     ImGui::InputText("##end", end_time_, sizeof(end_time_));
     ImGui::PopItemWidth();
     
+    bool in_place = in_place_trim_ && !segment_mode_ && !batch_mode_ && !chunks_active();
+    if (!segment_mode_ && !batch_mode_ && !chunks_active()) {
+        ImGui::Checkbox("Trim in place", &in_place_trim_);
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Cut the input file itself (TS, fragmented MP4, MKV/WebM) instead of writing a copy.\n"
+                              "Cuts land on keyframes. This cannot be undone.");
+        }
+        if (in_place_trim_) {
+            ImGui::SameLine();
+            ImGui::Checkbox("Dry run", &in_place_dry_run_);
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("Log what would be done without changing the file");
+            }
+        }
+    }
+    
+    if (!in_place && (!segment_mode_ || batch_mode_)) {
+        ImGui::Text("Also export:");
+        ImGui::SameLine();
+        ImGui::Checkbox("720p H.264", &extra_output_720p_);
+        ImGui::SameLine();
+        ImGui::Checkbox("Audio only", &extra_output_audio_);
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Extra outputs are produced from the same read of the input");
+        }
+    }
+    
+    if (!in_place && (!batch_mode_ || !remux_only_)) {
+        ImGui::Checkbox("Clean audio at cuts", &reencode_audio_);
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Video is still copied; audio is re-encoded with short fades at each cut");
+        }
+    }
+    
+    ImGui::Spacing();
+}
+
+void MainWindow::render_video_player() {
+    if (!video_player_) {
+        video_player_ = std::make_unique<VideoPlayer>();
+        if (!video_player_->initialize()) {
+            video_player_.reset();
+            show_player_ = false;
+            
+            TRIMORA_LOG_ERROR("Failed to initialize video player");
+            return;
+        }
+    }
+    
+    // Follow the input field (leaving any segment preview)
+    if (strlen(input_file_) > 0 && player_file_ != input_file_) {
+        player_file_ = input_file_;
+        load_player_source();
+    }
+    
+    if (!video_player_->has_file()) {
+        ImGui::TextDisabled("No video loaded");
+        return;
+    }
+    
+    // Video frame, 16:9 at the available width
+    float width = ImGui::GetContentRegionAvail().x;
+    float height = width * 9.0f / 16.0f;
+    video_player_->render(static_cast<int>(width), static_cast<int>(height));
+    ImGui::Image((ImTextureID)(intptr_t)video_player_->get_texture_id(), ImVec2(width, height));
+    
+    // Timeline
+    double duration = video_player_->get_duration();
+    double current = video_player_->get_current_time();
+    
+    ImGui::PushItemWidth(-1);
+    if (ImGui::SliderFloat("##timeline", &seek_position_, 0.0f, static_cast<float>(duration), "")) {
+        video_player_->seek(seek_position_);
+    } else if (!ImGui::IsItemActive()) {
+        seek_position_ = static_cast<float>(current);
+    }
+    ImGui::PopItemWidth();
+    
+    // Segment joins on the preview timeline
+    if (video_player_->is_segments_preview() && duration > 0) {
+        ImVec2 bar_min = ImGui::GetItemRectMin();
+        ImVec2 bar_max = ImGui::GetItemRectMax();
+        ImDrawList* draw_list = ImGui::GetWindowDrawList();
+        
+        for (double boundary : video_player_->get_segment_boundaries()) {
+            float x = bar_min.x + static_cast<float>(boundary / duration) * (bar_max.x - bar_min.x);
+            draw_list->AddLine(ImVec2(x, bar_min.y), ImVec2(x, bar_max.y), IM_COL32(255, 200, 0, 255), 2.0f);
+        }
+    }
+    
+    // Chunk files of a split recording
+    if (!video_player_->get_chunk_boundaries().empty() && duration > 0) {
+        ImVec2 bar_min = ImGui::GetItemRectMin();
+        ImVec2 bar_max = ImGui::GetItemRectMax();
+        ImDrawList* draw_list = ImGui::GetWindowDrawList();
+        
+        for (double boundary : video_player_->get_chunk_boundaries()) {
+            float x = bar_min.x + static_cast<float>(boundary / duration) * (bar_max.x - bar_min.x);
+            draw_list->AddLine(ImVec2(x, bar_min.y), ImVec2(x, bar_max.y), IM_COL32(120, 170, 255, 200), 1.0f);
+        }
+    }
+    
+    ImGui::Text("%s / %s", format_timestamp(current).c_str(), format_timestamp(duration).c_str());
+    
+    // Transport controls
+    if (ImGui::Button(video_player_->is_playing() ? "Pause" : "Play")) {
+        video_player_->toggle_play_pause();
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("-5s")) {
+        video_player_->seek_relative(-5.0);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("+5s")) {
+        video_player_->seek_relative(5.0);
+    }
+    
+    // Trim points only make sense on the source timeline
+    ImGui::SameLine();
+    if (video_player_->is_segments_preview()) {
+        ImGui::BeginDisabled();
+    }
+    if (ImGui::Button("Set Start Here")) {
+        std::strncpy(start_time_, format_timestamp(current).c_str(), sizeof(start_time_) - 1);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Set End Here")) {
+        std::strncpy(end_time_, format_timestamp(current).c_str(), sizeof(end_time_) - 1);
+    }
+    if (video_player_->is_segments_preview()) {
+        ImGui::EndDisabled();
+    }
+    
+    // Merged result preview
+    if (segment_mode_) {
+        ImGui::SameLine();
+        if (video_player_->is_segments_preview()) {
+            if (ImGui::Button("Exit Preview")) {
+                load_player_source();
+            }
+        } else if (ImGui::Button("Preview Result")) {
+            if (!video_player_->load_segments_preview(player_file_, segment_manager_->get_segments(),
+                    chunks_active() ? input_chunks_ : ChunkSequence())) {
+                TRIMORA_LOG_ERROR("No enabled segments to preview");
+            }
+        }
+    }
+    
+    ImGui::PushItemWidth(150);
+    if (ImGui::SliderFloat("Volume", &player_volume_, 0.0f, 100.0f, "%.0f")) {
+        video_player_->set_volume(player_volume_);
+    }
+    ImGui::SameLine();
+    if (ImGui::SliderFloat("Speed", &player_speed_, 0.25f, 4.0f, "%.2fx")) {
+        video_player_->set_speed(player_speed_);
+    }
+    ImGui::PopItemWidth();
+    
+    ImGui::Spacing();
+}
+
+void MainWindow::render_segment_mode() {
+    ImGui::Checkbox("Multi-Segment Mode", &segment_mode_);
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("Cut several ranges from one video");
+    }
+    
+    if (segment_mode_) {
+        render_segment_list();
+    }
+    
     ImGui::Spacing();
 }
 
+void MainWindow::render_segment_list() {
+    ImGui::PushItemWidth(200);
+    ImGui::InputText("Segment Name", segment_name_buffer_, sizeof(segment_name_buffer_));
+    ImGui::PopItemWidth();
+    ImGui::SameLine();
+    if (ImGui::Button("Add Segment")) {
+        TrimSegment segment(start_time_, end_time_, segment_name_buffer_);
+        std::string error_msg;
+        if (segment_manager_->validate_segment(segment, error_msg)) {
+            segment_manager_->add_segment(segment);
+            segment_name_buffer_[0] = '\0';
+        } else {
+            TRIMORA_LOG_ERROR(error_msg);
+        }
+    }
+    
+    ImGui::SameLine();
+    ImGui::Checkbox("Merge into one file", &merge_segments_);
+    
+    if (!segment_manager_->has_segments()) {
+        ImGui::TextDisabled("No segments yet - set a time range and click Add Segment");
+        return;
+    }
+    
+    if (segment_manager_->check_overlaps()) {
+        ImGui::TextColored(ImVec4(1.0f, 0.8f, 0.3f, 1.0f), "Warning: enabled segments overlap");
+    }
+    
+    ImGui::BeginChild("SegmentList", ImVec2(0, 120), true);
+    
+    int remove_index = -1;
+    int move_from = -1;
+    int move_to = -1;
+    
+    for (size_t i = 0; i < segment_manager_->get_segment_count(); ++i) {
+        TrimSegment segment = segment_manager_->get_segment(i);
+        ImGui::PushID(static_cast<int>(i));
+        
+        if (ImGui::Checkbox("##enabled", &segment.enabled)) {
+            segment_manager_->update_segment(i, segment);
+        }
+        ImGui::SameLine();
+        
+        std::string label = std::to_string(i + 1) + ". " +
+            (segment.name.empty() ? "Segment" : segment.name) + "  " +
+            segment.start_time + " - " + segment.end_time;
+        if (ImGui::Selectable(label.c_str(), selected_segment_index_ == static_cast<int>(i),
+                              0, ImVec2(ImGui::GetContentRegionAvail().x - 90, 0))) {
+            selected_segment_index_ = static_cast<int>(i);
+            std::strncpy(start_time_, segment.start_time.c_str(), sizeof(start_time_) - 1);
+            std::strncpy(end_time_, segment.end_time.c_str(), sizeof(end_time_) - 1);
+        }
+        
+        ImGui::SameLine();
+        if (ImGui::SmallButton("Up") && i > 0) {
+            move_from = static_cast<int>(i);
+            move_to = static_cast<int>(i) - 1;
+        }
+        ImGui::SameLine();
+        if (ImGui::SmallButton("Down") && i + 1 < segment_manager_->get_segment_count()) {
+            move_from = static_cast<int>(i);
+            move_to = static_cast<int>(i) + 1;
+        }
+        ImGui::SameLine();
+        if (ImGui::SmallButton("X")) {
+            remove_index = static_cast<int>(i);
+        }
+        
+        ImGui::PopID();
+    }
+    
+    ImGui::EndChild();
+    
+    if (speculative_extractor_ && merge_segments_) {
+        size_t enabled = std::count_if(segment_manager_->get_segments().begin(), segment_manager_->get_segments().end(),
+                                       [](const TrimSegment& segment) { return segment.enabled; });
+        ImGui::TextDisabled("%zu of %zu segment(s) prepared for export", 
+                            std::min(speculative_extractor_->ready_count(), enabled), enabled);
+    }
+    
+    // Apply structural edits after the loop
+    if (move_from >= 0) {
+        segment_manager_->move_segment(move_from, move_to);
+        selected_segment_index_ = -1;
+    }
+    if (remove_index >= 0) {
+        segment_manager_->remove_segment(remove_index);
+        selected_segment_index_ = -1;
+    }
+}
+
 void MainWindow::render_batch_mode() {
     ImGui::Checkbox("Batch Mode", &batch_mode_);
     ImGui::SameLine();
@@ -163,26 +614,217 @@ void MainWindow::render_batch_mode() {
         ImGui::SetTooltip("Trim multiple videos with the same time range");
     }
     
-    if (batch_mode_ && !batch_files_.empty()) {
+    if (batch_mode_ && !batch_jobs_.empty()) {
         ImGui::SameLine();
         ImGui::TextColored(ImVec4(0.3f, 1.0f, 0.3f, 1.0f), 
-            "(%zu files ready)", batch_files_.size());
+            "(%zu files ready)", count_batch_jobs(BatchJobStatus::Pending));
+    }
+    
+    if (batch_mode_) {
+        ImGui::Checkbox("Remux only (no trim)", &remux_only_);
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Copy all streams into another container over the full duration");
+        }
+        
+        if (remux_only_) {
+            ImGui::SameLine();
+            ImGui::PushItemWidth(100);
+            ImGui::Combo("Container", &remux_container_, kRemuxContainers, IM_ARRAYSIZE(kRemuxContainers));
+            ImGui::PopItemWidth();
+            ImGui::SameLine();
+            ImGui::Checkbox("Keep subtitles", &remux_keep_subtitles_);
+        }
     }
     
     ImGui::Spacing();
 }
 
+void MainWindow::render_batch_table() {
+    size_t selected = 0;
+    for (const auto& job : batch_jobs_) {
+        selected += job.selected ? 1 : 0;
+    }
+    
+    // Filter and bulk actions
+    ImGui::PushItemWidth(200);
+    if (ImGui::InputText("Filter##batch", batch_filter_, sizeof(batch_filter_))) {
+        batch_view_dirty_ = true;
+    }
+    ImGui::PopItemWidth();
+    
+    ImGui::SameLine();
+    ImGui::Text("%zu selected", selected);
+    
+    if (selected == 0) {
+        ImGui::BeginDisabled();
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Retry##batch")) {
+        retry_selected_jobs();
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Remove##batch")) {
+        remove_selected_jobs();
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Move to Front##batch")) {
+        move_selected_jobs(true);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Move to End##batch")) {
+        move_selected_jobs(false);
+    }
+    if (selected == 0) {
+        ImGui::EndDisabled();
+    }
+    
+    const ImGuiTableFlags flags = 
+        ImGuiTableFlags_Resizable | 
+        ImGuiTableFlags_Sortable | 
+        ImGuiTableFlags_RowBg | 
+        ImGuiTableFlags_BordersOuter | 
+        ImGuiTableFlags_BordersV | 
+        ImGuiTableFlags_ScrollY | 
+        ImGuiTableFlags_SizingFixedFit;
+    
+    if (!ImGui::BeginTable("BatchJobs", BatchColumn_Count, flags, ImVec2(0, 200))) {
+        return;
+    }
+    
+    ImGui::TableSetupScrollFreeze(0, 1);
+    ImGui::TableSetupColumn("#", ImGuiTableColumnFlags_DefaultSort, 0.0f, BatchColumn_Queue);
+    ImGui::TableSetupColumn("File", ImGuiTableColumnFlags_WidthStretch, 0.0f, BatchColumn_Name);
+    ImGui::TableSetupColumn("Status", ImGuiTableColumnFlags_None, 0.0f, BatchColumn_Status);
+    ImGui::TableSetupColumn("Duration", ImGuiTableColumnFlags_None, 0.0f, BatchColumn_Duration);
+    ImGui::TableSetupColumn("Size", ImGuiTableColumnFlags_None, 0.0f, BatchColumn_Size);
+    ImGui::TableSetupColumn("Progress", ImGuiTableColumnFlags_WidthFixed, 100.0f, BatchColumn_Progress);
+    ImGui::TableSetupColumn("Speed", ImGuiTableColumnFlags_None, 0.0f, BatchColumn_Speed);
+    ImGui::TableSetupColumn("Error", ImGuiTableColumnFlags_WidthStretch, 0.0f, BatchColumn_Error);
+    ImGui::TableHeadersRow();
+    
+    // Re-sort only when the sort order or the list changes, not every frame
+    if (ImGuiTableSortSpecs* sort_specs = ImGui::TableGetSortSpecs()) {
+        if (sort_specs->SpecsDirty) {
+            if (sort_specs->SpecsCount > 0) {
+                batch_sort_column_ = static_cast<int>(sort_specs->Specs[0].ColumnUserID);
+                batch_sort_ascending_ = sort_specs->Specs[0].SortDirection != ImGuiSortDirection_Descending;
+            }
+            batch_view_dirty_ = true;
+            sort_specs->SpecsDirty = false;
+        }
+    }
+    
+    if (batch_view_dirty_) {
+        rebuild_batch_view();
+    }
+    
+    // Only the visible rows are submitted
+    ImGuiListClipper clipper;
+    clipper.Begin(static_cast<int>(batch_view_.size()));
+    while (clipper.Step()) {
+        for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+            size_t index = batch_view_[row];
+            BatchJob& job = batch_jobs_[index];
+            
+            ImGui::PushID(static_cast<int>(job.id));
+            ImGui::TableNextRow();
+            
+            ImGui::TableNextColumn();
+            if (ImGui::Selectable("##row", job.selected, 
+                    ImGuiSelectableFlags_SpanAllColumns | ImGuiSelectableFlags_AllowOverlap)) {
+                const ImGuiIO& io = ImGui::GetIO();
+                if (io.KeyShift && batch_select_anchor_ >= 0) {
+                    if (!io.KeyCtrl) {
+                        for (auto& other : batch_jobs_) {
+                            other.selected = false;
+                        }
+                    }
+                    int first = std::min(batch_select_anchor_, row);
+                    int last = std::max(batch_select_anchor_, row);
+                    for (int r = first; r <= last; ++r) {
+                        batch_jobs_[batch_view_[r]].selected = true;
+                    }
+                } else if (io.KeyCtrl) {
+                    job.selected = !job.selected;
+                    batch_select_anchor_ = row;
+                } else {
+                    for (auto& other : batch_jobs_) {
+                        other.selected = false;
+                    }
+                    job.selected = true;
+                    batch_select_anchor_ = row;
+                }
+            }
+            ImGui::SameLine();
+            ImGui::Text("%zu", index + 1);
+            
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(job.name_label.c_str());
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("%s", job.input_file.c_str());
+            }
+            
+            ImGui::TableNextColumn();
+            switch (job.status) {
+                case BatchJobStatus::Running:
+                    ImGui::TextColored(ImVec4(1.0f, 0.8f, 0.2f, 1.0f), "%s", BatchJob::status_name(job.status));
+                    break;
+                case BatchJobStatus::Completed:
+                    ImGui::TextColored(ImVec4(0.3f, 1.0f, 0.3f, 1.0f), "%s", BatchJob::status_name(job.status));
+                    if (!job.digest_report.empty() && ImGui::IsItemHovered()) {
+                        ImGui::SetTooltip("%s", job.digest_report.c_str());
+                    }
+                    break;
+                case BatchJobStatus::Failed:
+                    ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "%s", BatchJob::status_name(job.status));
+                    break;
+                default:
+                    ImGui::TextUnformatted(BatchJob::status_name(job.status));
+                    break;
+            }
+            
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(job.duration_label.c_str());
+            
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(job.size_label.c_str());
+            
+            ImGui::TableNextColumn();
+            ImGui::ProgressBar(job.progress, ImVec2(-1, 0), job.progress_label.c_str());
+            
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(job.speed_label.c_str());
+            
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(job.error.c_str());
+            if (!job.error.empty() && ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("%s", job.error.c_str());
+            }
+            
+            ImGui::PopID();
+        }
+    }
+    
+    ImGui::EndTable();
+}
+
 void MainWindow::render_control_buttons() {
     bool can_trim = false;
     
-    if (!batch_mode_) {
+    if (segment_mode_ && !batch_mode_) {
         can_trim = ffmpeg_executor_->is_ffmpeg_available() && 
+                   !is_trimming_ && 
+                   strlen(input_file_) > 0 &&
+                   segment_manager_->has_segments();
+    } else if (!batch_mode_) {
+        // In-place trims don't run FFmpeg
+        can_trim = ((in_place_trim_ && !chunks_active()) || ffmpeg_executor_->is_ffmpeg_available()) && 
                    !is_trimming_ && 
                    strlen(input_file_) > 0;
     } else {
         can_trim = ffmpeg_executor_->is_ffmpeg_available() && 
                    !is_trimming_ && 
-                   !batch_files_.empty();
+                   count_batch_jobs(BatchJobStatus::Pending) > 0;
     }
     
     if (!can_trim) {
@@ -190,9 +832,21 @@ void MainWindow::render_control_buttons() {
     }
     
     if (batch_mode_) {
-        if (ImGui::Button("Trim All Videos", ImVec2(150, 30))) {
+        if (ImGui::Button(remux_only_ ? "Remux All Videos" : "Trim All Videos", ImVec2(150, 30))) {
             start_batch_trim();
         }
+    } else if (segment_mode_) {
+        if (ImGui::Button("Export Segments", ImVec2(150, 30))) {
+            start_segment_trim();
+        }
+    } else if (in_place_trim_ && !chunks_active()) {
+        if (ImGui::Button(in_place_dry_run_ ? "Dry Run" : "Trim In Place", ImVec2(120, 30))) {
+            if (in_place_dry_run_) {
+                start_in_place_trim();
+            } else {
+                ImGui::OpenPopup("Confirm in-place trim");
+            }
+        }
     } else {
         if (ImGui::Button("Trim Video", ImVec2(120, 30))) {
             start_trim();
@@ -203,6 +857,23 @@ void MainWindow::render_control_buttons() {
         ImGui::EndDisabled();
     }
     
+    if (ImGui::BeginPopupModal("Confirm in-place trim", nullptr, ImGuiWindowFlags_AlwaysAutoResize)) {
+        ImGui::Text("%s", input_file_);
+        ImGui::Text("will be cut to %s - %s (snapped to keyframes).", start_time_, end_time_);
+        ImGui::Text("The removed parts are gone for good.");
+        ImGui::Spacing();
+        if (ImGui::Button("Trim", ImVec2(120, 0))) {
+            ImGui::CloseCurrentPopup();
+            start_in_place_trim();
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Cancel", ImVec2(120, 0))) {
+            ImGui::CloseCurrentPopup();
+        }
+        ImGui::SetItemDefaultFocus();
+        ImGui::EndPopup();
+    }
+    
     ImGui::SameLine();
     
     if (!is_trimming_) {
@@ -234,6 +905,60 @@ void MainWindow::render_control_buttons() {
         ImGui::ProgressBar(current_progress_, ImVec2(-1, 0), progress_text);
     }
     
+    size_t uploads = upload_sink_ ? upload_sink_->active_uploads() : 0;
+    if (uploads > 0) {
+        ImGui::TextDisabled("Uploading %zu file(s) in the background", uploads);
+    }
+    
+    ImGui::Spacing();
+}
+
+void MainWindow::render_metadata_editor() {
+    if (!ImGui::CollapsingHeader("MP4 Metadata")) {
+        return;
+    }
+    
+    ImGui::TextWrapped("Fix rotation, title or recording date of exported MP4/MOV files. "
+                       "Only the header is rewritten; nothing is re-encoded. Source files are never changed.");
+    
+    ImGui::SetNextItemWidth(120);
+    ImGui::Combo("Rotation (degrees clockwise)", &metadata_rotation_, kRotationChoices, IM_ARRAYSIZE(kRotationChoices));
+    
+    ImGui::Checkbox("Set title", &metadata_set_title_);
+    if (metadata_set_title_) {
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(300);
+        ImGui::InputText("##metadata_title", metadata_title_, sizeof(metadata_title_));
+    }
+    
+    ImGui::Checkbox("Set creation date (UTC)", &metadata_set_date_);
+    if (metadata_set_date_) {
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(200);
+        ImGui::InputTextWithHint("##metadata_date", "YYYY-MM-DD HH:MM:SS", metadata_date_, sizeof(metadata_date_));
+    }
+    
+    // Files being written are open in FFmpeg; patch them once the run is over
+    bool can_patch = !patching_metadata_ && !is_trimming_ && !metadata_targets().empty();
+    if (!can_patch) {
+        ImGui::BeginDisabled();
+    }
+    if (ImGui::Button(batch_mode_ ? "Apply to Finished Files" : "Apply to Last Export", ImVec2(160, 0))) {
+        start_metadata_patch();
+    }
+    if (!can_patch) {
+        ImGui::EndDisabled();
+        if (!patching_metadata_ && !is_trimming_) {
+            ImGui::SameLine();
+            ImGui::TextDisabled(batch_mode_ ? "No finished batch outputs" : "Export a file first");
+        }
+    }
+    
+    if (patching_metadata_) {
+        ImGui::SameLine();
+        ImGui::Text("Patching %zu/%zu...", metadata_done_, metadata_total_);
+    }
+    
     ImGui::Spacing();
 }
 
@@ -242,9 +967,13 @@ void MainWindow::render_log_console() {
     
     ImGui::BeginChild("LogConsole", ImVec2(0, 150), true);
     
-    std::lock_guard<std::mutex> lock(log_mutex_);
-    for (const auto& msg : log_messages_) {
-        ImGui::TextUnformatted(msg.c_str());
+    // Only the visible lines are submitted
+    ImGuiListClipper clipper;
+    clipper.Begin(static_cast<int>(log_lines_.size()));
+    while (clipper.Step()) {
+        for (int line = clipper.DisplayStart; line < clipper.DisplayEnd; ++line) {
+            ImGui::TextUnformatted(log_lines_[line].c_str());
+        }
     }
     
     if (auto_scroll_log_ && ImGui::GetScrollY() >= ImGui::GetScrollMaxY()) {
@@ -254,13 +983,83 @@ void MainWindow::render_log_console() {
     ImGui::EndChild();
 }
 
-void MainWindow::render_recent_files() {
-    if (recent_files_.empty()) {
-        return;
-    }
+void MainWindow::render_performance_hud() {
+    auto& metrics = Metrics::instance();
+    
+    // Top-right overlay
+    const float padding = 10.0f;
+    ImVec2 display = ImGui::GetIO().DisplaySize;
+    ImGui::SetNextWindowPos(ImVec2(display.x - padding, padding + 20.0f), ImGuiCond_Always, ImVec2(1.0f, 0.0f));
+    ImGui::SetNextWindowBgAlpha(0.75f);
+    
+    ImGui::Begin("Performance", &show_performance_hud_,
+        ImGuiWindowFlags_NoDecoration |
+        ImGuiWindowFlags_AlwaysAutoResize |
+        ImGuiWindowFlags_NoSavedSettings |
+        ImGuiWindowFlags_NoFocusOnAppearing |
+        ImGuiWindowFlags_NoNav
+    );
     
-    ImGui::Spacing();
-    ImGui::Text("Recent Files:");
+    // UI frame time; the history is a ring buffer starting at the offset
+    const auto& history = metrics.get_frame_history();
+    float max_frame_ms = *std::max_element(history.begin(), history.end());
+    float frame_ms = metrics.get_last_frame_ms();
+    
+    ImGui::Text("Frame: %.2f ms (%.0f FPS)  UI build: %.2f ms",
+        frame_ms, frame_ms > 0 ? 1000.0f / frame_ms : 0.0f, metrics.get_last_render_ms());
+    
+    char overlay[32];
+    snprintf(overlay, sizeof(overlay), "max %.1f ms", max_frame_ms);
+    ImGui::PlotLines("##frame_times", history.data(), static_cast<int>(history.size()),
+        static_cast<int>(metrics.get_frame_history_offset()), overlay,
+        0.0f, std::max(33.3f, max_frame_ms * 1.2f), ImVec2(320, 50));
+    
+    if (video_player_) {
+        ImGui::Text("Player: render %.2f ms, dropped frames %lld",
+            metrics.get_player_render_ms(), static_cast<long long>(metrics.get_player_dropped_frames()));
+    }
+    
+    ImGui::Text("Batch queue: %zu pending  UI backlog: %d",
+        metrics.get_queue_depth(), metrics.get_ui_backlog());
+    
+    auto children = metrics.get_children();
+    ImGui::Text("FFmpeg processes: %zu", children.size());
+    if (!children.empty() && ImGui::BeginTable("HudChildren", 5, ImGuiTableFlags_SizingFixedFit | ImGuiTableFlags_RowBg)) {
+        ImGui::TableSetupColumn("PID");
+        ImGui::TableSetupColumn("Output");
+        ImGui::TableSetupColumn("CPU");
+        ImGui::TableSetupColumn("Write");
+        ImGui::TableSetupColumn("Speed");
+        ImGui::TableHeadersRow();
+        
+        for (const auto& child : children) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%d", static_cast<int>(child.pid));
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(child.label.c_str());
+            ImGui::TableNextColumn();
+            ImGui::Text("%.0f%%", child.cpu_percent);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f MB/s", child.write_mb_per_sec);
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(child.speed.c_str());
+        }
+        ImGui::EndTable();
+    }
+    
+    ImGui::Text("Memory: %.1f MB resident", metrics.get_resident_bytes() / (1024.0 * 1024.0));
+    
+    ImGui::End();
+}
+
+void MainWindow::render_recent_files() {
+    if (recent_files_.empty()) {
+        return;
+    }
+    
+    ImGui::Spacing();
+    ImGui::Text("Recent Files:");
     
     for (size_t i = 0; i < recent_files_.size() && i < 5; ++i) {
         if (ImGui::Selectable(recent_files_[i].c_str())) {
@@ -279,15 +1078,110 @@ void MainWindow::browse_input_file() {
         std::strncpy(input_file_, out_path, sizeof(input_file_) - 1);
         input_file_[sizeof(input_file_) - 1] = '\0';
         
-        std::lock_guard<std::mutex> lock(log_mutex_);
-        log_messages_.push_back("Selected: " + std::string(out_path));
+        TRIMORA_LOG_INFO("Selected: " + std::string(out_path));
         
         NFD_FreePath(out_path);
     } else if (result == NFD_CANCEL) {
         // User cancelled, do nothing
     } else {
-        std::lock_guard<std::mutex> lock(log_mutex_);
-        log_messages_.push_back("Error: " + std::string(NFD_GetError()));
+        TRIMORA_LOG_ERROR(std::string(NFD_GetError()));
+    }
+}
+
+void MainWindow::browse_input_chunks() {
+    const nfdpathset_t* path_set = nullptr;
+    nfdfilteritem_t filters[1] = {{"Video Files", "mp4,mkv,avi,mov,webm,ts,m2ts,mts"}};
+    
+    nfdresult_t result = NFD_OpenDialogMultiple(&path_set, filters, 1, nullptr);
+    
+    if (result == NFD_OKAY) {
+        nfdpathsetsize_t count = 0;
+        NFD_PathSet_GetCount(path_set, &count);
+        
+        std::vector<fs::path> files;
+        for (nfdpathsetsize_t i = 0; i < count; ++i) {
+            nfdchar_t* path = nullptr;
+            NFD_PathSet_GetPath(path_set, i, &path);
+            if (path) {
+                files.emplace_back(path);
+                NFD_PathSet_FreePath(path);
+            }
+        }
+        NFD_PathSet_Free(path_set);
+        
+        load_input_chunks(std::move(files));
+    } else if (result == NFD_CANCEL) {
+        // User cancelled
+    } else {
+        TRIMORA_LOG_ERROR(std::string(NFD_GetError()));
+    }
+}
+
+void MainWindow::load_input_chunks(std::vector<fs::path> files) {
+    if (files.empty()) {
+        return;
+    }
+    
+    // Dialogs return the selection in click order; recorders number chunks
+    ChunkSequence::sort_natural(files);
+    
+    uint64_t token = ++chunk_probe_token_;
+    input_chunks_ = ChunkSequence();
+    probing_chunks_.assign(files.size(), Chunk());
+    chunks_left_to_probe_ = files.size();
+    
+    // Durations place every chunk on the timeline; probed in parallel on
+    // the pre-flight pool, which also validates each file
+    for (size_t i = 0; i < files.size(); ++i) {
+        probing_chunks_[i].file = files[i];
+        
+        PreflightRequest request;
+        request.id = i;
+        request.input_file = files[i];
+        request.output_dir = fs::temp_directory_path();
+        request.naming_pattern = config_manager_.get_config().output_naming_pattern;
+        
+        preflight_->submit(std::move(request), [this, token](const PreflightResult& result) {
+            post_to_ui([this, token, result]() {
+                preflight_->release_name(result.output_file);
+                if (token != chunk_probe_token_) {
+                    return;
+                }
+                
+                if (!result.ok || result.duration_seconds <= 0) {
+                    ++chunk_probe_token_;
+                    chunks_left_to_probe_ = 0;
+                    TRIMORA_LOG_ERROR("Cannot use " + probing_chunks_[result.id].file.string() + " as a chunk: " +
+                        (result.ok ? std::string("duration unknown") : result.error_message));
+                    return;
+                }
+                
+                probing_chunks_[result.id].duration_seconds = result.duration_seconds;
+                if (--chunks_left_to_probe_ > 0) {
+                    return;
+                }
+                
+                input_chunks_ = ChunkSequence(std::move(probing_chunks_));
+                probing_chunks_.clear();
+                std::strncpy(input_file_, input_chunks_.chunks().front().file.string().c_str(), sizeof(input_file_) - 1);
+                player_file_.clear();  // Reload as one timeline
+                TRIMORA_LOG_INFO("Split recording: " + std::to_string(input_chunks_.size()) + " chunks, " +
+                    format_timestamp(input_chunks_.total_duration()) + " total");
+            });
+        });
+    }
+}
+
+bool MainWindow::chunks_active() const {
+    return !input_chunks_.empty() && input_chunks_.chunks().front().file == fs::path(input_file_);
+}
+
+void MainWindow::load_player_source() {
+    bool loaded = chunks_active()
+        ? video_player_->load_chunks(input_chunks_)
+        : video_player_->load_file(player_file_);
+    if (!loaded) {
+        TRIMORA_LOG_ERROR("Failed to load video: " + player_file_);
     }
 }
 
@@ -301,24 +1195,25 @@ void MainWindow::browse_input_files_batch() {
         nfdpathsetsize_t count = 0;
         NFD_PathSet_GetCount(path_set, &count);
         
+        std::vector<std::string> paths;
+        paths.reserve(count);
         for (nfdpathsetsize_t i = 0; i < count; ++i) {
             nfdchar_t* path = nullptr;
             NFD_PathSet_GetPath(path_set, i, &path);
             if (path) {
-                batch_files_.push_back(std::string(path));
+                paths.push_back(std::string(path));
                 NFD_PathSet_FreePath(path);
             }
         }
         
         NFD_PathSet_Free(path_set);
+        add_batch_files(paths);
         
-        std::lock_guard<std::mutex> lock(log_mutex_);
-        log_messages_.push_back("Added " + std::to_string(count) + " files to batch list.");
+        TRIMORA_LOG_INFO("Added " + std::to_string(count) + " files to batch list.");
     } else if (result == NFD_CANCEL) {
         // User cancelled, do nothing
     } else {
-        std::lock_guard<std::mutex> lock(log_mutex_);
-        log_messages_.push_back("Error: " + std::string(NFD_GetError()));
+        TRIMORA_LOG_ERROR(std::string(NFD_GetError()));
     }
 }
 
@@ -331,58 +1226,124 @@ void MainWindow::browse_output_directory() {
         std::strncpy(output_dir_, out_path, sizeof(output_dir_) - 1);
         output_dir_[sizeof(output_dir_) - 1] = '\0';
         
-        std::lock_guard<std::mutex> lock(log_mutex_);
-        log_messages_.push_back("Output directory: " + std::string(out_path));
+        TRIMORA_LOG_INFO("Output directory: " + std::string(out_path));
         
         NFD_FreePath(out_path);
     } else if (result == NFD_CANCEL) {
         // User cancelled, do nothing
     } else {
-        std::lock_guard<std::mutex> lock(log_mutex_);
-        log_messages_.push_back("Error: " + std::string(NFD_GetError()));
+        TRIMORA_LOG_ERROR(std::string(NFD_GetError()));
     }
 }
 
 void MainWindow::start_trim() {
     std::string error_msg;
     if (!validate_inputs(error_msg)) {
-        std::lock_guard<std::mutex> lock(log_mutex_);
-        log_messages_.push_back("Error: " + error_msg);
+        TRIMORA_LOG_ERROR(error_msg);
         return;
     }
     
     is_trimming_ = true;
     current_progress_ = 0.0f;
     
-    {
-        std::lock_guard<std::mutex> lock(log_mutex_);
-        log_messages_.push_back("Starting trim operation...");
+    TRIMORA_LOG_INFO("Checking input...");
+    
+    PreflightRequest request;
+    request.id = ++single_preflight_token_;
+    request.input_file = input_file_;
+    request.output_dir = output_dir_;
+    request.naming_pattern = config_manager_.get_config().output_naming_pattern;
+    request.probe_duration = false;  // FFmpeg reports it once running
+    
+    preflight_->submit(std::move(request), [this](const PreflightResult& result) {
+        post_to_ui([this, result]() {
+            // Stopped, or started again, while the check ran
+            if (!is_trimming_ || result.id != single_preflight_token_) {
+                preflight_->release_name(result.output_file);
+                return;
+            }
+            
+            if (!result.ok) {
+                is_trimming_ = false;
+                TRIMORA_LOG_ERROR(result.error_message);
+                return;
+            }
+            
+            TRIMORA_LOG_INFO("Starting trim operation...");
+            
+            // Build options
+            TrimOptions options;
+            options.input_file = input_file_;
+            options.output_file = result.output_file;
+            options.start_time = start_time_;
+            options.end_time = end_time_;
+            options.use_copy_codec = true;
+            options.reencode_audio = reencode_audio_;
+            if (chunks_active()) {
+                options.chunks = input_chunks_;
+            }
+            add_extra_outputs(options);
+            options.digests = output_digests_;
+            options.upload = upload_sink_;
+            
+            {
+                TRIMORA_LOG_INFO("Input: " + options.input_file.string());
+                TRIMORA_LOG_INFO("Output: " + options.output_file.string());
+                for (const auto& spec : options.additional_outputs) {
+                    TRIMORA_LOG_INFO("Output: " + spec.output_file.string());
+                }
+                TRIMORA_LOG_INFO("Time range: " + options.start_time + " to " + options.end_time);
+            }
+            
+            // Nothing else is named until this trim ends, and by then the
+            // file is on disk
+            preflight_->release_name(result.output_file);
+            
+            // Execute async
+            ffmpeg_executor_->execute_trim_async(
+                options,
+                [this](const FFmpegProgress& progress) {
+                    on_progress_update(progress);
+                },
+                [this, output = options.output_file](FFmpegStatus status, const std::string& message) {
+                    on_status_update(status, message, {output});
+                }
+            );
+        });
+    });
+}
+
+void MainWindow::start_in_place_trim() {
+    if (strlen(input_file_) == 0) {
+        TRIMORA_LOG_ERROR("Please select an input file");
+        return;
+    }
+    auto time_validation = Validator::validate_time_range(start_time_, end_time_);
+    if (!time_validation) {
+        TRIMORA_LOG_ERROR(time_validation.error_message);
+        return;
     }
     
-    // Build options
-    TrimOptions options;
-    options.input_file = input_file_;
+    // mpv would keep reading the old byte offsets; the player reloads the
+    // trimmed file the next time it is shown
+    if (!in_place_dry_run_ && video_player_ && player_file_ == input_file_) {
+        video_player_->stop();
+        player_file_.clear();
+    }
     
-    // Generate output filename
-    options.output_file = FileManager::generate_output_filename(
-        options.input_file,
-        output_dir_,
-        config_manager_.get_config().output_naming_pattern
-    );
+    is_trimming_ = true;
+    current_progress_ = 0.0f;
     
+    InPlaceTrimOptions options;
+    options.input_file = input_file_;
     options.start_time = start_time_;
     options.end_time = end_time_;
-    options.use_copy_codec = true;
+    options.dry_run = in_place_dry_run_;
     
-    {
-        std::lock_guard<std::mutex> lock(log_mutex_);
-        log_messages_.push_back("Input: " + options.input_file.string());
-        log_messages_.push_back("Output: " + options.output_file.string());
-        log_messages_.push_back("Time range: " + options.start_time + " to " + options.end_time);
-    }
+    TRIMORA_LOG_INFO(std::string(options.dry_run ? "Planning in-place trim of " : "Trimming in place: ") +
+                     options.input_file.string());
     
-    // Execute async
-    ffmpeg_executor_->execute_trim_async(
+    ffmpeg_executor_->execute_in_place_trim_async(
         options,
         [this](const FFmpegProgress& progress) {
             on_progress_update(progress);
@@ -393,117 +1354,686 @@ void MainWindow::start_trim() {
     );
 }
 
+void MainWindow::start_metadata_patch() {
+    Mp4MetadataEdit edit;
+    if (metadata_rotation_ > 0) {
+        edit.rotation = std::atoi(kRotationChoices[metadata_rotation_]);
+    }
+    if (metadata_set_title_) {
+        edit.title = std::string(metadata_title_);
+    }
+    if (metadata_set_date_) {
+        if (!Mp4MetadataEditor::parse_creation_time(metadata_date_)) {
+            TRIMORA_LOG_ERROR(std::string("Invalid creation date: ") + metadata_date_);
+            return;
+        }
+        edit.creation_time = std::string(metadata_date_);
+    }
+    if (edit.empty()) {
+        TRIMORA_LOG_ERROR("Choose a rotation, title or creation date to apply.");
+        return;
+    }
+    
+    std::vector<fs::path> files = metadata_targets();
+    if (files.empty()) {
+        TRIMORA_LOG_ERROR("No finished output to patch.");
+        return;
+    }
+    
+    // The player keeps reading the moov it loaded; reload after the patch
+    if (video_player_ && !player_file_.empty() &&
+        std::find(files.begin(), files.end(), fs::path(player_file_)) != files.end()) {
+        video_player_->stop();
+        player_file_.clear();
+    }
+    
+    if (metadata_thread_.joinable()) {
+        metadata_thread_.join();
+    }
+    patching_metadata_ = true;
+    metadata_done_ = 0;
+    metadata_total_ = files.size();
+    TRIMORA_LOG_INFO("Patching metadata of " + std::to_string(files.size()) + " file(s)");
+    
+    size_t worker_count = config_manager_.get_config().preflight_workers;
+    metadata_thread_ = std::thread([this, files = std::move(files), edit, worker_count]() {
+        auto results = Mp4MetadataEditor::apply_batch(files, edit, worker_count,
+            [this](const Mp4MetadataResult& result) {
+                if (result.ok) {
+                    TRIMORA_LOG_INFO("Metadata updated: " + result.file.filename().string() +
+                                     (result.method == Mp4MetadataResult::Method::Relocated ? " (header moved to end)" : ""));
+                } else {
+                    TRIMORA_LOG_ERROR("Metadata not updated: " + result.file.filename().string() +
+                                      ": " + result.error_message);
+                }
+                post_to_ui([this]() { ++metadata_done_; });
+            });
+        
+        size_t failed = std::count_if(results.begin(), results.end(),
+                                      [](const Mp4MetadataResult& result) { return !result.ok; });
+        post_to_ui([this, total = results.size(), failed]() {
+            patching_metadata_ = false;
+            TRIMORA_LOG_INFO("Metadata patch finished: " + std::to_string(total - failed) + " updated, " +
+                             std::to_string(failed) + " failed");
+        });
+    });
+}
+
+std::vector<fs::path> MainWindow::metadata_targets() const {
+    if (!batch_mode_) {
+        return last_export_outputs_;
+    }
+    std::vector<fs::path> files;
+    for (const auto& job : batch_jobs_) {
+        if (job.status == BatchJobStatus::Completed && !job.output_file.empty()) {
+            files.push_back(job.output_file);
+        }
+    }
+    return files;
+}
+
 void MainWindow::start_batch_trim() {
-    if (batch_files_.empty()) {
-        std::lock_guard<std::mutex> lock(log_mutex_);
-        log_messages_.push_back("Error: No files in batch list.");
+    if (batch_jobs_.empty()) {
+        TRIMORA_LOG_ERROR("No files in batch list.");
         return;
     }
     
-    // Validate time range
-    std::string error_msg;
-    auto time_validation = Validator::validate_time_range(start_time_, end_time_);
-    if (!time_validation) {
-        std::lock_guard<std::mutex> lock(log_mutex_);
-        log_messages_.push_back("Error: " + time_validation.error_message);
+    size_t pending = count_batch_jobs(BatchJobStatus::Pending);
+    if (pending == 0) {
+        TRIMORA_LOG_ERROR("No pending files in batch list. Select finished files and use Retry to queue them again.");
+        return;
+    }
+    
+    // Validate time range (remux copies the full duration)
+    if (!remux_only_) {
+        auto time_validation = Validator::validate_time_range(start_time_, end_time_);
+        if (!time_validation) {
+            TRIMORA_LOG_ERROR(time_validation.error_message);
+            return;
+        }
+    }
+    
+    if (strlen(output_dir_) == 0) {
+        TRIMORA_LOG_ERROR("Please select an output directory");
         return;
     }
     
     current_batch_index_ = 0;
-    total_batch_count_ = batch_files_.size();
+    total_batch_count_ = pending;
     is_trimming_ = true;
     current_progress_ = 0.0f;
     
-    {
-        std::lock_guard<std::mutex> lock(log_mutex_);
-        log_messages_.push_back("=== Starting batch trim of " + 
-            std::to_string(total_batch_count_) + " files ===");
+    // Check every queued input up front; errors show on their rows as
+    // results come in, and jobs start as soon as their own check passes
+    for (auto& job : batch_jobs_) {
+        if (job.status == BatchJobStatus::Pending) {
+            queue_preflight(job);
+        }
+    }
+    batch_view_dirty_ = true;
+    
+    // Stage upcoming inputs to local scratch when enabled
+    const auto& config = config_manager_.get_config();
+    if (config.stage_inputs) {
+        input_stager_ = std::make_unique<InputStager>(
+            config.staging_directory,
+            config.staging_max_file_mb * 1024 * 1024,
+            config.staging_bandwidth_limit_mbps * 1024 * 1024
+        );
+    } else {
+        input_stager_.reset();
     }
     
+    TRIMORA_LOG_INFO(std::string("=== Starting batch ") + (remux_only_ ? "remux" : "trim") +
+        " of " + std::to_string(total_batch_count_) + " files ===");
+    
     process_next_batch_file();
 }
 
+void MainWindow::start_segment_trim() {
+    std::string error_msg;
+    if (strlen(input_file_) == 0) {
+        error_msg = "Please select an input file";
+    } else if (strlen(output_dir_) == 0) {
+        error_msg = "Please select an output directory";
+    } else if (!segment_manager_->has_segments()) {
+        error_msg = "No segments defined";
+    }
+    
+    if (!error_msg.empty()) {
+        TRIMORA_LOG_ERROR(error_msg);
+        return;
+    }
+    
+    // Everything but the output name is fixed now; edits made while the
+    // input is checked apply to the next export
+    MultiSegmentTrimOptions options;
+    options.input_file = input_file_;
+    options.segments = segment_manager_->get_segments();
+    options.merge_segments = merge_segments_;
+    options.use_copy_codec = true;
+    options.reencode_audio = reencode_audio_;
+    if (chunks_active()) {
+        options.chunks = input_chunks_;
+    }
+    options.digests = output_digests_;
+    options.upload = upload_sink_;
+    options.piece_cache = segment_cache_;
+    
+    is_trimming_ = true;
+    current_progress_ = 0.0f;
+    
+    TRIMORA_LOG_INFO("Checking input...");
+    
+    PreflightRequest request;
+    request.id = ++single_preflight_token_;
+    request.input_file = input_file_;
+    request.output_dir = output_dir_;
+    request.naming_pattern = config_manager_.get_config().output_naming_pattern;
+    request.probe_duration = false;
+    
+    preflight_->submit(std::move(request), [this, options](const PreflightResult& result) {
+        post_to_ui([this, options, result]() mutable {
+            // Stopped, or started again, while the check ran
+            if (!is_trimming_ || result.id != single_preflight_token_) {
+                preflight_->release_name(result.output_file);
+                return;
+            }
+            
+            if (!result.ok) {
+                is_trimming_ = false;
+                TRIMORA_LOG_ERROR(result.error_message);
+                return;
+            }
+            
+            options.output_file = result.output_file;
+            TRIMORA_LOG_INFO("Exporting " + std::to_string(options.segments.size()) + 
+                " segment(s) " + (options.merge_segments ? "merged into " : "next to ") + 
+                options.output_file.string());
+            
+            std::vector<fs::path> outputs;
+            if (options.merge_segments) {
+                outputs.push_back(options.output_file);
+            } else {
+                for (size_t i = 0; i < options.segments.size(); ++i) {
+                    if (options.segments[i].enabled) {
+                        outputs.push_back(FFmpegExecutor::segment_output_file(options, i));
+                    }
+                }
+            }
+            
+            // As for a single trim, the name is on disk before it could
+            // be handed out again
+            preflight_->release_name(result.output_file);
+            
+            ffmpeg_executor_->execute_multi_segment_trim_async(
+                options,
+                [this](const FFmpegProgress& progress) {
+                    on_progress_update(progress);
+                },
+                [this, outputs = std::move(outputs)](FFmpegStatus status, const std::string& message) {
+                    on_status_update(status, message, outputs);
+                }
+            );
+        });
+    });
+}
+
 void MainWindow::process_next_batch_file() {
-    if (current_batch_index_ >= batch_files_.size()) {
+    BatchJob* job = next_pending_job();
+    
+    // Added or retried during the run: check it first
+    while (job && job->output_file.empty()) {
+        queue_preflight(*job);
+        job = next_pending_job();
+    }
+    
+    if (!job && count_batch_jobs(BatchJobStatus::Checking) > 0) {
+        // Picked up again when a check finishes
+        running_batch_job_id_ = 0;
+        return;
+    }
+    
+    if (!job) {
         // All done
         is_trimming_ = false;
+        running_batch_job_id_ = 0;
         current_batch_index_ = 0;
         total_batch_count_ = 0;
         
-        std::lock_guard<std::mutex> lock(log_mutex_);
-        log_messages_.push_back("=== Batch trim completed! ===");
+        if (input_stager_) {
+            input_stager_->clear();
+        }
+        
+        TRIMORA_LOG_INFO(std::string("=== Batch ") + (remux_only_ ? "remux" : "trim") + " completed! ===");
         return;
     }
     
     // Get current file
-    std::string current_file = batch_files_[current_batch_index_];
+    job->status = BatchJobStatus::Running;
+    job->refresh_labels();
+    running_batch_job_id_ = job->id;
+    update_queue_depth();
+    
+    uint64_t job_id = job->id;
+    TRIMORA_LOG_INFO("Processing file " + 
+        std::to_string(current_batch_index_ + 1) + "/" + 
+        std::to_string(total_batch_count_) + ": " + job->input_file.string());
+    
+    // Read from the staged copy if there is one; a copy still in flight
+    // starts the job when it is done, so the UI never waits for it
+    if (input_stager_) {
+        input_stager_->acquire(job->input_file, [this, job_id](const fs::path& input_path) {
+            post_to_ui([this, job_id, input_path]() {
+                start_batch_job(job_id, input_path);
+            });
+        });
+        return;
+    }
+    start_batch_job(job_id, job->input_file);
+}
+
+void MainWindow::start_batch_job(uint64_t job_id, const fs::path& input_path) {
+    // Stopped or removed while its input was being staged
+    BatchJob* job = find_batch_job(job_id);
+    if (!job || job->status != BatchJobStatus::Running || job_id != running_batch_job_id_) {
+        return;
+    }
     
-    {
-        std::lock_guard<std::mutex> lock(log_mutex_);
-        log_messages_.push_back("Processing file " + 
-            std::to_string(current_batch_index_ + 1) + "/" + 
-            std::to_string(total_batch_count_) + ": " + current_file);
+    std::string current_file = job->input_file.string();
+    fs::path output_file = job->output_file;
+    
+    // Next in queue order, for staging and prefetch
+    BatchJob* next_job = next_pending_job();
+    std::string next_file = next_job ? next_job->input_file.string() : std::string();
+    bool has_next = !next_file.empty();
+    
+    const auto& config = config_manager_.get_config();
+    
+    // Stage the next input while this job runs
+    if (input_stager_) {
+        if (input_path != fs::path(current_file)) {
+            TRIMORA_LOG_INFO("Reading staged copy: " + input_path.string());
+        }
+        
+        if (has_next) {
+            input_stager_->stage(next_file);
+        }
+    }
+    
+    auto on_progress = [this, job_id](const FFmpegProgress& progress) {
+        post_to_ui([this, job_id, progress]() {
+            on_progress_update(progress);
+            
+            BatchJob* job = find_batch_job(job_id);
+            if (!job || job->status != BatchJobStatus::Running) {
+                return;
+            }
+            if (progress.total_duration > 0 && progress.total_duration != job->duration_seconds) {
+                job->duration_seconds = progress.total_duration;
+                job->refresh_labels();
+            }
+            job->set_progress(static_cast<float>(progress.percentage / 100.0),
+                std::atof(progress.speed.c_str()));
+            if (!progress.output_digests.empty()) {
+                job->set_digests(progress.output_digests.front());
+            }
+        });
+    };
+    
+    auto on_status = [this, job_id, current_file](FFmpegStatus status, const std::string& message) {
+        post_to_ui([this, job_id, current_file, status, message]() {
+            if ((status == FFmpegStatus::Completed || status == FFmpegStatus::Failed) && input_stager_) {
+                input_stager_->release(current_file);
+            }
+            
+            if (status != FFmpegStatus::Completed && status != FFmpegStatus::Failed) {
+                on_status_update(status, message);
+                return;
+            }
+            
+            // Stopped or removed while FFmpeg was finishing
+            BatchJob* job = find_batch_job(job_id);
+            if (!job || job->status != BatchJobStatus::Running || job_id != running_batch_job_id_) {
+                return;
+            }
+            
+            if (status == FFmpegStatus::Completed) {
+                job->status = BatchJobStatus::Completed;
+                job->progress = 1.0f;
+                TRIMORA_LOG_INFO("✓ File " + 
+                    std::to_string(current_batch_index_ + 1) + " completed.");
+            } else {
+                job->status = BatchJobStatus::Failed;
+                job->error = message;
+                TRIMORA_LOG_WARNING("✗ File " + 
+                    std::to_string(current_batch_index_ + 1) + " failed: " + message);
+            }
+            job->refresh_labels();
+            preflight_->release_name(job->output_file);
+            
+            // Move to next file either way
+            current_batch_index_++;
+            process_next_batch_file();
+        });
+    };
+    
+    current_progress_ = 0.0f;
+    
+    if (remux_only_) {
+        RemuxOptions options;
+        options.input_file = input_path;
+        options.output_file = output_file;
+        options.keep_subtitles = remux_keep_subtitles_;
+        options.drop_behind = config.cache_drop_behind;
+        options.sync_before_drop = config.cache_sync_before_drop;
+        options.digests = output_digests_;
+        options.upload = upload_sink_;
+        
+        ffmpeg_executor_->execute_remux_async(options, on_progress, on_status);
+        return;
     }
     
     // Build options
     TrimOptions options;
-    options.input_file = current_file;
-    
-    // Generate output filename
-    options.output_file = FileManager::generate_output_filename(
-        options.input_file,
-        output_dir_,
-        config_manager_.get_config().output_naming_pattern
-    );
+    options.input_file = input_path;
     
+    options.output_file = output_file;
     options.start_time = start_time_;
     options.end_time = end_time_;
     options.use_copy_codec = true;
-    
-    current_progress_ = 0.0f;
+    options.reencode_audio = reencode_audio_;
+    add_extra_outputs(options);
+    options.drop_behind = config.cache_drop_behind;
+    options.sync_before_drop = config.cache_sync_before_drop;
+    options.digests = output_digests_;
+    options.upload = upload_sink_;
+    
+    // Without staging, at least warm the cache for the next input
+    if (!input_stager_ && has_next && config.cache_prefetch_next) {
+        TrimOptions next_options = options;
+        next_options.input_file = next_file;
+        ffmpeg_executor_->prefetch_input(next_options);
+    }
     
     // Execute async
-    ffmpeg_executor_->execute_trim_async(
-        options,
-        [this](const FFmpegProgress& progress) {
-            on_progress_update(progress);
-        },
-        [this](FFmpegStatus status, const std::string& message) {
-            if (status == FFmpegStatus::Completed) {
-                std::lock_guard<std::mutex> lock(log_mutex_);
-                log_messages_.push_back("✓ File " + 
-                    std::to_string(current_batch_index_ + 1) + " completed.");
-                
-                // Move to next file
-                current_batch_index_++;
-                process_next_batch_file();
-            } else if (status == FFmpegStatus::Failed) {
-                std::lock_guard<std::mutex> lock(log_mutex_);
-                log_messages_.push_back("✗ File " + 
-                    std::to_string(current_batch_index_ + 1) + " failed: " + message);
+    ffmpeg_executor_->execute_trim_async(options, on_progress, on_status);
+}
+
+void MainWindow::queue_preflight(BatchJob& job) {
+    preflight_->release_name(job.output_file);
+    job.status = BatchJobStatus::Checking;
+    job.output_file.clear();
+    job.refresh_labels();
+    
+    PreflightRequest request;
+    request.id = job.id;
+    request.input_file = job.input_file;
+    request.output_dir = output_dir_;
+    request.naming_pattern = config_manager_.get_config().output_naming_pattern;
+    if (remux_only_) {
+        request.extension = kRemuxContainers[remux_container_];
+    }
+    
+    preflight_->submit(std::move(request), [this](const PreflightResult& result) {
+        post_to_ui([this, result]() {
+            // Removed, or stopped and re-queued, while the check ran
+            BatchJob* job = find_batch_job(result.id);
+            if (!job || job->status != BatchJobStatus::Checking || !is_trimming_) {
+                preflight_->release_name(result.output_file);
+                return;
+            }
+            
+            if (result.ok) {
+                job->status = BatchJobStatus::Pending;
+                job->output_file = result.output_file;
+                job->duration_seconds = result.duration_seconds;
                 
-                // Move to next file anyway
+                // Trims only cover the selected range
+                auto start = Validator::timestamp_to_seconds(start_time_);
+                auto end = Validator::timestamp_to_seconds(end_time_);
+                if (!remux_only_ && start && end && result.duration_seconds > 0) {
+                    job->duration_seconds = std::max(0.0, std::min(*end, result.duration_seconds) - *start);
+                }
+            } else {
+                job->status = BatchJobStatus::Failed;
+                job->error = result.error_message;
+                TRIMORA_LOG_WARNING("✗ " + job->name_label + ": " + result.error_message);
                 current_batch_index_++;
+            }
+            job->refresh_labels();
+            batch_view_dirty_ = true;
+            update_queue_depth();
+            
+            if (running_batch_job_id_ == 0) {
                 process_next_batch_file();
-            } else {
-                on_status_update(status, message);
             }
+        });
+    });
+}
+
+void MainWindow::update_speculative_extraction() {
+    if (!speculative_extractor_) {
+        return;
+    }
+    
+    // Mirrors start_segment_trim(); anything else stops the speculation
+    MultiSegmentTrimOptions options;
+    if (segment_mode_ && !batch_mode_ && merge_segments_ && !is_trimming_) {
+        options.input_file = input_file_;
+        options.segments = segment_manager_->get_segments();
+        options.merge_segments = true;
+        options.use_copy_codec = true;
+        options.reencode_audio = reencode_audio_;
+        if (chunks_active()) {
+            options.chunks = input_chunks_;
         }
-    );
+        options.piece_cache = segment_cache_;
+    }
+    speculative_extractor_->update(options);
 }
 
 void MainWindow::stop_trim() {
     ffmpeg_executor_->cancel();
+    preflight_->cancel_pending();
     is_trimming_ = false;
+    ++single_preflight_token_;
+    
+    if (input_stager_) {
+        input_stager_->clear();
+    }
     
     // Reset batch state
-    if (batch_mode_) {
-        current_batch_index_ = 0;
-        total_batch_count_ = 0;
+    if (BatchJob* job = find_batch_job(running_batch_job_id_)) {
+        job->status = BatchJobStatus::Cancelled;
+        job->refresh_labels();
+    }
+    for (auto& job : batch_jobs_) {
+        if (job.status == BatchJobStatus::Checking) {
+            job.status = BatchJobStatus::Pending;
+            job.refresh_labels();
+        }
+    }
+    batch_view_dirty_ = true;
+    running_batch_job_id_ = 0;
+    current_batch_index_ = 0;
+    total_batch_count_ = 0;
+    
+    TRIMORA_LOG_WARNING("Trim operation cancelled.");
+}
+
+void MainWindow::add_batch_files(const std::vector<std::string>& paths) {
+    batch_jobs_.reserve(batch_jobs_.size() + paths.size());
+    
+    for (const auto& path : paths) {
+        BatchJob job;
+        if (!job.load(path, next_batch_job_id_++)) {
+            TRIMORA_LOG_WARNING("Could not read file size: " + path);
+        }
+        batch_jobs_.push_back(std::move(job));
+    }
+    
+    batch_view_dirty_ = true;
+    update_queue_depth();
+}
+
+BatchJob* MainWindow::find_batch_job(uint64_t job_id) {
+    for (auto& job : batch_jobs_) {
+        if (job.id == job_id) {
+            return &job;
+        }
+    }
+    return nullptr;
+}
+
+BatchJob* MainWindow::next_pending_job() {
+    for (auto& job : batch_jobs_) {
+        if (job.status == BatchJobStatus::Pending) {
+            return &job;
+        }
+    }
+    return nullptr;
+}
+
+void MainWindow::update_queue_depth() {
+    Metrics::instance().set_queue_depth(count_batch_jobs(BatchJobStatus::Pending));
+}
+
+size_t MainWindow::count_batch_jobs(BatchJobStatus status) const {
+    return static_cast<size_t>(std::count_if(batch_jobs_.begin(), batch_jobs_.end(),
+        [status](const BatchJob& job) { return job.status == status; }));
+}
+
+void MainWindow::retry_selected_jobs() {
+    size_t count = 0;
+    for (auto& job : batch_jobs_) {
+        if (job.selected && job.is_finished()) {
+            preflight_->release_name(job.output_file);
+            job.reset();
+            ++count;
+        }
+    }
+    
+    // Picked up by the running batch, if any
+    if (is_trimming_) {
+        total_batch_count_ += count;
+    }
+    
+    batch_view_dirty_ = true;
+    update_queue_depth();
+    TRIMORA_LOG_INFO("Queued " + std::to_string(count) + " file(s) for retry.");
+}
+
+void MainWindow::remove_selected_jobs() {
+    size_t removed = 0;
+    size_t removed_pending = 0;
+    
+    // The running job stays; stop the batch to remove it
+    std::erase_if(batch_jobs_, [&](const BatchJob& job) {
+        if (!job.selected || job.status == BatchJobStatus::Running) {
+            return false;
+        }
+        ++removed;
+        removed_pending += job.status == BatchJobStatus::Pending ||
+                           job.status == BatchJobStatus::Checking ? 1 : 0;
+        preflight_->release_name(job.output_file);
+        return true;
+    });
+    
+    if (is_trimming_) {
+        total_batch_count_ -= removed_pending;
+    }
+    
+    batch_view_dirty_ = true;
+    update_queue_depth();
+    TRIMORA_LOG_INFO("Removed " + std::to_string(removed) + " file(s) from batch list.");
+}
+
+void MainWindow::move_selected_jobs(bool to_front) {
+    // Queue order is the processing order; keep relative order within each group
+    std::stable_partition(batch_jobs_.begin(), batch_jobs_.end(),
+        [to_front](const BatchJob& job) { return job.selected == to_front; });
+    batch_view_dirty_ = true;
+}
+
+void MainWindow::rebuild_batch_view() {
+    std::string_view filter = batch_filter_;
+    
+    batch_view_.clear();
+    batch_view_.reserve(batch_jobs_.size());
+    for (size_t i = 0; i < batch_jobs_.size(); ++i) {
+        const auto& job = batch_jobs_[i];
+        if (filter.empty() ||
+            contains_ignore_case(job.name_label, filter) ||
+            contains_ignore_case(BatchJob::status_name(job.status), filter) ||
+            contains_ignore_case(job.error, filter)) {
+            batch_view_.push_back(i);
+        }
+    }
+    
+    auto less = [this](size_t a, size_t b) {
+        const auto& lhs = batch_jobs_[a];
+        const auto& rhs = batch_jobs_[b];
+        switch (batch_sort_column_) {
+            case BatchColumn_Name: return lhs.name_label < rhs.name_label;
+            case BatchColumn_Status: return lhs.status < rhs.status;
+            case BatchColumn_Duration: return lhs.duration_seconds < rhs.duration_seconds;
+            case BatchColumn_Size: return lhs.size_bytes < rhs.size_bytes;
+            case BatchColumn_Progress: return lhs.progress < rhs.progress;
+            case BatchColumn_Speed: return lhs.speed < rhs.speed;
+            case BatchColumn_Error: return lhs.error < rhs.error;
+            default: return a < b;
+        }
+    };
+    
+    if (batch_sort_ascending_) {
+        std::stable_sort(batch_view_.begin(), batch_view_.end(), less);
+    } else {
+        std::stable_sort(batch_view_.begin(), batch_view_.end(),
+            [&less](size_t a, size_t b) { return less(b, a); });
+    }
+    
+    batch_select_anchor_ = -1;
+    batch_view_dirty_ = false;
+}
+
+void MainWindow::post_to_ui(std::function<void()> task) {
+    std::lock_guard<std::mutex> lock(ui_tasks_mutex_);
+    ui_tasks_.push_back(std::move(task));
+    Metrics::instance().add_ui_backlog(1);
+}
+
+void MainWindow::run_ui_tasks() {
+    std::vector<std::function<void()>> tasks;
+    {
+        std::lock_guard<std::mutex> lock(ui_tasks_mutex_);
+        tasks.swap(ui_tasks_);
     }
+    Metrics::instance().add_ui_backlog(-static_cast<int>(tasks.size()));
     
-    std::lock_guard<std::mutex> lock(log_mutex_);
-    log_messages_.push_back("Trim operation cancelled.");
+    for (auto& task : tasks) {
+        task();
+    }
+}
+
+void MainWindow::drain_log() {
+    std::vector<PendingLogLine> pending;
+    {
+        std::lock_guard<std::mutex> lock(log_mutex_);
+        pending.swap(pending_log_);
+    }
+    
+    for (auto& line : pending) {
+        if (line.progress && !line.milestone && last_log_is_progress_ && !log_lines_.empty()) {
+            log_lines_.back() = std::move(line.text);
+        } else {
+            log_lines_.push_back(std::move(line.text));
+        }
+        last_log_is_progress_ = line.progress;
+    }
+    while (log_lines_.size() > kMaxLogLines) {
+        log_lines_.pop_front();
+    }
 }
 
 void MainWindow::on_progress_update(const FFmpegProgress& progress) {
@@ -511,8 +2041,6 @@ void MainWindow::on_progress_update(const FFmpegProgress& progress) {
     
     // Log progress updates
     if (!progress.current_time.empty() || progress.percentage > 0) {
-        std::lock_guard<std::mutex> lock(log_mutex_);
-        
         std::ostringstream msg;
         msg << "Progress: " << std::fixed << std::setprecision(1) << progress.percentage << "%";
         
@@ -522,41 +2050,43 @@ void MainWindow::on_progress_update(const FFmpegProgress& progress) {
         if (!progress.speed.empty()) {
             msg << " | Speed: " << progress.speed;
         }
-        
-        // Only add if it's a significant update (avoid spam)
-        if (log_messages_.empty() || 
-            log_messages_.back().find("Progress:") == std::string::npos ||
-            static_cast<int>(progress.percentage) % 10 == 0) {
-            log_messages_.push_back(msg.str());
-        } else {
-            // Replace last progress message
-            if (!log_messages_.empty() && log_messages_.back().find("Progress:") != std::string::npos) {
-                log_messages_.back() = msg.str();
+        if (progress.output_bytes.size() > 1) {
+            msg << " | Written:";
+            for (size_t bytes : progress.output_bytes) {
+                msg << " " << std::setprecision(1) << (bytes / (1024.0 * 1024.0)) << " MB";
             }
         }
+        
+        // Only every tenth percent stays; the rest replace each other
+        std::lock_guard<std::mutex> lock(log_mutex_);
+        pending_log_.push_back({msg.str(), true, static_cast<int>(progress.percentage) % 10 == 0});
     }
 }
 
-void MainWindow::on_status_update(FFmpegStatus status, const std::string& message) {
-    std::lock_guard<std::mutex> lock(log_mutex_);
-    
+void MainWindow::on_status_update(FFmpegStatus status, const std::string& message,
+                                  std::vector<fs::path> outputs) {
     switch (status) {
         case FFmpegStatus::Running:
-            log_messages_.push_back("Status: Running - " + message);
+            TRIMORA_LOG_INFO("Status: Running - " + message);
             break;
         case FFmpegStatus::Completed:
-            log_messages_.push_back("Success: " + message);
+            TRIMORA_LOG_INFO("Success: " + message);
             is_trimming_ = false;
             current_progress_ = 1.0f;
             FileManager::add_recent_file(input_file_);
+            if (!outputs.empty()) {
+                post_to_ui([this, outputs = std::move(outputs)]() mutable {
+                    last_export_outputs_ = std::move(outputs);
+                });
+            }
             break;
         case FFmpegStatus::Failed:
-            log_messages_.push_back("Error: " + message);
+            TRIMORA_LOG_ERROR(message);
             is_trimming_ = false;
             current_progress_ = 0.0f;
             break;
         case FFmpegStatus::Cancelled:
-            log_messages_.push_back("Cancelled: " + message);
+            TRIMORA_LOG_WARNING("Cancelled: " + message);
             is_trimming_ = false;
             current_progress_ = 0.0f;
             break;
@@ -565,6 +2095,38 @@ void MainWindow::on_status_update(FFmpegStatus status, const std::string& messag
     }
 }
 
+std::string MainWindow::format_timestamp(double seconds) {
+    if (seconds < 0) {
+        seconds = 0;
+    }
+    
+    auto total_ms = static_cast<long long>(seconds * 1000.0 + 0.5);
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%02lld:%02lld:%02lld.%03lld",
+        total_ms / 3600000, (total_ms / 60000) % 60, (total_ms / 1000) % 60, total_ms % 1000);
+    return buffer;
+}
+
+void MainWindow::add_extra_outputs(TrimOptions& options) const {
+    auto stem = options.output_file.stem().string();
+    auto dir = options.output_file.parent_path();
+    
+    if (extra_output_720p_) {
+        OutputSpec spec;
+        spec.output_file = dir / (stem + "_720p.mp4");
+        spec.kind = OutputSpec::Kind::VideoEncode;
+        spec.max_height = 720;
+        options.additional_outputs.push_back(spec);
+    }
+    
+    if (extra_output_audio_) {
+        OutputSpec spec;
+        spec.output_file = dir / (stem + "_audio.m4a");
+        spec.kind = OutputSpec::Kind::AudioOnly;
+        options.additional_outputs.push_back(spec);
+    }
+}
+
 bool MainWindow::validate_inputs(std::string& error_message) {
     // Validate input file
     if (strlen(input_file_) == 0) {
@@ -572,11 +2134,7 @@ bool MainWindow::validate_inputs(std::string& error_message) {
         return false;
     }
     
-    auto input_validation = Validator::validate_input_file(input_file_);
-    if (!input_validation) {
-        error_message = input_validation.error_message;
-        return false;
-    }
+    // The input itself is checked by pre-flight, off the UI thread
     
     // Validate output directory
     if (strlen(output_dir_) == 0) {
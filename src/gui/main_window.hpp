@@ -4,10 +4,20 @@
 #include "../config_manager.hpp"
 #include "../video_player.hpp"
 #include "../trim_segment.hpp"
+#include "../input_stager.hpp"
+#include "../preflight.hpp"
+#include "../mp4_metadata.hpp"
+#include "../upload_sink.hpp"
+#include "../segment_cache.hpp"
+#include "../speculative_extractor.hpp"
+#include "batch_job.hpp"
 #include <string>
 #include <memory>
 #include <vector>
+#include <deque>
 #include <mutex>
+#include <thread>
+#include <functional>
 
 namespace trimora {
 
@@ -20,37 +30,76 @@ public:
     void render();
 
 private:
+    friend struct UiBenchAccess;  // bench/ui_bench.cpp seeds synthetic state
+    
     void render_input_section();
     void render_video_player();
     void render_time_inputs();
     void render_segment_mode();
     void render_segment_list();
     void render_batch_mode();
+    void render_batch_table();
     void render_control_buttons();
+    void render_metadata_editor();
     void render_log_console();
     void render_recent_files();
+    void render_performance_hud();
 
     // Actions
     void browse_input_file();
     void browse_input_files_batch();
+    void browse_input_chunks();
+    void load_input_chunks(std::vector<std::filesystem::path> files);
+    bool chunks_active() const;
+    void load_player_source();
     void browse_output_directory();
     void start_trim();
+    void start_in_place_trim();
     void start_batch_trim();
     void start_segment_trim();
     void process_next_batch_file();
+    void start_batch_job(uint64_t job_id, const std::filesystem::path& input_path);  // Once its input is staged
+    void queue_preflight(BatchJob& job);
     void stop_trim();
+    void update_speculative_extraction();
+    void start_metadata_patch();
+    // Finished export outputs the metadata editor applies to
+    std::vector<std::filesystem::path> metadata_targets() const;
+    
+    // Batch list
+    void add_batch_files(const std::vector<std::string>& paths);
+    BatchJob* find_batch_job(uint64_t job_id);
+    BatchJob* next_pending_job();
+    size_t count_batch_jobs(BatchJobStatus status) const;
+    void update_queue_depth();
+    void retry_selected_jobs();
+    void remove_selected_jobs();
+    void move_selected_jobs(bool to_front);
+    void rebuild_batch_view();
+    
+    // Worker callbacks hand UI state changes to the render thread
+    void post_to_ui(std::function<void()> task);
+    void run_ui_tasks();
+    void drain_log();
 
     // Callbacks
     void on_progress_update(const FFmpegProgress& progress);
-    void on_status_update(FFmpegStatus status, const std::string& message);
+    // outputs are the files a completed export wrote, remembered for the
+    // metadata editor
+    void on_status_update(FFmpegStatus status, const std::string& message,
+                          std::vector<std::filesystem::path> outputs = {});
 
     // Validation
     bool validate_inputs(std::string& error_message);
 
+    static std::string format_timestamp(double seconds);
+    void add_extra_outputs(TrimOptions& options) const;
+
     ConfigManager& config_manager_;
     std::unique_ptr<FFmpegExecutor> ffmpeg_executor_;
     std::unique_ptr<VideoPlayer> video_player_;
     std::unique_ptr<SegmentManager> segment_manager_;
+    std::unique_ptr<Preflight> preflight_;
 
     // UI state
     char input_file_[512] = "";
@@ -59,13 +108,58 @@ private:
     char end_time_[32] = "00:00:00.000";
     
     bool is_trimming_ = false;
+    uint64_t single_preflight_token_ = 0;  // Bumped to discard a stale single-file check
     float current_progress_ = 0.0f;
     
+    // Extra deliverables rendered in the same pass as the trim
+    bool extra_output_720p_ = false;
+    bool extra_output_audio_ = false;
+    bool reencode_audio_ = false;  // Copy video, encode audio with fades at the cuts
+    std::vector<DigestAlgorithm> output_digests_;  // From the config, checked once at startup
+    std::shared_ptr<UploadSink> upload_sink_;      // Set when uploads are enabled and configured
+    std::shared_ptr<SegmentCache> segment_cache_;  // Set when merge pieces are kept between exports
+    std::unique_ptr<SpeculativeExtractor> speculative_extractor_;  // Fills segment_cache_ while segments are edited
+    
+    // Split recording picked as the input: one timeline over all chunks.
+    // Only used while the input field still names its first chunk.
+    ChunkSequence input_chunks_;
+    std::vector<Chunk> probing_chunks_;
+    size_t chunks_left_to_probe_ = 0;
+    uint64_t chunk_probe_token_ = 0;  // Bumped to discard a stale probe
+    
+    // Single-file trims can cut the input itself instead of writing a copy
+    bool in_place_trim_ = false;
+    bool in_place_dry_run_ = true;
+    
     // Batch mode
     bool batch_mode_ = false;
-    std::vector<std::string> batch_files_;
-    size_t current_batch_index_ = 0;
-    size_t total_batch_count_ = 0;
+    std::vector<BatchJob> batch_jobs_;       // Queue order
+    uint64_t next_batch_job_id_ = 1;
+    uint64_t running_batch_job_id_ = 0;      // 0 when idle
+    size_t current_batch_index_ = 0;         // Jobs finished in this run
+    size_t total_batch_count_ = 0;           // Jobs queued when the run started
+    std::vector<size_t> batch_view_;         // Filtered, sorted indices into batch_jobs_
+    bool batch_view_dirty_ = true;
+    int batch_sort_column_ = 0;
+    bool batch_sort_ascending_ = true;
+    int batch_select_anchor_ = -1;           // Row in batch_view_ for shift-click
+    char batch_filter_[128] = "";
+    std::unique_ptr<InputStager> input_stager_;  // Only set when staging is enabled
+    bool remux_only_ = false;  // Container conversion instead of trimming
+    int remux_container_ = 0;
+    bool remux_keep_subtitles_ = true;
+    
+    // MP4 metadata fixes on finished files, patched without remuxing
+    int metadata_rotation_ = 0;  // Index into the rotation choices, 0 keeps it
+    bool metadata_set_title_ = false;
+    char metadata_title_[256] = "";
+    bool metadata_set_date_ = false;
+    char metadata_date_[32] = "";
+    bool patching_metadata_ = false;
+    size_t metadata_done_ = 0;
+    size_t metadata_total_ = 0;
+    std::thread metadata_thread_;
+    std::vector<std::filesystem::path> last_export_outputs_;
     
     // Multi-segment mode
     bool segment_mode_ = false;
@@ -78,12 +172,27 @@ private:
     float player_volume_ = 100.0f;
     float player_speed_ = 1.0f;
     float seek_position_ = 0.0f;
+    std::string player_file_;  // File currently loaded in the player
     
-    // Log buffer
-    std::vector<std::string> log_messages_;
+    // Log buffer: workers and the log sink append to pending_log_, the
+    // render thread moves it into log_lines_ once per frame
+    struct PendingLogLine {
+        std::string text;
+        bool progress = false;   // Replaces a progress line before it
+        bool milestone = false;  // Every tenth percent stays in the log
+    };
+    std::deque<std::string> log_lines_;
+    std::vector<PendingLogLine> pending_log_;
     std::mutex log_mutex_;
+    bool last_log_is_progress_ = false;
+    int console_sink_id_ = 0;
+    
+    std::vector<std::function<void()>> ui_tasks_;
+    std::mutex ui_tasks_mutex_;
     bool auto_scroll_log_ = true;
     
+    bool show_performance_hud_ = false;
+    
     // Recent files
     std::vector<std::string> recent_files_;
 };
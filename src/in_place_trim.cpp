@@ -0,0 +1,290 @@
+#include "in_place_trim.hpp"
+#include "native_cut.hpp"
+#include "ts_cutter.hpp"
+#include "fmp4_cutter.hpp"
+#include "mkv_cutter.hpp"
+#include "scoped_fd.hpp"
+#include <iomanip>
+#include <sstream>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#ifdef __linux__
+#include <linux/falloc.h>
+#include <sys/vfs.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace trimora {
+
+namespace {
+
+// Padding allowed on top of the smallest header to reach a block boundary;
+// transport streams need up to 47 blocks to line up with 188-byte packets
+constexpr uint64_t kMaxHeaderPadding = 1024 * 1024;
+
+#ifdef __linux__
+constexpr long kExt4Magic = 0xEF53;
+constexpr long kXfsMagic = 0x58465342;
+#endif
+
+// Filesystems known to implement FALLOC_FL_COLLAPSE_RANGE
+bool supports_collapse_range(const fs::path& file) {
+#ifdef __linux__
+    struct statfs sfs {};
+    if (::statfs(file.c_str(), &sfs) != 0) {
+        return false;
+    }
+    return sfs.f_type == kExt4Magic || sfs.f_type == kXfsMagic;
+#else
+    (void)file;
+    return false;
+#endif
+}
+
+int64_t mtime_ns(const struct stat& st) {
+    return static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+}
+
+bool pwrite_all(int fd, const uint8_t* data, size_t size, uint64_t offset) {
+    while (size > 0) {
+        ssize_t n = ::pwrite(fd, data, size, static_cast<off_t>(offset));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+        offset += static_cast<uint64_t>(n);
+    }
+    return true;
+}
+
+bool pread_all(int fd, uint8_t* data, size_t size, uint64_t offset) {
+    while (size > 0) {
+        ssize_t n = ::pread(fd, data, size, static_cast<off_t>(offset));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+        offset += static_cast<uint64_t>(n);
+    }
+    return true;
+}
+
+// Whether the file already begins with bytes
+bool starts_with(const fs::path& file, const std::vector<uint8_t>& bytes) {
+    if (bytes.empty()) {
+        return true;
+    }
+    ScopedFd fd(::open(file.c_str(), O_RDONLY | O_CLOEXEC));
+    std::vector<uint8_t> head(bytes.size());
+    return fd && pread_all(fd.get(), head.data(), head.size(), 0) && head == bytes;
+}
+
+std::string errno_string(const std::string& what) {
+    return what + ": " + std::strerror(errno);
+}
+
+} // namespace
+
+bool InPlaceTrimmer::is_supported(const fs::path& path) {
+    return TsCutter::is_transport_stream(path) ||
+           Fmp4Cutter::is_fragmented_mp4(path) ||
+           MkvCutter::is_matroska(path);
+}
+
+InPlaceTrimPlan InPlaceTrimmer::plan(const fs::path& file, double start_seconds, double end_seconds) {
+    InPlaceTrimPlan plan;
+    plan.file = file;
+
+    // Safety checks: the file is modified directly, so it must be ours alone
+    struct stat st {};
+    if (::lstat(file.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) {
+        plan.error_message = "Not a regular file: " + file.string();
+        return plan;
+    }
+    if (st.st_nlink > 1) {
+        plan.error_message = "File has other hard links; trimming it would change them too";
+        return plan;
+    }
+    if (::access(file.c_str(), W_OK) != 0) {
+        plan.error_message = "File is not writable";
+        return plan;
+    }
+    plan.original_size = static_cast<uint64_t>(st.st_size);
+    plan.original_mtime_ns = mtime_ns(st);
+
+    NativeCutPlan cut;
+    std::string format;
+    if (TsCutter::is_transport_stream(file)) {
+        cut = TsCutter::plan(file, start_seconds, end_seconds);
+        format = "transport stream";
+    } else if (Fmp4Cutter::is_fragmented_mp4(file)) {
+        cut = Fmp4Cutter::plan(file, start_seconds, end_seconds);
+        format = "fragmented MP4";
+    } else if (MkvCutter::is_matroska(file)) {
+        cut = MkvCutter::plan(file, start_seconds, end_seconds);
+        format = "Matroska";
+    } else {
+        plan.error_message = "In-place trim supports MPEG-TS, fragmented MP4 and Matroska only";
+        return plan;
+    }
+    if (!cut.ok) {
+        plan.error_message = cut.error_message;
+        return plan;
+    }
+
+    plan.start_seconds = cut.start_seconds;
+    plan.end_seconds = cut.end_seconds;
+    plan.truncate_at = cut.range_offset + cut.range_length;
+
+    // Head. A stream that starts where the file does keeps its own header.
+    // Otherwise the header goes right in front of the kept range, starting
+    // on the last block boundary that leaves room for it.
+    uint64_t range_offset = cut.range_offset;
+    if (range_offset > 0) {
+        uint64_t block = static_cast<uint64_t>(st.st_blksize > 0 ? st.st_blksize : 4096);
+        bool can_collapse = supports_collapse_range(file);
+
+        // Smaller than the minimum is still worth a try: Matroska can leave
+        // out its cues to fit where the old header was
+        uint64_t largest = can_collapse && range_offset > cut.min_prefix_size
+            ? (range_offset - cut.min_prefix_size) / block * block
+            : 0;
+        for (uint64_t offset = largest;; offset -= block) {
+            uint64_t size = range_offset - offset;
+            if (size > cut.min_prefix_size + kMaxHeaderPadding) {
+                break;
+            }
+            plan.header = cut.build_prefix(size);
+            if (!plan.header.empty()) {
+                plan.collapse_offset = offset;
+                break;
+            }
+            if (offset == 0) {
+                break;
+            }
+        }
+
+        if (plan.header.empty()) {
+            plan.error_message = can_collapse
+                ? "The rebuilt " + format + " header does not fit in front of the kept range"
+                : "Trimming the start in place needs a filesystem with collapse-range support (ext4 or XFS)";
+            return plan;
+        }
+    }
+
+    // A head that fits its rebuilt header is trimmed without shrinking the
+    // file (the dropped bytes become header padding), so only an unchanged
+    // header means there is nothing to do
+    plan.final_size = plan.truncate_at - plan.collapse_offset;
+    if (plan.final_size >= plan.original_size && starts_with(file, plan.header)) {
+        plan.error_message = "Nothing to trim: the cut points are the start and end of the file";
+        return plan;
+    }
+
+    std::ostringstream step;
+    step << std::fixed << std::setprecision(3) << "Keep " << format << " " << plan.start_seconds << "s - ";
+    if (plan.end_seconds > 0.0) {
+        step << plan.end_seconds << "s";
+    } else {
+        step << "end";
+    }
+    step << " (bytes " << cut.range_offset << "-" << plan.truncate_at << " of " << plan.original_size << ")";
+    plan.steps.push_back(step.str());
+
+    if (!plan.header.empty()) {
+        plan.steps.push_back("Write " + std::to_string(plan.header.size()) + "-byte header at offset " +
+                             std::to_string(plan.collapse_offset));
+    }
+    if (plan.collapse_offset > 0) {
+        plan.steps.push_back("Collapse the first " + std::to_string(plan.collapse_offset) + " bytes");
+    }
+    if (plan.truncate_at < plan.original_size) {
+        plan.steps.push_back("Truncate to " + std::to_string(plan.final_size) + " bytes");
+    }
+
+    plan.ok = true;
+    return plan;
+}
+
+bool InPlaceTrimmer::apply(const InPlaceTrimPlan& plan, std::string& error_message) {
+    if (!plan.ok) {
+        error_message = plan.error_message;
+        return false;
+    }
+
+    ScopedFd fd(::open(plan.file.c_str(), O_RDWR | O_CLOEXEC | O_NOFOLLOW));
+    if (!fd) {
+        error_message = errno_string("Cannot open " + plan.file.string());
+        return false;
+    }
+
+    // Players and other trimora instances holding a lock keep the file as is
+    if (::flock(fd.get(), LOCK_EX | LOCK_NB) != 0) {
+        error_message = "File is locked by another process";
+        return false;
+    }
+
+    struct stat st {};
+    if (::fstat(fd.get(), &st) != 0 || static_cast<uint64_t>(st.st_size) != plan.original_size ||
+        mtime_ns(st) != plan.original_mtime_ns) {
+        error_message = "File changed since the trim was planned";
+        return false;
+    }
+
+    // The header lands in bytes that are about to be collapsed away or that
+    // held the old header, so the source stream is never touched. Keep the
+    // old bytes in case the collapse is refused.
+    std::vector<uint8_t> saved(plan.header.size());
+    if (!plan.header.empty()) {
+        if (!pread_all(fd.get(), saved.data(), saved.size(), plan.collapse_offset)) {
+            error_message = errno_string("Cannot read header area");
+            return false;
+        }
+        if (!pwrite_all(fd.get(), plan.header.data(), plan.header.size(), plan.collapse_offset) ||
+            ::fdatasync(fd.get()) != 0) {
+            error_message = errno_string("Cannot write header");
+            pwrite_all(fd.get(), saved.data(), saved.size(), plan.collapse_offset);
+            return false;
+        }
+    }
+
+    if (plan.collapse_offset > 0) {
+#ifdef __linux__
+        int rc = ::fallocate(fd.get(), FALLOC_FL_COLLAPSE_RANGE, 0, static_cast<off_t>(plan.collapse_offset));
+#else
+        int rc = -1;
+        errno = EOPNOTSUPP;
+#endif
+        if (rc != 0) {
+            error_message = errno_string("Collapse-range failed");
+            pwrite_all(fd.get(), saved.data(), saved.size(), plan.collapse_offset);
+            ::fdatasync(fd.get());
+            return false;
+        }
+    }
+
+    if (::ftruncate(fd.get(), static_cast<off_t>(plan.final_size)) != 0) {
+        error_message = errno_string("Truncate failed");
+        return false;
+    }
+    if (::fsync(fd.get()) != 0) {
+        error_message = errno_string("fsync failed");
+        return false;
+    }
+    return true;
+}
+
+} // namespace trimora
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace trimora {
+
+// What an in-place trim will do to a file. Planning only reads the file, so
+// a plan doubles as the dry-run report.
+struct InPlaceTrimPlan {
+    bool ok = false;
+    std::string error_message;
+
+    std::filesystem::path file;
+    uint64_t original_size = 0;
+    int64_t original_mtime_ns = 0;  // apply() refuses if the file changed since
+
+    // Head: the rebuilt container header is written at collapse_offset, then
+    // the first collapse_offset bytes (a multiple of the filesystem block
+    // size) are removed with FALLOC_FL_COLLAPSE_RANGE. With collapse_offset
+    // 0 the header simply replaces the old one; with no header too, the
+    // head stays as it is.
+    uint64_t collapse_offset = 0;
+    std::vector<uint8_t> header;
+
+    // Tail: source offset the file is cut at (before the collapse)
+    uint64_t truncate_at = 0;
+    uint64_t final_size = 0;
+
+    double start_seconds = 0.0;  // Where the cut actually lands
+    double end_seconds = 0.0;    // 0 when the file keeps its end
+
+    std::vector<std::string> steps;  // Human-readable, in order
+};
+
+// Trims MPEG-TS, fragmented MP4 and Matroska files without writing a copy:
+// ftruncate drops the tail and collapse-range drops the head, so the cost
+// is a few metadata operations and one small header write however large
+// the file is. Cut points are the same keyframe/fragment/cluster
+// boundaries the native copy trims use.
+class InPlaceTrimmer {
+public:
+    static bool is_supported(const std::filesystem::path& path);
+
+    static InPlaceTrimPlan plan(const std::filesystem::path& file, double start_seconds, double end_seconds);
+
+    // Carries out a plan. Takes an exclusive lock and re-checks the file
+    // first; if the collapse fails the header bytes are put back and the
+    // file is left as it was.
+    static bool apply(const InPlaceTrimPlan& plan, std::string& error_message);
+};
+
+} // namespace trimora
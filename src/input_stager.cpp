@@ -0,0 +1,228 @@
+#include "input_stager.hpp"
+#include "file_manager.hpp"
+#include <algorithm>
+#include <fstream>
+#include <vector>
+#include <chrono>
+
+namespace fs = std::filesystem;
+
+namespace trimora {
+
+namespace {
+
+constexpr size_t kCopyChunkSize = 1024 * 1024;
+constexpr size_t kScratchReserveBytes = 256 * 1024 * 1024;  // Keep headroom for outputs
+constexpr auto kCancelPoll = std::chrono::milliseconds(50);
+
+} // namespace
+
+InputStager::InputStager(
+    const fs::path& scratch_dir,
+    size_t max_file_bytes,
+    size_t bandwidth_limit_bytes_per_sec
+)
+    : scratch_dir_(scratch_dir)
+    , max_file_bytes_(max_file_bytes)
+    , bandwidth_limit_(bandwidth_limit_bytes_per_sec)
+{
+}
+
+InputStager::~InputStager() {
+    std::vector<std::shared_ptr<StagedInput>> entries;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& [path, entry] : staged_) {
+            evict(entry);
+        }
+        staged_.clear();
+        entries.swap(evicted_);
+    }
+    
+    // Workers stop within one chunk of copying
+    for (auto& entry : entries) {
+        entry->worker.join();
+    }
+}
+
+void InputStager::stage(const fs::path& input) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    join_finished();
+    
+    if (staged_.count(input.string())) {
+        return;
+    }
+    
+    // Each input gets its own slot directory so the original filename is kept
+    auto entry = std::make_shared<StagedInput>();
+    entry->staged_path = scratch_dir_ / ("job_" + std::to_string(next_slot_++)) / input.filename();
+    entry->worker = std::thread(&InputStager::copy_worker, this, input, entry);
+    
+    staged_[input.string()] = entry;
+}
+
+void InputStager::acquire(const fs::path& input, ReadyCallback on_ready) {
+    fs::path path = input;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = staged_.find(input.string());
+        if (it != staged_.end()) {
+            auto& entry = it->second;
+            if (entry->state == StageState::Copying) {
+                entry->waiting.push_back(std::move(on_ready));
+                return;
+            }
+            if (entry->state == StageState::Ready) {
+                path = entry->staged_path;
+            }
+        }
+    }
+    
+    on_ready(path);
+}
+
+void InputStager::release(const fs::path& input) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = staged_.find(input.string());
+    if (it == staged_.end()) {
+        return;
+    }
+    evict(it->second);
+    staged_.erase(it);
+}
+
+void InputStager::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& [path, entry] : staged_) {
+        evict(entry);
+    }
+    staged_.clear();
+    join_finished();
+}
+
+void InputStager::evict(const std::shared_ptr<StagedInput>& entry) {
+    entry->cancelled = true;
+    entry->evicted = true;
+    evicted_.push_back(entry);
+    state_changed_.notify_all();
+}
+
+void InputStager::join_finished() {
+    for (auto it = evicted_.begin(); it != evicted_.end();) {
+        if ((*it)->finished) {
+            (*it)->worker.join();
+            it = evicted_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+bool InputStager::should_stage(const fs::path& input) const {
+    // Only stage inputs that fit the size cap and the scratch volume
+    auto size = FileManager::get_file_size(input);
+    if (!size || *size == 0 || *size > max_file_bytes_) {
+        return false;
+    }
+    
+    std::error_code ec;
+    fs::create_directories(scratch_dir_, ec);
+    if (ec) {
+        return false;
+    }
+    
+    auto available = FileManager::get_available_space(scratch_dir_);
+    if (!available || *available < *size + kScratchReserveBytes) {
+        return false;
+    }
+    
+    // Inputs already on the scratch volume gain nothing from a copy
+    auto canonical_input = fs::canonical(input, ec);
+    return ec || canonical_input.string().rfind(fs::canonical(scratch_dir_, ec).string(), 0) != 0;
+}
+
+void InputStager::copy_worker(const fs::path& input, std::shared_ptr<StagedInput> entry) {
+    bool ok = false;
+    
+    try {
+        if (should_stage(input)) {
+            fs::create_directories(entry->staged_path.parent_path());
+            ok = copy_throttled(input, entry->staged_path, entry->cancelled);
+        }
+    } catch (...) {
+        ok = false;
+    }
+    
+    if (!ok) {
+        std::error_code ec;
+        fs::remove(entry->staged_path, ec);
+    }
+    
+    std::vector<ReadyCallback> waiting;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        entry->state = ok ? StageState::Ready : StageState::Failed;
+        waiting.swap(entry->waiting);
+    }
+    for (auto& on_ready : waiting) {
+        on_ready(ok ? entry->staged_path : input);
+    }
+    
+    // The copy stays until its job is done with it
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        state_changed_.wait(lock, [&entry]() { return entry->evicted; });
+    }
+    std::error_code ec;
+    fs::remove(entry->staged_path, ec);
+    fs::remove(entry->staged_path.parent_path(), ec);
+    entry->finished = true;
+}
+
+bool InputStager::copy_throttled(
+    const fs::path& from,
+    const fs::path& to,
+    const std::atomic<bool>& cancelled
+) const {
+    std::ifstream in(from, std::ios::binary);
+    std::ofstream out(to, std::ios::binary | std::ios::trunc);
+    if (!in || !out) {
+        return false;
+    }
+    
+    std::vector<char> buffer(kCopyChunkSize);
+    size_t copied = 0;
+    auto started = std::chrono::steady_clock::now();
+    
+    while (!cancelled) {
+        in.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        auto count = in.gcount();
+        if (count <= 0) {
+            break;
+        }
+        
+        out.write(buffer.data(), count);
+        if (!out) {
+            return false;
+        }
+        copied += static_cast<size_t>(count);
+        
+        // Sleep off any lead over the bandwidth budget so staging doesn't
+        // starve the job that is reading from the same device
+        if (bandwidth_limit_ > 0) {
+            auto budget = std::chrono::duration<double>(
+                static_cast<double>(copied) / static_cast<double>(bandwidth_limit_));
+            auto elapsed = std::chrono::steady_clock::now() - started;
+            // In short naps, so a cancel doesn't wait out the whole lead
+            while (budget > elapsed && !cancelled) {
+                std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(
+                    std::chrono::duration_cast<std::chrono::steady_clock::duration>(budget - elapsed), kCancelPoll));
+                elapsed = std::chrono::steady_clock::now() - started;
+            }
+        }
+    }
+    
+    return !cancelled && in.eof() && out.good();
+}
+
+} // namespace trimora
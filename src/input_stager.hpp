@@ -0,0 +1,90 @@
+#pragma once
+
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <map>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+
+namespace trimora {
+
+// Copies upcoming batch inputs from slow or removable media (SD cards, USB
+// drives, network mounts) to local scratch space while the current job runs,
+// so FFmpeg's random reads hit fast storage. Staged copies are evicted once
+// the job that used them has finished. Nothing here waits for a copy: the
+// checks, the copying and the clean-up all happen on the copy threads.
+class InputStager {
+public:
+    using ReadyCallback = std::function<void(const std::filesystem::path& path)>;
+
+    InputStager(
+        const std::filesystem::path& scratch_dir,
+        size_t max_file_bytes,
+        size_t bandwidth_limit_bytes_per_sec = 0  // 0 = unlimited
+    );
+    ~InputStager();
+
+    InputStager(const InputStager&) = delete;
+    InputStager& operator=(const InputStager&) = delete;
+
+    // Start copying an input to scratch in the background. Inputs that are
+    // too large, already local to scratch, or don't fit are left in place.
+    void stage(const std::filesystem::path& input);
+
+    // Hands on_ready the path FFmpeg should read for this input: the staged
+    // copy, or the original if staging was skipped or failed. Called right
+    // away unless a copy is in flight, in which case the copy thread calls
+    // it when the copy is done.
+    void acquire(const std::filesystem::path& input, ReadyCallback on_ready);
+
+    // Evict the staged copy of an input once its job has finished
+    void release(const std::filesystem::path& input);
+
+    // Cancel all copies and evict everything
+    void clear();
+
+private:
+    enum class StageState {
+        Copying,
+        Ready,
+        Failed
+    };
+
+    struct StagedInput {
+        std::filesystem::path staged_path;
+        StageState state = StageState::Copying;
+        std::atomic<bool> cancelled{false};
+        bool evicted = false;                // The worker removes the copy and exits
+        std::atomic<bool> finished{false};   // Worker done, join() won't block
+        std::vector<ReadyCallback> waiting;  // acquire() calls made during the copy
+        std::thread worker;
+    };
+
+    // Copies, reports to waiting callers, then holds the copy until evicted
+    void copy_worker(const std::filesystem::path& input, std::shared_ptr<StagedInput> entry);
+    bool should_stage(const std::filesystem::path& input) const;
+    bool copy_throttled(
+        const std::filesystem::path& from,
+        const std::filesystem::path& to,
+        const std::atomic<bool>& cancelled
+    ) const;
+    void evict(const std::shared_ptr<StagedInput>& entry);  // Lock held
+    void join_finished();                                   // Lock held
+
+    std::filesystem::path scratch_dir_;
+    size_t max_file_bytes_;
+    size_t bandwidth_limit_;
+    size_t next_slot_ = 0;
+
+    std::map<std::string, std::shared_ptr<StagedInput>> staged_;
+    std::vector<std::shared_ptr<StagedInput>> evicted_;  // Until their workers are joined
+    std::mutex mutex_;
+    std::condition_variable state_changed_;
+};
+
+} // namespace trimora
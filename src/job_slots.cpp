@@ -0,0 +1,224 @@
+#include "job_slots.hpp"
+#include "scoped_fd.hpp"
+#include "logger.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace trimora {
+
+namespace {
+
+// How often a waiting process checks whether its turn has come
+constexpr auto kWaitPoll = std::chrono::milliseconds(100);
+
+constexpr const char* kTicketPrefix = "ticket-";
+
+int open_lock_file(const fs::path& path) {
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0666);
+    if (fd < 0 && errno == EACCES) {
+        // Created by another user; flock() works on read-only descriptors too
+        fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    }
+    return fd;
+}
+
+bool lock(int fd, int operation) {
+    while (::flock(fd, operation) != 0) {
+        if (errno != EINTR) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Holds the queue lock for a scope
+class QueueLock {
+public:
+    explicit QueueLock(const fs::path& directory)
+        : fd_(open_lock_file(directory / "queue.lock")) {
+        locked_ = fd_ && lock(fd_.get(), LOCK_EX);
+    }
+    ~QueueLock() {
+        if (locked_) {
+            ::flock(fd_.get(), LOCK_UN);
+        }
+    }
+
+    QueueLock(const QueueLock&) = delete;
+    QueueLock& operator=(const QueueLock&) = delete;
+
+    explicit operator bool() const { return locked_; }
+
+private:
+    ScopedFd fd_;
+    bool locked_ = false;
+};
+
+} // namespace
+
+JobSlots::Lease::~Lease() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+JobSlots::Lease::Lease(Lease&& other) noexcept : fd_(other.fd_), slot_(other.slot_) {
+    other.fd_ = -1;
+}
+
+JobSlots::Lease& JobSlots::Lease::operator=(Lease&& other) noexcept {
+    if (this != &other) {
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+        fd_ = other.fd_;
+        slot_ = other.slot_;
+        other.fd_ = -1;
+    }
+    return *this;
+}
+
+JobSlots::JobSlots(fs::path directory, size_t slots)
+    : directory_(directory.empty() ? default_directory() : std::move(directory)),
+      slots_(slots > 0 ? slots : default_slots()) {
+}
+
+size_t JobSlots::default_slots() {
+    return std::max<size_t>(std::thread::hardware_concurrency() / 2, 1);
+}
+
+fs::path JobSlots::default_directory() {
+    // Usually tmpfs, and private to the user
+    const char* runtime_dir = std::getenv("XDG_RUNTIME_DIR");
+    if (runtime_dir && *runtime_dir) {
+        return fs::path(runtime_dir) / "trimora-slots";
+    }
+    return fs::temp_directory_path() / ("trimora-slots-" + std::to_string(::getuid()));
+}
+
+fs::path JobSlots::ticket_path(uint64_t ticket) const {
+    // Zero-padded so names sort like numbers
+    std::string number = std::to_string(ticket);
+    return directory_ / (kTicketPrefix + std::string(20 - number.size(), '0') + number);
+}
+
+std::vector<uint64_t> JobSlots::live_tickets() {
+    std::vector<uint64_t> tickets;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(directory_, ec)) {
+        std::string name = entry.path().filename().string();
+        if (name.rfind(kTicketPrefix, 0) != 0) {
+            continue;
+        }
+        // A waiter holds its ticket locked; one we can lock belongs to a dead process
+        ScopedFd fd(::open(entry.path().c_str(), O_RDONLY | O_CLOEXEC));
+        if (fd && ::flock(fd.get(), LOCK_EX | LOCK_NB) == 0) {
+            fs::remove(entry.path(), ec);
+            continue;
+        }
+        tickets.push_back(std::strtoull(name.c_str() + std::strlen(kTicketPrefix), nullptr, 10));
+    }
+    std::sort(tickets.begin(), tickets.end());
+    return tickets;
+}
+
+std::optional<JobSlots::Lease> JobSlots::take_slot(size_t position) {
+    // Waiters ahead of us get the first free slots; we may take one only
+    // if there is a free slot for each of them as well
+    std::vector<Lease> free_slots;
+    for (size_t slot = 0; slot < slots_ && free_slots.size() <= position; ++slot) {
+        int fd = open_lock_file(directory_ / ("slot-" + std::to_string(slot)));
+        if (fd < 0) {
+            continue;
+        }
+        Lease lease(fd, slot);
+        if (::flock(fd, LOCK_EX | LOCK_NB) == 0) {
+            free_slots.push_back(std::move(lease));
+        }
+    }
+    if (free_slots.size() <= position) {
+        return std::nullopt;  // The others are released on return
+    }
+    return std::move(free_slots.back());
+}
+
+std::optional<JobSlots::Lease> JobSlots::acquire(
+    const std::function<bool()>& keep_waiting,
+    const std::function<void()>& on_wait
+) {
+    std::error_code ec;
+    fs::create_directories(directory_, ec);
+
+    uint64_t ticket = 0;
+    std::optional<ScopedFd> ticket_fd;
+    {
+        QueueLock queue(directory_);
+        if (!queue) {
+            // A broken slot directory must not stop the work
+            TRIMORA_LOG_WARNING("Job slots unavailable in " + directory_.string() + ": " + std::strerror(errno));
+            return Lease();
+        }
+        auto tickets = live_tickets();
+        if (tickets.empty()) {
+            if (auto lease = take_slot(0)) {
+                return lease;
+            }
+        }
+        ticket = tickets.empty() ? 0 : tickets.back() + 1;
+        ticket_fd.emplace(open_lock_file(ticket_path(ticket)));
+        if (!*ticket_fd || !lock(ticket_fd->get(), LOCK_EX)) {
+            TRIMORA_LOG_WARNING("Cannot queue for a job slot in " + directory_.string() + ": " +
+                                std::strerror(errno));
+            return Lease();
+        }
+    }
+
+    if (on_wait) {
+        on_wait();
+    }
+    TRIMORA_LOG_DEBUG("Waiting for one of " + std::to_string(slots_) + " job slots (ticket " +
+                      std::to_string(ticket) + ")");
+
+    while (true) {
+        std::this_thread::sleep_for(kWaitPoll);
+        QueueLock queue(directory_);
+        if (!keep_waiting()) {
+            fs::remove(ticket_path(ticket), ec);
+            return std::nullopt;
+        }
+        auto tickets = live_tickets();
+        size_t position = static_cast<size_t>(
+            std::lower_bound(tickets.begin(), tickets.end(), ticket) - tickets.begin());
+        if (auto lease = take_slot(position)) {
+            fs::remove(ticket_path(ticket), ec);
+            TRIMORA_LOG_DEBUG("Got job slot " + std::to_string(lease->slot()));
+            return lease;
+        }
+    }
+}
+
+std::optional<JobSlots::Lease> JobSlots::try_acquire() {
+    std::error_code ec;
+    fs::create_directories(directory_, ec);
+
+    QueueLock queue(directory_);
+    if (!queue) {
+        return Lease();  // Unlimited, as in acquire()
+    }
+    if (!live_tickets().empty()) {
+        return std::nullopt;
+    }
+    return take_slot(0);
+}
+
+} // namespace trimora
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace trimora {
+
+// Host-wide budget of concurrent jobs, shared by every trimora process that
+// uses the same directory, so several instances don't oversubscribe the
+// machine. A slot is a lock file held with flock() for the length of a job;
+// the kernel drops the lock when its holder exits or crashes, so slots are
+// never leaked. Processes that have to wait queue by ticket (also a locked
+// file, removed by the next waiter if its owner died) and are served oldest
+// first.
+class JobSlots {
+public:
+    // A held slot, released on destruction. A lease taken when the slot
+    // directory is unusable holds nothing and doesn't limit the job.
+    class Lease {
+    public:
+        Lease() = default;
+        Lease(int fd, size_t slot) : fd_(fd), slot_(slot) {}
+        ~Lease();
+        Lease(Lease&& other) noexcept;
+        Lease& operator=(Lease&& other) noexcept;
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+
+        bool holds_slot() const { return fd_ >= 0; }
+        size_t slot() const { return slot_; }
+
+    private:
+        int fd_ = -1;
+        size_t slot_ = 0;
+    };
+
+    // slots = 0 picks default_slots()
+    JobSlots(std::filesystem::path directory, size_t slots);
+
+    // Blocks until this process's turn comes and a slot is free. on_wait
+    // runs once if the slot isn't available right away; keep_waiting is
+    // polled and returning false gives up (nullopt).
+    std::optional<Lease> acquire(
+        const std::function<bool()>& keep_waiting,
+        const std::function<void()>& on_wait = {}
+    );
+
+    // A slot only if one is free now and no process is queued for one;
+    // never waits. For work that can just as well run later.
+    std::optional<Lease> try_acquire();
+
+    size_t slots() const { return slots_; }
+    const std::filesystem::path& directory() const { return directory_; }
+
+    // Half the logical CPUs, at least one
+    static size_t default_slots();
+
+    // $XDG_RUNTIME_DIR/trimora-slots, else trimora-slots-<uid> in the temp directory
+    static std::filesystem::path default_directory();
+
+private:
+    std::vector<uint64_t> live_tickets();  // Sorted; removes tickets of dead processes. Queue lock held.
+    std::optional<Lease> take_slot(size_t position);  // Queue lock held
+    std::filesystem::path ticket_path(uint64_t ticket) const;
+
+    std::filesystem::path directory_;
+    size_t slots_;
+};
+
+} // namespace trimora
@@ -0,0 +1,331 @@
+#include "logger.hpp"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <ctime>
+#include <cctype>
+
+namespace fs = std::filesystem;
+
+namespace trimora {
+
+namespace {
+
+constexpr auto kDrainInterval = std::chrono::milliseconds(20);
+constexpr auto kFlushTimeout = std::chrono::seconds(2);
+
+// Size-capped log file that rotates trimora.log -> trimora.1.log -> ...
+class RotatingFileSink {
+public:
+    RotatingFileSink(const fs::path& directory, size_t max_file_bytes, size_t max_files)
+        : directory_(directory)
+        , max_file_bytes_(max_file_bytes)
+        , max_files_(std::max<size_t>(max_files, 1))
+    {
+        std::error_code ec;
+        fs::create_directories(directory_, ec);
+        open();
+    }
+
+    void write(const LogRecord& record) {
+        if (!file_) {
+            return;
+        }
+        
+        std::string line = Logger::format_record(record);
+        if (written_ + line.size() + 1 > max_file_bytes_ && written_ > 0) {
+            rotate();
+        }
+        
+        file_ << line << '\n';
+        written_ += line.size() + 1;
+        
+        // Errors are flushed right away so they survive a crash
+        if (record.level >= LogLevel::Error) {
+            file_.flush();
+        }
+    }
+
+private:
+    fs::path file_path(size_t generation) const {
+        if (generation == 0) {
+            return directory_ / "trimora.log";
+        }
+        return directory_ / ("trimora." + std::to_string(generation) + ".log");
+    }
+
+    void open() {
+        file_.open(file_path(0), std::ios::app);
+        std::error_code ec;
+        auto size = fs::file_size(file_path(0), ec);
+        written_ = ec ? 0 : static_cast<size_t>(size);
+    }
+
+    void rotate() {
+        file_.close();
+        
+        std::error_code ec;
+        fs::remove(file_path(max_files_ - 1), ec);
+        for (size_t generation = max_files_ - 1; generation > 0; --generation) {
+            fs::rename(file_path(generation - 1), file_path(generation), ec);
+        }
+        
+        open();
+    }
+
+    fs::path directory_;
+    size_t max_file_bytes_;
+    size_t max_files_;
+    std::ofstream file_;
+    size_t written_ = 0;
+};
+
+} // namespace
+
+// Single-producer/single-consumer ring owned by one logging thread and
+// drained by the logger's background thread
+class Logger::ThreadQueue {
+public:
+    static constexpr uint64_t kCapacity = 1024;  // Power of two
+
+    ThreadQueue() : slots_(kCapacity) {}
+
+    bool push(LogRecord&& record) {
+        uint64_t head = head_.load(std::memory_order_relaxed);
+        uint64_t tail = tail_.load(std::memory_order_acquire);
+        if (head - tail >= kCapacity) {
+            return false;
+        }
+        
+        slots_[head & (kCapacity - 1)] = std::move(record);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(LogRecord& record) {
+        uint64_t tail = tail_.load(std::memory_order_relaxed);
+        uint64_t head = head_.load(std::memory_order_acquire);
+        if (tail == head) {
+            return false;
+        }
+        
+        record = std::move(slots_[tail & (kCapacity - 1)]);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const {
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+    }
+
+    void retire() { retired_.store(true, std::memory_order_release); }
+    bool is_retired() const { return retired_.load(std::memory_order_acquire); }
+
+private:
+    std::vector<LogRecord> slots_;
+    alignas(64) std::atomic<uint64_t> head_{0};
+    alignas(64) std::atomic<uint64_t> tail_{0};
+    std::atomic<bool> retired_{false};
+};
+
+Logger& Logger::instance() {
+    static Logger logger;
+    return logger;
+}
+
+Logger::Logger() {
+    add_sink([](const LogRecord& record) {
+        std::cerr << format_record(record) << '\n';
+    });
+    
+    running_ = true;
+    worker_ = std::thread(&Logger::run, this);
+}
+
+Logger::~Logger() {
+    shutdown();
+}
+
+Logger::ThreadQueue& Logger::local_queue() {
+    // Retires the queue when its thread exits; the background thread frees
+    // it once drained
+    struct Handle {
+        std::shared_ptr<ThreadQueue> queue;
+        ~Handle() {
+            if (queue) {
+                queue->retire();
+            }
+        }
+    };
+    thread_local Handle handle;
+    
+    if (!handle.queue) {
+        handle.queue = std::make_shared<ThreadQueue>();
+        std::lock_guard<std::mutex> lock(queues_mutex_);
+        queues_.push_back(handle.queue);
+    }
+    return *handle.queue;
+}
+
+void Logger::log(LogLevel level, std::string message) {
+    LogRecord record;
+    record.level = level;
+    record.time = std::chrono::system_clock::now();
+    record.message = std::move(message);
+    
+    if (!running_.load(std::memory_order_acquire)) {
+        std::cerr << format_record(record) << '\n';
+        return;
+    }
+    
+    if (local_queue().push(std::move(record))) {
+        enqueued_.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+int Logger::add_sink(Sink sink) {
+    std::lock_guard<std::mutex> lock(sinks_mutex_);
+    int id = next_sink_id_++;
+    sinks_.emplace_back(id, std::move(sink));
+    return id;
+}
+
+void Logger::remove_sink(int sink_id) {
+    std::lock_guard<std::mutex> lock(sinks_mutex_);
+    sinks_.erase(
+        std::remove_if(sinks_.begin(), sinks_.end(),
+            [sink_id](const auto& entry) { return entry.first == sink_id; }),
+        sinks_.end());
+}
+
+int Logger::add_file_sink(const fs::path& directory, size_t max_file_bytes, size_t max_files) {
+    auto sink = std::make_shared<RotatingFileSink>(directory, max_file_bytes, max_files);
+    return add_sink([sink](const LogRecord& record) {
+        sink->write(record);
+    });
+}
+
+void Logger::flush() {
+    if (!running_) {
+        return;
+    }
+    
+    uint64_t target = enqueued_.load(std::memory_order_relaxed);
+    auto deadline = std::chrono::steady_clock::now() + kFlushTimeout;
+    while (delivered_.load(std::memory_order_acquire) < target &&
+           std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+void Logger::shutdown() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+    
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+    
+    // Records that raced with the stop
+    drain_once();
+}
+
+void Logger::run() {
+    while (running_.load(std::memory_order_acquire)) {
+        if (drain_once() == 0) {
+            std::this_thread::sleep_for(kDrainInterval);
+        }
+    }
+}
+
+size_t Logger::drain_once() {
+    std::vector<std::shared_ptr<ThreadQueue>> queues;
+    {
+        std::lock_guard<std::mutex> lock(queues_mutex_);
+        queues = queues_;
+    }
+    
+    std::vector<LogRecord> batch;
+    LogRecord record;
+    for (const auto& queue : queues) {
+        while (queue->pop(record)) {
+            batch.push_back(std::move(record));
+        }
+    }
+    
+    // Forget queues of threads that have exited
+    {
+        std::lock_guard<std::mutex> lock(queues_mutex_);
+        queues_.erase(
+            std::remove_if(queues_.begin(), queues_.end(),
+                [](const auto& queue) { return queue->is_retired() && queue->empty(); }),
+            queues_.end());
+    }
+    
+    if (batch.empty()) {
+        return 0;
+    }
+    
+    // Interleave threads in time order
+    std::stable_sort(batch.begin(), batch.end(),
+        [](const LogRecord& a, const LogRecord& b) { return a.time < b.time; });
+    
+    {
+        std::lock_guard<std::mutex> lock(sinks_mutex_);
+        for (const auto& entry : batch) {
+            for (const auto& [id, sink] : sinks_) {
+                sink(entry);
+            }
+        }
+    }
+    
+    delivered_.fetch_add(batch.size(), std::memory_order_release);
+    return batch.size();
+}
+
+LogLevel Logger::parse_level(const std::string& name) {
+    std::string lower = name;
+    std::transform(lower.begin(), lower.end(), lower.begin(),
+        [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    
+    if (lower == "trace") return LogLevel::Trace;
+    if (lower == "debug") return LogLevel::Debug;
+    if (lower == "warning" || lower == "warn") return LogLevel::Warning;
+    if (lower == "error") return LogLevel::Error;
+    if (lower == "off" || lower == "none") return LogLevel::Off;
+    return LogLevel::Info;
+}
+
+const char* Logger::level_name(LogLevel level) {
+    switch (level) {
+        case LogLevel::Trace: return "TRACE";
+        case LogLevel::Debug: return "DEBUG";
+        case LogLevel::Info: return "INFO";
+        case LogLevel::Warning: return "WARN";
+        case LogLevel::Error: return "ERROR";
+        case LogLevel::Off: return "OFF";
+    }
+    return "INFO";
+}
+
+std::string Logger::format_record(const LogRecord& record) {
+    auto time_t = std::chrono::system_clock::to_time_t(record.time);
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        record.time.time_since_epoch()).count() % 1000;
+    
+    std::tm local_tm{};
+    localtime_r(&time_t, &local_tm);
+    
+    std::ostringstream oss;
+    oss << std::put_time(&local_tm, "%Y-%m-%d %H:%M:%S") << "."
+        << std::setfill('0') << std::setw(3) << ms << " "
+        << "[" << level_name(record.level) << "] " << record.message;
+    return oss.str();
+}
+
+} // namespace trimora
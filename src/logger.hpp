@@ -0,0 +1,149 @@
+#pragma once
+
+#include <string>
+#include <filesystem>
+#include <functional>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace trimora {
+
+enum class LogLevel {
+    Trace = 0,
+    Debug = 1,
+    Info = 2,
+    Warning = 3,
+    Error = 4,
+    Off = 5
+};
+
+// Statements below this level compile to nothing. Override with
+// -DTRIMORA_LOG_COMPILE_LEVEL=<0..5>; release builds drop trace/debug.
+#ifndef TRIMORA_LOG_COMPILE_LEVEL
+#ifdef NDEBUG
+#define TRIMORA_LOG_COMPILE_LEVEL 2
+#else
+#define TRIMORA_LOG_COMPILE_LEVEL 0
+#endif
+#endif
+
+struct LogRecord {
+    LogLevel level = LogLevel::Info;
+    std::chrono::system_clock::time_point time;
+    std::string message;
+};
+
+// Asynchronous leveled logger. Each producing thread writes into its own
+// bounded lock-free queue (records are dropped, never waited on, when it is
+// full); a background thread drains the queues and feeds the sinks, so
+// logging never blocks a worker on file or console I/O.
+class Logger {
+public:
+    using Sink = std::function<void(const LogRecord& record)>;
+
+    static Logger& instance();
+
+    ~Logger();
+
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    // Runtime level (Config::log_level)
+    void set_level(LogLevel level) { level_.store(level, std::memory_order_relaxed); }
+    LogLevel get_level() const { return level_.load(std::memory_order_relaxed); }
+    bool should_log(LogLevel level) const { return level >= get_level(); }
+
+    // Enqueue a record from the calling thread
+    void log(LogLevel level, std::string message);
+
+    // Sinks run on the background thread; remove_sink() returns only once
+    // the sink can no longer be called
+    int add_sink(Sink sink);
+    void remove_sink(int sink_id);
+
+    // Rotating log file: <directory>/trimora.log, trimora.1.log, ...
+    int add_file_sink(const std::filesystem::path& directory, size_t max_file_bytes, size_t max_files);
+
+    // Wait until everything logged so far has reached the sinks
+    void flush();
+
+    // Drain remaining records and stop the background thread; later records
+    // are written straight to stderr
+    void shutdown();
+
+    // Records dropped because a thread's queue was full
+    size_t get_dropped_count() const { return dropped_.load(std::memory_order_relaxed); }
+
+    static LogLevel parse_level(const std::string& name);
+    static const char* level_name(LogLevel level);
+    static std::string format_record(const LogRecord& record);
+
+private:
+    class ThreadQueue;
+
+    Logger();
+
+    ThreadQueue& local_queue();
+    void run();
+    size_t drain_once();
+
+    std::atomic<LogLevel> level_{LogLevel::Info};
+    std::atomic<bool> running_{false};
+    std::atomic<size_t> dropped_{0};
+    std::atomic<uint64_t> enqueued_{0};
+    std::atomic<uint64_t> delivered_{0};
+
+    std::vector<std::shared_ptr<ThreadQueue>> queues_;
+    std::mutex queues_mutex_;
+
+    std::vector<std::pair<int, Sink>> sinks_;
+    std::mutex sinks_mutex_;
+    int next_sink_id_ = 1;
+
+    std::thread worker_;
+};
+
+} // namespace trimora
+
+#define TRIMORA_LOG_AT(level, message) \
+    do { \
+        auto& trimora_logger_ = ::trimora::Logger::instance(); \
+        if (trimora_logger_.should_log(level)) { \
+            trimora_logger_.log(level, message); \
+        } \
+    } while (0)
+
+#if TRIMORA_LOG_COMPILE_LEVEL <= 0
+#define TRIMORA_LOG_TRACE(message) TRIMORA_LOG_AT(::trimora::LogLevel::Trace, message)
+#else
+#define TRIMORA_LOG_TRACE(message) ((void)0)
+#endif
+
+#if TRIMORA_LOG_COMPILE_LEVEL <= 1
+#define TRIMORA_LOG_DEBUG(message) TRIMORA_LOG_AT(::trimora::LogLevel::Debug, message)
+#else
+#define TRIMORA_LOG_DEBUG(message) ((void)0)
+#endif
+
+#if TRIMORA_LOG_COMPILE_LEVEL <= 2
+#define TRIMORA_LOG_INFO(message) TRIMORA_LOG_AT(::trimora::LogLevel::Info, message)
+#else
+#define TRIMORA_LOG_INFO(message) ((void)0)
+#endif
+
+#if TRIMORA_LOG_COMPILE_LEVEL <= 3
+#define TRIMORA_LOG_WARNING(message) TRIMORA_LOG_AT(::trimora::LogLevel::Warning, message)
+#else
+#define TRIMORA_LOG_WARNING(message) ((void)0)
+#endif
+
+#if TRIMORA_LOG_COMPILE_LEVEL <= 4
+#define TRIMORA_LOG_ERROR(message) TRIMORA_LOG_AT(::trimora::LogLevel::Error, message)
+#else
+#define TRIMORA_LOG_ERROR(message) ((void)0)
+#endif
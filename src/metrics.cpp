@@ -0,0 +1,133 @@
+#include "metrics.hpp"
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <unistd.h>
+
+namespace trimora {
+
+Metrics& Metrics::instance() {
+    static Metrics metrics;
+    return metrics;
+}
+
+void Metrics::record_frame(float frame_ms, float render_ms) {
+    last_frame_ms_ = frame_ms;
+    last_render_ms_ = render_ms;
+    frame_history_[frame_history_offset_] = frame_ms;
+    frame_history_offset_ = (frame_history_offset_ + 1) % kFrameHistory;
+}
+
+void Metrics::child_started(pid_t pid, const std::string& label) {
+    ChildState state;
+    state.stats.pid = pid;
+    state.stats.label = label;
+    state.last_sample = std::chrono::steady_clock::now();
+    state.last_cpu_ticks = read_cpu_ticks(pid);
+
+    std::lock_guard<std::mutex> lock(children_mutex_);
+    children_.push_back(std::move(state));
+}
+
+void Metrics::child_progress(pid_t pid, uint64_t bytes_written, const std::string& speed) {
+    // Sampled on the reporting thread, outside the lock
+    auto now = std::chrono::steady_clock::now();
+    uint64_t cpu_ticks = read_cpu_ticks(pid);
+
+    std::lock_guard<std::mutex> lock(children_mutex_);
+    auto it = std::find_if(children_.begin(), children_.end(),
+        [pid](const ChildState& state) { return state.stats.pid == pid; });
+    if (it == children_.end()) {
+        return;
+    }
+
+    if (!speed.empty()) {
+        it->stats.speed = speed;
+    }
+
+    // Progress lines arrive several times a second; rate over >= 250 ms
+    double elapsed = std::chrono::duration<double>(now - it->last_sample).count();
+    if (elapsed < 0.25) {
+        return;
+    }
+
+    static const double ticks_per_second = static_cast<double>(sysconf(_SC_CLK_TCK));
+    if (cpu_ticks >= it->last_cpu_ticks) {
+        it->stats.cpu_percent = (cpu_ticks - it->last_cpu_ticks) / ticks_per_second / elapsed * 100.0;
+    }
+    if (bytes_written >= it->last_bytes) {
+        it->stats.write_mb_per_sec = (bytes_written - it->last_bytes) / (1024.0 * 1024.0) / elapsed;
+    }
+
+    it->last_sample = now;
+    it->last_cpu_ticks = cpu_ticks;
+    it->last_bytes = bytes_written;
+}
+
+void Metrics::child_exited(pid_t pid) {
+    std::lock_guard<std::mutex> lock(children_mutex_);
+    std::erase_if(children_, [pid](const ChildState& state) { return state.stats.pid == pid; });
+}
+
+std::vector<ChildProcessStats> Metrics::get_children() const {
+    std::lock_guard<std::mutex> lock(children_mutex_);
+    std::vector<ChildProcessStats> result;
+    result.reserve(children_.size());
+    for (const auto& state : children_) {
+        result.push_back(state.stats);
+    }
+    return result;
+}
+
+uint64_t Metrics::get_resident_bytes() {
+    auto now = std::chrono::steady_clock::now();
+    if (resident_bytes_ != 0 && now - resident_sampled_ < std::chrono::milliseconds(500)) {
+        return resident_bytes_;
+    }
+    resident_sampled_ = now;
+
+#ifdef __linux__
+    // statm: size resident shared ... (pages)
+    std::ifstream statm("/proc/self/statm");
+    uint64_t size_pages = 0;
+    uint64_t resident_pages = 0;
+    if (statm >> size_pages >> resident_pages) {
+        resident_bytes_ = resident_pages * static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    }
+#endif
+
+    return resident_bytes_;
+}
+
+uint64_t Metrics::read_cpu_ticks(pid_t pid) {
+#ifdef __linux__
+    // /proc/<pid>/stat: utime and stime are fields 14 and 15; skip past the
+    // parenthesised command name, which may contain spaces
+    std::ifstream stat("/proc/" + std::to_string(pid) + "/stat");
+    std::string content((std::istreambuf_iterator<char>(stat)), std::istreambuf_iterator<char>());
+    auto paren = content.rfind(')');
+    if (paren == std::string::npos || paren + 2 >= content.size()) {
+        return 0;
+    }
+
+    std::istringstream fields(content.substr(paren + 2));
+    std::string field;
+    uint64_t utime = 0;
+    uint64_t stime = 0;
+    // Fields after the name start at 3 (state)
+    for (int index = 3; index <= 15 && fields >> field; ++index) {
+        if (index == 14) {
+            utime = std::stoull(field);
+        } else if (index == 15) {
+            stime = std::stoull(field);
+        }
+    }
+    return utime + stime;
+#else
+    (void)pid;
+    return 0;
+#endif
+}
+
+} // namespace trimora
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <array>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <sys/types.h>
+
+namespace trimora {
+
+struct ChildProcessStats {
+    pid_t pid = 0;
+    std::string label;
+    double cpu_percent = 0.0;       // Of one core, since the previous report
+    double write_mb_per_sec = 0.0;
+    std::string speed;              // As reported by ffmpeg, e.g. "2.5x"
+};
+
+// Process-wide performance counters shown by the performance HUD. Values
+// are pushed by the code that already knows them (end of frame, mpv
+// events, ffmpeg progress lines); nothing here polls on its own.
+class Metrics {
+public:
+    static constexpr size_t kFrameHistory = 240;
+
+    static Metrics& instance();
+
+    Metrics(const Metrics&) = delete;
+    Metrics& operator=(const Metrics&) = delete;
+
+    // UI thread only
+    void record_frame(float frame_ms, float render_ms);
+    const std::array<float, kFrameHistory>& get_frame_history() const { return frame_history_; }
+    size_t get_frame_history_offset() const { return frame_history_offset_; }
+    float get_last_frame_ms() const { return last_frame_ms_; }
+    float get_last_render_ms() const { return last_render_ms_; }
+
+    void record_player_render(float render_ms) { player_render_ms_ = render_ms; }
+    void set_player_dropped_frames(int64_t frames) { player_dropped_frames_ = frames; }
+    float get_player_render_ms() const { return player_render_ms_; }
+    int64_t get_player_dropped_frames() const { return player_dropped_frames_; }
+
+    void set_queue_depth(size_t depth) { queue_depth_ = depth; }
+    size_t get_queue_depth() const { return queue_depth_; }
+
+    // Worker -> UI task backlog
+    void add_ui_backlog(int delta) { ui_backlog_.fetch_add(delta, std::memory_order_relaxed); }
+    int get_ui_backlog() const { return ui_backlog_.load(std::memory_order_relaxed); }
+
+    // FFmpeg children (any thread)
+    void child_started(pid_t pid, const std::string& label);
+    void child_progress(pid_t pid, uint64_t bytes_written, const std::string& speed);
+    void child_exited(pid_t pid);
+    std::vector<ChildProcessStats> get_children() const;
+
+    // Resident set size, refreshed at most twice a second
+    uint64_t get_resident_bytes();
+
+private:
+    Metrics() = default;
+
+    struct ChildState {
+        ChildProcessStats stats;
+        std::chrono::steady_clock::time_point last_sample;
+        uint64_t last_cpu_ticks = 0;
+        uint64_t last_bytes = 0;
+    };
+
+    static uint64_t read_cpu_ticks(pid_t pid);
+
+    std::array<float, kFrameHistory> frame_history_{};
+    size_t frame_history_offset_ = 0;
+    float last_frame_ms_ = 0.0f;
+    float last_render_ms_ = 0.0f;
+    float player_render_ms_ = 0.0f;
+    int64_t player_dropped_frames_ = 0;
+    size_t queue_depth_ = 0;
+
+    std::atomic<int> ui_backlog_{0};
+
+    std::vector<ChildState> children_;
+    mutable std::mutex children_mutex_;
+
+    uint64_t resident_bytes_ = 0;
+    std::chrono::steady_clock::time_point resident_sampled_;
+};
+
+} // namespace trimora
@@ -0,0 +1,672 @@
+#include "mkv_cutter.hpp"
+#include "scoped_fd.hpp"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <optional>
+#include <vector>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+namespace fs = std::filesystem;
+
+namespace trimora {
+
+namespace {
+
+constexpr uint32_t kEbmlId = 0x1a45dfa3;
+constexpr uint32_t kDocTypeId = 0x4282;
+constexpr uint32_t kSegmentId = 0x18538067;
+constexpr uint32_t kSeekHeadId = 0x114d9b74;
+constexpr uint32_t kSeekId = 0x4dbb;
+constexpr uint32_t kSeekPositionId = 0x53ac;
+constexpr uint32_t kInfoId = 0x1549a966;
+constexpr uint32_t kTimestampScaleId = 0x2ad7b1;
+constexpr uint32_t kDurationId = 0x4489;
+constexpr uint32_t kTracksId = 0x1654ae6b;
+constexpr uint32_t kChaptersId = 0x1043a770;
+constexpr uint32_t kAttachmentsId = 0x1941a469;
+constexpr uint32_t kCuesId = 0x1c53bb6b;
+constexpr uint32_t kCuePointId = 0xbb;
+constexpr uint32_t kCueTimeId = 0xb3;
+constexpr uint32_t kCueTrackPositionsId = 0xb7;
+constexpr uint32_t kCueTrackId = 0xf7;
+constexpr uint32_t kCueClusterPositionId = 0xf1;
+constexpr uint32_t kCueRelativePositionId = 0xf0;
+constexpr uint32_t kClusterId = 0x1f43b675;
+constexpr uint32_t kClusterTimestampId = 0xe7;
+constexpr uint32_t kSimpleBlockId = 0xa3;
+constexpr uint32_t kBlockGroupId = 0xa0;
+constexpr uint32_t kBlockId = 0xa1;
+constexpr uint32_t kVoidId = 0xec;
+constexpr uint32_t kCrc32Id = 0xbf;
+
+constexpr uint64_t kUnknownSize = ~0ULL;
+constexpr uint64_t kDefaultTimestampScale = 1000000;  // ns per tick
+constexpr uint64_t kMaxHeaderElementBytes = 256 * 1024 * 1024;
+constexpr uint64_t kMaxClusterParseBytes = 64 * 1024 * 1024;
+
+struct ElementHeader {
+    uint32_t id = 0;
+    uint64_t size = 0;       // kUnknownSize for live-streamed elements
+    uint64_t offset = 0;     // Start of the ID
+    size_t header_size = 0;
+
+    uint64_t data_offset() const { return offset + header_size; }
+    uint64_t end() const { return data_offset() + size; }
+};
+
+// EBML variable-length integer width from its first byte, 0 if invalid
+size_t vint_width(uint8_t first) {
+    for (size_t width = 1; width <= 8; ++width) {
+        if (first & (0x80 >> (width - 1))) {
+            return width;
+        }
+    }
+    return 0;
+}
+
+bool parse_header(const uint8_t* p, size_t available, ElementHeader& header) {
+    if (available < 2) {
+        return false;
+    }
+
+    // IDs keep their length marker
+    size_t id_width = vint_width(p[0]);
+    if (id_width == 0 || id_width > 4 || id_width >= available) {
+        return false;
+    }
+    header.id = 0;
+    for (size_t i = 0; i < id_width; ++i) {
+        header.id = (header.id << 8) | p[i];
+    }
+
+    size_t size_width = vint_width(p[id_width]);
+    if (size_width == 0 || id_width + size_width > available) {
+        return false;
+    }
+    uint64_t size = p[id_width] & (0xff >> size_width);
+    bool all_ones = size == (0xffu >> size_width);
+    for (size_t i = 1; i < size_width; ++i) {
+        size = (size << 8) | p[id_width + i];
+        all_ones = all_ones && p[id_width + i] == 0xff;
+    }
+
+    header.size = all_ones ? kUnknownSize : size;
+    header.header_size = id_width + size_width;
+    return true;
+}
+
+uint64_t read_uint(const uint8_t* p, size_t size) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < size && i < 8; ++i) {
+        value = (value << 8) | p[i];
+    }
+    return value;
+}
+
+// Calls visit(header, payload) for each child of an in-memory master element
+template <typename Visitor>
+bool for_each_child(const uint8_t* data, size_t size, Visitor&& visit) {
+    size_t offset = 0;
+    while (offset < size) {
+        ElementHeader header;
+        if (!parse_header(data + offset, size - offset, header) ||
+            header.size == kUnknownSize || header.size > size - offset - header.header_size) {
+            return false;
+        }
+        header.offset = offset;
+        visit(header, data + header.data_offset());
+        offset = header.end();
+    }
+    return true;
+}
+
+void put_id(std::vector<uint8_t>& out, uint32_t id) {
+    int bytes = id > 0xffffff ? 4 : id > 0xffff ? 3 : id > 0xff ? 2 : 1;
+    for (int i = bytes - 1; i >= 0; --i) {
+        out.push_back(static_cast<uint8_t>(id >> (i * 8)));
+    }
+}
+
+// Always 8 bytes wide, so sizes can be written before the content is final
+void put_size(std::vector<uint8_t>& out, uint64_t size) {
+    out.push_back(0x01);
+    for (int i = 6; i >= 0; --i) {
+        out.push_back(static_cast<uint8_t>(size >> (i * 8)));
+    }
+}
+
+void put_element(std::vector<uint8_t>& out, uint32_t id, const std::vector<uint8_t>& payload) {
+    put_id(out, id);
+    put_size(out, payload.size());
+    out.insert(out.end(), payload.begin(), payload.end());
+}
+
+// Fixed 8-byte value so cue sizes don't depend on the positions they hold
+void put_uint(std::vector<uint8_t>& out, uint32_t id, uint64_t value) {
+    put_id(out, id);
+    out.push_back(0x88);
+    for (int i = 7; i >= 0; --i) {
+        out.push_back(static_cast<uint8_t>(value >> (i * 8)));
+    }
+}
+
+void put_float(std::vector<uint8_t>& out, uint32_t id, double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    put_id(out, id);
+    out.push_back(0x88);
+    for (int i = 7; i >= 0; --i) {
+        out.push_back(static_cast<uint8_t>(bits >> (i * 8)));
+    }
+}
+
+// Void element of exactly size bytes (size != 1); readers skip its content
+void put_void(std::vector<uint8_t>& out, uint64_t size) {
+    if (size == 0) {
+        return;
+    }
+    out.push_back(static_cast<uint8_t>(kVoidId));
+    if (size <= 128) {
+        out.push_back(static_cast<uint8_t>(0x80 | (size - 2)));
+        out.resize(out.size() + size - 2, 0);
+    } else {
+        put_size(out, size - 9);
+        out.resize(out.size() + size - 9, 0);
+    }
+}
+
+struct CueTrackPosition {
+    uint64_t track = 0;
+    uint64_t cluster_position = 0;  // Relative to the segment data
+    std::optional<uint64_t> relative_position;
+};
+
+struct CuePoint {
+    uint64_t time = 0;  // Ticks
+    std::vector<CueTrackPosition> positions;
+};
+
+class MkvReader {
+public:
+    MkvReader(int fd, uint64_t file_size) : fd_(fd), file_size_(file_size) {}
+
+    std::optional<ElementHeader> read_header(uint64_t offset) const {
+        std::array<uint8_t, 12> buffer{};
+        ssize_t n = ::pread(fd_, buffer.data(), buffer.size(), static_cast<off_t>(offset));
+        ElementHeader header;
+        if (n <= 0 || !parse_header(buffer.data(), static_cast<size_t>(n), header)) {
+            return std::nullopt;
+        }
+        header.offset = offset;
+        return header;
+    }
+
+    bool read(uint64_t offset, uint64_t size, std::vector<uint8_t>& buffer) const {
+        if (offset + size > file_size_) {
+            return false;
+        }
+        buffer.resize(size);
+        size_t done = 0;
+        while (done < size) {
+            ssize_t n = ::pread(fd_, buffer.data() + done, size - done, static_cast<off_t>(offset + done));
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                return false;
+            }
+            done += static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    // Whole element (header included), for copying through unchanged
+    bool read_element(const ElementHeader& header, std::vector<uint8_t>& buffer) const {
+        return header.size <= kMaxHeaderElementBytes && read(header.offset, header.end() - header.offset, buffer);
+    }
+
+    // The cluster timestamp is the first child in practice; look a little way in
+    std::optional<uint64_t> cluster_timestamp(const ElementHeader& cluster) const {
+        std::vector<uint8_t> head;
+        uint64_t size = std::min<uint64_t>(64, file_size_ - cluster.data_offset());
+        if (!read(cluster.data_offset(), size, head)) {
+            return std::nullopt;
+        }
+
+        size_t offset = 0;
+        while (offset < head.size()) {
+            ElementHeader child;
+            if (!parse_header(head.data() + offset, head.size() - offset, child) || child.size == kUnknownSize) {
+                return std::nullopt;
+            }
+            if (child.id == kClusterTimestampId) {
+                if (offset + child.header_size + child.size > head.size()) {
+                    return std::nullopt;
+                }
+                return read_uint(head.data() + offset + child.header_size, child.size);
+            }
+            if (child.id != kCrc32Id && child.id != kVoidId) {
+                return std::nullopt;
+            }
+            offset += child.header_size + child.size;
+        }
+        return std::nullopt;
+    }
+
+    // Latest block timestamp in a cluster, relative to the cluster
+    int64_t last_block_offset(const ElementHeader& cluster) const {
+        std::vector<uint8_t> data;
+        if (cluster.size > kMaxClusterParseBytes || !read(cluster.data_offset(), cluster.size, data)) {
+            return 0;
+        }
+
+        int64_t latest = 0;
+        auto block_time = [&latest](const uint8_t* block, size_t size) {
+            size_t track_width = size > 0 ? vint_width(block[0]) : 0;
+            if (track_width == 0 || track_width + 2 > size) {
+                return;
+            }
+            auto relative = static_cast<int16_t>((block[track_width] << 8) | block[track_width + 1]);
+            latest = std::max<int64_t>(latest, relative);
+        };
+
+        for_each_child(data.data(), data.size(), [&](const ElementHeader& child, const uint8_t* payload) {
+            if (child.id == kSimpleBlockId) {
+                block_time(payload, child.size);
+            } else if (child.id == kBlockGroupId) {
+                for_each_child(payload, child.size, [&](const ElementHeader& inner, const uint8_t* block) {
+                    if (inner.id == kBlockId) {
+                        block_time(block, inner.size);
+                    }
+                });
+            }
+        });
+        return latest;
+    }
+
+    uint64_t file_size() const { return file_size_; }
+
+private:
+    int fd_;
+    uint64_t file_size_;
+};
+
+std::vector<CuePoint> parse_cues(const std::vector<uint8_t>& element, size_t header_size) {
+    std::vector<CuePoint> cues;
+    for_each_child(element.data() + header_size, element.size() - header_size,
+        [&](const ElementHeader& child, const uint8_t* payload) {
+            if (child.id != kCuePointId) {
+                return;
+            }
+            CuePoint cue;
+            for_each_child(payload, child.size, [&](const ElementHeader& field, const uint8_t* value) {
+                if (field.id == kCueTimeId) {
+                    cue.time = read_uint(value, field.size);
+                } else if (field.id == kCueTrackPositionsId) {
+                    CueTrackPosition position;
+                    for_each_child(value, field.size, [&](const ElementHeader& item, const uint8_t* data) {
+                        if (item.id == kCueTrackId) {
+                            position.track = read_uint(data, item.size);
+                        } else if (item.id == kCueClusterPositionId) {
+                            position.cluster_position = read_uint(data, item.size);
+                        } else if (item.id == kCueRelativePositionId) {
+                            position.relative_position = read_uint(data, item.size);
+                        }
+                    });
+                    cue.positions.push_back(position);
+                }
+            });
+            if (!cue.positions.empty()) {
+                cues.push_back(std::move(cue));
+            }
+        });
+
+    std::sort(cues.begin(), cues.end(), [](const CuePoint& a, const CuePoint& b) { return a.time < b.time; });
+    return cues;
+}
+
+} // namespace
+
+bool MkvCutter::is_matroska(const fs::path& path) {
+    ScopedFd fd(::open(path.c_str(), O_RDONLY | O_CLOEXEC));
+    struct stat st {};
+    if (!fd || ::fstat(fd.get(), &st) != 0) {
+        return false;
+    }
+
+    MkvReader reader(fd.get(), static_cast<uint64_t>(st.st_size));
+    auto ebml = reader.read_header(0);
+    std::vector<uint8_t> element;
+    if (!ebml || ebml->id != kEbmlId || ebml->size > 4096 || !reader.read_element(*ebml, element)) {
+        return false;
+    }
+
+    bool matroska = false;
+    for_each_child(element.data() + ebml->header_size, element.size() - ebml->header_size,
+        [&](const ElementHeader& child, const uint8_t* payload) {
+            if (child.id == kDocTypeId) {
+                std::string doc_type(reinterpret_cast<const char*>(payload), child.size);
+                matroska = doc_type == "matroska" || doc_type == "webm";
+            }
+        });
+    return matroska;
+}
+
+NativeCutPlan MkvCutter::plan(const fs::path& input_file, double start_seconds, double end_seconds) {
+    NativeCutPlan plan;
+    plan.input_file = input_file;
+
+    ScopedFd in(::open(input_file.c_str(), O_RDONLY | O_CLOEXEC));
+    struct stat st {};
+    if (!in || ::fstat(in.get(), &st) != 0) {
+        plan.error_message = "Cannot open input: " + input_file.string();
+        return plan;
+    }
+    MkvReader reader(in.get(), static_cast<uint64_t>(st.st_size));
+
+    auto ebml = reader.read_header(0);
+    std::vector<uint8_t> ebml_element;
+    if (!ebml || ebml->id != kEbmlId || !reader.read_element(*ebml, ebml_element)) {
+        plan.error_message = "Not a Matroska file";
+        return plan;
+    }
+
+    auto segment = reader.read_header(ebml->end());
+    if (!segment || segment->id != kSegmentId) {
+        plan.error_message = "No Matroska segment";
+        return plan;
+    }
+    uint64_t segment_data = segment->data_offset();
+    uint64_t segment_end = segment->size == kUnknownSize
+        ? reader.file_size()
+        : std::min(segment->end(), reader.file_size());
+
+    // Top-level elements up to the first cluster, plus anything the SeekHead
+    // places after the clusters (usually Cues)
+    std::optional<ElementHeader> info;
+    std::optional<ElementHeader> tracks;
+    std::optional<ElementHeader> chapters;
+    std::optional<ElementHeader> attachments;
+    std::optional<ElementHeader> cues;
+    std::optional<ElementHeader> first_cluster;
+
+    auto keep = [&](const ElementHeader& header) {
+        switch (header.id) {
+            case kInfoId: if (!info) info = header; break;
+            case kTracksId: if (!tracks) tracks = header; break;
+            case kChaptersId: if (!chapters) chapters = header; break;
+            case kAttachmentsId: if (!attachments) attachments = header; break;
+            case kCuesId: if (!cues) cues = header; break;
+            default: break;
+        }
+    };
+
+    std::vector<uint64_t> seek_positions;
+    for (uint64_t offset = segment_data; offset < segment_end;) {
+        auto header = reader.read_header(offset);
+        if (!header) {
+            break;
+        }
+        if (header->id == kClusterId) {
+            first_cluster = header;
+            break;
+        }
+        if (header->size == kUnknownSize) {
+            plan.error_message = "Unknown-size element before the first cluster";
+            return plan;
+        }
+
+        if (header->id == kSeekHeadId) {
+            std::vector<uint8_t> element;
+            if (reader.read_element(*header, element)) {
+                for_each_child(element.data() + header->header_size, element.size() - header->header_size,
+                    [&](const ElementHeader& seek, const uint8_t* payload) {
+                        if (seek.id != kSeekId) {
+                            return;
+                        }
+                        for_each_child(payload, seek.size, [&](const ElementHeader& field, const uint8_t* value) {
+                            if (field.id == kSeekPositionId) {
+                                seek_positions.push_back(segment_data + read_uint(value, field.size));
+                            }
+                        });
+                    });
+            }
+        }
+        keep(*header);
+        offset = header->end();
+    }
+
+    if (!info || !tracks || !first_cluster) {
+        plan.error_message = "Missing segment info, tracks or clusters";
+        return plan;
+    }
+    for (uint64_t position : seek_positions) {
+        if (position >= first_cluster->offset) {
+            if (auto header = reader.read_header(position)) {
+                keep(*header);
+            }
+        }
+    }
+
+    std::vector<uint8_t> info_element;
+    if (!reader.read_element(*info, info_element)) {
+        plan.error_message = "Cannot read segment info";
+        return plan;
+    }
+    uint64_t timestamp_scale = kDefaultTimestampScale;
+    for_each_child(info_element.data() + info->header_size, info_element.size() - info->header_size,
+        [&](const ElementHeader& child, const uint8_t* payload) {
+            if (child.id == kTimestampScaleId) {
+                timestamp_scale = std::max<uint64_t>(read_uint(payload, child.size), 1);
+            }
+        });
+    auto to_ticks = [timestamp_scale](double seconds) {
+        return static_cast<uint64_t>(std::max(0.0, seconds) * 1e9 / static_cast<double>(timestamp_scale));
+    };
+    auto to_seconds = [timestamp_scale](uint64_t ticks) {
+        return static_cast<double>(ticks) * static_cast<double>(timestamp_scale) / 1e9;
+    };
+
+    std::vector<CuePoint> cue_points;
+    if (cues) {
+        std::vector<uint8_t> cues_element;
+        if (reader.read_element(*cues, cues_element)) {
+            cue_points = parse_cues(cues_element, cues->header_size);
+        }
+    }
+
+    // Start cluster: straight from the cues when we have them, otherwise the
+    // last cluster that starts at or before the start time
+    ElementHeader start_cluster = *first_cluster;
+    uint64_t start_ticks = to_ticks(start_seconds);
+    if (start_seconds > 0) {
+        bool found = false;
+        for (auto it = cue_points.rbegin(); it != cue_points.rend() && !found; ++it) {
+            if (it->time > start_ticks) {
+                continue;
+            }
+            auto header = reader.read_header(segment_data + it->positions.front().cluster_position);
+            if (header && header->id == kClusterId && header->size != kUnknownSize) {
+                start_cluster = *header;
+                found = true;
+            }
+        }
+
+        for (uint64_t offset = first_cluster->offset; !found && offset < segment_end;) {
+            auto header = reader.read_header(offset);
+            if (!header || header->id != kClusterId || header->size == kUnknownSize) {
+                break;
+            }
+            auto timestamp = reader.cluster_timestamp(*header);
+            if (!timestamp || *timestamp > start_ticks) {
+                break;
+            }
+            start_cluster = *header;
+            offset = header->end();
+        }
+    }
+
+    // Walk cluster headers to the first one that starts after the end time
+    auto first_timestamp = reader.cluster_timestamp(start_cluster);
+    if (!first_timestamp || start_cluster.size == kUnknownSize) {
+        plan.error_message = "Clusters without size or timestamp (live recording?)";
+        return plan;
+    }
+    uint64_t end_ticks = end_seconds > start_seconds ? to_ticks(end_seconds) : ~0ULL;
+    ElementHeader last_cluster = start_cluster;
+    uint64_t last_timestamp = *first_timestamp;
+    uint64_t range_end = start_cluster.end();
+    bool to_end = true;
+
+    for (uint64_t offset = start_cluster.end(); offset < segment_end;) {
+        auto header = reader.read_header(offset);
+        if (!header || header->size == kUnknownSize) {
+            break;
+        }
+        if (header->id == kVoidId) {
+            offset = header->end();
+            continue;
+        }
+        if (header->id != kClusterId) {
+            break;
+        }
+        auto timestamp = reader.cluster_timestamp(*header);
+        if (!timestamp) {
+            break;
+        }
+        if (*timestamp > end_ticks) {
+            to_end = false;
+            break;
+        }
+        last_cluster = *header;
+        last_timestamp = *timestamp;
+        range_end = header->end();
+        offset = header->end();
+    }
+    range_end = std::min(range_end, segment_end);
+
+    uint64_t last_ticks = last_timestamp + static_cast<uint64_t>(std::max<int64_t>(0, reader.last_block_offset(last_cluster)));
+    plan.start_seconds = to_seconds(*first_timestamp);
+    plan.end_seconds = to_end ? 0.0 : to_seconds(last_ticks);
+
+    // Rewritten header: info with the new duration, then everything else
+    // readers need before the first cluster
+    std::vector<uint8_t> info_payload;
+    for_each_child(info_element.data() + info->header_size, info_element.size() - info->header_size,
+        [&](const ElementHeader& child, const uint8_t* payload) {
+            if (child.id == kDurationId || child.id == kCrc32Id || child.id == kVoidId) {
+                return;
+            }
+            const uint8_t* begin = payload - child.header_size;
+            info_payload.insert(info_payload.end(), begin, payload + child.size);
+        });
+    put_float(info_payload, kDurationId, static_cast<double>(last_ticks - *first_timestamp));
+
+    std::vector<uint8_t> head;
+    put_element(head, kInfoId, info_payload);
+    for (const auto& element : {tracks, chapters, attachments}) {
+        std::vector<uint8_t> bytes;
+        if (element && reader.read_element(*element, bytes)) {
+            head.insert(head.end(), bytes.begin(), bytes.end());
+        }
+    }
+
+    // Cues kept, with positions relative to the first copied cluster
+    struct KeptCue {
+        uint64_t time;
+        std::vector<CueTrackPosition> positions;
+    };
+    std::vector<KeptCue> kept_cues;
+    for (const auto& cue : cue_points) {
+        KeptCue kept{cue.time, {}};
+        for (const auto& position : cue.positions) {
+            uint64_t source = segment_data + position.cluster_position;
+            if (source >= start_cluster.offset && source < range_end) {
+                kept.positions.push_back(position);
+                kept.positions.back().cluster_position = source - start_cluster.offset;
+            }
+        }
+        if (!kept.positions.empty()) {
+            kept_cues.push_back(std::move(kept));
+        }
+    }
+
+    // Cue entries use fixed-width values, so their size is known before the
+    // cluster positions they point at
+    auto build_cues = [kept_cues](uint64_t clusters_position) {
+        std::vector<uint8_t> payload;
+        for (const auto& cue : kept_cues) {
+            std::vector<uint8_t> point;
+            put_uint(point, kCueTimeId, cue.time);
+            for (const auto& position : cue.positions) {
+                std::vector<uint8_t> track;
+                put_uint(track, kCueTrackId, position.track);
+                put_uint(track, kCueClusterPositionId, clusters_position + position.cluster_position);
+                if (position.relative_position) {
+                    put_uint(track, kCueRelativePositionId, *position.relative_position);
+                }
+                put_element(point, kCueTrackPositionsId, track);
+            }
+            put_element(payload, kCuePointId, point);
+        }
+        std::vector<uint8_t> element;
+        if (!payload.empty()) {
+            put_element(element, kCuesId, payload);
+        }
+        return element;
+    };
+
+    constexpr uint64_t kSegmentHeaderSize = 12;  // 4-byte ID, 8-byte size
+    uint64_t cluster_bytes = range_end - start_cluster.offset;
+    uint64_t cues_size = build_cues(0).size();
+    uint64_t fixed_size = ebml_element.size() + kSegmentHeaderSize + head.size();
+
+    // Padding is a Void element after the cues. When the cues don't fit
+    // (rewriting a header in place) they are left out and players index the
+    // file themselves.
+    plan.min_prefix_size = fixed_size + cues_size;
+    plan.build_prefix = [ebml_element, head, build_cues, cues_size, fixed_size, cluster_bytes](uint64_t size) {
+        for (bool with_cues : {true, false}) {
+            uint64_t used = fixed_size + (with_cues ? cues_size : 0);
+            if (size < used || size - used == 1) {
+                continue;
+            }
+            uint64_t segment_size = size - ebml_element.size() - kSegmentHeaderSize + cluster_bytes;
+            uint64_t clusters_position = size - ebml_element.size() - kSegmentHeaderSize;
+
+            std::vector<uint8_t> prefix = ebml_element;
+            prefix.reserve(size);
+            put_id(prefix, kSegmentId);
+            put_size(prefix, segment_size);
+            prefix.insert(prefix.end(), head.begin(), head.end());
+            if (with_cues) {
+                auto cues = build_cues(clusters_position);
+                prefix.insert(prefix.end(), cues.begin(), cues.end());
+            }
+            put_void(prefix, size - used);
+            return prefix;
+        }
+        return std::vector<uint8_t>();
+    };
+
+    plan.range_offset = start_cluster.offset;
+    plan.range_length = cluster_bytes;
+    plan.ok = true;
+    return plan;
+}
+
+NativeCutResult MkvCutter::cut(
+    const fs::path& input_file,
+    const fs::path& output_file,
+    double start_seconds,
+    double end_seconds,
+    const NativeCutProgress& progress_cb
+) {
+    return plan(input_file, start_seconds, end_seconds).copy_to(output_file, progress_cb);
+}
+
+} // namespace trimora
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "native_cut.hpp"
+#include <filesystem>
+
+namespace trimora {
+
+// Cluster-level Matroska/WebM trimming without a demux/remux pass. The Cues
+// index (or a walk over cluster headers when there is none) picks the
+// cluster holding the keyframe at or before the start time; clusters are
+// then copied unchanged up to the first one past the end time. Only the
+// header is rewritten: segment info with the new duration, tracks, chapters
+// and attachments as they were, and cues pointing into the copied clusters.
+// Block timestamps are left as-is, so the output keeps the source timeline.
+class MkvCutter {
+public:
+    // EBML header with a matroska or webm DocType
+    static bool is_matroska(const std::filesystem::path& path);
+
+    // Where the cut lands and what goes in front of it; nothing is written
+    static NativeCutPlan plan(const std::filesystem::path& input_file, double start_seconds, double end_seconds);
+
+    static NativeCutResult cut(
+        const std::filesystem::path& input_file,
+        const std::filesystem::path& output_file,
+        double start_seconds,
+        double end_seconds,
+        const NativeCutProgress& progress_cb = {}
+    );
+};
+
+} // namespace trimora
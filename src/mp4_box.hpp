@@ -0,0 +1,92 @@
+#pragma once
+
+#include <optional>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace trimora {
+namespace mp4 {
+
+// ISO-BMFF box primitives shared by the fragmented-MP4 cutter, the
+// metadata editor and mp4::Reader
+
+constexpr uint32_t fourcc(const char (&code)[5]) {
+    return (static_cast<uint32_t>(static_cast<uint8_t>(code[0])) << 24) |
+           (static_cast<uint32_t>(static_cast<uint8_t>(code[1])) << 16) |
+           (static_cast<uint32_t>(static_cast<uint8_t>(code[2])) << 8) |
+           static_cast<uint32_t>(static_cast<uint8_t>(code[3]));
+}
+
+struct Box {
+    uint32_t type = 0;
+    uint64_t offset = 0;
+    uint64_t size = 0;  // Whole box, header included
+    size_t header_size = 0;
+
+    uint64_t end() const { return offset + size; }
+};
+
+inline uint64_t read_be(const uint8_t* p, size_t bytes) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < bytes; ++i) {
+        value = (value << 8) | p[i];
+    }
+    return value;
+}
+
+inline void write_be(uint8_t* p, size_t bytes, uint64_t value) {
+    for (size_t i = 0; i < bytes; ++i) {
+        p[bytes - 1 - i] = static_cast<uint8_t>(value >> (i * 8));
+    }
+}
+
+inline std::optional<Box> parse_box(const uint8_t* p, size_t available, uint64_t offset, uint64_t limit) {
+    if (available < 8) {
+        return std::nullopt;
+    }
+    Box box;
+    box.offset = offset;
+    box.type = static_cast<uint32_t>(read_be(p + 4, 4));
+    box.size = read_be(p, 4);
+    box.header_size = 8;
+    if (box.size == 1) {
+        if (available < 16) {
+            return std::nullopt;
+        }
+        box.size = read_be(p + 8, 8);
+        box.header_size = 16;
+    } else if (box.size == 0) {
+        box.size = limit - offset;  // Runs to the end of the file
+    }
+    if (box.size < box.header_size || offset + box.size > limit) {
+        return std::nullopt;
+    }
+    return box;
+}
+
+// Children of an in-memory container box; offsets are relative to data
+inline std::vector<Box> child_boxes(const uint8_t* data, size_t size) {
+    std::vector<Box> boxes;
+    for (uint64_t offset = 0; offset < size;) {
+        auto box = parse_box(data + offset, size - offset, offset, size);
+        if (!box) {
+            break;
+        }
+        boxes.push_back(*box);
+        offset = box->end();
+    }
+    return boxes;
+}
+
+inline std::optional<Box> find_child(const uint8_t* data, size_t size, uint32_t type) {
+    for (const auto& box : child_boxes(data, size)) {
+        if (box.type == type) {
+            return box;
+        }
+    }
+    return std::nullopt;
+}
+
+} // namespace mp4
+} // namespace trimora
@@ -0,0 +1,477 @@
+#include "mp4_metadata.hpp"
+#include "mp4_box.hpp"
+#include "mp4_reader.hpp"
+#include "scoped_fd.hpp"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+
+namespace fs = std::filesystem;
+
+namespace trimora {
+
+namespace {
+
+using mp4::Box;
+using mp4::fourcc;
+using mp4::read_be;
+using mp4::write_be;
+
+constexpr uint64_t kMaxMoovBytes = 64 * 1024 * 1024;
+constexpr uint64_t kMp4EpochOffset = 2082844800;  // 1904-01-01 to 1970-01-01
+constexpr uint32_t kTitleType = fourcc("\xA9nam");
+
+using Bytes = std::vector<uint8_t>;
+
+Bytes make_box(uint32_t type, const Bytes& payload) {
+    Bytes box;
+    box.reserve(8 + payload.size());
+    box.resize(8);
+    write_be(box.data(), 4, 8 + payload.size());
+    write_be(box.data() + 4, 4, type);
+    box.insert(box.end(), payload.begin(), payload.end());
+    return box;
+}
+
+Bytes free_box_header(uint64_t size) {
+    Bytes header(8);
+    write_be(header.data(), 4, size);
+    write_be(header.data() + 4, 4, fourcc("free"));
+    return header;
+}
+
+// Box sizes are rewritten with 32-bit headers, so moov can't pass 4 GB
+// (it is kilobytes to a few megabytes in practice)
+struct View {
+    const uint8_t* data;
+    Box box;
+
+    const uint8_t* payload() const { return data + box.header_size; }
+    size_t payload_size() const { return box.size - box.header_size; }
+};
+
+// meta is a full box in MP4 but a plain container in some QuickTime files;
+// the children start right away when the first one is the handler
+size_t meta_prefix(const View& meta) {
+    if (meta.payload_size() >= 8 && read_be(meta.payload() + 4, 4) == fourcc("hdlr")) {
+        return 0;
+    }
+    return 4;
+}
+
+// A copy of a container with one child replaced, appended when missing, or
+// removed when the replacement is empty. prefix is the bytes between the
+// header and the first child (version and flags of a full box).
+Bytes with_child(const View& container, size_t prefix, uint32_t type, const Bytes& replacement) {
+    Bytes payload(container.payload(), container.payload() + prefix);
+    const uint8_t* children = container.payload() + prefix;
+    bool replaced = false;
+    for (const auto& child : mp4::child_boxes(children, container.payload_size() - prefix)) {
+        if (child.type == type && !replaced) {
+            payload.insert(payload.end(), replacement.begin(), replacement.end());
+            replaced = true;
+            continue;
+        }
+        payload.insert(payload.end(), children + child.offset, children + child.end());
+    }
+    if (!replaced) {
+        payload.insert(payload.end(), replacement.begin(), replacement.end());
+    }
+    return make_box(container.box.type, payload);
+}
+
+std::optional<View> child_view(const uint8_t* data, size_t size, uint32_t type) {
+    auto box = mp4::find_child(data, size, type);
+    if (!box) {
+        return std::nullopt;
+    }
+    return View{data + box->offset, Box{box->type, 0, box->size, box->header_size}};
+}
+
+View whole_view(const Bytes& bytes) {
+    auto box = mp4::parse_box(bytes.data(), bytes.size(), 0, bytes.size());
+    return View{bytes.data(), *box};
+}
+
+Bytes set_title(const Bytes& moov, const std::string& title) {
+    View moov_view = whole_view(moov);
+
+    Bytes udta = make_box(fourcc("udta"), {});
+    if (auto existing = child_view(moov_view.payload(), moov_view.payload_size(), fourcc("udta"))) {
+        udta.assign(existing->data, existing->data + existing->box.size);
+    }
+    View udta_view = whole_view(udta);
+
+    // iTunes-style metadata: meta (handler mdir) holding ilst
+    Bytes meta;
+    if (auto existing = child_view(udta_view.payload(), udta_view.payload_size(), fourcc("meta"))) {
+        meta.assign(existing->data, existing->data + existing->box.size);
+    } else {
+        Bytes hdlr_payload(25, 0);
+        write_be(hdlr_payload.data() + 8, 4, fourcc("mdir"));
+        write_be(hdlr_payload.data() + 12, 4, fourcc("appl"));
+        Bytes meta_payload(4, 0);
+        Bytes hdlr = make_box(fourcc("hdlr"), hdlr_payload);
+        meta_payload.insert(meta_payload.end(), hdlr.begin(), hdlr.end());
+        meta = make_box(fourcc("meta"), meta_payload);
+    }
+    View meta_view = whole_view(meta);
+    size_t prefix = meta_prefix(meta_view);
+
+    Bytes ilst = make_box(fourcc("ilst"), {});
+    if (auto existing = child_view(meta_view.payload() + prefix, meta_view.payload_size() - prefix, fourcc("ilst"))) {
+        ilst.assign(existing->data, existing->data + existing->box.size);
+    }
+
+    Bytes entry;
+    if (!title.empty()) {
+        Bytes data_payload(8, 0);
+        write_be(data_payload.data(), 4, 1);  // Well-known type: UTF-8
+        data_payload.insert(data_payload.end(), title.begin(), title.end());
+        entry = make_box(kTitleType, make_box(fourcc("data"), data_payload));
+    }
+
+    ilst = with_child(whole_view(ilst), 0, kTitleType, entry);
+    meta = with_child(meta_view, prefix, fourcc("ilst"), ilst);
+    udta = with_child(udta_view, 0, fourcc("meta"), meta);
+    return with_child(moov_view, 0, fourcc("udta"), udta);
+}
+
+// Display matrix for a clockwise rotation, as FFmpeg writes it: the
+// translation moves the rotated picture back into the frame. width and
+// height are the track's, 16.16 fixed point like the translation.
+void write_rotation_matrix(uint8_t* matrix, int rotation, int64_t width, int64_t height) {
+    constexpr int64_t one = 0x10000;
+    int64_t a = one, b = 0, c = 0, d = one, tx = 0, ty = 0;
+    switch (((rotation % 360) + 360) % 360) {
+        case 90:  a = 0;    b = one;  c = -one; d = 0;    tx = height; break;
+        case 180: a = -one; b = 0;    c = 0;    d = -one; tx = width; ty = height; break;
+        case 270: a = 0;    b = -one; c = one;  d = 0;    ty = width; break;
+        default: break;
+    }
+    const int64_t values[9] = {a, b, 0, c, d, 0, tx, ty, 0x40000000};
+    for (int i = 0; i < 9; ++i) {
+        write_be(matrix + i * 4, 4, static_cast<uint32_t>(static_cast<int32_t>(values[i])));
+    }
+}
+
+// Creation and modification time sit first in mvhd, tkhd and mdhd
+bool write_times(uint8_t* fields, size_t size, uint64_t time) {
+    if (size < 4) {
+        return false;
+    }
+    bool wide = fields[0] == 1;
+    size_t width = wide ? 8 : 4;
+    if (size < 4 + 2 * width || (!wide && time > 0xffffffffu)) {
+        return false;
+    }
+    write_be(fields + 4, width, time);
+    write_be(fields + 4 + width, width, time);
+    return true;
+}
+
+// Fixed-size fields are patched directly in the moov copy
+bool patch_fixed_fields(Bytes& moov, const Mp4MetadataEdit& edit, std::optional<uint64_t> time, std::string& error) {
+    View moov_view = whole_view(moov);
+    uint8_t* base = moov.data() + moov_view.box.header_size;
+    size_t size = moov_view.payload_size();
+    bool rotated = false;
+
+    for (const auto& box : mp4::child_boxes(base, size)) {
+        uint8_t* payload = base + box.offset + box.header_size;
+        size_t payload_size = box.size - box.header_size;
+
+        if (box.type == fourcc("mvhd") && time && !write_times(payload, payload_size, *time)) {
+            error = "Creation time does not fit this file's 32-bit header";
+            return false;
+        }
+        if (box.type != fourcc("trak")) {
+            continue;
+        }
+
+        auto tkhd = mp4::find_child(payload, payload_size, fourcc("tkhd"));
+        auto mdia = mp4::find_child(payload, payload_size, fourcc("mdia"));
+        // Version and flags come first; a shorter tkhd has nothing to patch
+        if (!tkhd || !mdia || tkhd->size < tkhd->header_size + 4) {
+            continue;
+        }
+        uint8_t* tkhd_fields = payload + tkhd->offset + tkhd->header_size;
+        size_t tkhd_size = tkhd->size - tkhd->header_size;
+        uint8_t* mdia_data = payload + mdia->offset + mdia->header_size;
+        size_t mdia_size = mdia->size - mdia->header_size;
+
+        if (time) {
+            auto mdhd = mp4::find_child(mdia_data, mdia_size, fourcc("mdhd"));
+            if (!write_times(tkhd_fields, tkhd_size, *time) ||
+                (mdhd && !write_times(mdia_data + mdhd->offset + mdhd->header_size, mdhd->size - mdhd->header_size, *time))) {
+                error = "Creation time does not fit this file's 32-bit header";
+                return false;
+            }
+        }
+
+        if (edit.rotation) {
+            auto hdlr = mp4::find_child(mdia_data, mdia_size, fourcc("hdlr"));
+            bool is_video = hdlr && hdlr->size >= hdlr->header_size + 12 &&
+                            read_be(mdia_data + hdlr->offset + hdlr->header_size + 8, 4) == fourcc("vide");
+            // The matrix is followed by the track width and height
+            size_t matrix_offset = 4 + (tkhd_fields[0] == 1 ? 32 : 20) + 16;
+            if (is_video && tkhd_size >= matrix_offset + 44) {
+                const uint8_t* dimensions = tkhd_fields + matrix_offset + 36;
+                write_rotation_matrix(tkhd_fields + matrix_offset, *edit.rotation,
+                                      static_cast<int64_t>(read_be(dimensions, 4)),
+                                      static_cast<int64_t>(read_be(dimensions + 4, 4)));
+                rotated = true;
+            }
+        }
+    }
+
+    if (edit.rotation && !rotated) {
+        error = "No video track to rotate";
+        return false;
+    }
+    return true;
+}
+
+bool pwrite_all(int fd, const uint8_t* data, size_t size, uint64_t offset) {
+    while (size > 0) {
+        ssize_t n = ::pwrite(fd, data, size, static_cast<off_t>(offset));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+        offset += static_cast<uint64_t>(n);
+    }
+    return true;
+}
+
+} // namespace
+
+std::optional<uint64_t> Mp4MetadataEditor::parse_creation_time(const std::string& text) {
+    struct tm tm {};
+    int consumed = 0;
+    if (std::sscanf(text.c_str(), "%4d-%2d-%2d%n", &tm.tm_year, &tm.tm_mon, &tm.tm_mday, &consumed) != 3) {
+        return std::nullopt;
+    }
+    const char* rest = text.c_str() + consumed;
+    if (*rest == ' ' || *rest == 'T') {
+        int time_consumed = 0;
+        if (std::sscanf(rest + 1, "%2d:%2d:%2d%n", &tm.tm_hour, &tm.tm_min, &tm.tm_sec, &time_consumed) != 3) {
+            return std::nullopt;
+        }
+        rest += 1 + time_consumed;
+    }
+    if (*rest == 'Z') {
+        ++rest;
+    }
+    if (*rest != '\0' || tm.tm_year < 1904 || tm.tm_mon < 1 || tm.tm_mon > 12 || tm.tm_mday < 1 ||
+        tm.tm_mday > 31 || tm.tm_hour > 23 || tm.tm_min > 59 || tm.tm_sec > 60) {
+        return std::nullopt;
+    }
+
+    tm.tm_year -= 1900;
+    tm.tm_mon -= 1;
+    time_t unix_time = ::timegm(&tm);
+    if (unix_time + static_cast<int64_t>(kMp4EpochOffset) < 0) {
+        return std::nullopt;
+    }
+    return static_cast<uint64_t>(unix_time + static_cast<int64_t>(kMp4EpochOffset));
+}
+
+Mp4MetadataResult Mp4MetadataEditor::apply(const fs::path& file, const Mp4MetadataEdit& edit) {
+    Mp4MetadataResult result;
+    result.file = file;
+
+    if (edit.rotation && *edit.rotation % 90 != 0) {
+        result.error_message = "Rotation must be 0, 90, 180 or 270";
+        return result;
+    }
+    std::optional<uint64_t> time;
+    if (edit.creation_time) {
+        time = parse_creation_time(*edit.creation_time);
+        if (!time) {
+            result.error_message = "Invalid creation time: " + *edit.creation_time;
+            return result;
+        }
+    }
+
+    ScopedFd fd(::open(file.c_str(), O_RDWR | O_CLOEXEC));
+    struct stat st {};
+    if (!fd || ::fstat(fd.get(), &st) != 0) {
+        result.error_message = "Cannot open " + file.string() + ": " + std::strerror(errno);
+        return result;
+    }
+    if (::flock(fd.get(), LOCK_EX | LOCK_NB) != 0) {
+        result.error_message = "File is locked by another process";
+        return result;
+    }
+
+    // Top level: moov, the box right after it, and any box running to EOF.
+    // The mapping is only read here, before anything is written or cut.
+    std::optional<Box> moov_box;
+    std::optional<Box> after_moov;
+    std::optional<Box> open_ended;
+    Bytes old_moov;
+    {
+        mp4::Reader reader(fd.get(), file.string());
+        if (!reader) {
+            result.error_message = reader.error_message();
+            return result;
+        }
+        uint64_t offset = 0;
+        for (const auto& box : reader.top_level()) {
+            if (moov_box && !after_moov) {
+                after_moov = box.box();
+            }
+            if (box.type() == fourcc("moov")) {
+                if (moov_box) {
+                    result.error_message = "More than one moov box";
+                    return result;
+                }
+                moov_box = box.box();
+            }
+            if (read_be(reader.data() + box.offset(), 4) == 0) {
+                open_ended = box.box();
+            }
+            offset = box.box().end();
+        }
+        if (offset < reader.size()) {
+            result.error_message = "Malformed box at offset " + std::to_string(offset);
+            return result;
+        }
+        if (!moov_box) {
+            result.error_message = "No moov box (not an MP4/MOV file?)";
+            return result;
+        }
+        if (moov_box->size > kMaxMoovBytes) {
+            result.error_message = "moov is unexpectedly large";
+            return result;
+        }
+        const uint8_t* moov_bytes = reader.data() + moov_box->offset;
+        old_moov.assign(moov_bytes, moov_bytes + moov_box->size);
+    }
+    Bytes moov = old_moov;
+    if (moov_box->header_size != 8) {
+        // Normalise to a 32-bit header so rebuilt sizes are consistent
+        moov.erase(moov.begin() + 8, moov.begin() + 16);
+        write_be(moov.data(), 4, moov.size());
+    }
+
+    if (!patch_fixed_fields(moov, edit, time, result.error_message)) {
+        return result;
+    }
+    if (edit.title) {
+        moov = set_title(moov, *edit.title);
+    }
+    if (moov == old_moov) {
+        result.ok = true;
+        result.method = Mp4MetadataResult::Method::InPlace;
+        return result;
+    }
+
+    // Room at moov's own place: itself plus a following free/skip box, or
+    // anything up to EOF when it is the last box
+    bool is_last = !after_moov;
+    bool free_follows = after_moov && (after_moov->type == fourcc("free") || after_moov->type == fourcc("skip"));
+    uint64_t room = moov_box->size + (free_follows ? after_moov->size : 0);
+
+    if (is_last) {
+        if (!pwrite_all(fd.get(), moov.data(), moov.size(), moov_box->offset) ||
+            ::ftruncate(fd.get(), static_cast<off_t>(moov_box->offset + moov.size())) != 0) {
+            result.error_message = std::string("Write failed: ") + std::strerror(errno);
+            return result;
+        }
+        result.method = Mp4MetadataResult::Method::InPlace;
+    } else if (moov.size() == room || (moov.size() + 8 <= room && room - moov.size() <= 0xffffffffu)) {
+        // moov then a free box covering what's left of the old space
+        Bytes block = moov;
+        if (moov.size() < room) {
+            Bytes padding = free_box_header(room - moov.size());
+            block.insert(block.end(), padding.begin(), padding.end());
+        }
+        if (!pwrite_all(fd.get(), block.data(), block.size(), moov_box->offset)) {
+            result.error_message = std::string("Write failed: ") + std::strerror(errno);
+            return result;
+        }
+        result.method = Mp4MetadataResult::Method::InPlace;
+    } else {
+        // Doesn't fit: append the new moov and free the old one. mdat stays
+        // where it is, so chunk offsets need no change. A box sized "to end
+        // of file" would swallow the appended moov; give it a real size.
+        if (open_ended) {
+            if (open_ended->header_size != 8 || open_ended->size > 0xffffffffu) {
+                result.error_message = "Last box has no size and is too large to fix; can't append moov";
+                return result;
+            }
+            Bytes size_field(4);
+            write_be(size_field.data(), 4, open_ended->size);
+            if (!pwrite_all(fd.get(), size_field.data(), 4, open_ended->offset)) {
+                result.error_message = std::string("Write failed: ") + std::strerror(errno);
+                return result;
+            }
+        }
+
+        // New moov durable before the old one is retired; until then
+        // readers still find the old, complete one first
+        Bytes free_type(4);
+        write_be(free_type.data(), 4, fourcc("free"));
+        if (!pwrite_all(fd.get(), moov.data(), moov.size(), static_cast<uint64_t>(st.st_size)) ||
+            ::fdatasync(fd.get()) != 0 ||
+            !pwrite_all(fd.get(), free_type.data(), 4, moov_box->offset + 4)) {
+            result.error_message = std::string("Write failed: ") + std::strerror(errno);
+            return result;
+        }
+        result.method = Mp4MetadataResult::Method::Relocated;
+    }
+
+    if (::fsync(fd.get()) != 0) {
+        result.error_message = std::string("fsync failed: ") + std::strerror(errno);
+        return result;
+    }
+    result.ok = true;
+    return result;
+}
+
+std::vector<Mp4MetadataResult> Mp4MetadataEditor::apply_batch(
+    const std::vector<fs::path>& files,
+    const Mp4MetadataEdit& edit,
+    size_t worker_count,
+    const std::function<void(const Mp4MetadataResult&)>& on_done
+) {
+    std::vector<Mp4MetadataResult> results(files.size());
+    std::atomic<size_t> next{0};
+
+    // Each file costs a few small reads and one small write, so throughput
+    // comes from keeping several in flight
+    auto work = [&]() {
+        for (size_t i = next++; i < files.size(); i = next++) {
+            results[i] = apply(files[i], edit);
+            if (on_done) {
+                on_done(results[i]);
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    size_t count = std::min(std::max<size_t>(worker_count, 1), files.size());
+    for (size_t i = 1; i < count; ++i) {
+        workers.emplace_back(work);
+    }
+    work();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    return results;
+}
+
+} // namespace trimora
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <optional>
+#include <functional>
+#include <filesystem>
+#include <cstdint>
+
+namespace trimora {
+
+// Metadata changes for finished MP4/MOV files. Unset fields are left alone.
+struct Mp4MetadataEdit {
+    std::optional<int> rotation;               // Display rotation, degrees clockwise: 0, 90, 180, 270
+    std::optional<std::string> title;          // Empty removes the title
+    std::optional<std::string> creation_time;  // UTC, "YYYY-MM-DD[ HH:MM:SS]" or ISO 8601
+
+    bool empty() const { return !rotation && !title && !creation_time; }
+};
+
+struct Mp4MetadataResult {
+    enum class Method {
+        None,        // Failed before writing
+        InPlace,     // moov rewritten where it was, padding absorbed the size change
+        Relocated    // New moov appended, the old one turned into free space
+    };
+
+    std::filesystem::path file;
+    bool ok = false;
+    std::string error_message;
+    Method method = Method::None;
+};
+
+// Patches moov without touching media data: the tkhd matrix for rotation,
+// mvhd/tkhd/mdhd times for the creation date, and the iTunes-style
+// udta/meta/ilst title. The rebuilt moov goes back in its old place when
+// it fits there (taking from or leaving a free box), otherwise it is
+// appended to the file and the old one becomes a free box, so chunk offsets
+// stay valid either way. Only moov is ever written.
+class Mp4MetadataEditor {
+public:
+    static Mp4MetadataResult apply(const std::filesystem::path& file, const Mp4MetadataEdit& edit);
+
+    // Patches files on worker threads; results come back in input order.
+    // on_done, if set, is called from the workers as each file finishes.
+    static std::vector<Mp4MetadataResult> apply_batch(
+        const std::vector<std::filesystem::path>& files,
+        const Mp4MetadataEdit& edit,
+        size_t worker_count = 8,
+        const std::function<void(const Mp4MetadataResult&)>& on_done = {}
+    );
+
+    // Seconds since 1904-01-01 UTC, the MP4 epoch
+    static std::optional<uint64_t> parse_creation_time(const std::string& text);
+};
+
+} // namespace trimora
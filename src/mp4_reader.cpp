@@ -0,0 +1,305 @@
+#include "mp4_reader.hpp"
+#include "scoped_fd.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace fs = std::filesystem;
+
+namespace trimora {
+namespace mp4 {
+
+namespace {
+
+// Version/flags and entry count in front of every sample table
+constexpr size_t kTableHeader = 8;
+
+// Entries of a full box laid out as version/flags, count, records
+std::optional<TableView> full_box_table(const BoxRef& box, size_t stride) {
+    if (box.payload_size() < kTableHeader) {
+        return std::nullopt;
+    }
+    auto count = static_cast<uint32_t>(read_be(box.payload() + 4, 4));
+    return TableView(box.payload() + kTableHeader, box.payload_size() - kTableHeader, count, stride);
+}
+
+} // namespace
+
+BoxRange BoxRef::children(size_t skip) const {
+    uint64_t begin = box_.offset + box_.header_size + std::min<uint64_t>(skip, payload_size());
+    return BoxRange(base_, begin, box_.end());
+}
+
+std::optional<BoxRef> BoxRef::child(uint32_t type, size_t skip) const {
+    return children(skip).find(type);
+}
+
+std::optional<BoxRef> BoxRef::descend(std::initializer_list<uint32_t> path) const {
+    std::optional<BoxRef> box = *this;
+    for (uint32_t type : path) {
+        box = box->child(type);
+        if (!box) {
+            break;
+        }
+    }
+    return box;
+}
+
+BoxRange::iterator::iterator(const uint8_t* base, uint64_t offset, uint64_t limit)
+    : base_(base), offset_(offset), limit_(limit), at_end_(false) {
+    parse();
+}
+
+BoxRange::iterator& BoxRange::iterator::operator++() {
+    offset_ = current_.box().end();
+    parse();
+    return *this;
+}
+
+void BoxRange::iterator::parse() {
+    if (offset_ >= limit_) {
+        at_end_ = true;
+        return;
+    }
+    // parse_box sees at most the 16 header bytes, never more of the mapping
+    auto box = parse_box(base_ + offset_, static_cast<size_t>(std::min<uint64_t>(limit_ - offset_, 16)),
+                         offset_, limit_);
+    if (!box) {
+        at_end_ = true;
+        return;
+    }
+    current_ = BoxRef(*box, base_);
+}
+
+std::optional<BoxRef> BoxRange::find(uint32_t type) const {
+    for (const auto& box : *this) {
+        if (box.type() == type) {
+            return box;
+        }
+    }
+    return std::nullopt;
+}
+
+TableView::TableView(const uint8_t* entries, uint64_t available, uint32_t count, size_t stride)
+    : entries_(entries),
+      count_(static_cast<uint32_t>(std::min<uint64_t>(count, available / stride))),
+      stride_(stride) {
+}
+
+std::optional<SampleSizes> SampleSizes::parse(const BoxRef& box) {
+    if (box.payload_size() < 12) {
+        return std::nullopt;
+    }
+    const uint8_t* p = box.payload();
+    uint64_t available = box.payload_size() - 12;
+    SampleSizes sizes;
+    sizes.count_ = static_cast<uint32_t>(read_be(p + 8, 4));
+    sizes.entries_ = p + 12;
+
+    if (box.type() == fourcc("stsz")) {
+        sizes.constant_size_ = static_cast<uint32_t>(read_be(p + 4, 4));
+        if (sizes.constant_size_ == 0) {
+            sizes.count_ = static_cast<uint32_t>(std::min<uint64_t>(sizes.count_, available / 4));
+        }
+        return sizes;
+    }
+    if (box.type() == fourcc("stz2")) {
+        sizes.field_bits_ = p[7];
+        if (sizes.field_bits_ != 4 && sizes.field_bits_ != 8 && sizes.field_bits_ != 16) {
+            return std::nullopt;
+        }
+        sizes.count_ = static_cast<uint32_t>(std::min<uint64_t>(sizes.count_, available * 8 / sizes.field_bits_));
+        return sizes;
+    }
+    return std::nullopt;
+}
+
+uint32_t SampleSizes::size(uint32_t sample) const {
+    if (constant_size_ != 0) {
+        return constant_size_;
+    }
+    if (field_bits_ == 4) {
+        uint8_t pair = entries_[sample / 2];
+        return sample % 2 == 0 ? pair >> 4 : pair & 0x0f;
+    }
+    size_t bytes = field_bits_ / 8;
+    return static_cast<uint32_t>(read_be(entries_ + static_cast<uint64_t>(sample) * bytes, bytes));
+}
+
+std::optional<ChunkOffsets> ChunkOffsets::parse(const BoxRef& box) {
+    size_t width = box.type() == fourcc("co64") ? 8 : box.type() == fourcc("stco") ? 4 : 0;
+    if (width == 0) {
+        return std::nullopt;
+    }
+    auto table = full_box_table(box, width);
+    if (!table) {
+        return std::nullopt;
+    }
+    ChunkOffsets offsets;
+    offsets.table_ = *table;
+    offsets.width_ = width;
+    return offsets;
+}
+
+std::optional<SampleToChunk> SampleToChunk::parse(const BoxRef& box) {
+    auto table = box.type() == fourcc("stsc") ? full_box_table(box, 12) : std::nullopt;
+    if (!table) {
+        return std::nullopt;
+    }
+    SampleToChunk runs;
+    runs.table_ = *table;
+    return runs;
+}
+
+std::optional<TimeToSample> TimeToSample::parse(const BoxRef& box) {
+    auto table = box.type() == fourcc("stts") ? full_box_table(box, 8) : std::nullopt;
+    if (!table) {
+        return std::nullopt;
+    }
+    TimeToSample runs;
+    runs.table_ = *table;
+    return runs;
+}
+
+uint64_t TimeToSample::total_duration() const {
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < count(); ++i) {
+        Entry run = entry(i);
+        total += static_cast<uint64_t>(run.sample_count) * run.delta;
+    }
+    return total;
+}
+
+std::optional<CompositionOffsets> CompositionOffsets::parse(const BoxRef& box) {
+    auto table = box.type() == fourcc("ctts") ? full_box_table(box, 8) : std::nullopt;
+    if (!table) {
+        return std::nullopt;
+    }
+    CompositionOffsets runs;
+    runs.table_ = *table;
+    runs.is_signed_ = box.version() == 1;
+    return runs;
+}
+
+CompositionOffsets::Entry CompositionOffsets::entry(uint32_t i) const {
+    auto raw = static_cast<uint32_t>(table_.field(i, 4, 4));
+    int64_t offset = is_signed_ ? static_cast<int64_t>(static_cast<int32_t>(raw)) : static_cast<int64_t>(raw);
+    return {static_cast<uint32_t>(table_.field(i, 0, 4)), offset};
+}
+
+std::optional<SyncSamples> SyncSamples::parse(const BoxRef& box) {
+    auto table = box.type() == fourcc("stss") ? full_box_table(box, 4) : std::nullopt;
+    if (!table) {
+        return std::nullopt;
+    }
+    SyncSamples samples;
+    samples.table_ = *table;
+    return samples;
+}
+
+bool SyncSamples::is_sync(uint32_t sample) const {
+    uint32_t found = at_or_before(sample);
+    return found != 0 && found == sample;
+}
+
+uint32_t SyncSamples::at_or_before(uint32_t sample) const {
+    // First entry greater than sample; the one before it is the answer
+    uint32_t low = 0;
+    uint32_t high = count();
+    while (low < high) {
+        uint32_t middle = low + (high - low) / 2;
+        if (this->sample(middle) <= sample) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low == 0 ? 0 : this->sample(low - 1);
+}
+
+std::optional<SampleTables> SampleTables::of_track(const BoxRef& trak) {
+    auto stbl = trak.descend({fourcc("mdia"), fourcc("minf"), fourcc("stbl")});
+    if (!stbl) {
+        return std::nullopt;
+    }
+    SampleTables tables;
+    for (const auto& box : stbl->children()) {
+        switch (box.type()) {
+            case fourcc("stsz"):
+            case fourcc("stz2"):
+                tables.sizes = SampleSizes::parse(box);
+                break;
+            case fourcc("stco"):
+            case fourcc("co64"):
+                tables.chunk_offsets = ChunkOffsets::parse(box);
+                break;
+            case fourcc("stsc"):
+                tables.sample_to_chunk = SampleToChunk::parse(box);
+                break;
+            case fourcc("stts"):
+                tables.time_to_sample = TimeToSample::parse(box);
+                break;
+            case fourcc("ctts"):
+                tables.composition_offsets = CompositionOffsets::parse(box);
+                break;
+            case fourcc("stss"):
+                tables.sync_samples = SyncSamples::parse(box);
+                break;
+            default:
+                break;
+        }
+    }
+    return tables;
+}
+
+Reader::Reader(const fs::path& path) {
+    ScopedFd fd(::open(path.c_str(), O_RDONLY | O_CLOEXEC));
+    if (!fd) {
+        error_message_ = "Cannot open " + path.string() + ": " + std::strerror(errno);
+        return;
+    }
+    map(fd.get(), path.string());
+}
+
+Reader::Reader(int fd, const std::string& name) {
+    map(fd, name);
+}
+
+void Reader::map(int fd, const std::string& name) {
+    struct stat st {};
+    if (::fstat(fd, &st) != 0) {
+        error_message_ = "Cannot open " + name + ": " + std::strerror(errno);
+        return;
+    }
+    if (st.st_size == 0) {
+        error_message_ = "Empty file: " + name;
+        return;
+    }
+    if (static_cast<uint64_t>(st.st_size) > SIZE_MAX) {
+        error_message_ = "File too large to map: " + name;
+        return;
+    }
+
+    // The mapping keeps the file referenced after the descriptor is closed
+    size_t length = static_cast<size_t>(st.st_size);
+    void* mapped = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapped == MAP_FAILED) {
+        error_message_ = "Cannot map " + name + ": " + std::strerror(errno);
+        return;
+    }
+    ::madvise(mapped, length, MADV_RANDOM);
+    data_ = static_cast<const uint8_t*>(mapped);
+    size_ = static_cast<uint64_t>(st.st_size);
+}
+
+Reader::~Reader() {
+    if (data_) {
+        ::munmap(const_cast<uint8_t*>(data_), static_cast<size_t>(size_));
+    }
+}
+
+} // namespace mp4
+} // namespace trimora
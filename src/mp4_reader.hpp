@@ -0,0 +1,276 @@
+#pragma once
+
+#include "mp4_box.hpp"
+#include <filesystem>
+#include <initializer_list>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+namespace trimora {
+namespace mp4 {
+
+class BoxRange;
+
+// A box inside a mapped file. Copies are cheap; the bytes belong to the
+// Reader it came from and are only valid while that is alive.
+class BoxRef {
+public:
+    BoxRef() = default;
+    BoxRef(const Box& box, const uint8_t* base) : box_(box), base_(base) {}
+
+    const Box& box() const { return box_; }
+    uint32_t type() const { return box_.type; }
+    uint64_t offset() const { return box_.offset; }
+    uint64_t size() const { return box_.size; }
+
+    const uint8_t* payload() const { return base_ + box_.offset + box_.header_size; }
+    uint64_t payload_size() const { return box_.size - box_.header_size; }
+
+    // Full boxes (mvhd, stsz, ...) start with a version byte and 24 bits of flags
+    uint8_t version() const { return payload_size() >= 4 ? payload()[0] : 0; }
+    uint32_t flags() const { return payload_size() >= 4 ? static_cast<uint32_t>(read_be(payload() + 1, 3)) : 0; }
+
+    // Child boxes, parsed as they are iterated. skip is the bytes of the
+    // payload before the first child, e.g. 4 for meta (version and flags)
+    BoxRange children(size_t skip = 0) const;
+    std::optional<BoxRef> child(uint32_t type, size_t skip = 0) const;
+
+    // Following a path of child types, e.g. {mdia, minf, stbl}
+    std::optional<BoxRef> descend(std::initializer_list<uint32_t> path) const;
+
+private:
+    Box box_;
+    const uint8_t* base_ = nullptr;
+};
+
+// Consecutive boxes between two offsets of a mapping. Iteration stops at
+// the first malformed box rather than reading past it.
+class BoxRange {
+public:
+    class iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = BoxRef;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const BoxRef*;
+        using reference = const BoxRef&;
+
+        iterator() = default;
+        iterator(const uint8_t* base, uint64_t offset, uint64_t limit);
+
+        const BoxRef& operator*() const { return current_; }
+        const BoxRef* operator->() const { return &current_; }
+        iterator& operator++();
+        iterator operator++(int) {
+            iterator previous = *this;
+            ++*this;
+            return previous;
+        }
+        bool operator==(const iterator& other) const { return at_end_ == other.at_end_ && (at_end_ || offset_ == other.offset_); }
+        bool operator!=(const iterator& other) const { return !(*this == other); }
+
+    private:
+        void parse();
+
+        const uint8_t* base_ = nullptr;
+        uint64_t offset_ = 0;
+        uint64_t limit_ = 0;
+        BoxRef current_;
+        bool at_end_ = true;
+    };
+
+    BoxRange(const uint8_t* base, uint64_t begin, uint64_t end) : base_(base), begin_(begin), end_(end) {}
+
+    iterator begin() const { return iterator(base_, begin_, end_); }
+    iterator end() const { return iterator(); }
+
+    std::optional<BoxRef> find(uint32_t type) const;
+
+private:
+    const uint8_t* base_;
+    uint64_t begin_;
+    uint64_t end_;
+};
+
+// Fixed-size records of a sample table, decoded on access. Tables that
+// claim more entries than their box holds are cut to what is there.
+class TableView {
+public:
+    TableView() = default;
+    TableView(const uint8_t* entries, uint64_t available, uint32_t count, size_t stride);
+
+    uint32_t count() const { return count_; }
+    bool empty() const { return count_ == 0; }
+
+    // bytes of the field at offset inside record i (unchecked; i < count())
+    uint64_t field(uint32_t i, size_t offset, size_t bytes) const {
+        return read_be(entries_ + static_cast<uint64_t>(i) * stride_ + offset, bytes);
+    }
+
+private:
+    const uint8_t* entries_ = nullptr;
+    uint32_t count_ = 0;
+    size_t stride_ = 0;
+};
+
+// stsz / stz2: the byte size of each sample
+class SampleSizes {
+public:
+    static std::optional<SampleSizes> parse(const BoxRef& box);
+
+    uint32_t count() const { return count_; }
+    uint32_t size(uint32_t sample) const;  // 0-based
+
+private:
+    uint32_t count_ = 0;
+    uint32_t constant_size_ = 0;  // Nonzero when all samples share it
+    size_t field_bits_ = 32;      // stz2 packs 4, 8 or 16 bits per sample
+    const uint8_t* entries_ = nullptr;
+};
+
+// stco / co64: file offset of each chunk
+class ChunkOffsets {
+public:
+    static std::optional<ChunkOffsets> parse(const BoxRef& box);
+
+    uint32_t count() const { return table_.count(); }
+    uint64_t offset(uint32_t chunk) const { return table_.field(chunk, 0, width_); }  // 0-based
+
+private:
+    TableView table_;
+    size_t width_ = 4;
+};
+
+// stsc: runs of chunks holding the same number of samples
+class SampleToChunk {
+public:
+    struct Entry {
+        uint32_t first_chunk;  // 1-based, as stored
+        uint32_t samples_per_chunk;
+        uint32_t description_index;
+    };
+
+    static std::optional<SampleToChunk> parse(const BoxRef& box);
+
+    uint32_t count() const { return table_.count(); }
+    Entry entry(uint32_t i) const {
+        return {static_cast<uint32_t>(table_.field(i, 0, 4)), static_cast<uint32_t>(table_.field(i, 4, 4)),
+                static_cast<uint32_t>(table_.field(i, 8, 4))};
+    }
+
+private:
+    TableView table_;
+};
+
+// stts: runs of samples with the same duration
+class TimeToSample {
+public:
+    struct Entry {
+        uint32_t sample_count;
+        uint32_t delta;
+    };
+
+    static std::optional<TimeToSample> parse(const BoxRef& box);
+
+    uint32_t count() const { return table_.count(); }
+    Entry entry(uint32_t i) const {
+        return {static_cast<uint32_t>(table_.field(i, 0, 4)), static_cast<uint32_t>(table_.field(i, 4, 4))};
+    }
+
+    // Sum of all sample durations, in media timescale units
+    uint64_t total_duration() const;
+
+private:
+    TableView table_;
+};
+
+// ctts: runs of samples with the same presentation offset
+class CompositionOffsets {
+public:
+    struct Entry {
+        uint32_t sample_count;
+        int64_t offset;  // Version 1 offsets are signed
+    };
+
+    static std::optional<CompositionOffsets> parse(const BoxRef& box);
+
+    uint32_t count() const { return table_.count(); }
+    Entry entry(uint32_t i) const;
+
+private:
+    TableView table_;
+    bool is_signed_ = false;
+};
+
+// stss: the sync samples (keyframes), ascending. Without an stss box every
+// sample is a sync sample.
+class SyncSamples {
+public:
+    static std::optional<SyncSamples> parse(const BoxRef& box);
+
+    uint32_t count() const { return table_.count(); }
+    uint32_t sample(uint32_t i) const { return static_cast<uint32_t>(table_.field(i, 0, 4)); }  // 1-based, as stored
+
+    // Binary searches over the mapped table
+    bool is_sync(uint32_t sample) const;
+    // Last sync sample at or before sample (1-based), 0 if none
+    uint32_t at_or_before(uint32_t sample) const;
+
+private:
+    TableView table_;
+};
+
+// The sample tables of one track, each empty when the box is absent
+struct SampleTables {
+    std::optional<SampleSizes> sizes;
+    std::optional<ChunkOffsets> chunk_offsets;
+    std::optional<SampleToChunk> sample_to_chunk;
+    std::optional<TimeToSample> time_to_sample;
+    std::optional<CompositionOffsets> composition_offsets;
+    std::optional<SyncSamples> sync_samples;
+
+    // From a trak box; nullopt without mdia/minf/stbl
+    static std::optional<SampleTables> of_track(const BoxRef& trak);
+};
+
+// Read-only view of an MP4/MOV file through a private mapping. Nothing is
+// parsed up front: boxes are read when iterated and sample tables decoded
+// one entry at a time, so only the pages actually looked at become
+// resident and a file of any size costs a few pages of memory. The mapping
+// is advised for random access so touching moov doesn't read ahead into
+// media data.
+//
+// Like any mapping, the file must not be truncated while it is in use.
+class Reader {
+public:
+    explicit Reader(const std::filesystem::path& path);
+    // A file the caller already has open (and perhaps locked); name is for
+    // error messages. fd may be closed once the Reader exists.
+    Reader(int fd, const std::string& name);
+    ~Reader();
+
+    Reader(const Reader&) = delete;
+    Reader& operator=(const Reader&) = delete;
+
+    explicit operator bool() const { return data_ != nullptr; }
+    const std::string& error_message() const { return error_message_; }
+
+    uint64_t size() const { return size_; }
+    const uint8_t* data() const { return data_; }
+
+    BoxRange top_level() const { return BoxRange(data_, 0, size_); }
+    std::optional<BoxRef> find(uint32_t type) const { return top_level().find(type); }
+
+private:
+    void map(int fd, const std::string& name);
+
+    const uint8_t* data_ = nullptr;
+    uint64_t size_ = 0;
+    std::string error_message_;
+};
+
+} // namespace mp4
+} // namespace trimora
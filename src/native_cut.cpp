@@ -0,0 +1,56 @@
+#include "native_cut.hpp"
+#include "file_manager.hpp"
+#include "scoped_fd.hpp"
+#include <fcntl.h>
+
+namespace fs = std::filesystem;
+
+namespace trimora {
+
+NativeCutResult NativeCutPlan::copy_to(const fs::path& output_file, const NativeCutProgress& progress_cb) const {
+    NativeCutResult result;
+    result.start_seconds = start_seconds;
+    result.end_seconds = end_seconds;
+
+    if (!ok) {
+        result.error_message = error_message;
+        return result;
+    }
+
+    std::vector<uint8_t> prefix = build_prefix(min_prefix_size);
+    if (prefix.size() != min_prefix_size) {
+        result.error_message = "Could not build container header";
+        return result;
+    }
+
+    ScopedFd in(::open(input_file.c_str(), O_RDONLY | O_CLOEXEC));
+    if (!in) {
+        result.error_message = "Cannot open input: " + input_file.string();
+        return result;
+    }
+    ScopedFd out(::open(output_file.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644));
+    if (!out) {
+        result.error_message = "Cannot create output: " + output_file.string();
+        return result;
+    }
+
+    bool cancelled = false;
+    bool copied = FileManager::write_fd_all(out.get(), prefix.data(), prefix.size()) &&
+                  FileManager::copy_fd_range(in.get(), out.get(), range_offset, range_length,
+                      [&](uint64_t done) {
+                          cancelled = progress_cb && !progress_cb(static_cast<double>(done) / range_length);
+                          return !cancelled;
+                      });
+    if (!copied) {
+        std::error_code ec;
+        fs::remove(output_file, ec);
+        result.error_message = cancelled ? "Cancelled" : "Failed writing " + output_file.string();
+        return result;
+    }
+
+    result.bytes_written = prefix.size() + range_length;
+    result.ok = true;
+    return result;
+}
+
+} // namespace trimora
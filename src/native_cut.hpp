@@ -0,0 +1,45 @@
+#pragma once
+
+#include <string>
+#include <filesystem>
+#include <functional>
+#include <vector>
+#include <cstdint>
+
+namespace trimora {
+
+// Outcome of a container-level copy trim (no FFmpeg involved)
+struct NativeCutResult {
+    bool ok = false;
+    std::string error_message;
+    uint64_t bytes_written = 0;
+    double start_seconds = 0.0;  // Where the cut actually landed, in stream time
+    double end_seconds = 0.0;    // 0 when the cut runs to the end of the input
+};
+
+// Gets the fraction copied so far; return false to cancel
+using NativeCutProgress = std::function<bool(double fraction)>;
+
+// A container-level cut is a rebuilt prefix (headers, program tables, index)
+// followed by one byte range of the source, unchanged. Copy trims write both
+// to a new file; in-place trims turn the source into them.
+struct NativeCutPlan {
+    bool ok = false;
+    std::string error_message;
+
+    std::filesystem::path input_file;
+    uint64_t range_offset = 0;  // Source bytes kept as they are
+    uint64_t range_length = 0;
+    double start_seconds = 0.0;
+    double end_seconds = 0.0;   // 0 when the range runs to the end of the stream
+
+    // Smallest prefix the container needs. build_prefix returns a prefix of
+    // exactly the requested size, padded the container's way, or nothing if
+    // it can't be padded to that size.
+    uint64_t min_prefix_size = 0;
+    std::function<std::vector<uint8_t>(uint64_t size)> build_prefix;
+
+    NativeCutResult copy_to(const std::filesystem::path& output_file, const NativeCutProgress& progress_cb) const;
+};
+
+} // namespace trimora
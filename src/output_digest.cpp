@@ -0,0 +1,595 @@
+#include "output_digest.hpp"
+#include "scoped_fd.hpp"
+#include "logger.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace trimora {
+
+namespace {
+
+// How often the follower looks for new bytes
+constexpr auto kPollInterval = std::chrono::milliseconds(50);
+
+constexpr size_t kReadSize = 1024 * 1024;
+
+// Kept from the follower's first read; muxers that seek back patch here
+constexpr size_t kHeadBytes = 64 * 1024;
+
+std::string to_hex(const uint8_t* bytes, size_t size) {
+    static const char kDigits[] = "0123456789abcdef";
+    std::string hex;
+    hex.reserve(size * 2);
+    for (size_t i = 0; i < size; ++i) {
+        hex += kDigits[bytes[i] >> 4];
+        hex += kDigits[bytes[i] & 0x0f];
+    }
+    return hex;
+}
+
+// --- SHA-256 ---
+
+constexpr std::array<uint32_t, 64> kSha256Rounds = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+constexpr uint32_t rotr32(uint32_t value, int bits) {
+    return (value >> bits) | (value << (32 - bits));
+}
+
+// --- XXH3 ---
+
+constexpr uint64_t kPrime32_1 = 0x9E3779B1U;
+constexpr uint64_t kPrime32_2 = 0x85EBCA77U;
+constexpr uint64_t kPrime32_3 = 0xC2B2AE3DU;
+constexpr uint64_t kPrime64_1 = 0x9E3779B185EBCA87ULL;
+constexpr uint64_t kPrime64_2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr uint64_t kPrime64_3 = 0x165667B19E3779F9ULL;
+constexpr uint64_t kPrime64_4 = 0x85EBCA77C2B2AE63ULL;
+constexpr uint64_t kPrime64_5 = 0x27D4EB2F165667C5ULL;
+constexpr uint64_t kPrimeMx1 = 0x165667919E3779F9ULL;
+constexpr uint64_t kPrimeMx2 = 0x9FB21C651E98DF25ULL;
+
+constexpr size_t kStripeLen = 64;
+constexpr size_t kStripesPerBlock = 16;  // (secret size - stripe) / 8
+constexpr size_t kMidSizeMax = 240;      // Longer inputs use the stripe loop
+
+constexpr uint8_t kXxh3Secret[192] = {
+    0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c, 0xf7, 0x21, 0xad, 0x1c,
+    0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb, 0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f,
+    0xcb, 0x79, 0xe6, 0x4e, 0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+    0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6, 0x81, 0x3a, 0x26, 0x4c,
+    0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb, 0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3,
+    0x71, 0x64, 0x48, 0x97, 0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+    0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7, 0xc7, 0x0b, 0x4f, 0x1d,
+    0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31, 0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64,
+    0xea, 0xc5, 0xac, 0x83, 0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+    0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26, 0x29, 0xd4, 0x68, 0x9e,
+    0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc, 0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce,
+    0x45, 0xcb, 0x3a, 0x8f, 0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e
+};
+
+uint32_t read_le32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+uint64_t read_le64(const uint8_t* p) {
+    return static_cast<uint64_t>(read_le32(p)) | (static_cast<uint64_t>(read_le32(p + 4)) << 32);
+}
+
+constexpr uint64_t rotl64(uint64_t value, int bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+// Low and high halves of the 128-bit product, xored
+uint64_t mul128_fold64(uint64_t lhs, uint64_t rhs) {
+    constexpr uint64_t kLow32 = 0xffffffffULL;
+    uint64_t lo_lo = (lhs & kLow32) * (rhs & kLow32);
+    uint64_t hi_lo = (lhs >> 32) * (rhs & kLow32);
+    uint64_t lo_hi = (lhs & kLow32) * (rhs >> 32);
+    uint64_t hi_hi = (lhs >> 32) * (rhs >> 32);
+    uint64_t cross = (lo_lo >> 32) + (hi_lo & kLow32) + lo_hi;
+    uint64_t high = (hi_lo >> 32) + (cross >> 32) + hi_hi;
+    uint64_t low = (cross << 32) | (lo_lo & kLow32);
+    return low ^ high;
+}
+
+uint64_t xxh64_avalanche(uint64_t h) {
+    h ^= h >> 33;
+    h *= kPrime64_2;
+    h ^= h >> 29;
+    h *= kPrime64_3;
+    return h ^ (h >> 32);
+}
+
+uint64_t xxh3_avalanche(uint64_t h) {
+    h ^= h >> 37;
+    h *= kPrimeMx1;
+    return h ^ (h >> 32);
+}
+
+uint64_t xxh3_rrmxmx(uint64_t h, uint64_t length) {
+    h ^= rotl64(h, 49) ^ rotl64(h, 24);
+    h *= kPrimeMx2;
+    h ^= (h >> 35) + length;
+    h *= kPrimeMx2;
+    return h ^ (h >> 28);
+}
+
+uint64_t xxh3_mix16(const uint8_t* input, const uint8_t* secret) {
+    return mul128_fold64(read_le64(input) ^ read_le64(secret), read_le64(input + 8) ^ read_le64(secret + 8));
+}
+
+// One-shot hash of inputs up to kMidSizeMax bytes
+uint64_t xxh3_short(const uint8_t* input, size_t length) {
+    const uint8_t* secret = kXxh3Secret;
+    if (length == 0) {
+        return xxh64_avalanche(read_le64(secret + 56) ^ read_le64(secret + 64));
+    }
+    if (length <= 3) {
+        uint32_t combined = (static_cast<uint32_t>(input[0]) << 16) |
+                            (static_cast<uint32_t>(input[length >> 1]) << 24) |
+                            static_cast<uint32_t>(input[length - 1]) |
+                            (static_cast<uint32_t>(length) << 8);
+        uint64_t bitflip = read_le32(secret) ^ read_le32(secret + 4);
+        return xxh64_avalanche(combined ^ bitflip);
+    }
+    if (length <= 8) {
+        uint64_t input64 = read_le32(input + length - 4) + (static_cast<uint64_t>(read_le32(input)) << 32);
+        uint64_t bitflip = read_le64(secret + 8) ^ read_le64(secret + 16);
+        return xxh3_rrmxmx(input64 ^ bitflip, length);
+    }
+    if (length <= 16) {
+        uint64_t low = read_le64(input) ^ (read_le64(secret + 24) ^ read_le64(secret + 32));
+        uint64_t high = read_le64(input + length - 8) ^ (read_le64(secret + 40) ^ read_le64(secret + 48));
+        uint64_t acc = length + __builtin_bswap64(low) + high + mul128_fold64(low, high);
+        return xxh3_avalanche(acc);
+    }
+    uint64_t acc = length * kPrime64_1;
+    if (length <= 128) {
+        if (length > 32) {
+            if (length > 64) {
+                if (length > 96) {
+                    acc += xxh3_mix16(input + 48, secret + 96);
+                    acc += xxh3_mix16(input + length - 64, secret + 112);
+                }
+                acc += xxh3_mix16(input + 32, secret + 64);
+                acc += xxh3_mix16(input + length - 48, secret + 80);
+            }
+            acc += xxh3_mix16(input + 16, secret + 32);
+            acc += xxh3_mix16(input + length - 32, secret + 48);
+        }
+        acc += xxh3_mix16(input, secret);
+        acc += xxh3_mix16(input + length - 16, secret + 16);
+        return xxh3_avalanche(acc);
+    }
+    for (size_t i = 0; i < 8; ++i) {
+        acc += xxh3_mix16(input + 16 * i, secret + 16 * i);
+    }
+    acc = xxh3_avalanche(acc);
+    uint64_t acc_end = xxh3_mix16(input + length - 16, secret + 136 - 17);
+    for (size_t i = 8; i < length / 16; ++i) {
+        acc_end += xxh3_mix16(input + 16 * i, secret + 16 * (i - 8) + 3);
+    }
+    return xxh3_avalanche(acc + acc_end);
+}
+
+void xxh3_accumulate(std::array<uint64_t, 8>& acc, const uint8_t* stripe, const uint8_t* secret) {
+    for (size_t i = 0; i < 8; ++i) {
+        uint64_t value = read_le64(stripe + 8 * i);
+        uint64_t key = value ^ read_le64(secret + 8 * i);
+        acc[i ^ 1] += value;
+        acc[i] += (key & 0xffffffffULL) * (key >> 32);
+    }
+}
+
+void xxh3_scramble(std::array<uint64_t, 8>& acc, const uint8_t* secret) {
+    for (size_t i = 0; i < 8; ++i) {
+        uint64_t value = acc[i];
+        value ^= value >> 47;
+        value ^= read_le64(secret + 8 * i);
+        acc[i] = value * kPrime32_1;
+    }
+}
+
+} // namespace
+
+const char* digest_name(DigestAlgorithm algorithm) {
+    switch (algorithm) {
+        case DigestAlgorithm::Sha256: return "sha256";
+        case DigestAlgorithm::Xxh3: return "xxh3";
+    }
+    return "";
+}
+
+std::vector<DigestAlgorithm> parse_digest_list(const std::string& list, std::string& error_message) {
+    std::vector<DigestAlgorithm> algorithms;
+    std::string name;
+    auto flush = [&]() {
+        if (name.empty()) {
+            return;
+        }
+        std::optional<DigestAlgorithm> algorithm;
+        if (name == "sha256" || name == "sha-256") {
+            algorithm = DigestAlgorithm::Sha256;
+        } else if (name == "xxh3" || name == "xxh3-64") {
+            algorithm = DigestAlgorithm::Xxh3;
+        }
+        if (!algorithm) {
+            error_message += (error_message.empty() ? "Unknown digest: " : ", ") + name;
+        } else if (std::find(algorithms.begin(), algorithms.end(), *algorithm) == algorithms.end()) {
+            algorithms.push_back(*algorithm);
+        }
+        name.clear();
+    };
+    for (char c : list) {
+        if (c == ',' || std::isspace(static_cast<unsigned char>(c))) {
+            flush();
+        } else {
+            name += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+    }
+    flush();
+    return algorithms;
+}
+
+Sha256::Sha256()
+    : state_{0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19} {}
+
+void Sha256::compress(const uint8_t* block) {
+    std::array<uint32_t, 64> w;
+    for (size_t i = 0; i < 16; ++i) {
+        w[i] = (static_cast<uint32_t>(block[4 * i]) << 24) | (static_cast<uint32_t>(block[4 * i + 1]) << 16) |
+               (static_cast<uint32_t>(block[4 * i + 2]) << 8) | static_cast<uint32_t>(block[4 * i + 3]);
+    }
+    for (size_t i = 16; i < 64; ++i) {
+        uint32_t s0 = rotr32(w[i - 15], 7) ^ rotr32(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        uint32_t s1 = rotr32(w[i - 2], 17) ^ rotr32(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint32_t a = state_[0], b = state_[1], c = state_[2], d = state_[3];
+    uint32_t e = state_[4], f = state_[5], g = state_[6], h = state_[7];
+    for (size_t i = 0; i < 64; ++i) {
+        uint32_t s1 = rotr32(e, 6) ^ rotr32(e, 11) ^ rotr32(e, 25);
+        uint32_t choose = (e & f) ^ (~e & g);
+        uint32_t t1 = h + s1 + choose + kSha256Rounds[i] + w[i];
+        uint32_t s0 = rotr32(a, 2) ^ rotr32(a, 13) ^ rotr32(a, 22);
+        uint32_t majority = (a & b) ^ (a & c) ^ (b & c);
+        uint32_t t2 = s0 + majority;
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+    state_[0] += a; state_[1] += b; state_[2] += c; state_[3] += d;
+    state_[4] += e; state_[5] += f; state_[6] += g; state_[7] += h;
+}
+
+void Sha256::update(const uint8_t* data, size_t size) {
+    total_ += size;
+    if (buffered_ > 0) {
+        size_t take = std::min(size, buffer_.size() - buffered_);
+        std::memcpy(buffer_.data() + buffered_, data, take);
+        buffered_ += take;
+        data += take;
+        size -= take;
+        if (buffered_ < buffer_.size()) {
+            return;
+        }
+        compress(buffer_.data());
+        buffered_ = 0;
+    }
+    for (; size >= 64; data += 64, size -= 64) {
+        compress(data);
+    }
+    std::memcpy(buffer_.data(), data, size);
+    buffered_ = size;
+}
+
+std::array<uint8_t, 32> Sha256::digest() {
+    uint64_t bit_length = total_ * 8;
+    uint8_t padding[72] = {0x80};
+    size_t pad_size = (buffered_ < 56 ? 56 : 120) - buffered_;
+    for (size_t i = 0; i < 8; ++i) {
+        padding[pad_size + i] = static_cast<uint8_t>(bit_length >> (56 - 8 * i));
+    }
+    update(padding, pad_size + 8);
+
+    std::array<uint8_t, 32> bytes;
+    for (size_t i = 0; i < 8; ++i) {
+        bytes[4 * i] = static_cast<uint8_t>(state_[i] >> 24);
+        bytes[4 * i + 1] = static_cast<uint8_t>(state_[i] >> 16);
+        bytes[4 * i + 2] = static_cast<uint8_t>(state_[i] >> 8);
+        bytes[4 * i + 3] = static_cast<uint8_t>(state_[i]);
+    }
+    return bytes;
+}
+
+std::string Sha256::hex_digest() {
+    auto bytes = digest();
+    return to_hex(bytes.data(), bytes.size());
+}
+
+Xxh3::Xxh3()
+    : acc_{kPrime32_3, kPrime64_1, kPrime64_2, kPrime64_3, kPrime64_4, kPrime32_2, kPrime64_5, kPrime32_1} {}
+
+void Xxh3::consume_stripe(std::array<uint64_t, 8>& acc, size_t& stripes_in_block, const uint8_t* stripe) const {
+    xxh3_accumulate(acc, stripe, kXxh3Secret + stripes_in_block * 8);
+    if (++stripes_in_block == kStripesPerBlock) {
+        xxh3_scramble(acc, kXxh3Secret + sizeof(kXxh3Secret) - kStripeLen);
+        stripes_in_block = 0;
+    }
+}
+
+void Xxh3::update(const uint8_t* data, size_t size) {
+    total_ += size;
+    if (total_ <= kMidSizeMax) {
+        // May still end up short, and short inputs are hashed in one go
+        std::memcpy(buffer_.data() + buffered_, data, size);
+        buffered_ += size;
+        return;
+    }
+
+    // A stripe is only consumed once input follows it: the last stripe is
+    // hashed differently in hex_digest()
+    while (buffered_ > 0 && size > 0) {
+        if (buffered_ % kStripeLen == 0) {
+            for (size_t offset = 0; offset < buffered_; offset += kStripeLen) {
+                consume_stripe(acc_, stripes_in_block_, buffer_.data() + offset);
+            }
+            std::memcpy(last_stripe_.data(), buffer_.data() + buffered_ - kStripeLen, kStripeLen);
+            buffered_ = 0;
+            break;
+        }
+        size_t take = std::min(size, kStripeLen - buffered_ % kStripeLen);
+        std::memcpy(buffer_.data() + buffered_, data, take);
+        buffered_ += take;
+        data += take;
+        size -= take;
+    }
+    if (size == 0) {
+        return;
+    }
+
+    const uint8_t* start = data;
+    for (; size > kStripeLen; data += kStripeLen, size -= kStripeLen) {
+        consume_stripe(acc_, stripes_in_block_, data);
+    }
+    if (data != start) {
+        std::memcpy(last_stripe_.data(), data - kStripeLen, kStripeLen);
+    }
+    std::memcpy(buffer_.data(), data, size);
+    buffered_ = size;
+}
+
+std::string Xxh3::hex_digest() const {
+    uint64_t hash;
+    if (total_ <= kMidSizeMax) {
+        hash = xxh3_short(buffer_.data(), static_cast<size_t>(total_));
+    } else {
+        auto acc = acc_;
+        size_t stripes_in_block = stripes_in_block_;
+        size_t offset = 0;
+        for (; buffered_ - offset > kStripeLen; offset += kStripeLen) {
+            consume_stripe(acc, stripes_in_block, buffer_.data() + offset);
+        }
+
+        // The final 64 bytes of input, reaching back into the last consumed
+        // stripe when fewer are buffered
+        uint8_t last[kStripeLen];
+        if (buffered_ >= kStripeLen) {
+            std::memcpy(last, buffer_.data() + buffered_ - kStripeLen, kStripeLen);
+        } else {
+            std::memcpy(last, last_stripe_.data() + buffered_, kStripeLen - buffered_);
+            std::memcpy(last + kStripeLen - buffered_, buffer_.data(), buffered_);
+        }
+        xxh3_accumulate(acc, last, kXxh3Secret + sizeof(kXxh3Secret) - kStripeLen - 7);
+
+        hash = total_ * kPrime64_1;
+        for (size_t i = 0; i < 4; ++i) {
+            const uint8_t* secret = kXxh3Secret + 11 + 16 * i;
+            hash += mul128_fold64(acc[2 * i] ^ read_le64(secret), acc[2 * i + 1] ^ read_le64(secret + 8));
+        }
+        hash = xxh3_avalanche(hash);
+    }
+
+    uint8_t bytes[8];
+    for (size_t i = 0; i < 8; ++i) {
+        bytes[i] = static_cast<uint8_t>(hash >> (56 - 8 * i));
+    }
+    return to_hex(bytes, sizeof(bytes));
+}
+
+OutputDigester::OutputDigester(fs::path file, std::vector<DigestAlgorithm> algorithms, bool append_only)
+    : file_(std::move(file)), algorithms_(std::move(algorithms)), append_only_(append_only) {
+    hashers_ = make_hashers();
+    if (append_only_) {
+        follower_ = std::thread([this]() { follow(); });
+    }
+}
+
+OutputDigester::~OutputDigester() {
+    writer_done_ = true;
+    if (follower_.joinable()) {
+        follower_.join();
+    }
+}
+
+bool OutputDigester::is_append_only(const fs::path& file) {
+    std::string ext = file.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return std::tolower(c); });
+    return ext == ".ts" || ext == ".m2ts" || ext == ".mts";
+}
+
+OutputDigester::Hashers OutputDigester::make_hashers() const {
+    Hashers hashers;
+    for (auto algorithm : algorithms_) {
+        if (algorithm == DigestAlgorithm::Sha256) {
+            hashers.sha256.emplace();
+        } else {
+            hashers.xxh3.emplace();
+        }
+    }
+    return hashers;
+}
+
+bool OutputDigester::hash_to(int fd, uint64_t end) {
+    uint64_t offset = hashed_;
+    std::vector<uint8_t> buffer(static_cast<size_t>(std::min<uint64_t>(kReadSize, end - offset)));
+    while (offset < end) {
+        size_t want = static_cast<size_t>(std::min<uint64_t>(buffer.size(), end - offset));
+        ssize_t n = ::pread(fd, buffer.data(), want, static_cast<off_t>(offset));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        auto size = static_cast<size_t>(n);
+        if (hashers_.sha256) {
+            hashers_.sha256->update(buffer.data(), size);
+        }
+        if (hashers_.xxh3) {
+            hashers_.xxh3->update(buffer.data(), size);
+        }
+        if (offset < kHeadBytes) {
+            size_t head_size = std::min(size, static_cast<size_t>(kHeadBytes - offset));
+            head_.insert(head_.end(), buffer.data(), buffer.data() + head_size);
+        }
+        offset += size;
+        hashed_ = offset;
+    }
+    return true;
+}
+
+void OutputDigester::follow() {
+    // The writer may not have created the file yet
+    int raw_fd = -1;
+    while ((raw_fd = ::open(file_.c_str(), O_RDONLY | O_CLOEXEC)) < 0) {
+        if (writer_done_) {
+            follow_ok_ = false;
+            return;
+        }
+        std::this_thread::sleep_for(kPollInterval);
+    }
+    ScopedFd fd(raw_fd);
+
+    struct stat st {};
+    if (::fstat(fd.get(), &st) != 0) {
+        follow_ok_ = false;
+        return;
+    }
+    followed_inode_ = st.st_ino;
+
+    while (true) {
+        // Checked before the size, so the last size read is the final one
+        bool done = writer_done_;
+        if (::fstat(fd.get(), &st) != 0 || static_cast<uint64_t>(st.st_size) < hashed_) {
+            follow_ok_ = false;  // Truncated under us
+            return;
+        }
+        auto size = static_cast<uint64_t>(st.st_size);
+        if (size > hashed_) {
+            if (!hash_to(fd.get(), size)) {
+                follow_ok_ = false;
+                return;
+            }
+        } else if (done) {
+            return;
+        } else {
+            std::this_thread::sleep_for(kPollInterval);
+        }
+    }
+}
+
+bool OutputDigester::finish(std::vector<OutputDigest>& digests, std::string& error_message) {
+    writer_done_ = true;
+    if (follower_.joinable()) {
+        follower_.join();
+    }
+
+    ScopedFd fd(::open(file_.c_str(), O_RDONLY | O_CLOEXEC));
+    struct stat st {};
+    if (!fd || ::fstat(fd.get(), &st) != 0) {
+        error_message = "Cannot read " + file_.string() + " for checksums";
+        return false;
+    }
+    auto size = static_cast<uint64_t>(st.st_size);
+
+    // Anything already hashed must still be what the file holds
+    bool resume = append_only_ && follow_ok_ && hashed_ > 0 &&
+                  st.st_ino == followed_inode_ && size >= hashed_;
+    if (resume) {
+        std::vector<uint8_t> head(head_.size());
+        resume = ::pread(fd.get(), head.data(), head.size(), 0) == static_cast<ssize_t>(head.size()) &&
+                 head == head_;
+    }
+    if (!resume) {
+        if (append_only_ && hashed_ > 0) {
+            TRIMORA_LOG_DEBUG("Output changed behind the checksum reader, hashing again: " + file_.string());
+        }
+        hashers_ = make_hashers();
+        hashed_ = 0;
+        head_.clear();
+    }
+
+    if (!hash_to(fd.get(), size)) {
+        error_message = "Failed reading " + file_.string() + " for checksums";
+        return false;
+    }
+
+    digests.clear();
+    for (auto algorithm : algorithms_) {
+        OutputDigest digest;
+        digest.algorithm = algorithm;
+        digest.hex = algorithm == DigestAlgorithm::Sha256 ? hashers_.sha256->hex_digest() : hashers_.xxh3->hex_digest();
+        digests.push_back(digest);
+    }
+    return true;
+}
+
+bool OutputDigester::write_sidecars(
+    const fs::path& file,
+    const std::vector<OutputDigest>& digests,
+    std::string& error_message
+) {
+    for (const auto& digest : digests) {
+        fs::path sidecar = file;
+        sidecar += std::string(".") + digest_name(digest.algorithm);
+
+        // Same line format as sha256sum and xxhsum -H3, so their --check works
+        std::ofstream out(sidecar, std::ios::trunc);
+        out << (digest.algorithm == DigestAlgorithm::Xxh3 ? "XXH3_" : "") << digest.hex
+            << "  " << file.filename().string() << "\n";
+        out.close();
+        if (!out) {
+            error_message = "Failed writing " + sidecar.string();
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace trimora
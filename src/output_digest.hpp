@@ -0,0 +1,123 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <optional>
+#include <thread>
+#include <filesystem>
+#include <cstdint>
+#include <cstddef>
+
+namespace trimora {
+
+enum class DigestAlgorithm {
+    Sha256,
+    Xxh3  // XXH3-64, seed 0
+};
+
+struct OutputDigest {
+    DigestAlgorithm algorithm = DigestAlgorithm::Sha256;
+    std::string hex;
+};
+
+// "sha256" / "xxh3", also the sidecar extension
+const char* digest_name(DigestAlgorithm algorithm);
+
+// Comma- or space-separated names from the config. Unknown names are listed
+// in error_message and skipped; duplicates are dropped.
+std::vector<DigestAlgorithm> parse_digest_list(const std::string& list, std::string& error_message);
+
+// Incremental SHA-256 (FIPS 180-4)
+class Sha256 {
+public:
+    Sha256();
+    void update(const uint8_t* data, size_t size);
+    std::array<uint8_t, 32> digest();  // Finalizes; call once
+    std::string hex_digest();
+
+private:
+    void compress(const uint8_t* block);
+
+    std::array<uint32_t, 8> state_;
+    std::array<uint8_t, 64> buffer_{};
+    size_t buffered_ = 0;
+    uint64_t total_ = 0;
+};
+
+// Incremental XXH3-64 with the default secret and seed 0, matching
+// `xxhsum -H3`
+class Xxh3 {
+public:
+    Xxh3();
+    void update(const uint8_t* data, size_t size);
+    std::string hex_digest() const;
+
+private:
+    void consume_stripe(std::array<uint64_t, 8>& acc, size_t& stripes_in_block, const uint8_t* stripe) const;
+
+    std::array<uint64_t, 8> acc_;
+    size_t stripes_in_block_ = 0;
+    std::array<uint8_t, 256> buffer_{};  // Whole input while it may still be short
+    size_t buffered_ = 0;
+    std::array<uint8_t, 64> last_stripe_{};  // Last stripe consumed, for the final one
+    uint64_t total_ = 0;
+};
+
+// Hashes an output while FFmpeg or a native cut writes it, so the archive
+// digests don't cost a second read of every file. Append-only outputs (see
+// is_append_only) are read right behind the writer, while the new pages are
+// still cached. Muxers that go back to patch their header (MP4, Matroska)
+// are hashed in finish(), which callers run before drop-behind evicts the
+// file. If a followed file turns out to have been rewritten, finish() starts
+// over from the beginning.
+class OutputDigester {
+public:
+    OutputDigester(std::filesystem::path file, std::vector<DigestAlgorithm> algorithms, bool append_only);
+    ~OutputDigester();
+
+    OutputDigester(const OutputDigester&) = delete;
+    OutputDigester& operator=(const OutputDigester&) = delete;
+
+    const std::filesystem::path& file() const { return file_; }
+
+    // Call once the writer has closed the file
+    bool finish(std::vector<OutputDigest>& digests, std::string& error_message);
+
+    // Written at the end by every muxer we use for these extensions
+    static bool is_append_only(const std::filesystem::path& file);
+
+    // <file>.sha256 / <file>.xxh3 in sha256sum / xxhsum format, next to the file
+    static bool write_sidecars(
+        const std::filesystem::path& file,
+        const std::vector<OutputDigest>& digests,
+        std::string& error_message
+    );
+
+private:
+    struct Hashers {
+        std::optional<Sha256> sha256;
+        std::optional<Xxh3> xxh3;
+    };
+
+    void follow();
+    Hashers make_hashers() const;
+    bool hash_to(int fd, uint64_t end);  // Feeds [hashed_, end)
+
+    std::filesystem::path file_;
+    std::vector<DigestAlgorithm> algorithms_;
+    bool append_only_;
+
+    // Owned by the follower thread until it is joined
+    Hashers hashers_;
+    uint64_t hashed_ = 0;
+    uint64_t followed_inode_ = 0;
+    std::vector<uint8_t> head_;  // First bytes as hashed, checked again in finish()
+    bool follow_ok_ = true;
+
+    std::atomic<bool> writer_done_{false};
+    std::thread follower_;
+};
+
+} // namespace trimora
@@ -0,0 +1,107 @@
+#include "preflight.hpp"
+#include "validator.hpp"
+#include "file_manager.hpp"
+#include <algorithm>
+#include <cctype>
+
+namespace fs = std::filesystem;
+
+namespace trimora {
+
+Preflight::Preflight(size_t worker_count, ProbeFunction probe_duration)
+    : probe_duration_(std::move(probe_duration))
+{
+    worker_count = std::max<size_t>(worker_count, 1);
+    for (size_t i = 0; i < worker_count; ++i) {
+        workers_.emplace_back(&Preflight::run, this);
+    }
+}
+
+Preflight::~Preflight() {
+    {
+        std::lock_guard<std::mutex> lock(tasks_mutex_);
+        stopping_ = true;
+        tasks_.clear();
+    }
+    tasks_cv_.notify_all();
+
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+void Preflight::submit(PreflightRequest request, ResultCallback on_result) {
+    {
+        std::lock_guard<std::mutex> lock(tasks_mutex_);
+        tasks_.push_back({std::move(request), std::move(on_result)});
+    }
+    tasks_cv_.notify_one();
+}
+
+void Preflight::cancel_pending() {
+    std::lock_guard<std::mutex> lock(tasks_mutex_);
+    tasks_.clear();
+}
+
+void Preflight::release_name(const fs::path& output_file) {
+    std::lock_guard<std::mutex> lock(names_mutex_);
+    claimed_names_.erase(output_file);
+}
+
+void Preflight::run() {
+    while (true) {
+        Task task;
+        {
+            std::unique_lock<std::mutex> lock(tasks_mutex_);
+            tasks_cv_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+            if (stopping_) {
+                return;
+            }
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+
+        task.on_result(check(task.request));
+    }
+}
+
+PreflightResult Preflight::check(const PreflightRequest& request) {
+    PreflightResult result;
+    result.id = request.id;
+
+    auto validation = Validator::validate_input_file(request.input_file);
+    if (!validation) {
+        result.error_message = validation.error_message;
+        return result;
+    }
+
+    // Sniff ISO-BMFF inputs; other containers are left to ffprobe/ffmpeg
+    std::string ext = request.input_file.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return std::tolower(c); });
+    if ((ext == ".mp4" || ext == ".mov" || ext == ".m4v") && !Validator::is_valid_mp4(request.input_file)) {
+        result.error_message = "Not a valid MP4/MOV file (no ftyp box): " + request.input_file.string();
+        return result;
+    }
+
+    if (request.probe_duration && probe_duration_) {
+        result.duration_seconds = probe_duration_(request.input_file);
+    }
+
+    result.output_file = FileManager::generate_output_filename(
+        request.input_file,
+        request.output_dir,
+        request.naming_pattern,
+        request.extension,
+        [this](const fs::path& candidate) { return claim_name(candidate); }
+    );
+
+    result.ok = true;
+    return result;
+}
+
+bool Preflight::claim_name(const fs::path& output_file) {
+    std::lock_guard<std::mutex> lock(names_mutex_);
+    return claimed_names_.insert(output_file).second;
+}
+
+} // namespace trimora
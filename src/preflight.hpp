@@ -0,0 +1,81 @@
+#pragma once
+
+#include <string>
+#include <filesystem>
+#include <functional>
+#include <vector>
+#include <deque>
+#include <set>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <cstdint>
+
+namespace trimora {
+
+struct PreflightRequest {
+    uint64_t id = 0;  // Caller's job id, echoed in the result
+    std::filesystem::path input_file;
+    std::filesystem::path output_dir;
+    std::string naming_pattern;
+    std::string extension;  // Output extension, empty keeps the input's
+    bool probe_duration = true;
+};
+
+struct PreflightResult {
+    uint64_t id = 0;
+    bool ok = false;
+    std::string error_message;
+    std::filesystem::path output_file;
+    double duration_seconds = 0.0;  // 0 if unknown
+};
+
+// Checks that touch the filesystem before a job starts: input validation,
+// container sniffing, duration probe and output naming. They run on a small
+// worker pool because on network mounts each one can take seconds.
+// Output names handed out by one Preflight never collide with each other,
+// even before the files exist.
+class Preflight {
+public:
+    using ProbeFunction = std::function<double(const std::filesystem::path&)>;
+    using ResultCallback = std::function<void(const PreflightResult&)>;
+
+    Preflight(size_t worker_count, ProbeFunction probe_duration);
+    ~Preflight();
+
+    Preflight(const Preflight&) = delete;
+    Preflight& operator=(const Preflight&) = delete;
+
+    // The callback runs on a worker thread
+    void submit(PreflightRequest request, ResultCallback on_result);
+
+    // Drop requests that haven't started yet
+    void cancel_pending();
+
+    // Make a claimed name available again (job removed or re-queued)
+    void release_name(const std::filesystem::path& output_file);
+
+private:
+    struct Task {
+        PreflightRequest request;
+        ResultCallback on_result;
+    };
+
+    void run();
+    PreflightResult check(const PreflightRequest& request);
+    bool claim_name(const std::filesystem::path& output_file);
+
+    ProbeFunction probe_duration_;
+
+    std::deque<Task> tasks_;
+    std::mutex tasks_mutex_;
+    std::condition_variable tasks_cv_;
+    bool stopping_ = false;
+
+    std::set<std::filesystem::path> claimed_names_;
+    std::mutex names_mutex_;
+
+    std::vector<std::thread> workers_;
+};
+
+} // namespace trimora
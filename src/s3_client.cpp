@@ -0,0 +1,424 @@
+#include "s3_client.hpp"
+#include "output_digest.hpp"
+#include "logger.hpp"
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <sstream>
+#include <thread>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <boost/asio/connect.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <boost/beast/http/span_body.hpp>
+#ifdef TRIMORA_HAVE_TLS
+#include <boost/asio/ssl.hpp>
+#endif
+
+namespace net = boost::asio;
+namespace beast = boost::beast;
+namespace http = boost::beast::http;
+using tcp = boost::asio::ip::tcp;
+
+namespace trimora {
+
+namespace {
+
+// Socket send/receive timeout; a stalled connection fails and is retried
+constexpr int kSocketTimeoutSeconds = 60;
+
+constexpr size_t kMaxResponseBytes = 1024 * 1024;
+
+constexpr auto kRetryBaseDelay = std::chrono::milliseconds(250);
+constexpr auto kRetryMaxDelay = std::chrono::seconds(8);
+
+using Request = http::request<http::span_body<const char>>;
+
+std::string hex(const uint8_t* bytes, size_t size) {
+    static const char kDigits[] = "0123456789abcdef";
+    std::string text;
+    for (size_t i = 0; i < size; ++i) {
+        text += kDigits[bytes[i] >> 4];
+        text += kDigits[bytes[i] & 0x0f];
+    }
+    return text;
+}
+
+std::string sha256_hex(const std::string& data) {
+    Sha256 hasher;
+    hasher.update(reinterpret_cast<const uint8_t*>(data.data()), data.size());
+    return hasher.hex_digest();
+}
+
+// RFC 2104 over SHA-256; keys and results are raw bytes in a string
+std::string hmac_sha256(const std::string& key, const std::string& message) {
+    constexpr size_t kBlockSize = 64;
+    std::string block_key = key;
+    if (block_key.size() > kBlockSize) {
+        Sha256 hasher;
+        hasher.update(reinterpret_cast<const uint8_t*>(block_key.data()), block_key.size());
+        auto digest = hasher.digest();
+        block_key.assign(digest.begin(), digest.end());
+    }
+    block_key.resize(kBlockSize, '\0');
+
+    std::string inner_pad(kBlockSize, '\0');
+    std::string outer_pad(kBlockSize, '\0');
+    for (size_t i = 0; i < kBlockSize; ++i) {
+        inner_pad[i] = static_cast<char>(block_key[i] ^ 0x36);
+        outer_pad[i] = static_cast<char>(block_key[i] ^ 0x5c);
+    }
+
+    Sha256 inner;
+    inner.update(reinterpret_cast<const uint8_t*>(inner_pad.data()), inner_pad.size());
+    inner.update(reinterpret_cast<const uint8_t*>(message.data()), message.size());
+    auto inner_digest = inner.digest();
+
+    Sha256 outer;
+    outer.update(reinterpret_cast<const uint8_t*>(outer_pad.data()), outer_pad.size());
+    outer.update(inner_digest.data(), inner_digest.size());
+    auto digest = outer.digest();
+    return std::string(digest.begin(), digest.end());
+}
+
+std::string amz_date() {
+    std::time_t now = std::time(nullptr);
+    std::tm utc{};
+    gmtime_r(&now, &utc);
+    char buffer[32];
+    std::strftime(buffer, sizeof(buffer), "%Y%m%dT%H%M%SZ", &utc);
+    return buffer;
+}
+
+// Text of the first <tag>...</tag> in an S3 XML reply
+std::string xml_value(const std::string& body, const std::string& tag) {
+    auto start = body.find("<" + tag + ">");
+    if (start == std::string::npos) {
+        return "";
+    }
+    start += tag.size() + 2;
+    auto end = body.find("</" + tag + ">", start);
+    return end == std::string::npos ? "" : body.substr(start, end - start);
+}
+
+void set_socket_timeouts(tcp::socket& socket) {
+    timeval timeout{};
+    timeout.tv_sec = kSocketTimeoutSeconds;
+    ::setsockopt(socket.native_handle(), SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    ::setsockopt(socket.native_handle(), SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+}
+
+template <class Stream>
+void exchange(Stream& stream, Request& request, int& status, std::string& body, std::string& etag,
+              beast::error_code& ec) {
+    http::write(stream, request, ec);
+    if (ec) {
+        return;
+    }
+    beast::flat_buffer buffer;
+    http::response_parser<http::string_body> parser;
+    parser.body_limit(kMaxResponseBytes);
+    http::read(stream, buffer, parser, ec);
+    if (ec) {
+        return;
+    }
+    const auto& message = parser.get();
+    status = static_cast<int>(message.result_int());
+    body = message.body();
+    etag = std::string(message[http::field::etag]);
+}
+
+} // namespace
+
+S3Client::S3Client(UploadTarget target) : target_(std::move(target)) {
+    std::string rest = target_.endpoint;
+    while (!rest.empty() && rest.back() == '/') {
+        rest.pop_back();
+    }
+    if (rest.rfind("https://", 0) == 0) {
+        use_tls_ = true;
+        rest = rest.substr(8);
+    } else if (rest.rfind("http://", 0) == 0) {
+        rest = rest.substr(7);
+    }
+    host_header_ = rest;
+
+    // host, host:port, [v6] or [v6]:port
+    size_t host_end = rest.front() == '[' ? rest.find(']') : std::string::npos;
+    size_t colon = rest.find(':', host_end == std::string::npos ? 0 : host_end);
+    if (host_end != std::string::npos) {
+        host_ = rest.substr(1, host_end - 1);
+    } else {
+        host_ = rest.substr(0, colon);
+    }
+    port_ = colon == std::string::npos ? (use_tls_ ? "443" : "80") : rest.substr(colon + 1);
+}
+
+bool S3Client::is_valid(std::string& error_message) const {
+    if (host_.empty() || target_.bucket.empty()) {
+        error_message = "Upload endpoint and bucket must be set";
+        return false;
+    }
+    if (target_.access_key.empty() || target_.secret_key.empty()) {
+        error_message = "Upload credentials are missing";
+        return false;
+    }
+#ifndef TRIMORA_HAVE_TLS
+    if (use_tls_) {
+        error_message = "This build has no TLS support; use an http:// endpoint";
+        return false;
+    }
+#endif
+    return true;
+}
+
+std::string S3Client::uri_encode(const std::string& value, bool keep_slash) {
+    static const char kDigits[] = "0123456789ABCDEF";
+    std::string encoded;
+    for (unsigned char c : value) {
+        if (std::isalnum(c) || c == '-' || c == '_' || c == '.' || c == '~' || (keep_slash && c == '/')) {
+            encoded += static_cast<char>(c);
+        } else {
+            encoded += '%';
+            encoded += kDigits[c >> 4];
+            encoded += kDigits[c & 0x0f];
+        }
+    }
+    return encoded;
+}
+
+std::string S3Client::sign_v4(
+    const std::string& method,
+    const std::string& canonical_uri,
+    const std::map<std::string, std::string>& query,
+    const std::map<std::string, std::string>& headers,
+    const std::string& payload_sha256,
+    const std::string& region,
+    const std::string& access_key,
+    const std::string& secret_key
+) {
+    std::string canonical_query;
+    for (const auto& [name, value] : query) {
+        canonical_query += (canonical_query.empty() ? "" : "&") + uri_encode(name, false) + "=" + uri_encode(value, false);
+    }
+    std::string canonical_headers;
+    std::string signed_headers;
+    for (const auto& [name, value] : headers) {
+        canonical_headers += name + ":" + value + "\n";
+        signed_headers += (signed_headers.empty() ? "" : ";") + name;
+    }
+    std::string canonical_request = method + "\n" + canonical_uri + "\n" + canonical_query + "\n" +
+                                    canonical_headers + "\n" + signed_headers + "\n" + payload_sha256;
+
+    std::string date = headers.at("x-amz-date");
+    std::string day = date.substr(0, 8);
+    std::string scope = day + "/" + region + "/s3/aws4_request";
+    std::string string_to_sign = "AWS4-HMAC-SHA256\n" + date + "\n" + scope + "\n" + sha256_hex(canonical_request);
+
+    std::string key = hmac_sha256("AWS4" + secret_key, day);
+    key = hmac_sha256(key, region);
+    key = hmac_sha256(key, "s3");
+    key = hmac_sha256(key, "aws4_request");
+    std::string signature = hmac_sha256(key, string_to_sign);
+
+    return "AWS4-HMAC-SHA256 Credential=" + access_key + "/" + scope +
+           ",SignedHeaders=" + signed_headers +
+           ",Signature=" + hex(reinterpret_cast<const uint8_t*>(signature.data()), signature.size());
+}
+
+S3Client::Response S3Client::send_once(
+    const std::string& method,
+    const std::string& key,
+    const std::map<std::string, std::string>& query,
+    const std::string& body,
+    const std::string& payload_sha256
+) {
+    Response response;
+
+    std::string path = "/" + uri_encode(target_.bucket, false);
+    if (!key.empty()) {
+        path += "/" + uri_encode(key, true);
+    }
+    std::map<std::string, std::string> headers = {
+        {"host", host_header_},
+        {"x-amz-content-sha256", payload_sha256},
+        {"x-amz-date", amz_date()}
+    };
+    std::string authorization = sign_v4(method, path, query, headers, payload_sha256,
+                                         target_.region, target_.access_key, target_.secret_key);
+
+    std::string request_target = path;
+    for (const auto& [name, value] : query) {
+        request_target += (request_target == path ? "?" : "&") + uri_encode(name, false);
+        if (!value.empty()) {
+            request_target += "=" + uri_encode(value, false);
+        }
+    }
+
+    Request request{http::string_to_verb(method), request_target, 11};
+    request.set(http::field::host, host_header_);
+    request.set(http::field::user_agent, "trimora");
+    request.set(http::field::authorization, authorization);
+    request.set("x-amz-content-sha256", payload_sha256);
+    request.set("x-amz-date", headers["x-amz-date"]);
+    request.body() = boost::beast::span<const char>(body.data(), body.size());
+    request.prepare_payload();
+
+    net::io_context ioc;
+    tcp::resolver resolver(ioc);
+    beast::error_code ec;
+    auto endpoints = resolver.resolve(host_, port_, ec);
+    if (ec) {
+        response.error_message = "Cannot resolve " + host_ + ": " + ec.message();
+        return response;
+    }
+
+    if (use_tls_) {
+#ifdef TRIMORA_HAVE_TLS
+        net::ssl::context context(net::ssl::context::tls_client);
+        context.set_default_verify_paths();
+        context.set_verify_mode(net::ssl::verify_peer);
+        net::ssl::stream<tcp::socket> stream(ioc, context);
+        SSL_set_tlsext_host_name(stream.native_handle(), host_.c_str());
+        stream.set_verify_callback(net::ssl::host_name_verification(host_));
+        net::connect(stream.next_layer(), endpoints, ec);
+        if (!ec) {
+            set_socket_timeouts(stream.next_layer());
+            stream.handshake(net::ssl::stream_base::client, ec);
+        }
+        if (!ec) {
+            exchange(stream, request, response.status, response.body, response.etag, ec);
+        }
+        beast::error_code ignored;
+        stream.shutdown(ignored);
+#endif
+    } else {
+        tcp::socket socket(ioc);
+        net::connect(socket, endpoints, ec);
+        if (!ec) {
+            set_socket_timeouts(socket);
+            exchange(socket, request, response.status, response.body, response.etag, ec);
+        }
+        beast::error_code ignored;
+        socket.shutdown(tcp::socket::shutdown_both, ignored);
+    }
+
+    if (ec) {
+        response.status = 0;
+        response.error_message = host_header_ + ": " + ec.message();
+    }
+    return response;
+}
+
+S3Client::Response S3Client::send(
+    const std::string& method,
+    const std::string& key,
+    const std::map<std::string, std::string>& query,
+    const std::string& body
+) {
+    std::string payload_sha256 = sha256_hex(body);
+    for (size_t attempt = 0;; ++attempt) {
+        Response response = send_once(method, key, query, body, payload_sha256);
+
+        // CompleteMultipartUpload can fail after sending 200 headers; the
+        // error then arrives in the body
+        if (response.status == 200 && response.body.find("<Error>") != std::string::npos) {
+            response.status = 500;
+        }
+
+        bool transient = response.status == 0 || response.status == 408 || response.status == 429 ||
+                         response.status >= 500;
+        if (!transient || attempt >= target_.max_retries) {
+            return response;
+        }
+
+        auto delay = std::min<std::chrono::milliseconds>(kRetryBaseDelay * (1 << attempt), kRetryMaxDelay);
+        TRIMORA_LOG_DEBUG(method + " " + key + " failed (" + describe_failure(response) + "), retrying in " +
+                          std::to_string(delay.count()) + " ms");
+        std::this_thread::sleep_for(delay);
+    }
+}
+
+std::string S3Client::describe_failure(const Response& response) {
+    if (response.status == 0) {
+        return response.error_message;
+    }
+    std::string message = "HTTP " + std::to_string(response.status);
+    std::string code = xml_value(response.body, "Code");
+    if (!code.empty()) {
+        message += " " + code;
+    }
+    std::string detail = xml_value(response.body, "Message");
+    if (!detail.empty()) {
+        message += ": " + detail;
+    }
+    return message;
+}
+
+std::optional<std::string> S3Client::create_multipart_upload(const std::string& key, std::string& error_message) {
+    auto response = send("POST", key, {{"uploads", ""}}, "");
+    std::string upload_id = xml_value(response.body, "UploadId");
+    if (response.status != 200 || upload_id.empty()) {
+        error_message = "Cannot start upload of " + key + ": " + describe_failure(response);
+        return std::nullopt;
+    }
+    return upload_id;
+}
+
+std::optional<std::string> S3Client::upload_part(
+    const std::string& key,
+    const std::string& upload_id,
+    int part_number,
+    std::string data,
+    std::string& error_message
+) {
+    auto response = send("PUT", key, {{"partNumber", std::to_string(part_number)}, {"uploadId", upload_id}}, data);
+    if (response.status != 200 || response.etag.empty()) {
+        error_message = "Part " + std::to_string(part_number) + " of " + key + " failed: " + describe_failure(response);
+        return std::nullopt;
+    }
+    return response.etag;
+}
+
+bool S3Client::complete_multipart_upload(
+    const std::string& key,
+    const std::string& upload_id,
+    const std::vector<std::string>& etags,
+    std::string& error_message
+) {
+    std::ostringstream body;
+    body << "<CompleteMultipartUpload>";
+    for (size_t i = 0; i < etags.size(); ++i) {
+        body << "<Part><PartNumber>" << (i + 1) << "</PartNumber><ETag>" << etags[i] << "</ETag></Part>";
+    }
+    body << "</CompleteMultipartUpload>";
+
+    auto response = send("POST", key, {{"uploadId", upload_id}}, body.str());
+    if (response.status != 200) {
+        error_message = "Cannot complete upload of " + key + ": " + describe_failure(response);
+        return false;
+    }
+    return true;
+}
+
+void S3Client::abort_multipart_upload(const std::string& key, const std::string& upload_id) {
+    auto response = send("DELETE", key, {{"uploadId", upload_id}}, "");
+    if (response.status != 204 && response.status != 200) {
+        // Left for the bucket's lifecycle rule to clean up
+        TRIMORA_LOG_WARNING("Could not abort upload of " + key + ": " + describe_failure(response));
+    }
+}
+
+bool S3Client::put_object(const std::string& key, std::string data, std::string& error_message) {
+    auto response = send("PUT", key, {}, data);
+    if (response.status != 200) {
+        error_message = "Upload of " + key + " failed: " + describe_failure(response);
+        return false;
+    }
+    return true;
+}
+
+} // namespace trimora
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <optional>
+#include <cstdint>
+
+namespace trimora {
+
+// An S3-compatible bucket (AWS, MinIO, Ceph RGW, ...) and how to talk to it
+struct UploadTarget {
+    std::string endpoint;      // http(s)://host[:port]; https needs a build with OpenSSL
+    std::string region = "us-east-1";
+    std::string bucket;
+    std::string prefix;        // Prepended to each output's file name to form the key
+    std::string access_key;
+    std::string secret_key;
+    size_t part_size_mb = 16;  // At least 5, the S3 minimum for every part but the last
+    size_t concurrency = 4;    // Part uploads in flight across all files
+    size_t max_retries = 4;    // Per request, with exponential backoff
+};
+
+// Multipart upload calls with AWS Signature V4 and path-style addressing.
+// Each call opens its own connection, so one client can be shared by
+// several threads. Requests that fail at the transport level or with a 5xx
+// or throttling status are retried; the payload SHA-256 is part of every
+// signature, so the server rejects a part that arrives altered.
+class S3Client {
+public:
+    explicit S3Client(UploadTarget target);
+
+    // Whether the endpoint can be used; otherwise error_message says why
+    bool is_valid(std::string& error_message) const;
+
+    std::optional<std::string> create_multipart_upload(const std::string& key, std::string& error_message);
+
+    // Returns the part's ETag
+    std::optional<std::string> upload_part(
+        const std::string& key,
+        const std::string& upload_id,
+        int part_number,
+        std::string data,
+        std::string& error_message
+    );
+
+    bool complete_multipart_upload(
+        const std::string& key,
+        const std::string& upload_id,
+        const std::vector<std::string>& etags,
+        std::string& error_message
+    );
+
+    void abort_multipart_upload(const std::string& key, const std::string& upload_id);
+
+    // Single request for small objects
+    bool put_object(const std::string& key, std::string data, std::string& error_message);
+
+    // Authorization header value for a request; headers are lowercase names
+    // and must include host, x-amz-date and x-amz-content-sha256, all of
+    // which are signed
+    static std::string sign_v4(
+        const std::string& method,
+        const std::string& canonical_uri,
+        const std::map<std::string, std::string>& query,
+        const std::map<std::string, std::string>& headers,
+        const std::string& payload_sha256,
+        const std::string& region,
+        const std::string& access_key,
+        const std::string& secret_key
+    );
+
+    // Percent-encoding as SigV4 wants it; '/' is kept when encoding a path
+    static std::string uri_encode(const std::string& value, bool keep_slash);
+
+private:
+    struct Response {
+        int status = 0;  // 0: no response (connection or TLS failure)
+        std::string body;
+        std::string etag;
+        std::string error_message;
+    };
+
+    Response send(
+        const std::string& method,
+        const std::string& key,
+        const std::map<std::string, std::string>& query,
+        const std::string& body
+    );
+    Response send_once(
+        const std::string& method,
+        const std::string& key,
+        const std::map<std::string, std::string>& query,
+        const std::string& body,
+        const std::string& payload_sha256
+    );
+    static std::string describe_failure(const Response& response);
+
+    UploadTarget target_;
+    bool use_tls_ = false;
+    std::string host_;
+    std::string port_;
+    std::string host_header_;
+};
+
+} // namespace trimora
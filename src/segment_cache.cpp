@@ -0,0 +1,194 @@
+#include "segment_cache.hpp"
+#include "output_digest.hpp"
+#include "logger.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace trimora {
+
+namespace {
+
+// Bump when the way pieces are produced changes
+constexpr const char* kKeyVersion = "piece-v2";
+
+constexpr const char* kStagingSuffix = ".partial";
+
+constexpr const char* kLockFile = "cache.lock";
+
+// A staging file this old belongs to a job that is gone
+constexpr auto kStaleStaging = std::chrono::hours(24);
+
+std::atomic<uint64_t> g_next_staging{0};
+
+} // namespace
+
+SegmentCache::SegmentCache(fs::path directory, uint64_t max_bytes)
+    : directory_(directory.empty() ? default_directory() : std::move(directory)),
+      max_bytes_(max_bytes) {
+}
+
+SegmentCache::Use::Use(const SegmentCache& cache) : fd_(cache.open_lock()) {
+    if (fd_) {
+        int result;
+        while ((result = ::flock(fd_.get(), LOCK_SH)) != 0 && errno == EINTR) {
+        }
+        locked_ = result == 0;
+    }
+    if (!locked_) {
+        TRIMORA_LOG_DEBUG("Segment cache: cannot lock " + (cache.directory_ / kLockFile).string());
+    }
+}
+
+SegmentCache::Use::~Use() {
+    if (locked_) {
+        ::flock(fd_.get(), LOCK_UN);
+    }
+}
+
+int SegmentCache::open_lock() const {
+    std::error_code ec;
+    fs::create_directories(directory_, ec);
+    fs::path path = directory_ / kLockFile;
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0666);
+    if (fd < 0 && errno == EACCES) {
+        // Created by another user; flock() works on read-only descriptors too
+        fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    }
+    return fd;
+}
+
+fs::path SegmentCache::default_directory() {
+    return fs::temp_directory_path() / "trimora_segment_cache";
+}
+
+std::string SegmentCache::make_key(
+    const std::vector<fs::path>& inputs,
+    double start_seconds,
+    double end_seconds,
+    const std::string& codec_options
+) {
+    std::ostringstream identity;
+    identity << kKeyVersion << '\n';
+    for (const auto& input : inputs) {
+        std::error_code ec;
+        fs::path absolute = fs::absolute(input, ec);
+        struct stat info{};
+        if (ec || ::stat(absolute.c_str(), &info) != 0) {
+            return "";
+        }
+        identity << absolute.string() << '\n'
+                 << info.st_dev << ':' << info.st_ino << ' ' << info.st_size << ' '
+                 << info.st_mtim.tv_sec << '.' << info.st_mtim.tv_nsec << '\n';
+    }
+    identity << std::fixed << std::setprecision(6) << start_seconds << '-' << end_seconds << '\n'
+             << codec_options;
+
+    std::string text = identity.str();
+    Sha256 hasher;
+    hasher.update(reinterpret_cast<const uint8_t*>(text.data()), text.size());
+    return hasher.hex_digest().substr(0, 32);
+}
+
+fs::path SegmentCache::piece_path(const std::string& key, const std::string& extension) const {
+    return directory_ / (key + extension);
+}
+
+std::optional<fs::path> SegmentCache::find(const std::string& key, const std::string& extension) const {
+    fs::path piece = piece_path(key, extension);
+    std::error_code ec;
+    if (!fs::is_regular_file(piece, ec) || fs::file_size(piece, ec) == 0) {
+        return std::nullopt;
+    }
+    // The modification time doubles as the last use, for trim()
+    fs::last_write_time(piece, fs::file_time_type::clock::now(), ec);
+    return piece;
+}
+
+fs::path SegmentCache::staging_path(const std::string& key, const std::string& extension) const {
+    std::error_code ec;
+    fs::create_directories(directory_, ec);
+    // FFmpeg picks the muxer from the last extension
+    return directory_ / (key + "." + std::to_string(::getpid()) + "-" + std::to_string(g_next_staging++) +
+                         kStagingSuffix + extension);
+}
+
+std::optional<fs::path> SegmentCache::commit(
+    const fs::path& staged,
+    const std::string& key,
+    const std::string& extension
+) const {
+    fs::path piece = piece_path(key, extension);
+    std::error_code ec;
+    fs::rename(staged, piece, ec);
+    if (ec) {
+        TRIMORA_LOG_WARNING("Cannot cache segment piece " + piece.string() + ": " + ec.message());
+        return std::nullopt;
+    }
+    return piece;
+}
+
+void SegmentCache::trim(const std::vector<fs::path>& keep) const {
+    struct Entry {
+        fs::path file;
+        fs::file_time_type used;
+        uint64_t size;
+    };
+    std::vector<Entry> entries;
+    uint64_t total = 0;
+    std::error_code ec;
+    auto stale_before = fs::file_time_type::clock::now() - kStaleStaging;
+    for (const auto& entry : fs::directory_iterator(directory_, ec)) {
+        if (!entry.is_regular_file(ec) || entry.path().filename() == kLockFile) {
+            continue;
+        }
+        if (entry.path().filename().string().find(kStagingSuffix) != std::string::npos) {
+            if (entry.last_write_time(ec) < stale_before) {
+                fs::remove(entry.path(), ec);
+            }
+            continue;
+        }
+        uint64_t size = entry.file_size(ec);
+        entries.push_back({entry.path(), entry.last_write_time(ec), size});
+        total += size;
+    }
+    if (total <= max_bytes_) {
+        return;
+    }
+
+    // A merge between find() and its concat would lose pieces it has found;
+    // the cache is trimmed after the last one finishes instead
+    ScopedFd lock(open_lock());
+    if (!lock || ::flock(lock.get(), LOCK_EX | LOCK_NB) != 0) {
+        TRIMORA_LOG_DEBUG("Segment cache: in use, not trimmed");
+        return;
+    }
+
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.used < b.used; });
+    size_t removed = 0;
+    for (const auto& entry : entries) {
+        if (total <= max_bytes_) {
+            break;
+        }
+        if (std::find(keep.begin(), keep.end(), entry.file) != keep.end()) {
+            continue;
+        }
+        if (fs::remove(entry.file, ec)) {
+            total -= entry.size;
+            ++removed;
+        }
+    }
+    TRIMORA_LOG_DEBUG("Segment cache: removed " + std::to_string(removed) + " piece(s), " +
+                      std::to_string(total / (1024 * 1024)) + " MB left");
+}
+
+} // namespace trimora
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "scoped_fd.hpp"
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace trimora {
+
+// Segment pieces extracted for merges, kept in scratch space so that
+// re-exporting an edited segment list only extracts the segments that
+// changed. A piece is keyed by the identity of every file it is read from
+// (path, size, modification time, inode), the exact range and the options
+// that shape its bytes, so an edited or replaced input never matches an
+// old piece. Least recently used pieces are removed beyond the size limit.
+class SegmentCache {
+public:
+    SegmentCache(std::filesystem::path directory, uint64_t max_bytes);
+
+    // While a Use exists, trim() removes no pieces, in this process or any
+    // other. A merge holds one from its first find() until the concat has
+    // read the pieces.
+    class Use {
+    public:
+        explicit Use(const SegmentCache& cache);
+        ~Use();
+
+        Use(const Use&) = delete;
+        Use& operator=(const Use&) = delete;
+
+    private:
+        ScopedFd fd_;
+        bool locked_ = false;
+    };
+
+    // Empty if an input can't be stat'ed (nothing is cached then)
+    static std::string make_key(
+        const std::vector<std::filesystem::path>& inputs,
+        double start_seconds,
+        double end_seconds,
+        const std::string& codec_options
+    );
+
+    // The cached piece, marked as recently used
+    std::optional<std::filesystem::path> find(const std::string& key, const std::string& extension) const;
+
+    // Where to extract a new piece (unique per call, so concurrent jobs
+    // don't write over each other); commit() moves it into the cache
+    std::filesystem::path staging_path(const std::string& key, const std::string& extension) const;
+    std::optional<std::filesystem::path> commit(
+        const std::filesystem::path& staged,
+        const std::string& key,
+        const std::string& extension
+    ) const;
+
+    // Removes least recently used pieces until the cache fits, sparing keep,
+    // and staging files left behind by jobs that died. Pieces are left alone
+    // while any Use is held.
+    void trim(const std::vector<std::filesystem::path>& keep) const;
+
+    const std::filesystem::path& directory() const { return directory_; }
+
+    // trimora_segment_cache in the temp directory
+    static std::filesystem::path default_directory();
+
+private:
+    std::filesystem::path piece_path(const std::string& key, const std::string& extension) const;
+    // Descriptor of the lock file users share and trim() takes exclusively
+    int open_lock() const;
+
+    std::filesystem::path directory_;
+    uint64_t max_bytes_;
+};
+
+} // namespace trimora
@@ -0,0 +1,158 @@
+#include "speculative_extractor.hpp"
+#include "segment_cache.hpp"
+#include "logger.hpp"
+#include <algorithm>
+#include <set>
+#include <sstream>
+
+namespace trimora {
+
+namespace {
+
+// How often the worker looks for a settled segment
+constexpr auto kPoll = std::chrono::milliseconds(250);
+
+bool same_segments(const std::vector<TrimSegment>& a, const std::vector<TrimSegment>& b) {
+    return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](const TrimSegment& x, const TrimSegment& y) {
+        return x.start_time == y.start_time && x.end_time == y.end_time && x.enabled == y.enabled;
+    });
+}
+
+// A job the user started, running or queued for a slot, has the machine
+// to itself
+bool foreground_busy(const FFmpegExecutor& executor) {
+    return executor.is_running() || executor.is_waiting_for_slot();
+}
+
+} // namespace
+
+SpeculativeExtractor::SpeculativeExtractor(FFmpegExecutor& executor, std::chrono::milliseconds settle_time)
+    : executor_(executor),
+      settle_time_(settle_time),
+      worker_([this] { run(); }) {
+}
+
+SpeculativeExtractor::~SpeculativeExtractor() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    worker_.join();
+}
+
+std::string SpeculativeExtractor::range_of(const TrimSegment& segment) {
+    return segment.start_time + "|" + segment.end_time;
+}
+
+std::string SpeculativeExtractor::context_of(const MultiSegmentTrimOptions& options) {
+    if (!options.piece_cache || !options.merge_segments || options.input_file.empty()) {
+        return "";
+    }
+    std::ostringstream context;
+    context << options.piece_cache.get() << '\n' << options.input_file.string() << '\n';
+    for (const auto& chunk : options.chunks.chunks()) {
+        context << chunk.file.string() << '\n';
+    }
+    context << options.use_copy_codec << options.reencode_audio << ' ' << options.audio_fade_seconds;
+    return context.str();
+}
+
+void SpeculativeExtractor::update(const MultiSegmentTrimOptions& options) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::string context = context_of(options);
+    bool changed = false;
+    if (context != context_) {
+        context_ = std::move(context);
+        ++generation_;
+        candidates_.clear();
+        changed = true;
+    }
+    if (!changed && same_segments(options.segments, latest_.segments)) {
+        return;
+    }
+
+    std::set<std::string> ranges;
+    if (!context_.empty()) {
+        for (const auto& segment : options.segments) {
+            if (segment.enabled) {
+                ranges.insert(range_of(segment));
+            }
+        }
+    }
+    auto now = std::chrono::steady_clock::now();
+    for (auto it = candidates_.begin(); it != candidates_.end();) {
+        it = ranges.count(it->first) ? std::next(it) : candidates_.erase(it);
+    }
+    for (const auto& range : ranges) {
+        candidates_.try_emplace(range, Candidate{now});
+    }
+    latest_ = options;
+    wake_.notify_all();
+}
+
+size_t SpeculativeExtractor::ready_count() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return static_cast<size_t>(std::count_if(candidates_.begin(), candidates_.end(),
+        [](const auto& candidate) { return candidate.second.ready; }));
+}
+
+std::optional<size_t> SpeculativeExtractor::next_candidate(std::chrono::steady_clock::time_point now) const {
+    for (size_t i = 0; i < latest_.segments.size(); ++i) {
+        const auto& segment = latest_.segments[i];
+        if (!segment.enabled) {
+            continue;
+        }
+        auto candidate = candidates_.find(range_of(segment));
+        if (candidate != candidates_.end() && !candidate->second.ready && !candidate->second.failed &&
+            now - candidate->second.stable_since >= settle_time_) {
+            return i;
+        }
+    }
+    return std::nullopt;
+}
+
+bool SpeculativeExtractor::is_current(uint64_t generation, const std::string& range) const {
+    return !stop_ && generation == generation_ && candidates_.count(range) > 0;
+}
+
+void SpeculativeExtractor::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stop_) {
+        wake_.wait_for(lock, kPoll);
+        if (stop_ || context_.empty() || foreground_busy(executor_)) {
+            continue;
+        }
+        auto index = next_candidate(std::chrono::steady_clock::now());
+        if (!index) {
+            continue;
+        }
+
+        MultiSegmentTrimOptions options = latest_;
+        uint64_t generation = generation_;
+        std::string range = range_of(options.segments[*index]);
+        lock.unlock();
+
+        PrecacheResult result = executor_.precache_segment(options, *index, [&] {
+            std::lock_guard<std::mutex> guard(mutex_);
+            return is_current(generation, range) && !foreground_busy(executor_);
+        });
+        if (result == PrecacheResult::Cached) {
+            options.piece_cache->trim({});
+        }
+
+        lock.lock();
+        if (!is_current(generation, range)) {
+            continue;  // Edited meanwhile; whatever was extracted is discarded
+        }
+        if (result == PrecacheResult::Cached) {
+            candidates_[range].ready = true;
+        } else if (result == PrecacheResult::Failed) {
+            // The export will report why
+            TRIMORA_LOG_DEBUG("Background extraction of segment " + std::to_string(*index + 1) + " failed");
+            candidates_[range].failed = true;
+        }
+    }
+}
+
+} // namespace trimora
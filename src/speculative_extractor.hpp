@@ -0,0 +1,66 @@
+#pragma once
+
+#include "ffmpeg_executor.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+
+namespace trimora {
+
+// Extracts merge pieces into the segment cache while segments are still
+// being edited, so pressing Export is mostly a concat of pieces that are
+// already there. A segment is extracted once its range has stayed the same
+// for the settle time; an extraction whose segment is edited or removed, or
+// that would compete with a job the user started, is stopped and discarded.
+// One piece is extracted at a time, at the lowest CPU priority, and only
+// in a job slot that no queued job is waiting for.
+class SpeculativeExtractor {
+public:
+    SpeculativeExtractor(FFmpegExecutor& executor, std::chrono::milliseconds settle_time);
+    ~SpeculativeExtractor();
+
+    SpeculativeExtractor(const SpeculativeExtractor&) = delete;
+    SpeculativeExtractor& operator=(const SpeculativeExtractor&) = delete;
+
+    // The merge as it would run if exported now (output_file is not used).
+    // Cheap when nothing changed, so it can be called every frame. Options
+    // without a piece cache, or that don't merge, stop the speculation.
+    void update(const MultiSegmentTrimOptions& options);
+
+    // Enabled segments of the latest options whose piece is ready
+    size_t ready_count() const;
+
+private:
+    struct Candidate {
+        std::chrono::steady_clock::time_point stable_since;
+        bool ready = false;
+        bool failed = false;  // Not retried until the segment changes
+    };
+
+    void run();
+    // Segment at the front of the latest list that has settled and isn't
+    // extracted yet; lock held
+    std::optional<size_t> next_candidate(std::chrono::steady_clock::time_point now) const;
+    bool is_current(uint64_t generation, const std::string& range) const;  // Lock held
+
+    static std::string range_of(const TrimSegment& segment);
+    static std::string context_of(const MultiSegmentTrimOptions& options);
+
+    FFmpegExecutor& executor_;
+    std::chrono::milliseconds settle_time_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    MultiSegmentTrimOptions latest_;
+    std::string context_;                        // Everything but the ranges that shapes a piece
+    uint64_t generation_ = 0;                    // Bumped when context_ changes
+    std::map<std::string, Candidate> candidates_;  // By range of each enabled segment
+    bool stop_ = false;
+    std::thread worker_;
+};
+
+} // namespace trimora
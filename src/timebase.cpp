@@ -0,0 +1,246 @@
+#include "timebase.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <numeric>
+
+namespace trimora {
+
+namespace {
+
+// Decimals kept when parsing; finer digits are rounded away
+constexpr int kMaxDecimals = 9;
+
+struct U128 {
+    uint64_t hi = 0;
+    uint64_t lo = 0;
+};
+
+U128 multiply(uint64_t a, uint64_t b) {
+    uint64_t a_lo = a & 0xffffffffu, a_hi = a >> 32;
+    uint64_t b_lo = b & 0xffffffffu, b_hi = b >> 32;
+    uint64_t lo_lo = a_lo * b_lo;
+    uint64_t hi_lo = a_hi * b_lo;
+    uint64_t lo_hi = a_lo * b_hi;
+    uint64_t hi_hi = a_hi * b_hi;
+    uint64_t middle = (lo_lo >> 32) + (hi_lo & 0xffffffffu) + lo_hi;
+    return {hi_hi + (hi_lo >> 32) + (middle >> 32), (middle << 32) | (lo_lo & 0xffffffffu)};
+}
+
+// Quotient (saturated to 64 bits) and remainder of a 128-bit value
+uint64_t divide(U128 value, uint64_t divisor, uint64_t& remainder) {
+    uint64_t quotient = 0;
+    remainder = 0;
+    for (int bit = 127; bit >= 0; --bit) {
+        bool carry = remainder >> 63;
+        uint64_t next = bit >= 64 ? (value.hi >> (bit - 64)) & 1 : (value.lo >> bit) & 1;
+        remainder = (remainder << 1) | next;
+        if (carry || remainder >= divisor) {
+            remainder -= divisor;
+            if (bit >= 64) {
+                return UINT64_MAX;  // Doesn't fit
+            }
+            quotient |= uint64_t{1} << bit;
+        }
+    }
+    return quotient;
+}
+
+uint64_t magnitude(int64_t value) {
+    return value < 0 ? uint64_t{0} - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+}
+
+int64_t parse_digits(std::string_view digits) {
+    if (digits.empty() || digits.size() > 15) {
+        return -1;
+    }
+    int64_t value = 0;
+    for (char c : digits) {
+        if (c < '0' || c > '9') {
+            return -1;
+        }
+        value = value * 10 + (c - '0');
+    }
+    return value;
+}
+
+// "12" or "12.345"; exact
+std::optional<Rational> parse_decimal(std::string_view text) {
+    size_t dot = text.find('.');
+    int64_t whole = parse_digits(text.substr(0, dot));
+    if (whole < 0 && !(dot == 0 && text.size() > 1)) {
+        return std::nullopt;
+    }
+    Rational value(whole < 0 ? 0 : whole);
+    if (dot == std::string_view::npos) {
+        return value;
+    }
+
+    std::string_view decimals = text.substr(dot + 1);
+    bool round_up = false;
+    if (decimals.size() > kMaxDecimals) {
+        round_up = decimals[kMaxDecimals] >= '5';
+        for (char c : decimals.substr(kMaxDecimals)) {
+            if (c < '0' || c > '9') {
+                return std::nullopt;
+            }
+        }
+        decimals = decimals.substr(0, kMaxDecimals);
+    }
+    if (decimals.empty()) {
+        return value;
+    }
+    int64_t fraction = parse_digits(decimals);
+    if (fraction < 0) {
+        return std::nullopt;
+    }
+    int64_t scale = 1;
+    for (size_t i = 0; i < decimals.size(); ++i) {
+        scale *= 10;
+    }
+    return value + Rational(fraction + (round_up ? 1 : 0), scale);
+}
+
+} // namespace
+
+Rational::Rational(int64_t numerator, int64_t denominator) : num(numerator), den(denominator) {
+    if (den < 0) {
+        num = -num;
+        den = -den;
+    }
+    int64_t divisor = std::gcd(num, den);
+    if (divisor > 1) {
+        num /= divisor;
+        den /= divisor;
+    }
+}
+
+std::optional<Rational> Rational::parse(std::string_view text) {
+    size_t slash = text.find('/');
+    if (slash == std::string_view::npos) {
+        auto value = parse_decimal(text);
+        if (!value || value->is_zero()) {
+            return std::nullopt;
+        }
+        return value;
+    }
+    int64_t numerator = parse_digits(text.substr(0, slash));
+    int64_t denominator = parse_digits(text.substr(slash + 1));
+    if (numerator <= 0 || denominator <= 0) {
+        return std::nullopt;
+    }
+    return Rational(numerator, denominator);
+}
+
+Rational operator+(Rational a, Rational b) {
+    int64_t divisor = std::gcd(a.den, b.den);
+    int64_t scale_b = a.den / divisor;
+    return Rational(a.num * (b.den / divisor) + b.num * scale_b, b.den * scale_b);
+}
+
+Rational operator-(Rational a, Rational b) {
+    return a + Rational(-b.num, b.den);
+}
+
+Rational operator*(Rational a, Rational b) {
+    // Cross-reduce first to keep the products small
+    int64_t g1 = std::gcd(a.num, b.den);
+    int64_t g2 = std::gcd(b.num, a.den);
+    g1 = g1 == 0 ? 1 : g1;
+    g2 = g2 == 0 ? 1 : g2;
+    return Rational((a.num / g1) * (b.num / g2), (a.den / g2) * (b.den / g1));
+}
+
+Rational operator/(Rational a, Rational b) {
+    return a * Rational(b.den, b.num);
+}
+
+bool operator==(Rational a, Rational b) {
+    return a.num == b.num && a.den == b.den;
+}
+
+bool operator<(Rational a, Rational b) {
+    // a.num * b.den < b.num * a.den, without overflow
+    return mul_div(a.num, b.den, 1, Rounding::Down) < mul_div(b.num, a.den, 1, Rounding::Down);
+}
+
+int64_t mul_div(int64_t value, int64_t multiplier, int64_t divisor, Rounding rounding) {
+    bool negative = (value < 0) != (multiplier < 0);
+    uint64_t remainder = 0;
+    uint64_t divisor_magnitude = magnitude(divisor);
+    uint64_t quotient = divide(multiply(magnitude(value), magnitude(multiplier)), divisor_magnitude, remainder);
+    if (remainder != 0) {
+        // Round the magnitude so that the signed result rounds as asked
+        bool away = rounding == Rounding::Nearest ? remainder >= divisor_magnitude - remainder
+                  : (rounding == Rounding::Up) != negative;
+        if (away) {
+            ++quotient;
+        }
+    }
+    auto result = static_cast<int64_t>(quotient > static_cast<uint64_t>(INT64_MAX) ? INT64_MAX : quotient);
+    return negative ? -result : result;
+}
+
+int64_t to_units(Rational time, Rational unit, Rounding rounding) {
+    // time / unit = (time.num * unit.den) / (time.den * unit.num)
+    Rational ratio(unit.den, time.den);  // Reduced, so the divisor stays small
+    return mul_div(time.num, ratio.num, ratio.den * unit.num, rounding);
+}
+
+std::optional<Rational> parse_timecode(std::string_view text) {
+    while (!text.empty() && text.front() == ' ') {
+        text.remove_prefix(1);
+    }
+    while (!text.empty() && text.back() == ' ') {
+        text.remove_suffix(1);
+    }
+    if (text.empty()) {
+        return std::nullopt;
+    }
+
+    // Whole minutes and hours before the last field
+    Rational total;
+    size_t fields = 0;
+    size_t colon = 0;
+    while ((colon = text.find(':')) != std::string_view::npos) {
+        int64_t value = parse_digits(text.substr(0, colon));
+        if (value < 0 || ++fields > 2) {
+            return std::nullopt;
+        }
+        total = (total + Rational(value)) * Rational(60);
+        text.remove_prefix(colon + 1);
+    }
+    auto seconds = parse_decimal(text);
+    if (!seconds) {
+        return std::nullopt;
+    }
+    return total + *seconds;
+}
+
+std::string format_seconds(Rational seconds, Rounding rounding) {
+    int64_t micros = to_units(seconds, Rational(1, 1000000), rounding);
+    uint64_t value = magnitude(micros);
+    char buffer[48];
+    std::snprintf(buffer, sizeof(buffer), "%s%llu.%06llu", micros < 0 ? "-" : "",
+                  static_cast<unsigned long long>(value / 1000000),
+                  static_cast<unsigned long long>(value % 1000000));
+    return buffer;
+}
+
+Rational CutGrid::snap(Rational time) const {
+    if (!has_frames()) {
+        return time;
+    }
+    Rational period(frame_rate.den, frame_rate.num);
+    return origin + Rational(to_units(time - origin, period, Rounding::Nearest)) * period;
+}
+
+Rational CutGrid::cut_before(Rational boundary) const {
+    if (!has_frames()) {
+        return boundary;
+    }
+    Rational half_period(frame_rate.den, frame_rate.num * 2);
+    Rational cut = boundary - half_period;
+    return cut < origin ? std::min(origin, boundary) : cut;
+}
+
+} // namespace trimora
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <cstdint>
+
+namespace trimora {
+
+// Exact fraction, always reduced and with a positive denominator. Cut points,
+// frame rates and stream timebases are kept as rationals so that frame
+// boundaries of NTSC rates (30000/1001) don't drift the way sums of doubles do.
+struct Rational {
+    int64_t num = 0;
+    int64_t den = 1;
+
+    Rational() = default;
+    Rational(int64_t numerator, int64_t denominator = 1);
+
+    bool is_zero() const { return num == 0; }
+    double to_double() const { return static_cast<double>(num) / static_cast<double>(den); }
+
+    // "30000/1001", "48000" or a decimal like "29.97" (taken exactly).
+    // nullopt for junk and for ffprobe's "0/0" (unknown).
+    static std::optional<Rational> parse(std::string_view text);
+};
+
+Rational operator+(Rational a, Rational b);
+Rational operator-(Rational a, Rational b);
+Rational operator*(Rational a, Rational b);
+Rational operator/(Rational a, Rational b);
+bool operator==(Rational a, Rational b);
+bool operator<(Rational a, Rational b);
+inline bool operator!=(Rational a, Rational b) { return !(a == b); }
+inline bool operator>(Rational a, Rational b) { return b < a; }
+inline bool operator<=(Rational a, Rational b) { return !(b < a); }
+inline bool operator>=(Rational a, Rational b) { return !(a < b); }
+
+enum class Rounding { Down, Nearest, Up };
+
+// value * multiplier / divisor with a 128-bit intermediate, rounded.
+// divisor must be positive.
+int64_t mul_div(int64_t value, int64_t multiplier, int64_t divisor, Rounding rounding);
+
+// How many whole units fit in time, e.g. ticks of a timebase or frames of a
+// frame period: to_units(t, {1, 90000}) is t in 90 kHz ticks
+int64_t to_units(Rational time, Rational unit, Rounding rounding);
+
+// A cut time as typed: "HH:MM:SS.fff", "MM:SS.fff" or plain seconds, with
+// any number of decimals (beyond nanoseconds they are rounded). nullopt if
+// malformed or negative.
+std::optional<Rational> parse_timecode(std::string_view text);
+
+// Seconds with six decimals, the precision ffmpeg parses time options with
+std::string format_seconds(Rational seconds, Rounding rounding = Rounding::Nearest);
+
+// Where cuts in one input may land: the frame boundaries of its video
+// stream. A grid without a frame rate (no video, or variable frame rate)
+// leaves cut times as typed.
+struct CutGrid {
+    Rational frame_rate;      // Frames per second; zero when unknown
+    Rational time_base;       // Of the video stream; zero when unknown
+    Rational origin;          // First frame, on the timeline cut times refer to
+    Rational timeline_start;  // Raw timestamp of that timeline's zero (earliest stream start)
+    int64_t sample_rate = 0;  // Of the first audio stream; 0 without audio
+
+    bool has_frames() const { return !frame_rate.is_zero(); }
+
+    // Frame boundary nearest to time
+    Rational snap(Rational time) const;
+
+    // Cut for a frame boundary as passed to ffmpeg: half a frame early, so
+    // the microsecond rounding of time options and the rounding of frame
+    // timestamps to the timebase can't move the cut across a frame. The
+    // frame starting at boundary is on the far side of the cut.
+    Rational cut_before(Rational boundary) const;
+};
+
+} // namespace trimora
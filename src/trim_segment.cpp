@@ -1,7 +1,7 @@
 #include "trim_segment.hpp"
 #include "validator.hpp"
+#include "timebase.hpp"
 #include <algorithm>
-#include <regex>
 
 namespace trimora {
 
@@ -99,25 +99,8 @@ bool SegmentManager::check_overlaps(size_t exclude_index) const {
 }
 
 double SegmentManager::time_to_seconds(const std::string& time) const {
-    // Parse HH:MM:SS.mmm format
-    std::regex time_regex(R"((\d{2}):(\d{2}):(\d{2})\.?(\d{0,3}))");
-    std::smatch match;
-    
-    if (std::regex_match(time, match, time_regex)) {
-        int hours = std::stoi(match[1]);
-        int minutes = std::stoi(match[2]);
-        int seconds = std::stoi(match[3]);
-        int milliseconds = match[4].length() > 0 ? std::stoi(match[4]) : 0;
-        
-        return hours * 3600.0 + minutes * 60.0 + seconds + milliseconds / 1000.0;
-    }
-    
-    // Try to parse as decimal seconds
-    try {
-        return std::stod(time);
-    } catch (...) {
-        return 0.0;
-    }
+    // HH:MM:SS.mmm, MM:SS.mmm or decimal seconds
+    return parse_timecode(time).value_or(Rational()).to_double();
 }
 
 } // namespace trimora
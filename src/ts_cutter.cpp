@@ -0,0 +1,463 @@
+#include "ts_cutter.hpp"
+#include "scoped_fd.hpp"
+#include <algorithm>
+#include <array>
+#include <optional>
+#include <vector>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+namespace fs = std::filesystem;
+
+namespace trimora {
+
+namespace {
+
+constexpr size_t kTsPacketSize = 188;
+constexpr uint8_t kSyncByte = 0x47;
+constexpr uint64_t kPtsWrap = 1ULL << 33;
+constexpr double kPtsClock = 90000.0;
+
+constexpr uint64_t kProbePackets = 256;         // Packets read per timestamp probe
+constexpr uint64_t kMaxScanPackets = 1 << 18;   // ~48 MB: give up looking for a PTS, RAP or PSI
+
+// Packet layout and the program tables needed to cut one input
+struct TsLayout {
+    size_t packet_size = kTsPacketSize;  // 192 for M2TS
+    size_t sync_offset = 0;              // 4 for M2TS (arrival timestamp first)
+    uint64_t first_offset = 0;           // Byte offset of packet 0
+    uint64_t packet_count = 0;
+
+    uint16_t pmt_pid = 0;
+    uint16_t video_pid = 0;
+    uint8_t video_type = 0;
+    std::vector<uint8_t> pat;  // Raw packets, packet_size bytes each
+    std::vector<uint8_t> pmt;
+    uint64_t first_pts = 0;
+
+    uint64_t packet_offset(uint64_t index) const {
+        return first_offset + index * packet_size;
+    }
+};
+
+struct TsPacket {
+    uint16_t pid = 0;
+    bool unit_start = false;
+    bool random_access = false;
+    const uint8_t* payload = nullptr;
+    size_t payload_size = 0;
+};
+
+std::optional<TsPacket> parse_packet(const uint8_t* p) {
+    if (p[0] != kSyncByte) {
+        return std::nullopt;
+    }
+
+    TsPacket packet;
+    packet.pid = static_cast<uint16_t>(((p[1] & 0x1f) << 8) | p[2]);
+    packet.unit_start = (p[1] & 0x40) != 0;
+
+    int adaptation = (p[3] >> 4) & 0x3;
+    size_t offset = 4;
+    if (adaptation & 0x2) {
+        size_t length = p[4];
+        if (length > 0) {
+            packet.random_access = (p[5] & 0x40) != 0;
+        }
+        offset = 5 + length;
+    }
+    if ((adaptation & 0x1) && offset < kTsPacketSize) {
+        packet.payload = p + offset;
+        packet.payload_size = kTsPacketSize - offset;
+    }
+    return packet;
+}
+
+// PSI section in a single packet (PAT and PMT almost always are)
+const uint8_t* section_start(const TsPacket& packet, uint8_t table_id, size_t& section_size) {
+    if (!packet.unit_start || packet.payload_size < 1) {
+        return nullptr;
+    }
+    size_t pointer = packet.payload[0];
+    if (1 + pointer + 3 > packet.payload_size) {
+        return nullptr;
+    }
+    const uint8_t* section = packet.payload + 1 + pointer;
+    size_t available = packet.payload_size - 1 - pointer;
+    size_t length = ((section[1] & 0x0f) << 8) | section[2];
+    if (section[0] != table_id || 3 + length > available || length < 9) {
+        return nullptr;
+    }
+    section_size = 3 + length;
+    return section;
+}
+
+bool is_video_stream_type(uint8_t type) {
+    switch (type) {
+        case 0x01:  // MPEG-1
+        case 0x02:  // MPEG-2
+        case 0x10:  // MPEG-4 part 2
+        case 0x1b:  // H.264
+        case 0x24:  // HEVC
+        case 0xea:  // VC-1
+            return true;
+        default:
+            return false;
+    }
+}
+
+std::optional<uint64_t> parse_pes_pts(const TsPacket& packet) {
+    const uint8_t* pes = packet.payload;
+    if (!packet.unit_start || packet.payload_size < 14 ||
+        pes[0] != 0x00 || pes[1] != 0x00 || pes[2] != 0x01 || !(pes[7] & 0x80)) {
+        return std::nullopt;
+    }
+    return (static_cast<uint64_t>((pes[9] >> 1) & 0x07) << 30) |
+           (static_cast<uint64_t>(pes[10]) << 22) |
+           (static_cast<uint64_t>(pes[11] >> 1) << 15) |
+           (static_cast<uint64_t>(pes[12]) << 7) |
+           (static_cast<uint64_t>(pes[13]) >> 1);
+}
+
+// A video PES that a decoder can start from: flagged by the muxer, or
+// opening with a keyframe/sequence header we can recognise
+bool is_random_access_point(const TsPacket& packet, uint8_t video_type) {
+    if (!packet.unit_start) {
+        return false;
+    }
+    if (packet.random_access) {
+        return true;
+    }
+    if (packet.payload_size < 9) {
+        return false;
+    }
+
+    size_t start = 9 + packet.payload[8];
+    for (size_t i = start; i + 3 < packet.payload_size; ++i) {
+        if (packet.payload[i] != 0x00 || packet.payload[i + 1] != 0x00 || packet.payload[i + 2] != 0x01) {
+            continue;
+        }
+        uint8_t code = packet.payload[i + 3];
+        switch (video_type) {
+            case 0x1b: {
+                int nal_type = code & 0x1f;
+                if (nal_type == 5 || nal_type == 7) {
+                    return true;
+                }
+                break;
+            }
+            case 0x24: {
+                int nal_type = (code >> 1) & 0x3f;
+                if ((nal_type >= 16 && nal_type <= 21) || (nal_type >= 32 && nal_type <= 34)) {
+                    return true;
+                }
+                break;
+            }
+            case 0x01:
+            case 0x02:
+                if (code == 0xb3) {
+                    return true;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+    return false;
+}
+
+bool read_packets(int fd, const TsLayout& layout, uint64_t index, uint64_t count, std::vector<uint8_t>& buffer) {
+    buffer.resize(count * layout.packet_size);
+    size_t done = 0;
+    while (done < buffer.size()) {
+        ssize_t n = ::pread(fd, buffer.data() + done, buffer.size() - done,
+            static_cast<off_t>(layout.packet_offset(index) + done));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        done += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool detect_layout(int fd, uint64_t file_size, TsLayout& layout) {
+    constexpr int kSyncChecks = 8;
+    std::array<uint8_t, 192 * (kSyncChecks + 1)> head{};
+    ssize_t n = ::pread(fd, head.data(), head.size(), 0);
+    if (n < static_cast<ssize_t>(head.size())) {
+        return false;
+    }
+
+    for (size_t packet_size : {size_t(188), size_t(192)}) {
+        size_t sync_offset = packet_size - kTsPacketSize;
+        for (size_t start = 0; start < packet_size; ++start) {
+            bool aligned = true;
+            for (int k = 0; k < kSyncChecks && aligned; ++k) {
+                size_t at = start + sync_offset + k * packet_size;
+                aligned = at < head.size() && head[at] == kSyncByte;
+            }
+            if (aligned) {
+                layout.packet_size = packet_size;
+                layout.sync_offset = sync_offset;
+                layout.first_offset = start;
+                layout.packet_count = (file_size - start) / packet_size;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// PAT, then the first program's PMT and video stream, from the head of the file
+bool read_program_tables(int fd, TsLayout& layout) {
+    std::vector<uint8_t> buffer;
+    uint64_t limit = std::min(layout.packet_count, kMaxScanPackets);
+
+    for (uint64_t index = 0; index < limit; index += kProbePackets) {
+        uint64_t count = std::min(kProbePackets, limit - index);
+        if (!read_packets(fd, layout, index, count, buffer)) {
+            return false;
+        }
+
+        for (uint64_t i = 0; i < count; ++i) {
+            const uint8_t* raw = buffer.data() + i * layout.packet_size;
+            auto packet = parse_packet(raw + layout.sync_offset);
+            if (!packet) {
+                continue;
+            }
+
+            size_t size = 0;
+            if (layout.pat.empty() && packet->pid == 0) {
+                const uint8_t* pat = section_start(*packet, 0x00, size);
+                if (!pat) {
+                    continue;
+                }
+                for (size_t at = 8; at + 4 <= size - 4; at += 4) {
+                    uint16_t program = static_cast<uint16_t>((pat[at] << 8) | pat[at + 1]);
+                    if (program != 0) {
+                        layout.pmt_pid = static_cast<uint16_t>(((pat[at + 2] & 0x1f) << 8) | pat[at + 3]);
+                        layout.pat.assign(raw, raw + layout.packet_size);
+                        break;
+                    }
+                }
+            } else if (!layout.pat.empty() && packet->pid == layout.pmt_pid) {
+                const uint8_t* pmt = section_start(*packet, 0x02, size);
+                if (!pmt) {
+                    continue;
+                }
+                size_t program_info = ((pmt[10] & 0x0f) << 8) | pmt[11];
+                for (size_t at = 12 + program_info; at + 5 <= size - 4;) {
+                    uint8_t type = pmt[at];
+                    uint16_t pid = static_cast<uint16_t>(((pmt[at + 1] & 0x1f) << 8) | pmt[at + 2]);
+                    size_t info_length = ((pmt[at + 3] & 0x0f) << 8) | pmt[at + 4];
+                    if (is_video_stream_type(type)) {
+                        layout.video_pid = pid;
+                        layout.video_type = type;
+                        layout.pmt.assign(raw, raw + layout.packet_size);
+                        return true;
+                    }
+                    at += 5 + info_length;
+                }
+                return false;  // No video stream to cut on
+            }
+        }
+    }
+    return false;
+}
+
+struct PtsHit {
+    uint64_t index = 0;
+    uint64_t pts = 0;  // Relative to the first PTS, wrap-corrected
+};
+
+// First video PES timestamp at or after a packet
+std::optional<PtsHit> find_pts_forward(int fd, const TsLayout& layout, uint64_t from) {
+    std::vector<uint8_t> buffer;
+    uint64_t limit = std::min(layout.packet_count, from + kMaxScanPackets);
+
+    for (uint64_t index = from; index < limit; index += kProbePackets) {
+        uint64_t count = std::min(kProbePackets, limit - index);
+        if (!read_packets(fd, layout, index, count, buffer)) {
+            return std::nullopt;
+        }
+        for (uint64_t i = 0; i < count; ++i) {
+            auto packet = parse_packet(buffer.data() + i * layout.packet_size + layout.sync_offset);
+            if (!packet || packet->pid != layout.video_pid) {
+                continue;
+            }
+            if (auto pts = parse_pes_pts(*packet)) {
+                return PtsHit{index + i, (*pts + kPtsWrap - layout.first_pts) % kPtsWrap};
+            }
+        }
+    }
+    return std::nullopt;
+}
+
+// First packet whose next video timestamp is at or past the target. PTS
+// isn't monotonic across B-frames, so this is a close bracket rather than
+// an exact frame boundary.
+uint64_t find_packet_for_pts(int fd, const TsLayout& layout, uint64_t target_pts) {
+    uint64_t low = 0;
+    uint64_t high = layout.packet_count;
+    while (low < high) {
+        uint64_t mid = low + (high - low) / 2;
+        auto hit = find_pts_forward(fd, layout, mid);
+        if (!hit || hit->pts >= target_pts) {
+            high = mid;
+        } else {
+            low = hit->index + 1;
+        }
+    }
+    return low;
+}
+
+std::optional<uint64_t> find_random_access_before(int fd, const TsLayout& layout, uint64_t from) {
+    std::vector<uint8_t> buffer;
+    uint64_t floor = from > kMaxScanPackets ? from - kMaxScanPackets : 0;
+
+    uint64_t end = std::min(from + 1, layout.packet_count);
+    while (end > floor) {
+        uint64_t count = std::min(kProbePackets * 16, end - floor);
+        uint64_t index = end - count;
+        if (!read_packets(fd, layout, index, count, buffer)) {
+            return std::nullopt;
+        }
+        for (uint64_t i = count; i-- > 0;) {
+            auto packet = parse_packet(buffer.data() + i * layout.packet_size + layout.sync_offset);
+            if (packet && packet->pid == layout.video_pid && is_random_access_point(*packet, layout.video_type)) {
+                return index + i;
+            }
+        }
+        end = index;
+    }
+    return std::nullopt;
+}
+
+} // namespace
+
+bool TsCutter::is_transport_stream(const fs::path& path) {
+    ScopedFd fd(::open(path.c_str(), O_RDONLY | O_CLOEXEC));
+    struct stat st {};
+    if (!fd || ::fstat(fd.get(), &st) != 0) {
+        return false;
+    }
+    TsLayout layout;
+    return detect_layout(fd.get(), static_cast<uint64_t>(st.st_size), layout);
+}
+
+NativeCutPlan TsCutter::plan(const fs::path& input_file, double start_seconds, double end_seconds) {
+    NativeCutPlan plan;
+    plan.input_file = input_file;
+
+    ScopedFd in(::open(input_file.c_str(), O_RDONLY | O_CLOEXEC));
+    struct stat st {};
+    if (!in || ::fstat(in.get(), &st) != 0) {
+        plan.error_message = "Cannot open input: " + input_file.string();
+        return plan;
+    }
+
+    TsLayout layout;
+    if (!detect_layout(in.get(), static_cast<uint64_t>(st.st_size), layout)) {
+        plan.error_message = "Not an MPEG-TS file";
+        return plan;
+    }
+    if (!read_program_tables(in.get(), layout)) {
+        plan.error_message = "No PAT/PMT with a video stream near the start of the file";
+        return plan;
+    }
+
+    auto first = find_pts_forward(in.get(), layout, 0);
+    if (!first) {
+        plan.error_message = "No video timestamps found";
+        return plan;
+    }
+    layout.first_pts = first->pts;  // Absolute while the base is still 0
+
+    // Start on a random access point at or before the requested time
+    uint64_t start_index = 0;
+    if (start_seconds > 0) {
+        uint64_t target = static_cast<uint64_t>(start_seconds * kPtsClock);
+        uint64_t bracket = find_packet_for_pts(in.get(), layout, target);
+        auto rap = find_random_access_before(in.get(), layout, bracket);
+        if (!rap) {
+            plan.error_message = "No random access point before the start time";
+            return plan;
+        }
+        start_index = *rap;
+    }
+
+    uint64_t end_index = layout.packet_count;
+    if (end_seconds > start_seconds) {
+        uint64_t target = static_cast<uint64_t>(end_seconds * kPtsClock);
+        end_index = std::max(find_packet_for_pts(in.get(), layout, target), start_index + 1);
+    }
+    end_index = std::min(end_index, layout.packet_count);
+
+    if (auto hit = find_pts_forward(in.get(), layout, start_index)) {
+        plan.start_seconds = hit->pts / kPtsClock;
+    }
+    if (end_index < layout.packet_count) {
+        if (auto hit = find_pts_forward(in.get(), layout, end_index)) {
+            plan.end_seconds = hit->pts / kPtsClock;
+        }
+    }
+
+    // Program tables first, so players can set up decoders before the first
+    // keyframe. M2TS arrival stamps are taken from the first kept packet to
+    // keep them monotonic.
+    std::vector<uint8_t> first_packet;
+    if (!read_packets(in.get(), layout, start_index, 1, first_packet)) {
+        plan.error_message = "Read error";
+        return plan;
+    }
+    std::vector<uint8_t> tables = layout.pat;
+    tables.insert(tables.end(), layout.pmt.begin(), layout.pmt.end());
+
+    // Padding is null packets, so the prefix stays a whole number of packets
+    std::vector<uint8_t> null_packet(layout.packet_size, 0xff);
+    null_packet[layout.sync_offset] = kSyncByte;
+    null_packet[layout.sync_offset + 1] = 0x1f;
+    null_packet[layout.sync_offset + 2] = 0xff;
+    null_packet[layout.sync_offset + 3] = 0x10;
+
+    size_t packet_size = layout.packet_size;
+    size_t sync_offset = layout.sync_offset;
+    plan.min_prefix_size = tables.size();
+    plan.build_prefix = [tables, null_packet, first_packet, packet_size, sync_offset](uint64_t size) {
+        std::vector<uint8_t> prefix;
+        if (size < tables.size() || size % packet_size != 0) {
+            return prefix;
+        }
+        prefix.reserve(size);
+        prefix.insert(prefix.end(), tables.begin(), tables.end());
+        while (prefix.size() < size) {
+            prefix.insert(prefix.end(), null_packet.begin(), null_packet.end());
+        }
+        for (size_t at = 0; sync_offset > 0 && at < prefix.size(); at += packet_size) {
+            std::copy_n(first_packet.begin(), sync_offset, prefix.begin() + at);
+        }
+        return prefix;
+    };
+
+    plan.range_offset = layout.packet_offset(start_index);
+    plan.range_length = (end_index - start_index) * layout.packet_size;
+    plan.ok = true;
+    return plan;
+}
+
+NativeCutResult TsCutter::cut(
+    const fs::path& input_file,
+    const fs::path& output_file,
+    double start_seconds,
+    double end_seconds,
+    const NativeCutProgress& progress_cb
+) {
+    return plan(input_file, start_seconds, end_seconds).copy_to(output_file, progress_cb);
+}
+
+} // namespace trimora
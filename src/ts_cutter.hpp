@@ -0,0 +1,31 @@
+#pragma once
+
+#include "native_cut.hpp"
+#include <filesystem>
+
+namespace trimora {
+
+// Packet-level MPEG-TS trimming without a demux/remux pass. Cut points are
+// found by binary search over packet-aligned offsets using video PES
+// timestamps. The start snaps back to the nearest random access point and
+// the stream's PAT and PMT are written ahead of it, so the output is
+// decodable from its first packet. Everything in between is copied in the
+// kernel with copy_file_range where available.
+class TsCutter {
+public:
+    // 188-byte TS, or 192-byte M2TS, with sync bytes in place
+    static bool is_transport_stream(const std::filesystem::path& path);
+
+    // Where the cut lands and what goes in front of it; nothing is written
+    static NativeCutPlan plan(const std::filesystem::path& input_file, double start_seconds, double end_seconds);
+
+    static NativeCutResult cut(
+        const std::filesystem::path& input_file,
+        const std::filesystem::path& output_file,
+        double start_seconds,
+        double end_seconds,
+        const NativeCutProgress& progress_cb = {}
+    );
+};
+
+} // namespace trimora
@@ -0,0 +1,339 @@
+#include "upload_sink.hpp"
+#include "scoped_fd.hpp"
+#include "logger.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <optional>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace trimora {
+
+namespace {
+
+// S3 rejects smaller parts except the last
+constexpr uint64_t kMinPartSize = 5ull * 1024 * 1024;
+
+// How often a file written in order is checked for another full part
+constexpr auto kGrowthPoll = std::chrono::milliseconds(100);
+
+bool read_part(const fs::path& file, uint64_t offset, std::string& data, std::string& error_message) {
+    ScopedFd fd(::open(file.c_str(), O_RDONLY | O_CLOEXEC));
+    if (!fd) {
+        error_message = "Cannot open " + file.string() + ": " + std::strerror(errno);
+        return false;
+    }
+    size_t done = 0;
+    while (done < data.size()) {
+        ssize_t n = ::pread(fd.get(), data.data() + done, data.size() - done, static_cast<off_t>(offset + done));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            error_message = n < 0 ? "Cannot read " + file.string() + ": " + std::strerror(errno)
+                                  : file.string() + " shrank while it was uploaded";
+            return false;
+        }
+        done += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+} // namespace
+
+UploadSink::UploadSink(UploadTarget target, DoneCallback on_done)
+    : client_(target),
+      on_done_(std::move(on_done)),
+      key_prefix_(target.prefix),
+      part_size_(std::max<uint64_t>(target.part_size_mb * 1024 * 1024, kMinPartSize)),
+      queue_capacity_(std::max<size_t>(target.concurrency, 1)) {
+    for (size_t i = 0; i < queue_capacity_; ++i) {
+        workers_.emplace_back([this] { work(); });
+    }
+}
+
+UploadSink::~UploadSink() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        for (auto& upload : uploads_) {
+            if (!upload->failed) {
+                upload->failed = true;
+                upload->error_message = "Upload cancelled";
+            }
+        }
+    }
+    changed_.notify_all();
+    queued_.notify_all();
+
+    // Producers wait for their queued parts, which the workers drain
+    for (auto& upload : uploads_) {
+        if (upload->producer.joinable()) {
+            upload->producer.join();
+        }
+    }
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+void UploadSink::begin(const fs::path& file, bool written_in_order) {
+    std::error_code ec;
+    fs::remove(file, ec);
+    start(file, written_in_order, false);
+}
+
+void UploadSink::end(const fs::path& file, bool writer_ok) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // The newest upload of this name; an aborted native cut may have left an older one
+    for (auto it = uploads_.rbegin(); it != uploads_.rend(); ++it) {
+        if ((*it)->file == file && !(*it)->writer_done) {
+            (*it)->writer_done = true;
+            (*it)->writer_ok = writer_ok;
+            changed_.notify_all();
+            return;
+        }
+    }
+}
+
+void UploadSink::submit(const fs::path& file) {
+    start(file, false, true);
+}
+
+size_t UploadSink::active_uploads() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return static_cast<size_t>(std::count_if(uploads_.begin(), uploads_.end(),
+                                             [](const auto& upload) { return !upload->finished; }));
+}
+
+void UploadSink::start(const fs::path& file, bool written_in_order, bool writer_done) {
+    auto upload = std::make_shared<Upload>();
+    upload->file = file;
+    upload->key = key_prefix_ + file.filename().string();
+    upload->written_in_order = written_in_order;
+    upload->writer_done = writer_done;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    reap();
+    uploads_.push_back(upload);
+    upload->producer = std::thread([this, upload] { produce(upload); });
+}
+
+void UploadSink::reap() {
+    for (auto it = uploads_.begin(); it != uploads_.end();) {
+        if ((*it)->finished) {
+            (*it)->producer.join();
+            it = uploads_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void UploadSink::produce(const std::shared_ptr<Upload>& upload) {
+    std::string upload_id;
+    uint64_t offset = 0;
+    int next_part = 1;
+
+    auto fail = [&](const std::string& message) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!upload->failed) {
+            upload->failed = true;
+            upload->error_message = message;
+        }
+    };
+
+    while (true) {
+        bool writer_done = false;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            auto woken = [&] { return upload->writer_done || upload->failed; };
+            if (upload->written_in_order) {
+                changed_.wait_for(lock, kGrowthPoll, woken);
+            } else {
+                changed_.wait(lock, woken);
+            }
+            if (upload->failed || (upload->writer_done && !upload->writer_ok)) {
+                break;
+            }
+            writer_done = upload->writer_done;
+        }
+
+        std::error_code ec;
+        uint64_t size = fs::file_size(upload->file, ec);
+        if (ec) {
+            if (writer_done) {
+                fail("Cannot read " + upload->file.string() + ": " + ec.message());
+                break;
+            }
+            continue;  // Not created yet
+        }
+        if (size < offset) {
+            fail(upload->file.string() + " was rewritten while it was uploaded");
+            break;
+        }
+
+        // A finished file smaller than a part (sidecars, short clips) goes
+        // up in a single PUT
+        if (writer_done && next_part == 1 && size < part_size_) {
+            enqueue({upload, "", next_part, 0, size});
+            break;
+        }
+
+        // Full parts as they appear; once the writer is done, the rest
+        while (size >= offset + part_size_ || (writer_done && size > offset)) {
+            if (upload_id.empty()) {
+                std::string error_message;
+                auto id = client_.create_multipart_upload(upload->key, error_message);
+                if (!id) {
+                    fail(error_message);
+                    break;
+                }
+                upload_id = *id;
+            }
+            uint64_t part = std::min(part_size_, size - offset);
+            if (!enqueue({upload, upload_id, next_part, offset, part})) {
+                break;
+            }
+            offset += part;
+            ++next_part;
+        }
+        if (writer_done) {
+            break;
+        }
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    changed_.wait(lock, [&] { return upload->parts_pending == 0; });
+    bool writer_ok = upload->writer_done && upload->writer_ok;
+    UploadResult result;
+    result.file = upload->file;
+    result.key = upload->key;
+    result.error_message = upload->error_message;
+    result.bytes = upload->bytes;
+    result.parts = upload->etags.size();
+    bool send = !upload->failed && writer_ok;
+    bool report = writer_ok && !stopping_;
+    auto etags = upload->etags;
+    lock.unlock();
+
+    if (send) {
+        // Without an upload ID the file went up in one PUT, already done
+        result.ok = upload_id.empty() ||
+                    client_.complete_multipart_upload(upload->key, upload_id, etags, result.error_message);
+    }
+    if (!result.ok && !upload_id.empty()) {
+        client_.abort_multipart_upload(upload->key, upload_id);
+    }
+    // Nothing to report for outputs that were never written
+    if (report && on_done_) {
+        on_done_(result);
+    }
+
+    lock.lock();
+    upload->finished = true;
+}
+
+bool UploadSink::enqueue(PartJob job) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    changed_.wait(lock, [&] { return queue_.size() < queue_capacity_ || job.upload->failed; });
+    if (job.upload->failed) {
+        return false;
+    }
+    job.upload->etags.resize(static_cast<size_t>(job.part_number));
+    ++job.upload->parts_pending;
+    queue_.push_back(std::move(job));
+    queued_.notify_one();
+    return true;
+}
+
+void UploadSink::work() {
+    while (true) {
+        PartJob job;
+        bool skip = false;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            queued_.wait(lock, [&] { return stopping_ || !queue_.empty(); });
+            if (queue_.empty()) {
+                return;
+            }
+            job = std::move(queue_.front());
+            queue_.pop_front();
+            skip = job.upload->failed;
+        }
+        changed_.notify_all();  // Queue space
+
+        std::optional<std::string> etag;
+        std::string error_message;
+        if (!skip) {
+            std::string data(job.size, '\0');
+            if (read_part(job.upload->file, job.offset, data, error_message)) {
+                if (job.upload_id.empty()) {
+                    if (client_.put_object(job.upload->key, std::move(data), error_message)) {
+                        etag = std::string();  // A single PUT has no part to list
+                    }
+                } else {
+                    etag = client_.upload_part(job.upload->key, job.upload_id, job.part_number, std::move(data),
+                                               error_message);
+                }
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto& upload = *job.upload;
+            if (etag) {
+                upload.etags[static_cast<size_t>(job.part_number - 1)] = *etag;
+                upload.bytes += job.size;
+            } else if (!skip && !upload.failed) {
+                upload.failed = true;
+                upload.error_message = error_message;
+            }
+            --upload.parts_pending;
+        }
+        changed_.notify_all();
+    }
+}
+
+PendingUploads::PendingUploads(
+    std::shared_ptr<UploadSink> sink,
+    std::vector<fs::path> files,
+    bool written_in_order,
+    std::vector<DigestAlgorithm> sidecars
+) : sink_(std::move(sink)), files_(std::move(files)), sidecars_(std::move(sidecars)) {
+    if (!sink_) {
+        return;
+    }
+    for (const auto& file : files_) {
+        sink_->begin(file, written_in_order || OutputDigester::is_append_only(file));
+    }
+}
+
+void PendingUploads::finish(bool writer_ok) {
+    if (!sink_ || finished_) {
+        return;
+    }
+    finished_ = true;
+    for (const auto& file : files_) {
+        sink_->end(file, writer_ok);
+    }
+    if (!writer_ok) {
+        return;
+    }
+    for (const auto& file : files_) {
+        for (auto algorithm : sidecars_) {
+            fs::path sidecar = file;
+            sidecar += std::string(".") + digest_name(algorithm);
+            std::error_code ec;
+            if (fs::exists(sidecar, ec)) {
+                sink_->submit(sidecar);
+            }
+        }
+    }
+}
+
+} // namespace trimora
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "s3_client.hpp"
+#include "output_digest.hpp"
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+
+namespace trimora {
+
+struct UploadResult {
+    std::filesystem::path file;
+    std::string key;
+    bool ok = false;
+    std::string error_message;
+    uint64_t bytes = 0;
+    size_t parts = 0;
+};
+
+// Copies finished outputs to object storage in the background, so a job's
+// upload overlaps with the jobs after it. Outputs written front to back
+// (transport streams, native cuts) are sent part by part while they grow;
+// the rest are sent once the writer closes them, in a single PUT if they
+// are smaller than a part. Uploads of all files share a pool of
+// target.concurrency workers fed by a queue of the same size, which bounds
+// both connections and buffered part data.
+class UploadSink {
+public:
+    using DoneCallback = std::function<void(const UploadResult&)>;
+
+    // on_done runs on a sink thread once per file
+    UploadSink(UploadTarget target, DoneCallback on_done);
+    ~UploadSink();  // Aborts unfinished uploads
+
+    UploadSink(const UploadSink&) = delete;
+    UploadSink& operator=(const UploadSink&) = delete;
+
+    bool is_valid(std::string& error_message) const { return client_.is_valid(error_message); }
+
+    // Call before the writer creates the file; a leftover file of the same
+    // name is removed so none of it is sent
+    void begin(const std::filesystem::path& file, bool written_in_order);
+
+    // The writer has closed the file; writer_ok = false aborts the upload
+    void end(const std::filesystem::path& file, bool writer_ok);
+
+    // Uploads a file that is already complete
+    void submit(const std::filesystem::path& file);
+
+    size_t active_uploads() const;
+
+private:
+    struct Upload {
+        std::filesystem::path file;
+        std::string key;
+        bool written_in_order = false;
+
+        // Guarded by UploadSink::mutex_
+        bool writer_done = false;
+        bool writer_ok = true;
+        bool failed = false;
+        std::string error_message;
+        std::vector<std::string> etags;  // By part number - 1
+        size_t parts_pending = 0;
+        uint64_t bytes = 0;
+        bool finished = false;
+
+        std::thread producer;
+    };
+
+    struct PartJob {
+        std::shared_ptr<Upload> upload;
+        std::string upload_id;  // Empty: the whole file in one PUT
+        int part_number = 0;
+        uint64_t offset = 0;
+        uint64_t size = 0;
+    };
+
+    void start(const std::filesystem::path& file, bool written_in_order, bool writer_done);
+    void produce(const std::shared_ptr<Upload>& upload);
+    bool enqueue(PartJob job);  // Blocks while the queue is full; false if the upload failed meanwhile
+    void work();
+    void reap();  // Joins producers of finished uploads; mutex_ held
+
+    S3Client client_;
+    DoneCallback on_done_;
+    std::string key_prefix_;
+    uint64_t part_size_;
+    size_t queue_capacity_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable changed_;  // Writer state, parts done, queue space
+    std::condition_variable queued_;   // Part jobs for the workers
+    std::list<std::shared_ptr<Upload>> uploads_;
+    std::deque<PartJob> queue_;
+    bool stopping_ = false;
+
+    std::vector<std::thread> workers_;
+};
+
+// The uploads of one job's outputs. Outputs not finished with success,
+// including on early returns, are aborted.
+class PendingUploads {
+public:
+    PendingUploads(
+        std::shared_ptr<UploadSink> sink,
+        std::vector<std::filesystem::path> files,
+        bool written_in_order,
+        std::vector<DigestAlgorithm> sidecars
+    );
+    ~PendingUploads() { finish(false); }
+
+    PendingUploads(const PendingUploads&) = delete;
+    PendingUploads& operator=(const PendingUploads&) = delete;
+
+    // On success the checksum sidecars written by finish_digests follow the outputs
+    void finish(bool writer_ok);
+
+private:
+    std::shared_ptr<UploadSink> sink_;
+    std::vector<std::filesystem::path> files_;
+    std::vector<DigestAlgorithm> sidecars_;
+    bool finished_ = false;
+};
+
+} // namespace trimora
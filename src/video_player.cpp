@@ -2,8 +2,13 @@
 #include <GL/gl.h>
 #include <GL/glext.h>
 #include <GLFW/glfw3.h>
-#include <iostream>
+#include "validator.hpp"
+#include "logger.hpp"
+#include "metrics.hpp"
 #include <cstring>
+#include <sstream>
+#include <iomanip>
+#include <chrono>
 
 namespace trimora {
 
@@ -19,6 +24,18 @@ static PFNGLCHECKFRAMEBUFFERSTATUSPROC glCheckFramebufferStatus_ = nullptr;
 static PFNGLDELETEFRAMEBUFFERSPROC glDeleteFramebuffers_ = nullptr;
 static PFNGLDELETERENDERBUFFERSPROC glDeleteRenderbuffers_ = nullptr;
 
+// One EDL entry; the %len% prefix lets paths contain commas and semicolons.
+// A negative length plays to the end of the file.
+static void append_edl_entry(std::ostringstream& edl, const std::string& path, double start, double length) {
+    edl << "%" << path.size() << "%" << path;
+    if (start > 0.0 || length >= 0.0) {
+        edl << "," << std::fixed << std::setprecision(6) << start;
+    }
+    if (length >= 0.0) {
+        edl << "," << length;
+    }
+}
+
 static void load_gl_extensions() {
     static bool loaded = false;
     if (loaded) return;
@@ -87,7 +104,7 @@ bool VideoPlayer::initialize() {
     // Create mpv instance
     mpv_ = mpv_create();
     if (!mpv_) {
-        std::cerr << "Failed to create MPV instance" << std::endl;
+        TRIMORA_LOG_ERROR("Failed to create MPV instance");
         return false;
     }
     
@@ -98,12 +115,16 @@ bool VideoPlayer::initialize() {
     
     // Initialize mpv
     if (mpv_initialize(mpv_) < 0) {
-        std::cerr << "Failed to initialize MPV" << std::endl;
+        TRIMORA_LOG_ERROR("Failed to initialize MPV");
         mpv_terminate_destroy(mpv_);
         mpv_ = nullptr;
         return false;
     }
     
+    // Dropped frame counters arrive as property-change events
+    mpv_observe_property(mpv_, 0, "frame-drop-count", MPV_FORMAT_INT64);
+    mpv_observe_property(mpv_, 0, "decoder-frame-drop-count", MPV_FORMAT_INT64);
+    
     // Setup OpenGL rendering
     mpv_opengl_init_params gl_init_params{get_proc_address_mpv, nullptr};
     mpv_render_param params[] = {
@@ -113,7 +134,7 @@ bool VideoPlayer::initialize() {
     };
     
     if (mpv_render_context_create(&mpv_gl_, mpv_, params) < 0) {
-        std::cerr << "Failed to create MPV render context" << std::endl;
+        TRIMORA_LOG_ERROR("Failed to create MPV render context");
         mpv_terminate_destroy(mpv_);
         mpv_ = nullptr;
         return false;
@@ -127,25 +148,150 @@ bool VideoPlayer::initialize() {
 
 bool VideoPlayer::load_file(const std::filesystem::path& file_path) {
     if (!initialized_) {
-        std::cerr << "VideoPlayer not initialized" << std::endl;
+        TRIMORA_LOG_ERROR("VideoPlayer not initialized");
         return false;
     }
     
     if (!std::filesystem::exists(file_path)) {
-        std::cerr << "Video file does not exist: " << file_path << std::endl;
+        TRIMORA_LOG_ERROR("Video file does not exist: " + file_path.string());
         return false;
     }
     
-    const char* cmd[] = {"loadfile", file_path.c_str(), nullptr};
-    int result = mpv_command(mpv_, cmd);
-    
-    if (result < 0) {
-        std::cerr << "Failed to load file: " << mpv_error_string(result) << std::endl;
+    if (!load_url(file_path.string())) {
         return false;
     }
     
     current_file_ = file_path.string();
     has_file_ = true;
+    segments_preview_ = false;
+    segment_boundaries_.clear();
+    chunk_boundaries_.clear();
+    
+    return true;
+}
+
+bool VideoPlayer::load_chunks(const ChunkSequence& chunks) {
+    if (!initialized_) {
+        TRIMORA_LOG_ERROR("VideoPlayer not initialized");
+        return false;
+    }
+    
+    if (chunks.empty()) {
+        return false;
+    }
+    
+    // Whole chunks back to back; mpv reads each file only while it plays
+    std::ostringstream edl;
+    edl << "edl://";
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        if (i > 0) {
+            edl << ";";
+        }
+        append_edl_entry(edl, chunks.chunks()[i].file.string(), 0.0, -1.0);
+    }
+    
+    if (!load_url(edl.str())) {
+        return false;
+    }
+    
+    current_file_ = chunks.chunks().front().file.string();
+    has_file_ = true;
+    segments_preview_ = false;
+    segment_boundaries_.clear();
+    chunk_boundaries_.assign(chunks.chunk_starts().begin() + 1, chunks.chunk_starts().end());
+    
+    return true;
+}
+
+bool VideoPlayer::load_segments_preview(
+    const std::filesystem::path& source_file,
+    const std::vector<TrimSegment>& segments,
+    const ChunkSequence& chunks
+) {
+    if (!initialized_) {
+        TRIMORA_LOG_ERROR("VideoPlayer not initialized");
+        return false;
+    }
+    
+    if (!std::filesystem::exists(source_file)) {
+        TRIMORA_LOG_ERROR("Video file does not exist: " + source_file.string());
+        return false;
+    }
+    
+    // Build an EDL timeline: edl://%len%path,start,length;... mpv turns
+    // every entry into a chapter, so segment joins also show up as chapter
+    // marks. A segment crossing a chunk boundary takes one entry per chunk.
+    std::string source = source_file.string();
+    std::ostringstream edl;
+    edl << "edl://";
+    
+    std::vector<double> boundaries;
+    double timeline_position = 0.0;
+    
+    for (const auto& segment : segments) {
+        if (!segment.enabled) {
+            continue;
+        }
+        
+        auto start = Validator::timestamp_to_seconds(segment.start_time);
+        auto end = Validator::timestamp_to_seconds(segment.end_time);
+        if (!start || !end || *end <= *start) {
+            continue;
+        }
+        
+        std::vector<ChunkRange> ranges;
+        if (!chunks.empty()) {
+            ranges = chunks.map_range(*start, *end);
+            if (ranges.empty()) {
+                continue;
+            }
+        }
+        
+        if (!boundaries.empty()) {
+            edl << ";";
+        }
+        if (chunks.empty()) {
+            append_edl_entry(edl, source, *start, *end - *start);
+        } else {
+            for (size_t i = 0; i < ranges.size(); ++i) {
+                if (i > 0) {
+                    edl << ";";
+                }
+                append_edl_entry(edl, ranges[i].file.string(), ranges[i].inpoint,
+                                 ranges[i].outpoint - ranges[i].inpoint);
+            }
+        }
+        
+        boundaries.push_back(timeline_position);
+        timeline_position += *end - *start;
+    }
+    
+    if (boundaries.empty()) {
+        TRIMORA_LOG_ERROR("No enabled segments to preview");
+        return false;
+    }
+    
+    if (!load_url(edl.str())) {
+        return false;
+    }
+    
+    current_file_ = source;
+    has_file_ = true;
+    segments_preview_ = true;
+    segment_boundaries_ = std::move(boundaries);
+    chunk_boundaries_.clear();
+    
+    return true;
+}
+
+bool VideoPlayer::load_url(const std::string& url) {
+    const char* cmd[] = {"loadfile", url.c_str(), nullptr};
+    int result = mpv_command(mpv_, cmd);
+    
+    if (result < 0) {
+        TRIMORA_LOG_ERROR(std::string("Failed to load file: ") + mpv_error_string(result));
+        return false;
+    }
     
     return true;
 }
@@ -184,6 +330,9 @@ void VideoPlayer::stop() {
     mpv_command(mpv_, cmd);
     
     has_file_ = false;
+    segments_preview_ = false;
+    segment_boundaries_.clear();
+    chunk_boundaries_.clear();
 }
 
 void VideoPlayer::seek(double position_seconds) {
@@ -277,7 +426,7 @@ void VideoPlayer::create_fbo(int width, int height) {
     glFramebufferRenderbuffer_(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, rbo_);
     
     if (glCheckFramebufferStatus_(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
-        std::cerr << "Framebuffer not complete!" << std::endl;
+        TRIMORA_LOG_ERROR("Framebuffer not complete!");
     }
     
     glBindFramebuffer_(GL_FRAMEBUFFER, 0);
@@ -301,6 +450,9 @@ void VideoPlayer::destroy_fbo() {
 void VideoPlayer::render(int width, int height) {
     if (!initialized_ || !mpv_gl_ || !has_file_) return;
     
+    process_events();
+    auto render_start = std::chrono::steady_clock::now();
+    
     create_fbo(width, height);
     
     mpv_opengl_fbo mpv_fbo{
@@ -319,6 +471,33 @@ void VideoPlayer::render(int width, int height) {
     };
     
     mpv_render_context_render(mpv_gl_, params);
+    
+    Metrics::instance().record_player_render(std::chrono::duration<float, std::milli>(
+        std::chrono::steady_clock::now() - render_start).count());
+}
+
+void VideoPlayer::process_events() {
+    while (true) {
+        mpv_event* event = mpv_wait_event(mpv_, 0);
+        if (!event || event->event_id == MPV_EVENT_NONE) {
+            break;
+        }
+        
+        if (event->event_id == MPV_EVENT_PROPERTY_CHANGE) {
+            auto* property = static_cast<mpv_event_property*>(event->data);
+            if (property->format != MPV_FORMAT_INT64 || !property->data) {
+                continue;
+            }
+            
+            int64_t value = *static_cast<int64_t*>(property->data);
+            if (std::strcmp(property->name, "frame-drop-count") == 0) {
+                vo_dropped_frames_ = value;
+            } else if (std::strcmp(property->name, "decoder-frame-drop-count") == 0) {
+                decoder_dropped_frames_ = value;
+            }
+            Metrics::instance().set_player_dropped_frames(vo_dropped_frames_ + decoder_dropped_frames_);
+        }
+    }
 }
 
 } // namespace trimora
@@ -5,6 +5,10 @@
 #include <string>
 #include <filesystem>
 #include <functional>
+#include <vector>
+#include <cstdint>
+#include "trim_segment.hpp"
+#include "chunk_sequence.hpp"
 
 namespace trimora {
 
@@ -19,6 +23,25 @@ public:
     // Load a video file
     bool load_file(const std::filesystem::path& file_path);
 
+    // Play a chunked recording as one continuous timeline (mpv EDL)
+    bool load_chunks(const ChunkSequence& chunks);
+
+    // Preview the merged result of the enabled segments as one virtual
+    // timeline (mpv EDL) without rendering anything to disk. With chunks,
+    // segment times are on the joined timeline of those chunks.
+    bool load_segments_preview(
+        const std::filesystem::path& source_file,
+        const std::vector<TrimSegment>& segments,
+        const ChunkSequence& chunks = {}
+    );
+    bool is_segments_preview() const { return segments_preview_; }
+
+    // Segment start positions on the preview timeline (seconds)
+    const std::vector<double>& get_segment_boundaries() const { return segment_boundaries_; }
+
+    // Chunk start positions when playing a chunked recording (seconds)
+    const std::vector<double>& get_chunk_boundaries() const { return chunk_boundaries_; }
+
     // Playback controls
     void play();
     void pause();
@@ -47,6 +70,8 @@ private:
     static void* get_proc_address_mpv(void* ctx, const char* name);
     static void on_mpv_render_update(void* ctx);
     static void on_mpv_events(void* ctx);
+    bool load_url(const std::string& url);
+    void process_events();
 
     mpv_handle* mpv_;
     mpv_render_context* mpv_gl_;
@@ -60,6 +85,13 @@ private:
     bool initialized_;
     bool has_file_;
     std::string current_file_;
+    
+    bool segments_preview_ = false;
+    std::vector<double> segment_boundaries_;
+    std::vector<double> chunk_boundaries_;
+    
+    int64_t vo_dropped_frames_ = 0;
+    int64_t decoder_dropped_frames_ = 0;
 };
 
 } // namespace trimora
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "mp4_box.hpp"
+#include "test_support.hpp"
+#include <algorithm>
+#include <initializer_list>
+#include <optional>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// Synthetic ISO-BMFF boxes for the MP4 tests. Only the fields the code under
+// test reads are meaningful; the rest are zero.
+
+namespace trimora {
+namespace test {
+
+inline Bytes be(uint64_t value, size_t bytes) {
+    Bytes out(bytes);
+    mp4::write_be(out.data(), bytes, value);
+    return out;
+}
+
+inline Bytes box(const char (&type)[5], std::initializer_list<Bytes> parts = {}) {
+    Bytes payload = cat(parts);
+    return cat({be(8 + payload.size(), 4), be(mp4::fourcc(type), 4), payload});
+}
+
+inline Bytes full_box(const char (&type)[5], uint8_t version, uint32_t flags, std::initializer_list<Bytes> parts = {}) {
+    Bytes payload = cat(parts);
+    return box(type, {be(version, 1), be(flags, 3), payload});
+}
+
+// Identity display matrix, as in mvhd and tkhd
+inline Bytes identity_matrix() {
+    return cat({be(0x10000, 4), be(0, 4), be(0, 4), be(0, 4), be(0x10000, 4), be(0, 4), be(0, 4), be(0, 4),
+                be(0x40000000, 4)});
+}
+
+inline Bytes mvhd(uint32_t timescale, uint32_t duration) {
+    return full_box("mvhd", 0, 0, {be(0, 8), be(timescale, 4), be(duration, 4), be(0x10000, 4), be(0x100, 2),
+                                   Bytes(10), identity_matrix(), Bytes(24), be(2, 4)});
+}
+
+// width and height in pixels; stored as 16.16 fixed point
+inline Bytes tkhd(uint8_t version, uint32_t track_id, uint32_t width, uint32_t height) {
+    Bytes times = version == 1 ? Bytes(16) : Bytes(8);
+    Bytes duration = version == 1 ? Bytes(8) : Bytes(4);
+    return full_box("tkhd", version, 3, {times, be(track_id, 4), Bytes(4), duration, Bytes(16), identity_matrix(),
+                                         be(static_cast<uint64_t>(width) << 16, 4),
+                                         be(static_cast<uint64_t>(height) << 16, 4)});
+}
+
+inline Bytes mdhd(uint32_t timescale) {
+    return full_box("mdhd", 0, 0, {be(0, 8), be(timescale, 4), be(0, 4), be(0x55c4, 2), Bytes(2)});
+}
+
+inline Bytes hdlr(const char (&handler)[5]) {
+    return full_box("hdlr", 0, 0, {Bytes(4), be(mp4::fourcc(handler), 4), Bytes(12), Bytes(1)});
+}
+
+// trak with tkhd and mdia (mdhd, hdlr, then whatever else goes in mdia)
+inline Bytes trak(const Bytes& track_header, uint32_t timescale, const char (&handler)[5],
+                  std::initializer_list<Bytes> more_mdia = {}) {
+    Bytes mdia_payload = cat({mdhd(timescale), hdlr(handler), cat(more_mdia)});
+    return box("trak", {track_header, box("mdia", {mdia_payload})});
+}
+
+// Children of a box in bytes, with offsets from the start of bytes. meta is
+// a full box: its children start after the version and flags.
+inline std::vector<mp4::Box> children_of(const Bytes& bytes, const mp4::Box& parent) {
+    uint64_t begin = parent.offset + parent.header_size + (parent.type == mp4::fourcc("meta") ? 4 : 0);
+    std::vector<mp4::Box> boxes = mp4::child_boxes(bytes.data() + begin, parent.end() - begin);
+    for (auto& box : boxes) {
+        box.offset += begin;
+    }
+    return boxes;
+}
+
+// The first box of each type along path, from the top level down
+inline std::optional<mp4::Box> find_box(const Bytes& bytes, std::initializer_list<uint32_t> path) {
+    std::vector<mp4::Box> level = mp4::child_boxes(bytes.data(), bytes.size());
+    std::optional<mp4::Box> found;
+    for (uint32_t type : path) {
+        auto it = std::find_if(level.begin(), level.end(), [type](const mp4::Box& box) { return box.type == type; });
+        if (it == level.end()) {
+            return std::nullopt;
+        }
+        found = *it;
+        level = children_of(bytes, *found);
+    }
+    return found;
+}
+
+inline const uint8_t* payload_of(const Bytes& bytes, const mp4::Box& box) {
+    return bytes.data() + box.offset + box.header_size;
+}
+
+} // namespace test
+} // namespace trimora
@@ -0,0 +1,174 @@
+#include "fmp4_cutter.hpp"
+#include "mp4_fixture.hpp"
+#include "test_support.hpp"
+
+namespace fs = std::filesystem;
+
+using namespace trimora;
+using namespace trimora::test;
+using mp4::fourcc;
+
+namespace {
+
+constexpr uint32_t kVideoTrack = 1;
+constexpr uint32_t kAudioTrack = 2;
+constexpr uint32_t kTimescale = 1000;  // Video track; fragments are one second
+constexpr uint32_t kMovieTimescale = 600;
+
+Bytes traf(uint32_t track_id, uint64_t decode_time, uint32_t tf_flags) {
+    Bytes base_offset = (tf_flags & 0x1) ? be(0, 8) : Bytes();
+    return box("traf", {full_box("tfhd", 0, tf_flags, {be(track_id, 4), base_offset}),
+                        full_box("tfdt", 1, 0, {be(decode_time, 8)}),
+                        full_box("trun", 0, 0, {be(0, 4)})});
+}
+
+// The audio traf comes first and must not be taken for the video one. Its
+// fragments claim two seconds each, so plans show which track was used.
+Bytes moof(uint32_t sequence, uint64_t video_time, uint64_t audio_time, uint32_t tf_flags = 0x020000) {
+    return box("moof", {full_box("mfhd", 0, 0, {be(sequence, 4)}),
+                        traf(kAudioTrack, audio_time, tf_flags),
+                        traf(kVideoTrack, video_time, tf_flags)});
+}
+
+// ftyp, moov with an audio track ahead of the video track and a 32-bit
+// mehd, then one moof/mdat pair per second of video
+struct Fixture {
+    Bytes bytes;
+    std::vector<uint64_t> fragment_offsets;
+    uint64_t fragments_end = 0;
+    size_t header_size = 0;
+};
+
+Fixture make_fixture(size_t fragments, uint32_t tf_flags = 0x020000,
+                     const Bytes& video_header = tkhd(0, kVideoTrack, 1280, 720)) {
+    Bytes moov = box("moov", {mvhd(kMovieTimescale, 0),
+                              trak(tkhd(0, kAudioTrack, 0, 0), 48000, "soun"),
+                              trak(video_header, kTimescale, "vide"),
+                              box("mvex", {full_box("mehd", 0, 0, {be(fragments * kMovieTimescale, 4)}),
+                                           full_box("trex", 0, 0, {be(kVideoTrack, 4), Bytes(16)})})});
+    Fixture fixture;
+    fixture.bytes = cat({box("ftyp", {be(fourcc("iso6"), 4), be(0, 4)}), moov});
+    fixture.header_size = fixture.bytes.size();
+    for (size_t i = 0; i < fragments; ++i) {
+        fixture.fragment_offsets.push_back(fixture.bytes.size());
+        Bytes fragment = cat({moof(static_cast<uint32_t>(i + 1), 5000 + kTimescale * i, 96000 * i, tf_flags),
+                              box("mdat", {Bytes(100 + i, static_cast<uint8_t>(i))})});
+        fixture.bytes.insert(fixture.bytes.end(), fragment.begin(), fragment.end());
+    }
+    fixture.fragments_end = fixture.bytes.size();
+    // Random access index, dropped by the cut
+    Bytes mfra = box("mfra", {full_box("mfro", 0, 0, {be(16, 4)})});
+    fixture.bytes.insert(fixture.bytes.end(), mfra.begin(), mfra.end());
+    return fixture;
+}
+
+uint64_t mehd_duration(const Bytes& prefix) {
+    auto mehd = find_box(prefix, {fourcc("moov"), fourcc("mvex"), fourcc("mehd")});
+    return mehd ? mp4::read_be(payload_of(prefix, *mehd) + 4, 4) : 0;
+}
+
+void test_detection(const TempDir& dir) {
+    auto fixture = make_fixture(3);
+    write_file(dir / "frag.mp4", fixture.bytes);
+    CHECK(Fmp4Cutter::is_fragmented_mp4(dir / "frag.mp4"));
+
+    // A progressive file (no mvex) and media before moov are not fragmented
+    write_file(dir / "plain.mp4", cat({box("ftyp"), box("moov", {mvhd(1000, 0)}), box("mdat")}));
+    CHECK(!Fmp4Cutter::is_fragmented_mp4(dir / "plain.mp4"));
+    write_file(dir / "late.mp4", cat({box("ftyp"), box("mdat"), box("moov", {box("mvex")})}));
+    CHECK(!Fmp4Cutter::is_fragmented_mp4(dir / "late.mp4"));
+}
+
+void test_plan(const TempDir& dir) {
+    auto fixture = make_fixture(6);
+    fs::path input = dir / "frag.mp4";
+    write_file(input, fixture.bytes);
+
+    // From the fragment at or before 1.5 s to the last one starting by 3.5 s
+    auto plan = Fmp4Cutter::plan(input, 1.5, 3.5);
+    CHECK(plan.ok);
+    CHECK_EQ(plan.range_offset, fixture.fragment_offsets[1]);
+    CHECK_EQ(plan.range_length, fixture.fragment_offsets[4] - fixture.fragment_offsets[1]);
+    CHECK_EQ(plan.start_seconds, 1.0);
+    CHECK_EQ(plan.end_seconds, 4.0);
+
+    // The prefix is ftyp and moov with the kept duration in mehd
+    CHECK_EQ(plan.min_prefix_size, uint64_t(fixture.header_size));
+    Bytes prefix = plan.build_prefix(plan.min_prefix_size);
+    CHECK_EQ(prefix.size(), fixture.header_size);
+    CHECK_EQ(mehd_duration(prefix), uint64_t(3 * kMovieTimescale));
+
+    // Padding is a free box, which can't be smaller than its header
+    CHECK(plan.build_prefix(plan.min_prefix_size + 4).empty());
+    CHECK(plan.build_prefix(plan.min_prefix_size - 1).empty());
+    Bytes padded = plan.build_prefix(plan.min_prefix_size + 64);
+    CHECK_EQ(padded.size(), fixture.header_size + 64);
+    auto free_box = mp4::parse_box(padded.data() + fixture.header_size, 64, fixture.header_size, padded.size());
+    CHECK(free_box && free_box->type == fourcc("free") && free_box->size == 64);
+
+    // Running to the end stops before mfra; mehd loses only the head
+    auto tail = Fmp4Cutter::plan(input, 2.0, 0.0);
+    CHECK(tail.ok);
+    CHECK_EQ(tail.range_offset, fixture.fragment_offsets[2]);
+    CHECK_EQ(tail.range_offset + tail.range_length, fixture.fragments_end);
+    CHECK_EQ(tail.end_seconds, 0.0);
+    CHECK_EQ(mehd_duration(tail.build_prefix(tail.min_prefix_size)), uint64_t(4 * kMovieTimescale));
+
+    // The output is the prefix followed by the kept fragments, unchanged
+    auto result = plan.copy_to(dir / "cut.mp4", {});
+    CHECK(result.ok);
+    Bytes output = read_file(dir / "cut.mp4");
+    CHECK(output == cat({prefix, slice(fixture.bytes, plan.range_offset, plan.range_length)}));
+    CHECK(Fmp4Cutter::is_fragmented_mp4(dir / "cut.mp4"));
+}
+
+void test_rejected_inputs(const TempDir& dir) {
+    // Absolute data offsets would point into the removed head
+    auto absolute = make_fixture(3, 0x020001);
+    write_file(dir / "absolute.mp4", absolute.bytes);
+    auto plan = Fmp4Cutter::plan(dir / "absolute.mp4", 1.0, 0.0);
+    CHECK(!plan.ok);
+    CHECK(plan.error_message.find("absolute file offset") != std::string::npos);
+
+    // A video tkhd cut short before its track ID leaves the audio track as the
+    // main one; a truncated mdhd leaves no track at all
+    Bytes short_tkhd = full_box("tkhd", 0, 0, {Bytes(6)});
+    auto fallback = make_fixture(3, 0x020000, short_tkhd);
+    write_file(dir / "short_tkhd.mp4", fallback.bytes);
+    plan = Fmp4Cutter::plan(dir / "short_tkhd.mp4", 1.5, 0.0);
+    CHECK(plan.ok);
+    CHECK_EQ(plan.range_offset, fallback.fragment_offsets[0]);
+
+    Bytes moov = box("moov", {mvhd(kMovieTimescale, 0),
+                              box("trak", {tkhd(0, kVideoTrack, 0, 0),
+                                           box("mdia", {full_box("mdhd", 0, 0, {Bytes(4)}), hdlr("vide")})}),
+                              box("mvex")});
+    write_file(dir / "short_mdhd.mp4", cat({box("ftyp"), moov, moof(1, 0, 0), box("mdat")}));
+    plan = Fmp4Cutter::plan(dir / "short_mdhd.mp4", 1.0, 0.0);
+    CHECK(!plan.ok);
+    CHECK_EQ(plan.error_message, std::string("No track with a timescale in moov"));
+
+    // A tfdt too short for its time
+    Bytes bad_moof = box("moof", {box("traf", {full_box("tfhd", 0, 0x020000, {be(kVideoTrack, 4)}),
+                                               full_box("tfdt", 1, 0, {be(0, 4)})})});
+    auto good = make_fixture(1);
+    Bytes truncated = slice(good.bytes, 0, good.header_size);
+    write_file(dir / "short_tfdt.mp4", cat({truncated, bad_moof, box("mdat")}));
+    plan = Fmp4Cutter::plan(dir / "short_tfdt.mp4", 0.0, 0.0);
+    CHECK(!plan.ok);
+    CHECK(plan.error_message.find("without a decode time") != std::string::npos);
+
+    write_file(dir / "nothing.mp4", cat({box("ftyp"), box("free")}));
+    plan = Fmp4Cutter::plan(dir / "nothing.mp4", 0.0, 0.0);
+    CHECK(!plan.ok);
+}
+
+} // namespace
+
+int main() {
+    TempDir dir("fmp4-cutter");
+    test_detection(dir);
+    test_plan(dir);
+    test_rejected_inputs(dir);
+    return test::result();
+}
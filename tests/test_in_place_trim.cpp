@@ -0,0 +1,96 @@
+#include "in_place_trim.hpp"
+#include "ts_cutter.hpp"
+#include "ts_fixture.hpp"
+
+namespace fs = std::filesystem;
+
+using namespace trimora;
+using namespace trimora::test;
+
+namespace {
+
+void test_head(const TempDir& dir) {
+    // The dropped head is smaller than a filesystem block, so nothing can be
+    // collapsed: the rebuilt tables and null packets take its place
+    fs::path file = dir / "head.ts";
+    Bytes ts = transport_stream(0);
+    write_file(file, ts);
+    uint64_t range_offset = frame_packet(4) * kPacket;
+
+    auto plan = InPlaceTrimmer::plan(file, 3.0, 0.0);
+    CHECK(plan.ok);
+    CHECK_EQ(plan.collapse_offset, uint64_t(0));
+    CHECK_EQ(plan.header.size(), range_offset);
+    CHECK_EQ(plan.final_size, uint64_t(ts.size()));
+    CHECK_EQ(plan.start_seconds, 2.0);
+    CHECK(read_file(file) == ts);
+
+    std::string error;
+    CHECK(InPlaceTrimmer::apply(plan, error));
+    Bytes trimmed = read_file(file);
+    CHECK(slice(trimmed, 0, range_offset) == plan.header);
+    CHECK(slice(trimmed, range_offset, ts.size() - range_offset) == slice(ts, range_offset, ts.size() - range_offset));
+
+    // The first frame of the result is the kept keyframe
+    auto again = TsCutter::plan(file, 0.1, 0.0);
+    CHECK(again.ok);
+    CHECK_EQ(again.range_offset, range_offset);
+    CHECK_EQ(again.start_seconds, 0.0);
+}
+
+void test_tail(const TempDir& dir) {
+    fs::path file = dir / "tail.ts";
+    Bytes ts = transport_stream(0);
+    write_file(file, ts);
+    uint64_t end = (frame_packet(11) + 1) * kPacket;
+
+    auto plan = InPlaceTrimmer::plan(file, 0.0, 6.0);
+    CHECK(plan.ok);
+    CHECK_EQ(plan.truncate_at, end);
+    CHECK_EQ(plan.final_size, end);
+    CHECK(plan.steps.back().find("Truncate") == 0);
+
+    std::string error;
+    CHECK(InPlaceTrimmer::apply(plan, error));
+    CHECK(read_file(file) == slice(ts, 0, end));
+}
+
+void test_refused(const TempDir& dir) {
+    fs::path file = dir / "whole.ts";
+    Bytes ts = transport_stream(0);
+    write_file(file, ts);
+
+    // The whole file: the header it would write is the one already there
+    auto plan = InPlaceTrimmer::plan(file, 0.0, 0.0);
+    CHECK(!plan.ok);
+    CHECK(plan.error_message.find("Nothing to trim") == 0);
+
+    // Changed between the plan and the trim
+    plan = InPlaceTrimmer::plan(file, 3.0, 6.0);
+    CHECK(plan.ok);
+    write_file(file, cat({ts, packet(kAudioPid, true, false, {})}));
+    std::string error;
+    CHECK(!InPlaceTrimmer::apply(plan, error));
+    CHECK_EQ(error, std::string("File changed since the trim was planned"));
+
+    // Another name for the same data would change too
+    fs::create_hard_link(file, dir / "link.ts");
+    plan = InPlaceTrimmer::plan(file, 3.0, 6.0);
+    CHECK(!plan.ok);
+    CHECK(plan.error_message.find("hard links") != std::string::npos);
+
+    write_file(dir / "text.ts", Bytes(4096, 'x'));
+    plan = InPlaceTrimmer::plan(dir / "text.ts", 1.0, 0.0);
+    CHECK(!plan.ok);
+    CHECK(!InPlaceTrimmer::is_supported(dir / "text.ts"));
+}
+
+} // namespace
+
+int main() {
+    TempDir dir("in-place-trim");
+    test_head(dir);
+    test_tail(dir);
+    test_refused(dir);
+    return test::result();
+}
@@ -0,0 +1,138 @@
+#include "job_slots.hpp"
+#include "scoped_fd.hpp"
+#include "test_support.hpp"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <fcntl.h>
+#include <sys/file.h>
+
+namespace fs = std::filesystem;
+
+using namespace trimora;
+using namespace trimora::test;
+
+namespace {
+
+// flock() locks belong to open file descriptions, so threads with their own
+// JobSlots stand in for separate processes
+
+size_t ticket_count(const fs::path& directory) {
+    size_t count = 0;
+    for (const auto& entry : fs::directory_iterator(directory)) {
+        count += entry.path().filename().string().rfind("ticket-", 0) == 0 ? 1 : 0;
+    }
+    return count;
+}
+
+void wait_for(const std::atomic<bool>& flag) {
+    while (!flag) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+}
+
+void test_slots(const TempDir& dir) {
+    JobSlots slots(dir / "two", 2);
+    CHECK_EQ(slots.slots(), size_t(2));
+
+    auto first = slots.acquire([] { return true; });
+    auto second = slots.try_acquire();
+    CHECK(first && first->holds_slot());
+    CHECK(second && second->holds_slot());
+    CHECK(first && second && first->slot() != second->slot());
+
+    // Both held: try_acquire gives up at once, acquire gives up when told to
+    CHECK(!slots.try_acquire());
+    int waits = 0;
+    auto refused = slots.acquire([] { return false; }, [&] { ++waits; });
+    CHECK(!refused);
+    CHECK_EQ(waits, 1);
+    CHECK_EQ(ticket_count(dir / "two"), size_t(0));
+
+    // A released slot is free again
+    first.reset();
+    auto third = slots.try_acquire();
+    CHECK(third && third->holds_slot());
+}
+
+void test_ticket_order(const TempDir& dir) {
+    fs::path directory = dir / "queue";
+    JobSlots slots(directory, 1);
+    auto held = slots.acquire([] { return true; });
+    CHECK(held && held->holds_slot());
+
+    // Waiters queue one after another and are served in that order
+    std::mutex mutex;
+    std::vector<char> served;
+    std::atomic<int> waits{0};
+    std::atomic<bool> queued[3] = {false, false, false};
+    std::vector<std::thread> waiters;
+    for (size_t i = 0; i < 3; ++i) {
+        waiters.emplace_back([&, i] {
+            JobSlots own(directory, 1);
+            auto lease = own.acquire([] { return true; }, [&] {
+                ++waits;
+                queued[i] = true;
+            });
+            {
+                std::lock_guard<std::mutex> guard(mutex);
+                served.push_back(lease && lease->holds_slot() ? static_cast<char>('B' + i) : '?');
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(150));
+        });
+        wait_for(queued[i]);
+    }
+    CHECK_EQ(ticket_count(directory), size_t(3));
+
+    // Queued processes go first, even for a slot that is free
+    held.reset();
+    CHECK(!slots.try_acquire());
+    for (auto& waiter : waiters) {
+        waiter.join();
+    }
+    CHECK((served == std::vector<char>{'B', 'C', 'D'}));
+    CHECK_EQ(waits.load(), 3);
+    CHECK_EQ(ticket_count(directory), size_t(0));
+}
+
+void test_stale_ticket(const TempDir& dir) {
+    fs::path directory = dir / "stale";
+    JobSlots slots(directory, 1);
+    CHECK(slots.try_acquire().has_value());
+
+    // A ticket held locked is a live waiter somewhere else
+    fs::path ticket = directory / "ticket-00000000000000000007";
+    {
+        ScopedFd waiter(::open(ticket.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0666));
+        CHECK(waiter && ::flock(waiter.get(), LOCK_EX) == 0);
+        CHECK(!slots.try_acquire());
+        CHECK(fs::exists(ticket));
+    }
+
+    // Its owner gone, the next look at the queue removes it
+    auto lease = slots.try_acquire();
+    CHECK(lease && lease->holds_slot());
+    CHECK(!fs::exists(ticket));
+}
+
+void test_unusable_directory(const TempDir& dir) {
+    // A file where the directory should be: jobs run unlimited
+    write_file(dir / "not_a_directory", {});
+    JobSlots slots(dir / "not_a_directory", 1);
+    auto lease = slots.acquire([] { return true; });
+    CHECK(lease && !lease->holds_slot());
+    auto other = slots.try_acquire();
+    CHECK(other && !other->holds_slot());
+}
+
+} // namespace
+
+int main() {
+    TempDir dir("job-slots");
+    test_slots(dir);
+    test_ticket_order(dir);
+    test_stale_ticket(dir);
+    test_unusable_directory(dir);
+    return test::result();
+}
@@ -0,0 +1,397 @@
+#include "mkv_cutter.hpp"
+#include "test_support.hpp"
+#include <cstring>
+#include <optional>
+
+namespace fs = std::filesystem;
+
+using namespace trimora;
+using namespace trimora::test;
+
+namespace {
+
+constexpr uint32_t kEbml = 0x1a45dfa3;
+constexpr uint32_t kDocType = 0x4282;
+constexpr uint32_t kSegment = 0x18538067;
+constexpr uint32_t kSeekHead = 0x114d9b74;
+constexpr uint32_t kSeek = 0x4dbb;
+constexpr uint32_t kSeekId = 0x53ab;
+constexpr uint32_t kSeekPosition = 0x53ac;
+constexpr uint32_t kInfo = 0x1549a966;
+constexpr uint32_t kTimestampScale = 0x2ad7b1;
+constexpr uint32_t kDuration = 0x4489;
+constexpr uint32_t kTracks = 0x1654ae6b;
+constexpr uint32_t kTrackEntry = 0xae;
+constexpr uint32_t kTrackNumber = 0xd7;
+constexpr uint32_t kCues = 0x1c53bb6b;
+constexpr uint32_t kCuePoint = 0xbb;
+constexpr uint32_t kCueTime = 0xb3;
+constexpr uint32_t kCueTrackPositions = 0xb7;
+constexpr uint32_t kCueTrack = 0xf7;
+constexpr uint32_t kCueClusterPosition = 0xf1;
+constexpr uint32_t kCluster = 0x1f43b675;
+constexpr uint32_t kClusterTimestamp = 0xe7;
+constexpr uint32_t kSimpleBlock = 0xa3;
+constexpr uint32_t kVoid = 0xec;
+
+constexpr size_t kClusters = 10;       // One a second, timestamps in ms
+constexpr int16_t kLastBlockTime = 500;
+
+Bytes id_bytes(uint32_t id) {
+    Bytes out;
+    for (int i = id > 0xffffff ? 3 : id > 0xffff ? 2 : id > 0xff ? 1 : 0; i >= 0; --i) {
+        out.push_back(static_cast<uint8_t>(id >> (i * 8)));
+    }
+    return out;
+}
+
+// Sizes take one byte when they can, eight otherwise, as muxers do
+Bytes element(uint32_t id, std::initializer_list<Bytes> parts) {
+    Bytes payload = cat(parts);
+    Bytes size;
+    if (payload.size() < 0x7f) {
+        size = {static_cast<uint8_t>(0x80 | payload.size())};
+    } else {
+        size = {0x01};
+        for (int i = 6; i >= 0; --i) {
+            size.push_back(static_cast<uint8_t>(payload.size() >> (i * 8)));
+        }
+    }
+    return cat({id_bytes(id), size, payload});
+}
+
+Bytes uint_element(uint32_t id, uint64_t value, size_t width) {
+    Bytes payload(width);
+    for (size_t i = 0; i < width; ++i) {
+        payload[i] = static_cast<uint8_t>(value >> ((width - 1 - i) * 8));
+    }
+    return element(id, {payload});
+}
+
+Bytes float_element(uint32_t id, double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return uint_element(id, bits, 8);
+}
+
+// Track 1, keyframe flag, relative time, a little data
+Bytes simple_block(int16_t relative) {
+    return element(kSimpleBlock, {{0x81, static_cast<uint8_t>(relative >> 8), static_cast<uint8_t>(relative), 0x80},
+                                  Bytes(24, 0x33)});
+}
+
+// Enough EBML to walk the files the cutter writes
+struct Element {
+    uint32_t id = 0;
+    uint64_t offset = 0;
+    size_t header_size = 0;
+    uint64_t size = 0;
+
+    uint64_t data() const { return offset + header_size; }
+    uint64_t end() const { return data() + size; }
+};
+
+std::optional<Element> read_element(const Bytes& bytes, uint64_t offset) {
+    auto width = [](uint8_t first) {
+        size_t n = 1;
+        while (n <= 8 && !(first & (0x80 >> (n - 1)))) {
+            ++n;
+        }
+        return n;
+    };
+    if (offset + 2 > bytes.size()) {
+        return std::nullopt;
+    }
+    Element out;
+    out.offset = offset;
+    size_t id_width = width(bytes[offset]);
+    for (size_t i = 0; i < id_width; ++i) {
+        out.id = (out.id << 8) | bytes[offset + i];
+    }
+    size_t size_width = width(bytes[offset + id_width]);
+    out.size = bytes[offset + id_width] & (0xff >> size_width);
+    for (size_t i = 1; i < size_width; ++i) {
+        out.size = (out.size << 8) | bytes[offset + id_width + i];
+    }
+    out.header_size = id_width + size_width;
+    if (out.end() > bytes.size()) {
+        return std::nullopt;
+    }
+    return out;
+}
+
+std::vector<Element> children(const Bytes& bytes, const Element& parent) {
+    std::vector<Element> out;
+    for (uint64_t at = parent.data(); at < parent.end();) {
+        auto child = read_element(bytes, at);
+        if (!child) {
+            break;
+        }
+        out.push_back(*child);
+        at = child->end();
+    }
+    return out;
+}
+
+// First child with an ID, if the parent is there at all
+std::optional<Element> child(const Bytes& bytes, const std::optional<Element>& parent, uint32_t id) {
+    if (!parent) {
+        return std::nullopt;
+    }
+    for (const auto& element : children(bytes, *parent)) {
+        if (element.id == id) {
+            return element;
+        }
+    }
+    return std::nullopt;
+}
+
+uint64_t uint_value(const Bytes& bytes, const Element& element) {
+    uint64_t value = 0;
+    for (uint64_t i = 0; i < element.size; ++i) {
+        value = (value << 8) | bytes[element.data() + i];
+    }
+    return value;
+}
+
+double float_value(const Bytes& bytes, const Element& element) {
+    uint64_t bits = uint_value(bytes, element);
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+struct Fixture {
+    Bytes bytes;
+    Bytes ebml;
+    Bytes tracks;
+    uint64_t segment_data = 0;
+    std::vector<uint64_t> cluster_offsets;
+    uint64_t clusters_end = 0;
+};
+
+// EBML header, then a segment with SeekHead, Info, Tracks, one cluster a
+// second and, optionally, Cues after the clusters for every other cluster
+Fixture make_fixture(bool with_cues, const std::string& doc_type = "webm") {
+    Fixture fixture;
+    fixture.ebml = element(kEbml, {element(kDocType, {Bytes(doc_type.begin(), doc_type.end())})});
+    Bytes info = element(kInfo, {uint_element(kTimestampScale, 1000000, 3),
+                                 float_element(kDuration, kClusters * 1000.0)});
+    fixture.tracks = element(kTracks, {element(kTrackEntry, {uint_element(kTrackNumber, 1, 1)})});
+
+    std::vector<Bytes> clusters;
+    for (size_t i = 0; i < kClusters; ++i) {
+        clusters.push_back(element(kCluster, {uint_element(kClusterTimestamp, i * 1000, 2),
+                                              simple_block(0), simple_block(kLastBlockTime)}));
+    }
+
+    // The seek position is fixed-width, so the SeekHead size doesn't depend on it
+    auto seek_head = [](uint64_t position) {
+        return element(kSeekHead, {element(kSeek, {uint_element(kSeekId, kCues, 4),
+                                                   uint_element(kSeekPosition, position, 8)})});
+    };
+    Bytes head = cat({with_cues ? seek_head(0) : Bytes(), info, fixture.tracks});
+    uint64_t position = head.size();
+    for (const auto& cluster : clusters) {
+        fixture.cluster_offsets.push_back(position);
+        position += cluster.size();
+    }
+
+    Bytes cues;
+    if (with_cues) {
+        head = cat({seek_head(position), info, fixture.tracks});
+        Bytes points;
+        for (size_t i = 0; i < kClusters; i += 2) {
+            points = cat({points, element(kCuePoint, {uint_element(kCueTime, i * 1000, 2),
+                                                      element(kCueTrackPositions, {
+                                                          uint_element(kCueTrack, 1, 1),
+                                                          uint_element(kCueClusterPosition, fixture.cluster_offsets[i], 4)})})});
+        }
+        cues = element(kCues, {points});
+    }
+
+    Bytes body = head;
+    for (const auto& cluster : clusters) {
+        body = cat({body, cluster});
+    }
+    body = cat({body, cues});
+    Bytes segment = element(kSegment, {body});
+    fixture.bytes = cat({fixture.ebml, segment});
+
+    fixture.segment_data = fixture.ebml.size() + (segment.size() - body.size());
+    for (auto& offset : fixture.cluster_offsets) {
+        offset += fixture.segment_data;
+    }
+    fixture.clusters_end = fixture.segment_data + position;
+    return fixture;
+}
+
+// Checks the cut file hangs together: the segment size covers the file,
+// the duration matches, and every cue points at a cluster with its time
+void check_output(const Bytes& output, const Fixture& fixture, double duration, size_t expected_cues) {
+    CHECK(slice(output, 0, fixture.ebml.size()) == fixture.ebml);
+    auto segment = read_element(output, fixture.ebml.size());
+    CHECK(segment && segment->id == kSegment && segment->end() == output.size());
+    if (!segment) {
+        return;
+    }
+
+    auto info = child(output, *segment, kInfo);
+    auto length = child(output, info, kDuration);
+    CHECK(length && float_value(output, *length) == duration);
+    auto scale = child(output, info, kTimestampScale);
+    CHECK(scale && uint_value(output, *scale) == 1000000);
+
+    auto tracks = child(output, *segment, kTracks);
+    CHECK(tracks && slice(output, tracks->offset, tracks->end() - tracks->offset) == fixture.tracks);
+
+    size_t cue_count = 0;
+    if (auto cues = child(output, *segment, kCues)) {
+        for (const auto& point : children(output, *cues)) {
+            auto time = child(output, point, kCueTime);
+            auto positions = child(output, point, kCueTrackPositions);
+            auto position = child(output, positions, kCueClusterPosition);
+            CHECK(time && position);
+            if (!time || !position) {
+                continue;
+            }
+            auto cluster = read_element(output, segment->data() + uint_value(output, *position));
+            auto timestamp = child(output, cluster, kClusterTimestamp);
+            CHECK(cluster && cluster->id == kCluster);
+            CHECK(timestamp && uint_value(output, *timestamp) == uint_value(output, *time));
+            ++cue_count;
+        }
+    }
+    CHECK_EQ(cue_count, expected_cues);
+}
+
+void test_detection(const TempDir& dir) {
+    write_file(dir / "a.webm", make_fixture(false).bytes);
+    CHECK(MkvCutter::is_matroska(dir / "a.webm"));
+    write_file(dir / "a.mkv", make_fixture(false, "matroska").bytes);
+    CHECK(MkvCutter::is_matroska(dir / "a.mkv"));
+    write_file(dir / "other.mkv", make_fixture(false, "other").bytes);
+    CHECK(!MkvCutter::is_matroska(dir / "other.mkv"));
+    write_file(dir / "text.mkv", Bytes(256, 'x'));
+    CHECK(!MkvCutter::is_matroska(dir / "text.mkv"));
+}
+
+void test_without_cues(const TempDir& dir) {
+    auto fixture = make_fixture(false);
+    fs::path input = dir / "plain.mkv";
+    write_file(input, fixture.bytes);
+
+    // Walking cluster headers: the cluster at 3 s holds 3.5 s; the one at
+    // 6 s is the last before 6.2 s and its last block is half a second in
+    auto plan = MkvCutter::plan(input, 3.5, 6.2);
+    CHECK(plan.ok);
+    CHECK_EQ(plan.range_offset, fixture.cluster_offsets[3]);
+    CHECK_EQ(plan.range_offset + plan.range_length, fixture.cluster_offsets[7]);
+    CHECK_EQ(plan.start_seconds, 3.0);
+    CHECK_EQ(plan.end_seconds, 6.5);
+
+    auto result = plan.copy_to(dir / "plain_cut.mkv", {});
+    CHECK(result.ok);
+    Bytes output = read_file(dir / "plain_cut.mkv");
+    CHECK_EQ(output.size(), plan.min_prefix_size + plan.range_length);
+    check_output(output, fixture, 3500.0, 0);
+    CHECK(slice(output, plan.min_prefix_size, plan.range_length) ==
+          slice(fixture.bytes, plan.range_offset, plan.range_length));
+}
+
+void test_with_cues(const TempDir& dir) {
+    auto fixture = make_fixture(true);
+    fs::path input = dir / "cued.mkv";
+    write_file(input, fixture.bytes);
+
+    // Cues only index even clusters, so the start goes back to 2 s; the
+    // cues for 2, 4 and 6 s land in the copied range
+    auto plan = MkvCutter::plan(input, 3.5, 6.2);
+    CHECK(plan.ok);
+    CHECK_EQ(plan.range_offset, fixture.cluster_offsets[2]);
+    CHECK_EQ(plan.range_offset + plan.range_length, fixture.cluster_offsets[7]);
+    CHECK_EQ(plan.start_seconds, 2.0);
+    CHECK_EQ(plan.end_seconds, 6.5);
+
+    CHECK(plan.copy_to(dir / "cued_cut.mkv", {}).ok);
+    Bytes output = read_file(dir / "cued_cut.mkv");
+    check_output(output, fixture, 4500.0, 3);
+
+    // Running to the end stops at the last cluster, before the old cues
+    auto tail = MkvCutter::plan(input, 7.0, 0.0);
+    CHECK(tail.ok);
+    CHECK_EQ(tail.range_offset, fixture.cluster_offsets[6]);
+    CHECK_EQ(tail.range_offset + tail.range_length, fixture.clusters_end);
+    CHECK_EQ(tail.end_seconds, 0.0);
+    CHECK(tail.copy_to(dir / "tail_cut.mkv", {}).ok);
+    check_output(read_file(dir / "tail_cut.mkv"), fixture, 3500.0, 2);
+}
+
+void test_padding(const TempDir& dir) {
+    auto fixture = make_fixture(true);
+    write_file(dir / "pad.mkv", fixture.bytes);
+    auto plan = MkvCutter::plan(dir / "pad.mkv", 3.5, 6.2);
+    CHECK(plan.ok);
+
+    Bytes minimal = plan.build_prefix(plan.min_prefix_size);
+    CHECK_EQ(minimal.size(), plan.min_prefix_size);
+    Bytes clusters = slice(fixture.bytes, plan.range_offset, plan.range_length);
+    Bytes output = cat({minimal, clusters});
+    auto segment = read_element(output, fixture.ebml.size());
+    uint64_t cues_size = 0;
+    if (auto cues = child(output, segment, kCues)) {
+        cues_size = cues->end() - cues->offset;
+    }
+    CHECK(cues_size > 0);
+
+    // Extra room becomes a Void element after the cues
+    Bytes roomy = plan.build_prefix(plan.min_prefix_size + 40);
+    CHECK_EQ(roomy.size(), plan.min_prefix_size + 40);
+    auto padding = read_element(roomy, plan.min_prefix_size);
+    CHECK(padding && padding->id == kVoid && padding->end() == roomy.size());
+    check_output(cat({roomy, clusters}), fixture, 4500.0, 3);
+
+    // One spare byte can't hold a Void, and less room than the cues need
+    // drops them; players then index the file themselves
+    Bytes odd = plan.build_prefix(plan.min_prefix_size + 1);
+    CHECK_EQ(odd.size(), plan.min_prefix_size + 1);
+    check_output(cat({odd, clusters}), fixture, 4500.0, 0);
+    Bytes tight = plan.build_prefix(plan.min_prefix_size - cues_size);
+    CHECK_EQ(tight.size(), plan.min_prefix_size - cues_size);
+    check_output(cat({tight, clusters}), fixture, 4500.0, 0);
+    CHECK(plan.build_prefix(plan.min_prefix_size - cues_size - 1).empty());
+}
+
+void test_rejected_inputs(const TempDir& dir) {
+    write_file(dir / "text.mkv", Bytes(256, 'x'));
+    auto plan = MkvCutter::plan(dir / "text.mkv", 1.0, 0.0);
+    CHECK(!plan.ok);
+    CHECK_EQ(plan.error_message, std::string("Not a Matroska file"));
+
+    // Header elements but no clusters
+    auto fixture = make_fixture(false);
+    Bytes ebml = fixture.ebml;
+    Bytes head_only = cat({ebml, element(kSegment, {element(kInfo, {uint_element(kTimestampScale, 1000000, 3)}),
+                                                    fixture.tracks})});
+    write_file(dir / "empty.mkv", head_only);
+    plan = MkvCutter::plan(dir / "empty.mkv", 1.0, 0.0);
+    CHECK(!plan.ok);
+    CHECK_EQ(plan.error_message, std::string("Missing segment info, tracks or clusters"));
+
+    write_file(dir / "no_segment.mkv", cat({ebml, element(kVoid, {Bytes(8)})}));
+    plan = MkvCutter::plan(dir / "no_segment.mkv", 1.0, 0.0);
+    CHECK(!plan.ok);
+    CHECK_EQ(plan.error_message, std::string("No Matroska segment"));
+}
+
+} // namespace
+
+int main() {
+    TempDir dir("mkv-cutter");
+    test_detection(dir);
+    test_without_cues(dir);
+    test_with_cues(dir);
+    test_padding(dir);
+    test_rejected_inputs(dir);
+    return test::result();
+}
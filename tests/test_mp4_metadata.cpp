@@ -0,0 +1,302 @@
+#include "mp4_metadata.hpp"
+#include "mp4_fixture.hpp"
+#include "test_support.hpp"
+#include "scoped_fd.hpp"
+#include <atomic>
+#include <fcntl.h>
+#include <sys/file.h>
+
+namespace fs = std::filesystem;
+
+using namespace trimora;
+using namespace trimora::test;
+using mp4::fourcc;
+
+namespace {
+
+using Method = Mp4MetadataResult::Method;
+
+const Bytes kMedia(4096, 0x5a);
+
+Bytes movie(bool with_video) {
+    Bytes video = with_video ? trak(tkhd(0, 1, 1920, 1080), 90000, "vide") : Bytes();
+    return box("moov", {mvhd(1000, 10000), video, trak(tkhd(0, 2, 0, 0), 48000, "soun")});
+}
+
+// ftyp, moov, then what follows it (free space, media)
+Bytes file_with(const Bytes& moov, std::initializer_list<Bytes> after) {
+    return cat({box("ftyp", {be(fourcc("isom"), 4), be(0, 4)}), moov, cat(after)});
+}
+
+// The nine matrix values of the tkhd of the trak-th track (0-based)
+std::vector<uint32_t> matrix_of(const Bytes& bytes, size_t track) {
+    std::vector<uint32_t> values;
+    for (const auto& box : children_of(bytes, *find_box(bytes, {fourcc("moov")}))) {
+        if (box.type != fourcc("trak") || track-- > 0) {
+            continue;
+        }
+        auto children = children_of(bytes, box);
+        auto header = std::find_if(children.begin(), children.end(),
+                                   [](const mp4::Box& child) { return child.type == fourcc("tkhd"); });
+        for (size_t i = 0; i < 9; ++i) {
+            values.push_back(static_cast<uint32_t>(mp4::read_be(payload_of(bytes, *header) + 40 + i * 4, 4)));
+        }
+        break;
+    }
+    return values;
+}
+
+std::string title_of(const Bytes& bytes) {
+    auto data = find_box(bytes, {fourcc("moov"), fourcc("udta"), fourcc("meta"), fourcc("ilst"),
+                                 fourcc("\xA9nam"), fourcc("data")});
+    if (!data) {
+        return "";
+    }
+    return std::string(reinterpret_cast<const char*>(payload_of(bytes, *data)) + 8,
+                       data->size - data->header_size - 8);
+}
+
+// Where the media sits and whether it is intact
+bool media_intact(const fs::path& file, uint64_t offset) {
+    Bytes bytes = read_file(file);
+    return bytes.size() >= offset + 8 + kMedia.size() && slice(bytes, offset + 8, kMedia.size()) == kMedia;
+}
+
+void test_parse_creation_time() {
+    CHECK_EQ(Mp4MetadataEditor::parse_creation_time("1970-01-01").value_or(0), uint64_t(2082844800));
+    CHECK_EQ(Mp4MetadataEditor::parse_creation_time("2024-02-29T12:34:56Z").value_or(0), uint64_t(3792054896));
+    CHECK_EQ(Mp4MetadataEditor::parse_creation_time("2024-02-29 12:34:56").value_or(0), uint64_t(3792054896));
+    CHECK_EQ(Mp4MetadataEditor::parse_creation_time("1904-01-01").value_or(1), uint64_t(0));
+    CHECK(!Mp4MetadataEditor::parse_creation_time("1903-12-31"));
+    CHECK(!Mp4MetadataEditor::parse_creation_time("2024-13-01"));
+    CHECK(!Mp4MetadataEditor::parse_creation_time("2024-01-01 25:00:00"));
+    CHECK(!Mp4MetadataEditor::parse_creation_time("2024-01-01 12:00"));
+    CHECK(!Mp4MetadataEditor::parse_creation_time("yesterday"));
+}
+
+void test_rotation(const TempDir& dir) {
+    fs::path file = dir / "rotate.mp4";
+    Bytes original = file_with(movie(true), {box("mdat", {kMedia})});
+    uint64_t mdat_offset = original.size() - 8 - kMedia.size();
+    write_file(file, original);
+
+    Mp4MetadataEdit edit;
+    edit.rotation = 90;
+    auto result = Mp4MetadataEditor::apply(file, edit);
+    CHECK(result.ok);
+    CHECK(result.method == Method::InPlace);
+    CHECK_EQ(read_file(file).size(), original.size());
+    CHECK(media_intact(file, mdat_offset));
+    {
+        Bytes bytes = read_file(file);
+        // Rotated a quarter turn clockwise and moved back into the frame by its height
+        CHECK((matrix_of(bytes, 0) == std::vector<uint32_t>{0, 0x10000, 0, 0xffff0000u, 0, 0,
+                                                           1080u << 16, 0, 0x40000000}));
+        // The audio track keeps its identity matrix
+        CHECK((matrix_of(bytes, 1) == std::vector<uint32_t>{0x10000, 0, 0, 0, 0x10000, 0, 0, 0, 0x40000000}));
+    }
+
+    edit.rotation = 270;
+    CHECK(Mp4MetadataEditor::apply(file, edit).ok);
+    CHECK((matrix_of(read_file(file), 0) == std::vector<uint32_t>{0, 0xffff0000u, 0, 0x10000, 0, 0,
+                                                              0, 1920u << 16, 0x40000000}));
+
+    edit.rotation = 0;
+    CHECK(Mp4MetadataEditor::apply(file, edit).ok);
+    CHECK(read_file(file) == original);
+
+    edit.rotation = 45;
+    result = Mp4MetadataEditor::apply(file, edit);
+    CHECK(!result.ok);
+    CHECK(result.method == Method::None);
+
+    // Nothing to rotate: the file is left alone
+    fs::path audio = dir / "audio.mp4";
+    Bytes audio_only = file_with(movie(false), {box("mdat", {kMedia})});
+    write_file(audio, audio_only);
+    edit.rotation = 90;
+    result = Mp4MetadataEditor::apply(audio, edit);
+    CHECK(!result.ok);
+    CHECK_EQ(result.error_message, std::string("No video track to rotate"));
+    CHECK(read_file(audio) == audio_only);
+}
+
+void test_creation_time(const TempDir& dir) {
+    fs::path file = dir / "times.mp4";
+    write_file(file, file_with(movie(true), {box("mdat", {kMedia})}));
+
+    Mp4MetadataEdit edit;
+    edit.creation_time = "2024-02-29 12:34:56";
+    CHECK(Mp4MetadataEditor::apply(file, edit).ok);
+    {
+        Bytes bytes = read_file(file);
+        auto header = find_box(bytes, {fourcc("moov"), fourcc("mvhd")});
+        CHECK_EQ(mp4::read_be(payload_of(bytes, *header) + 4, 4), uint64_t(3792054896));
+        CHECK_EQ(mp4::read_be(payload_of(bytes, *header) + 8, 4), uint64_t(3792054896));
+        auto media_header = find_box(bytes, {fourcc("moov"), fourcc("trak"), fourcc("mdia"), fourcc("mdhd")});
+        CHECK_EQ(mp4::read_be(payload_of(bytes, *media_header) + 4, 4), uint64_t(3792054896));
+    }
+
+    // Past 2040 the version 0 fields overflow
+    edit.creation_time = "2041-01-01";
+    auto result = Mp4MetadataEditor::apply(file, edit);
+    CHECK(!result.ok);
+    CHECK(result.error_message.find("32-bit") != std::string::npos);
+
+    edit.creation_time = "not a date";
+    CHECK(!Mp4MetadataEditor::apply(file, edit).ok);
+}
+
+void test_title(const TempDir& dir) {
+    Mp4MetadataEdit edit;
+    edit.title = "Holiday 2024";
+
+    // Free space after moov absorbs the new boxes
+    fs::path roomy = dir / "roomy.mp4";
+    Bytes moov = movie(true);
+    Bytes original = file_with(moov, {box("free", {Bytes(512)}), box("mdat", {kMedia})});
+    uint64_t mdat_offset = original.size() - 8 - kMedia.size();
+    write_file(roomy, original);
+    auto result = Mp4MetadataEditor::apply(roomy, edit);
+    CHECK(result.ok);
+    CHECK(result.method == Method::InPlace);
+    CHECK_EQ(read_file(roomy).size(), original.size());
+    CHECK(media_intact(roomy, mdat_offset));
+    {
+        Bytes bytes = read_file(roomy);
+        CHECK_EQ(title_of(bytes), edit.title.value());
+        auto grown = find_box(bytes, {fourcc("moov")});
+        auto padding = find_box(bytes, {fourcc("free")});
+        CHECK(grown && padding && grown->end() == padding->offset);
+        CHECK(padding && padding->end() == mdat_offset);
+    }
+
+    // Changing it again replaces the entry rather than adding one
+    edit.title = "Holiday";
+    CHECK(Mp4MetadataEditor::apply(roomy, edit).ok);
+    {
+        Bytes bytes = read_file(roomy);
+        CHECK_EQ(title_of(bytes), std::string("Holiday"));
+        auto ilst = find_box(bytes, {fourcc("moov"), fourcc("udta"), fourcc("meta"), fourcc("ilst")});
+        size_t entries = 0;
+        for (const auto& entry : children_of(bytes, *ilst)) {
+            entries += entry.type == fourcc("\xA9nam") ? 1 : 0;
+        }
+        CHECK_EQ(entries, size_t(1));
+    }
+
+    // An empty title removes it
+    edit.title = "";
+    CHECK(Mp4MetadataEditor::apply(roomy, edit).ok);
+    CHECK_EQ(title_of(read_file(roomy)), std::string());
+
+    // No room: the new moov goes to the end and the old one becomes free space
+    fs::path tight = dir / "tight.mp4";
+    original = file_with(moov, {box("mdat", {kMedia})});
+    mdat_offset = original.size() - 8 - kMedia.size();
+    uint64_t moov_offset = original.size() - 8 - kMedia.size() - moov.size();
+    write_file(tight, original);
+    edit.title = "Holiday 2024";
+    result = Mp4MetadataEditor::apply(tight, edit);
+    CHECK(result.ok);
+    CHECK(result.method == Method::Relocated);
+    CHECK(media_intact(tight, mdat_offset));
+    {
+        Bytes bytes = read_file(tight);
+        CHECK_EQ(title_of(bytes), edit.title.value());
+        auto relocated = find_box(bytes, {fourcc("moov")});
+        CHECK(relocated && relocated->offset == original.size() && relocated->end() == bytes.size());
+        auto retired = find_box(bytes, {fourcc("free")});
+        CHECK(retired && retired->offset == moov_offset && retired->size == moov.size());
+    }
+
+    // moov last in the file is rewritten where it is
+    fs::path last = dir / "last.mp4";
+    Bytes media_first = cat({box("ftyp", {be(fourcc("isom"), 4), be(0, 4)}), box("mdat", {kMedia}), moov});
+    write_file(last, media_first);
+    result = Mp4MetadataEditor::apply(last, edit);
+    CHECK(result.ok);
+    CHECK(result.method == Method::InPlace);
+    {
+        Bytes bytes = read_file(last);
+        CHECK_EQ(title_of(bytes), edit.title.value());
+        auto rewritten = find_box(bytes, {fourcc("moov")});
+        CHECK(rewritten && rewritten->offset == media_first.size() - moov.size());
+        CHECK(rewritten && rewritten->end() == bytes.size());
+    }
+}
+
+void test_failures(const TempDir& dir) {
+    Mp4MetadataEdit edit;
+    edit.title = "x";
+
+    write_file(dir / "no_moov.mp4", cat({box("ftyp"), box("mdat", {kMedia})}));
+    auto result = Mp4MetadataEditor::apply(dir / "no_moov.mp4", edit);
+    CHECK(!result.ok);
+    CHECK(result.error_message.find("No moov") == 0);
+
+    write_file(dir / "two_moov.mp4", cat({box("ftyp"), movie(true), movie(true)}));
+    CHECK(!Mp4MetadataEditor::apply(dir / "two_moov.mp4", edit).ok);
+
+    Bytes malformed = file_with(movie(true), {be(4, 4), be(fourcc("mdat"), 4)});
+    write_file(dir / "malformed.mp4", malformed);
+    result = Mp4MetadataEditor::apply(dir / "malformed.mp4", edit);
+    CHECK(!result.ok);
+    CHECK(result.error_message.find("Malformed box") == 0);
+    CHECK(read_file(dir / "malformed.mp4") == malformed);
+
+    // A video track whose tkhd is too short to hold even its version
+    Bytes stub = box("moov", {mvhd(1000, 10000), box("trak", {box("tkhd"), box("mdia", {mdhd(90000), hdlr("vide")})})});
+    Bytes truncated = file_with(stub, {box("mdat", {kMedia})});
+    write_file(dir / "short_tkhd.mp4", truncated);
+    Mp4MetadataEdit rotate;
+    rotate.rotation = 90;
+    result = Mp4MetadataEditor::apply(dir / "short_tkhd.mp4", rotate);
+    CHECK(!result.ok);
+    CHECK_EQ(result.error_message, std::string("No video track to rotate"));
+    CHECK(read_file(dir / "short_tkhd.mp4") == truncated);
+
+    // Another process editing the file
+    fs::path locked = dir / "locked.mp4";
+    write_file(locked, file_with(movie(true), {box("mdat", {kMedia})}));
+    ScopedFd holder(::open(locked.c_str(), O_RDONLY | O_CLOEXEC));
+    CHECK(holder && ::flock(holder.get(), LOCK_EX) == 0);
+    result = Mp4MetadataEditor::apply(locked, edit);
+    CHECK(!result.ok);
+    CHECK_EQ(result.error_message, std::string("File is locked by another process"));
+}
+
+void test_batch(const TempDir& dir) {
+    std::vector<fs::path> files;
+    for (int i = 0; i < 6; ++i) {
+        files.push_back(dir / ("batch" + std::to_string(i) + ".mp4"));
+        write_file(files.back(), file_with(movie(true), {box("mdat", {kMedia})}));
+    }
+    files.push_back(dir / "missing.mp4");
+
+    Mp4MetadataEdit edit;
+    edit.rotation = 180;
+    std::atomic<size_t> done{0};
+    auto results = Mp4MetadataEditor::apply_batch(files, edit, 3, [&](const Mp4MetadataResult&) { ++done; });
+    CHECK_EQ(results.size(), files.size());
+    CHECK_EQ(done.load(), files.size());
+    for (size_t i = 0; i < files.size(); ++i) {
+        CHECK(results[i].file == files[i]);
+        CHECK_EQ(results[i].ok, i + 1 < files.size());
+    }
+    CHECK((matrix_of(read_file(files[0]), 0) == std::vector<uint32_t>{0xffff0000u, 0, 0, 0, 0xffff0000u, 0,
+                                                                      1920u << 16, 1080u << 16, 0x40000000}));
+}
+
+} // namespace
+
+int main() {
+    TempDir dir("mp4-metadata");
+    test_parse_creation_time();
+    test_rotation(dir);
+    test_creation_time(dir);
+    test_title(dir);
+    test_failures(dir);
+    test_batch(dir);
+    return test::result();
+}
@@ -0,0 +1,299 @@
+#include "mp4_reader.hpp"
+#include "mp4_fixture.hpp"
+#include "test_support.hpp"
+#include "scoped_fd.hpp"
+#include <fstream>
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+using namespace trimora;
+using namespace trimora::test;
+using mp4::fourcc;
+
+namespace {
+
+// A box parsed from the front of an in-memory buffer
+mp4::BoxRef ref_of(const Bytes& bytes) {
+    return mp4::BoxRef(*mp4::parse_box(bytes.data(), bytes.size(), 0, bytes.size()), bytes.data());
+}
+
+void test_box_iteration(const TempDir& dir) {
+    // 64-bit mdat size, and a last box claiming more bytes than the file has
+    Bytes mdat = cat({be(1, 4), be(fourcc("mdat"), 4), be(16 + 5, 8), Bytes(5, 0xaa)});
+    Bytes moov = box("moov", {mvhd(1000, 5000), box("trak", {box("mdia", {box("minf", {box("stbl")})})})});
+    Bytes truncated = cat({be(100, 4), be(fourcc("skip"), 4), Bytes(10)});
+    fs::path file = dir / "boxes.mp4";
+    write_file(file, cat({box("ftyp", {be(fourcc("isom"), 4), be(0, 4)}), mdat, moov, truncated}));
+
+    mp4::Reader reader(file);
+    CHECK(static_cast<bool>(reader));
+    std::vector<uint32_t> types;
+    for (const auto& top : reader.top_level()) {
+        types.push_back(top.type());
+    }
+    CHECK((types == std::vector<uint32_t>{fourcc("ftyp"), fourcc("mdat"), fourcc("moov")}));
+
+    auto large = reader.find(fourcc("mdat"));
+    CHECK(large.has_value());
+    CHECK_EQ(large->box().header_size, size_t(16));
+    CHECK_EQ(large->payload_size(), uint64_t(5));
+    CHECK_EQ(large->payload()[0], uint8_t(0xaa));
+
+    auto movie = reader.find(fourcc("moov"));
+    CHECK(movie.has_value());
+    CHECK(movie->descend({fourcc("trak"), fourcc("mdia"), fourcc("minf"), fourcc("stbl")}).has_value());
+    CHECK(!movie->descend({fourcc("trak"), fourcc("tkhd")}).has_value());
+    auto header = movie->child(fourcc("mvhd"));
+    CHECK(header.has_value());
+    CHECK_EQ(header->version(), uint8_t(0));
+    CHECK_EQ(mp4::read_be(header->payload() + 12, 4), uint64_t(1000));
+}
+
+void test_reader_errors(const TempDir& dir) {
+    mp4::Reader missing(dir / "missing.mp4");
+    CHECK(!missing);
+    CHECK(missing.error_message().find("Cannot open") == 0);
+
+    write_file(dir / "empty.mp4", {});
+    mp4::Reader empty(dir / "empty.mp4");
+    CHECK(!empty);
+    CHECK(empty.error_message().find("Empty file") == 0);
+
+    // From a descriptor, which can be closed once the file is mapped
+    write_file(dir / "open.mp4", box("ftyp", {be(fourcc("isom"), 4)}));
+    int fd = ::open((dir / "open.mp4").c_str(), O_RDONLY | O_CLOEXEC);
+    mp4::Reader opened(fd, "open.mp4");
+    ::close(fd);
+    CHECK(opened && opened.find(fourcc("ftyp")).has_value());
+    mp4::Reader closed(fd, "open.mp4");
+    CHECK(!closed);
+    CHECK_EQ(closed.error_message().find("Cannot open open.mp4"), size_t(0));
+}
+
+void test_table_view_clamps() {
+    Bytes entries = cat({be(1, 4), be(2, 4), Bytes(2)});
+    mp4::TableView view(entries.data(), entries.size(), 5, 4);
+    CHECK_EQ(view.count(), uint32_t(2));
+    CHECK_EQ(view.field(1, 0, 4), uint64_t(2));
+
+    // A table claiming 2^32 - 1 entries in an 8-byte box has none
+    Bytes stco = full_box("stco", 0, 0, {be(0xffffffffu, 4)});
+    auto offsets = mp4::ChunkOffsets::parse(ref_of(stco));
+    CHECK(offsets.has_value());
+    CHECK_EQ(offsets->count(), uint32_t(0));
+
+    // Too short for version, flags and count
+    CHECK(!mp4::ChunkOffsets::parse(ref_of(box("stco", {be(0, 4)}))).has_value());
+    CHECK(!mp4::TimeToSample::parse(ref_of(full_box("stts", 0, 0))).has_value());
+}
+
+void test_sample_sizes() {
+    // stsz with a size per sample; the count claims more than are present
+    Bytes stsz = full_box("stsz", 0, 0, {be(0, 4), be(10, 4), be(100, 4), be(200, 4), be(300, 4)});
+    auto sizes = mp4::SampleSizes::parse(ref_of(stsz));
+    CHECK(sizes.has_value());
+    CHECK_EQ(sizes->count(), uint32_t(3));
+    CHECK_EQ(sizes->size(0), uint32_t(100));
+    CHECK_EQ(sizes->size(2), uint32_t(300));
+
+    // Constant size: the count stands without any entries
+    Bytes constant = full_box("stsz", 0, 0, {be(512, 4), be(1000, 4)});
+    sizes = mp4::SampleSizes::parse(ref_of(constant));
+    CHECK(sizes.has_value());
+    CHECK_EQ(sizes->count(), uint32_t(1000));
+    CHECK_EQ(sizes->size(999), uint32_t(512));
+
+    // stz2, 4 bits: high nibble first; 3 bytes hold 6 samples of the 7 claimed
+    Bytes nibbles = full_box("stz2", 0, 0, {be(4, 4), be(7, 4), be(0x12, 1), be(0x34, 1), be(0x5f, 1)});
+    sizes = mp4::SampleSizes::parse(ref_of(nibbles));
+    CHECK(sizes.has_value());
+    CHECK_EQ(sizes->count(), uint32_t(6));
+    CHECK_EQ(sizes->size(0), uint32_t(1));
+    CHECK_EQ(sizes->size(1), uint32_t(2));
+    CHECK_EQ(sizes->size(4), uint32_t(5));
+    CHECK_EQ(sizes->size(5), uint32_t(15));
+
+    Bytes bytes8 = full_box("stz2", 0, 0, {be(8, 4), be(2, 4), be(7, 1), be(250, 1)});
+    sizes = mp4::SampleSizes::parse(ref_of(bytes8));
+    CHECK(sizes.has_value());
+    CHECK_EQ(sizes->count(), uint32_t(2));
+    CHECK_EQ(sizes->size(1), uint32_t(250));
+
+    Bytes bytes16 = full_box("stz2", 0, 0, {be(16, 4), be(3, 4), be(1000, 2), be(65535, 2), be(1, 1)});
+    sizes = mp4::SampleSizes::parse(ref_of(bytes16));
+    CHECK(sizes.has_value());
+    CHECK_EQ(sizes->count(), uint32_t(2));
+    CHECK_EQ(sizes->size(0), uint32_t(1000));
+    CHECK_EQ(sizes->size(1), uint32_t(65535));
+
+    CHECK(!mp4::SampleSizes::parse(ref_of(full_box("stz2", 0, 0, {be(12, 4), be(1, 4), be(0, 2)}))).has_value());
+    CHECK(!mp4::SampleSizes::parse(ref_of(full_box("stsz", 0, 0, {be(0, 4)}))).has_value());
+}
+
+void test_sample_tables() {
+    Bytes co64 = full_box("co64", 0, 0, {be(2, 4), be(0x123456789ULL, 8), be(42, 8)});
+    auto offsets = mp4::ChunkOffsets::parse(ref_of(co64));
+    CHECK(offsets.has_value());
+    CHECK_EQ(offsets->count(), uint32_t(2));
+    CHECK_EQ(offsets->offset(0), uint64_t(0x123456789ULL));
+    CHECK_EQ(offsets->offset(1), uint64_t(42));
+
+    Bytes stsc = full_box("stsc", 0, 0, {be(2, 4), be(1, 4), be(10, 4), be(1, 4), be(5, 4), be(3, 4), be(1, 4)});
+    auto runs = mp4::SampleToChunk::parse(ref_of(stsc));
+    CHECK(runs.has_value());
+    CHECK_EQ(runs->count(), uint32_t(2));
+    CHECK_EQ(runs->entry(1).first_chunk, uint32_t(5));
+    CHECK_EQ(runs->entry(1).samples_per_chunk, uint32_t(3));
+
+    Bytes stts = full_box("stts", 0, 0, {be(2, 4), be(100, 4), be(1001, 4), be(1, 4), be(500, 4)});
+    auto times = mp4::TimeToSample::parse(ref_of(stts));
+    CHECK(times.has_value());
+    CHECK_EQ(times->total_duration(), uint64_t(100 * 1001 + 500));
+
+    // Version 1 offsets are signed, version 0 ones are not
+    Bytes ctts = full_box("ctts", 1, 0, {be(1, 4), be(2, 4), be(0xfffffc18u, 4)});
+    auto composition = mp4::CompositionOffsets::parse(ref_of(ctts));
+    CHECK(composition.has_value());
+    CHECK_EQ(composition->entry(0).sample_count, uint32_t(2));
+    CHECK_EQ(composition->entry(0).offset, int64_t(-1000));
+    Bytes ctts_v0 = full_box("ctts", 0, 0, {be(1, 4), be(2, 4), be(0xfffffc18u, 4)});
+    CHECK_EQ(mp4::CompositionOffsets::parse(ref_of(ctts_v0))->entry(0).offset, int64_t(0xfffffc18u));
+
+    Bytes stss = full_box("stss", 0, 0, {be(4, 4), be(1, 4), be(31, 4), be(61, 4), be(91, 4)});
+    auto sync = mp4::SyncSamples::parse(ref_of(stss));
+    CHECK(sync.has_value());
+    CHECK_EQ(sync->at_or_before(1), uint32_t(1));
+    CHECK_EQ(sync->at_or_before(30), uint32_t(1));
+    CHECK_EQ(sync->at_or_before(31), uint32_t(31));
+    CHECK_EQ(sync->at_or_before(1000), uint32_t(91));
+    CHECK_EQ(sync->at_or_before(0), uint32_t(0));
+    CHECK(sync->is_sync(61));
+    CHECK(!sync->is_sync(62));
+
+    // Wrong box types are not taken for tables
+    CHECK(!mp4::SyncSamples::parse(ref_of(stts)).has_value());
+    CHECK(!mp4::ChunkOffsets::parse(ref_of(stss)).has_value());
+}
+
+void test_of_track() {
+    Bytes stbl = box("stbl", {full_box("stsz", 0, 0, {be(0, 4), be(2, 4), be(10, 4), be(20, 4)}),
+                              full_box("stco", 0, 0, {be(1, 4), be(4096, 4)}),
+                              full_box("stsc", 0, 0, {be(1, 4), be(1, 4), be(2, 4), be(1, 4)}),
+                              full_box("stts", 0, 0, {be(1, 4), be(2, 4), be(512, 4)})});
+    Bytes track = trak(tkhd(0, 1, 640, 360), 12800, "vide", {box("minf", {stbl})});
+
+    auto tables = mp4::SampleTables::of_track(ref_of(track));
+    CHECK(tables.has_value());
+    CHECK(tables->sizes.has_value());
+    CHECK(tables->chunk_offsets.has_value());
+    CHECK(tables->sample_to_chunk.has_value());
+    CHECK(tables->time_to_sample.has_value());
+    CHECK(!tables->composition_offsets.has_value());
+    CHECK(!tables->sync_samples.has_value());
+    CHECK_EQ(tables->sizes->size(1), uint32_t(20));
+    CHECK_EQ(tables->chunk_offsets->offset(0), uint64_t(4096));
+    CHECK_EQ(tables->time_to_sample->total_duration(), uint64_t(1024));
+
+    CHECK(!mp4::SampleTables::of_track(ref_of(box("trak", {tkhd(0, 1, 0, 0)}))).has_value());
+}
+
+// Resident size of the mapping that contains address, from /proc/self/smaps
+int64_t resident_kb(const void* address) {
+    std::ifstream smaps("/proc/self/smaps");
+    std::string line;
+    bool inside = false;
+    auto at = reinterpret_cast<uintptr_t>(address);
+    while (std::getline(smaps, line)) {
+        unsigned long long start = 0;
+        unsigned long long end = 0;
+        if (std::sscanf(line.c_str(), "%llx-%llx ", &start, &end) == 2) {
+            inside = at >= start && at < end;
+            continue;
+        }
+        long long kb = 0;
+        if (inside && std::sscanf(line.c_str(), "Rss: %lld kB", &kb) == 1) {
+            return kb;
+        }
+    }
+    return -1;
+}
+
+// A 100 GB file whose moov (with 4M-entry sample tables) sits behind a
+// sparse mdat: looking up samples maps in a few pages, not the tables
+void test_large_file_stays_small(const TempDir& dir) {
+    constexpr uint64_t kMdatSize = 100ULL << 30;
+    constexpr uint32_t kSamples = 4 << 20;
+
+    fs::path file = dir / "large.mp4";
+    Bytes head = cat({box("ftyp", {be(fourcc("isom"), 4), be(0, 4)}),
+                      be(1, 4), be(fourcc("mdat"), 4), be(kMdatSize, 8)});
+    Bytes stsz_header = cat({be(8 + 12 + uint64_t(kSamples) * 4, 4), be(fourcc("stsz"), 4),
+                             be(0, 4), be(0, 4), be(kSamples, 4)});
+    Bytes sizes(uint64_t(kSamples) * 4);
+    for (uint32_t i = 0; i < kSamples; ++i) {
+        mp4::write_be(sizes.data() + uint64_t(i) * 4, 4, 1000 + (i % 500));
+    }
+    Bytes stbl_header = cat({be(8 + stsz_header.size() + sizes.size(), 4), be(fourcc("stbl"), 4)});
+    Bytes minf_header = cat({be(8 + stbl_header.size() + stsz_header.size() + sizes.size(), 4), be(fourcc("minf"), 4)});
+    uint64_t minf_size = minf_header.size() + stbl_header.size() + stsz_header.size() + sizes.size();
+    Bytes media_header = cat({mdhd(90000), hdlr("vide")});
+    Bytes mdia_header = cat({be(8 + media_header.size() + minf_size, 4), be(fourcc("mdia"), 4)});
+    Bytes track_header = tkhd(0, 1, 1920, 1080);
+    uint64_t mdia_size = mdia_header.size() + media_header.size() + minf_size;
+    Bytes trak_header = cat({be(8 + track_header.size() + mdia_size, 4), be(fourcc("trak"), 4)});
+    Bytes moov_header = cat({be(8 + trak_header.size() + track_header.size() + mdia_size, 4), be(fourcc("moov"), 4)});
+    Bytes moov = cat({moov_header, trak_header, track_header, mdia_header, media_header, minf_header,
+                      stbl_header, stsz_header, sizes});
+
+    {
+        ScopedFd fd(::open(file.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644));
+        off_t moov_offset = static_cast<off_t>(head.size() - 16 + kMdatSize);
+        if (!fd || ::pwrite(fd.get(), head.data(), head.size(), 0) != static_cast<ssize_t>(head.size()) ||
+            ::pwrite(fd.get(), moov.data(), moov.size(), moov_offset) != static_cast<ssize_t>(moov.size())) {
+            std::fprintf(stderr, "skipping the 100 GB file check: no sparse file support here\n");
+            return;
+        }
+        // Out of the page cache, so what becomes resident is what the reader faults in
+        ::fdatasync(fd.get());
+        ::posix_fadvise(fd.get(), 0, 0, POSIX_FADV_DONTNEED);
+    }
+
+    mp4::Reader reader(file);
+    CHECK(static_cast<bool>(reader));
+    CHECK(reader.size() > kMdatSize);
+    int64_t before = resident_kb(reader.data());
+
+    auto movie = reader.find(fourcc("moov"));
+    CHECK(movie.has_value());
+    auto track = movie ? movie->child(fourcc("trak")) : std::nullopt;
+    auto tables = track ? mp4::SampleTables::of_track(*track) : std::nullopt;
+    CHECK(tables && tables->sizes);
+    if (tables && tables->sizes) {
+        CHECK_EQ(tables->sizes->count(), kSamples);
+        CHECK_EQ(tables->sizes->size(0), uint32_t(1000));
+        CHECK_EQ(tables->sizes->size(kSamples / 2 + 7), uint32_t(1000 + (kSamples / 2 + 7) % 500));
+        CHECK_EQ(tables->sizes->size(kSamples - 1), uint32_t(1000 + (kSamples - 1) % 500));
+    }
+
+    // The 16 MB table and 100 GB of media stay out of memory
+    int64_t after = resident_kb(reader.data());
+    CHECK(before >= 0 && after >= 0);
+    CHECK(after < 1024);
+}
+
+} // namespace
+
+int main() {
+    TempDir dir("mp4-reader");
+    test_box_iteration(dir);
+    test_reader_errors(dir);
+    test_table_view_clamps();
+    test_sample_sizes();
+    test_sample_tables();
+    test_of_track();
+    test_large_file_stays_small(dir);
+    return test::result();
+}
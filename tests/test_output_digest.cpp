@@ -0,0 +1,220 @@
+#include "output_digest.hpp"
+#include "test_support.hpp"
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+using namespace trimora;
+using namespace trimora::test;
+
+namespace {
+
+Bytes text(const std::string& value) {
+    return Bytes(value.begin(), value.end());
+}
+
+// data[i] = (i * 31 + 7) & 0xff, the input of the XXH3 reference values
+Bytes pattern(size_t size) {
+    Bytes out(size);
+    for (size_t i = 0; i < size; ++i) {
+        out[i] = static_cast<uint8_t>(i * 31 + 7);
+    }
+    return out;
+}
+
+std::string sha256_of(const Bytes& data, size_t chunk) {
+    Sha256 hasher;
+    for (size_t at = 0; at < data.size(); at += chunk) {
+        hasher.update(data.data() + at, std::min(chunk, data.size() - at));
+    }
+    return hasher.hex_digest();
+}
+
+std::string xxh3_of(const Bytes& data, size_t chunk) {
+    Xxh3 hasher;
+    for (size_t at = 0; at < data.size(); at += chunk) {
+        hasher.update(data.data() + at, std::min(chunk, data.size() - at));
+    }
+    return hasher.hex_digest();
+}
+
+void test_sha256() {
+    // FIPS 180-4 examples
+    CHECK_EQ(sha256_of({}, 1), std::string("e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"));
+    CHECK_EQ(sha256_of(text("abc"), 3), std::string("ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"));
+    const std::string two_blocks = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+    for (size_t chunk : {size_t(1), size_t(55), size_t(56), size_t(64)}) {
+        CHECK_EQ(sha256_of(text(two_blocks), chunk),
+                 std::string("248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1"));
+    }
+    Bytes million(1000000, 'a');
+    for (size_t chunk : {size_t(63), size_t(4096), million.size()}) {
+        CHECK_EQ(sha256_of(million, chunk),
+                 std::string("cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0"));
+    }
+}
+
+void test_xxh3() {
+    // From the reference implementation (xxhsum -H3), covering each length
+    // class: empty, 1-3, 4-8, 9-16, 17-128, 129-240 and the striped path
+    const std::pair<size_t, const char*> expected[] = {
+        {0, "2d06800538d394c2"},    {1, "4c5cca45d0f4811f"},    {3, "15f7093b173d005c"},
+        {4, "dca012f95811b6b9"},    {8, "dec6a9a43575982e"},    {9, "cbe393399f17ffbd"},
+        {16, "7e484c18d74895d0"},   {17, "208bde5ee2bed407"},   {128, "f92b70eaa21a6288"},
+        {129, "f8f76713f2bb60fa"},  {240, "ccc7375172c41f03"},  {241, "0b3b630948ce4a00"},
+        {1024, "23bc880ebf0d29c6"}, {5000, "559fff92c2b7f8ee"},
+    };
+    for (const auto& [size, hex] : expected) {
+        Bytes data = pattern(size);
+        CHECK_EQ(xxh3_of(data, std::max<size_t>(size, 1)), std::string(hex));
+        // Split across stripe, block and buffer boundaries
+        for (size_t chunk : {size_t(1), size_t(7), size_t(64), size_t(100), size_t(255), size_t(1024)}) {
+            CHECK_EQ(xxh3_of(data, chunk), std::string(hex));
+        }
+    }
+
+    // hex_digest doesn't finalize; hashing can go on
+    Bytes data = pattern(1024);
+    Xxh3 hasher;
+    hasher.update(data.data(), 512);
+    CHECK_EQ(hasher.hex_digest(), xxh3_of(pattern(512), 512));
+    hasher.update(data.data() + 512, 512);
+    CHECK_EQ(hasher.hex_digest(), std::string("23bc880ebf0d29c6"));
+}
+
+void test_parse_digest_list() {
+    std::string error;
+    auto algorithms = parse_digest_list("SHA256, xxh3 sha-256", error);
+    CHECK((algorithms == std::vector<DigestAlgorithm>{DigestAlgorithm::Sha256, DigestAlgorithm::Xxh3}));
+    CHECK(error.empty());
+
+    algorithms = parse_digest_list("md5,xxh3-64,,crc32", error);
+    CHECK((algorithms == std::vector<DigestAlgorithm>{DigestAlgorithm::Xxh3}));
+    CHECK_EQ(error, std::string("Unknown digest: md5, crc32"));
+
+    error.clear();
+    CHECK(parse_digest_list("  ", error).empty());
+    CHECK(error.empty());
+
+    CHECK_EQ(std::string(digest_name(DigestAlgorithm::Sha256)), std::string("sha256"));
+    CHECK_EQ(std::string(digest_name(DigestAlgorithm::Xxh3)), std::string("xxh3"));
+}
+
+const std::vector<DigestAlgorithm> kBoth = {DigestAlgorithm::Sha256, DigestAlgorithm::Xxh3};
+
+void check_digests(const std::vector<OutputDigest>& digests, const Bytes& data) {
+    CHECK_EQ(digests.size(), size_t(2));
+    if (digests.size() == 2) {
+        CHECK(digests[0].algorithm == DigestAlgorithm::Sha256);
+        CHECK_EQ(digests[0].hex, sha256_of(data, data.size()));
+        CHECK(digests[1].algorithm == DigestAlgorithm::Xxh3);
+        CHECK_EQ(digests[1].hex, xxh3_of(data, data.size()));
+    }
+}
+
+void append(const fs::path& file, const Bytes& data, size_t offset, size_t size) {
+    std::ofstream out(file, std::ios::binary | std::ios::app);
+    out.write(reinterpret_cast<const char*>(data.data() + offset), static_cast<std::streamsize>(size));
+}
+
+void test_digester(const TempDir& dir) {
+    CHECK(OutputDigester::is_append_only("clip.ts"));
+    CHECK(OutputDigester::is_append_only("clip.M2TS"));
+    CHECK(OutputDigester::is_append_only("clip.mts"));
+    CHECK(!OutputDigester::is_append_only("clip.mp4"));
+    CHECK(!OutputDigester::is_append_only("clip.mkv"));
+
+    Bytes data = pattern(3 * 1024 * 1024 + 17);
+    std::vector<OutputDigest> digests;
+    std::string error;
+
+    // Followed while a writer appends, from before the file exists
+    {
+        fs::path file = dir / "followed.ts";
+        OutputDigester digester(file, kBoth, true);
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        for (size_t at = 0; at < data.size(); at += 512 * 1024) {
+            append(file, data, at, std::min<size_t>(512 * 1024, data.size() - at));
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        CHECK(digester.finish(digests, error));
+        check_digests(digests, data);
+    }
+
+    // Rewritten from the start behind the follower: hashed again in full
+    {
+        fs::path file = dir / "rewritten.ts";
+        OutputDigester digester(file, kBoth, true);
+        append(file, data, 0, 1024 * 1024);
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        Bytes other = data;
+        other[0] ^= 0xff;
+        write_file(file, other);
+        CHECK(digester.finish(digests, error));
+        check_digests(digests, other);
+    }
+
+    // Not followed: hashed in finish, after the header was patched
+    {
+        fs::path file = dir / "patched.mp4";
+        OutputDigester digester(file, kBoth, false);
+        write_file(file, data);
+        Bytes patched = data;
+        std::memset(patched.data(), 0, 64);
+        write_file(file, patched);
+        CHECK(digester.finish(digests, error));
+        check_digests(digests, patched);
+    }
+
+    // Only the algorithms asked for, in the order asked
+    {
+        fs::path file = dir / "one.mp4";
+        write_file(file, text("abc"));
+        OutputDigester digester(file, {DigestAlgorithm::Xxh3}, false);
+        CHECK(digester.finish(digests, error));
+        CHECK_EQ(digests.size(), size_t(1));
+        CHECK(!digests.empty() && digests[0].algorithm == DigestAlgorithm::Xxh3);
+    }
+
+    {
+        OutputDigester digester(dir / "never_written.ts", kBoth, true);
+        CHECK(!digester.finish(digests, error));
+        CHECK(error.find("Cannot read") == 0);
+    }
+}
+
+void test_sidecars(const TempDir& dir) {
+    fs::path file = dir / "clip.mp4";
+    write_file(file, text("abc"));
+    std::vector<OutputDigest> digests = {
+        {DigestAlgorithm::Sha256, sha256_of(text("abc"), 3)},
+        {DigestAlgorithm::Xxh3, xxh3_of(text("abc"), 3)},
+    };
+    std::string error;
+    CHECK(OutputDigester::write_sidecars(file, digests, error));
+
+    // sha256sum and xxhsum --check formats
+    auto sidecar = [&](const char* extension) {
+        Bytes bytes = read_file(dir / ("clip.mp4." + std::string(extension)));
+        return std::string(bytes.begin(), bytes.end());
+    };
+    CHECK_EQ(sidecar("sha256"), digests[0].hex + "  clip.mp4\n");
+    CHECK_EQ(sidecar("xxh3"), "XXH3_" + digests[1].hex + "  clip.mp4\n");
+
+    CHECK(!OutputDigester::write_sidecars(dir / "no_such_dir" / "clip.mp4", digests, error));
+    CHECK(error.find("Failed writing") == 0);
+}
+
+} // namespace
+
+int main() {
+    TempDir dir("output-digest");
+    test_sha256();
+    test_xxh3();
+    test_parse_digest_list();
+    test_digester(dir);
+    test_sidecars(dir);
+    return test::result();
+}
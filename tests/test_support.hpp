@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <initializer_list>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <unistd.h>
+
+// Minimal checks for the unit tests: a failed check prints its location
+// and the test keeps going; main returns test::result() so ctest sees the
+// failure.
+
+namespace trimora {
+namespace test {
+
+inline int& failures() {
+    static int count = 0;
+    return count;
+}
+
+inline void fail(const char* file, int line, const std::string& what) {
+    std::fprintf(stderr, "%s:%d: FAILED %s\n", file, line, what.c_str());
+    ++failures();
+}
+
+template <typename A, typename B>
+void check_eq(const A& actual, const B& expected, const char* text, const char* file, int line) {
+    if (!(actual == expected)) {
+        std::ostringstream what;
+        what << text << " (got " << actual << ", expected " << expected << ")";
+        fail(file, line, what.str());
+    }
+}
+
+inline int result() {
+    if (failures() > 0) {
+        std::fprintf(stderr, "%d check(s) failed\n", failures());
+        return 1;
+    }
+    return 0;
+}
+
+// A fresh directory under the system temp directory, removed with its
+// contents on destruction
+class TempDir {
+public:
+    explicit TempDir(const std::string& name)
+        : path_(std::filesystem::temp_directory_path() /
+                ("trimora-" + name + "-" + std::to_string(::getpid()))) {
+        std::filesystem::remove_all(path_);
+        std::filesystem::create_directories(path_);
+    }
+    ~TempDir() {
+        std::error_code ec;
+        std::filesystem::remove_all(path_, ec);
+    }
+
+    TempDir(const TempDir&) = delete;
+    TempDir& operator=(const TempDir&) = delete;
+
+    const std::filesystem::path& path() const { return path_; }
+    std::filesystem::path operator/(const std::string& name) const { return path_ / name; }
+
+private:
+    std::filesystem::path path_;
+};
+
+inline void write_file(const std::filesystem::path& path, const std::vector<uint8_t>& bytes) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+}
+
+inline std::vector<uint8_t> read_file(const std::filesystem::path& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+using Bytes = std::vector<uint8_t>;
+
+inline Bytes cat(std::initializer_list<Bytes> parts) {
+    Bytes out;
+    for (const auto& part : parts) {
+        out.insert(out.end(), part.begin(), part.end());
+    }
+    return out;
+}
+
+// Bytes [offset, offset + length) of a buffer, as a new one
+inline Bytes slice(const Bytes& bytes, uint64_t offset, uint64_t length) {
+    return Bytes(bytes.begin() + static_cast<std::ptrdiff_t>(offset),
+                 bytes.begin() + static_cast<std::ptrdiff_t>(offset + length));
+}
+
+} // namespace test
+} // namespace trimora
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            ::trimora::test::fail(__FILE__, __LINE__, #condition); \
+        } \
+    } while (0)
+
+#define CHECK_EQ(actual, expected) \
+    ::trimora::test::check_eq((actual), (expected), #actual " == " #expected, __FILE__, __LINE__)
@@ -0,0 +1,141 @@
+#include "timebase.hpp"
+#include "test_support.hpp"
+#include <cstdint>
+
+using namespace trimora;
+
+namespace {
+
+void test_rational() {
+    // Always reduced, denominator positive
+    Rational half(3, 6);
+    CHECK_EQ(half.num, int64_t(1));
+    CHECK_EQ(half.den, int64_t(2));
+    Rational negative(1, -3);
+    CHECK_EQ(negative.num, int64_t(-1));
+    CHECK_EQ(negative.den, int64_t(3));
+
+    CHECK(Rational(1, 3) + Rational(1, 6) == Rational(1, 2));
+    CHECK(Rational(1, 3) - Rational(1, 2) == Rational(-1, 6));
+    CHECK(Rational(30000, 1001) * Rational(1001, 30000) == Rational(1));
+    CHECK(Rational(1, 25) / Rational(1, 50) == Rational(2));
+    CHECK(Rational(1001, 30000) < Rational(1, 29));
+    CHECK(Rational(-1, 2) < Rational(0));
+
+    // Comparison can't overflow on large terms
+    CHECK(Rational(INT64_MAX / 2, 3) < Rational(INT64_MAX / 2, 2));
+
+    CHECK(Rational::parse("30000/1001") == Rational(30000, 1001));
+    CHECK(Rational::parse("48000") == Rational(48000));
+    CHECK(Rational::parse("29.97") == Rational(2997, 100));
+    CHECK(!Rational::parse("0/0"));
+    CHECK(!Rational::parse("0"));
+    CHECK(!Rational::parse("abc"));
+    CHECK(!Rational::parse("25/0"));
+}
+
+void test_rounding() {
+    CHECK_EQ(mul_div(7, 1, 2, Rounding::Down), int64_t(3));
+    CHECK_EQ(mul_div(7, 1, 2, Rounding::Nearest), int64_t(4));
+    CHECK_EQ(mul_div(7, 1, 2, Rounding::Up), int64_t(4));
+    CHECK_EQ(mul_div(5, 1, 3, Rounding::Nearest), int64_t(2));
+    CHECK_EQ(mul_div(4, 1, 3, Rounding::Nearest), int64_t(1));
+
+    // Down and Up are floor and ceiling; Nearest rounds halves away from zero
+    CHECK_EQ(mul_div(-7, 1, 2, Rounding::Down), int64_t(-4));
+    CHECK_EQ(mul_div(-7, 1, 2, Rounding::Up), int64_t(-3));
+    CHECK_EQ(mul_div(-7, 1, 2, Rounding::Nearest), int64_t(-4));
+
+    // The intermediate product needs more than 64 bits
+    CHECK_EQ(mul_div(INT64_MAX, 1000, 1000, Rounding::Down), INT64_MAX);
+    CHECK_EQ(mul_div(int64_t(1) << 62, 6, 8, Rounding::Down), int64_t(3) << 60);
+
+    // One NTSC frame is 3003 ticks of 90 kHz
+    CHECK_EQ(to_units(Rational(1001, 30000), Rational(1, 90000), Rounding::Nearest), int64_t(3003));
+    // Frames in an hour of 29.97 fps: 107892.1...
+    CHECK_EQ(to_units(Rational(3600), Rational(1001, 30000), Rounding::Down), int64_t(107892));
+    CHECK_EQ(to_units(Rational(3600), Rational(1001, 30000), Rounding::Up), int64_t(107893));
+}
+
+void test_timecodes() {
+    CHECK(parse_timecode("90") == Rational(90));
+    CHECK(parse_timecode("1:30") == Rational(90));
+    CHECK(parse_timecode("01:02:03.5") == Rational(7447, 2));
+    CHECK(parse_timecode(" 0.25 ") == Rational(1, 4));
+    CHECK(parse_timecode(".5") == Rational(1, 2));
+
+    // Taken exactly, up to nanoseconds; finer digits round
+    CHECK(parse_timecode("0.1") == Rational(1, 10));
+    CHECK(parse_timecode("1.0000000004") == Rational(1));
+    CHECK(parse_timecode("1.0000000005") == Rational(1000000001, 1000000000));
+
+    CHECK(!parse_timecode(""));
+    CHECK(!parse_timecode("-1"));
+    CHECK(!parse_timecode("1:2:3:4"));
+    CHECK(!parse_timecode("1:xx"));
+    CHECK(!parse_timecode("12abc"));
+
+    CHECK_EQ(format_seconds(Rational(1, 3)), std::string("0.333333"));
+    CHECK_EQ(format_seconds(Rational(2, 3)), std::string("0.666667"));
+    CHECK_EQ(format_seconds(Rational(2, 3), Rounding::Down), std::string("0.666666"));
+    CHECK_EQ(format_seconds(Rational(1, 3), Rounding::Up), std::string("0.333334"));
+    CHECK_EQ(format_seconds(Rational(-3, 2)), std::string("-1.500000"));
+    CHECK_EQ(format_seconds(Rational(3600)), std::string("3600.000000"));
+}
+
+void test_cut_grid() {
+    CutGrid ntsc;
+    ntsc.frame_rate = Rational(30000, 1001);
+
+    // Snapping is exact: frame 107892 of an NTSC stream, not a sum of doubles
+    Rational frame(1001, 30000);
+    CHECK(ntsc.snap(Rational(3600)) == Rational(107892) * frame);
+    CHECK(ntsc.snap(Rational(1, 100)) == Rational(0));
+    CHECK(ntsc.snap(Rational(1, 50)) == frame);
+
+    // Half a frame early, never before the first frame
+    CHECK(ntsc.cut_before(frame * Rational(10)) == frame * Rational(19, 2));
+    CHECK(ntsc.cut_before(Rational(0)) == Rational(0));
+
+    // Snapping on a grid that starts late
+    CutGrid offset;
+    offset.frame_rate = Rational(25);
+    offset.origin = Rational(1, 5);
+    CHECK(offset.snap(Rational(1)) == Rational(1));
+    CHECK(offset.snap(Rational(101, 100)) == Rational(1));
+    CHECK(offset.snap(Rational(103, 100)) == Rational(26, 25));
+    CHECK(offset.snap(Rational(0)) == Rational(1, 5) - Rational(5) * Rational(1, 25));
+    CHECK(offset.cut_before(Rational(1, 5)) == Rational(1, 5));
+    CHECK(offset.cut_before(Rational(24, 100)) == Rational(22, 100));
+
+    // Ties go to the later frame, as with Rounding::Nearest
+    CHECK(offset.snap(Rational(22, 100)) == Rational(24, 100));
+
+    // No frame rate: times stay as typed
+    CutGrid none;
+    CHECK(!none.has_frames());
+    CHECK(none.snap(Rational(1234, 1000)) == Rational(1234, 1000));
+    CHECK(none.cut_before(Rational(1234, 1000)) == Rational(1234, 1000));
+
+    // A thousand cuts of an hour at 23.976 don't drift: each is on a frame
+    CutGrid film;
+    film.frame_rate = Rational(24000, 1001);
+    Rational period(1001, 24000);
+    for (int64_t second = 0; second < 3600; second += 3) {
+        Rational snapped = film.snap(Rational(second));
+        Rational frames = snapped / period;
+        CHECK_EQ(frames.den, int64_t(1));
+        CHECK(snapped - Rational(second) <= period / Rational(2));
+        CHECK(Rational(second) - snapped <= period / Rational(2));
+    }
+}
+
+} // namespace
+
+int main() {
+    test_rational();
+    test_rounding();
+    test_timecodes();
+    test_cut_grid();
+    return test::result();
+}
@@ -0,0 +1,128 @@
+#include "ts_cutter.hpp"
+#include "ts_fixture.hpp"
+
+namespace fs = std::filesystem;
+
+using namespace trimora;
+using namespace trimora::test;
+
+namespace {
+
+void test_detection(const TempDir& dir) {
+    Bytes ts = transport_stream(0);
+    write_file(dir / "a.ts", ts);
+    CHECK(TsCutter::is_transport_stream(dir / "a.ts"));
+    write_file(dir / "a.m2ts", to_m2ts(ts));
+    CHECK(TsCutter::is_transport_stream(dir / "a.m2ts"));
+
+    // Leading garbage is skipped to the first aligned packet
+    write_file(dir / "offset.ts", cat({Bytes(5, 0x00), ts}));
+    CHECK(TsCutter::is_transport_stream(dir / "offset.ts"));
+
+    // Too short to see eight sync bytes, or not packetised at all
+    write_file(dir / "short.ts", slice(ts, 0, 6 * kPacket));
+    CHECK(!TsCutter::is_transport_stream(dir / "short.ts"));
+    write_file(dir / "noise.ts", Bytes(ts.size(), 0x47 ^ 0xff));
+    CHECK(!TsCutter::is_transport_stream(dir / "noise.ts"));
+    CHECK(!TsCutter::is_transport_stream(dir / "missing.ts"));
+}
+
+void check_plan(const fs::path& input, const Bytes& bytes, size_t packet_size) {
+    // 3.0 s falls on frame 6; the random access point before it is frame 4.
+    // The range runs up to the packet after the last frame before 6.0 s.
+    auto plan = TsCutter::plan(input, 3.0, 6.0);
+    CHECK(plan.ok);
+    CHECK_EQ(plan.range_offset, frame_packet(4) * packet_size);
+    CHECK_EQ(plan.range_length, (frame_packet(11) + 1 - frame_packet(4)) * packet_size);
+    CHECK_EQ(plan.start_seconds, 2.0);
+    CHECK_EQ(plan.end_seconds, 6.0);
+
+    // A keyframe found from its NAL unit serves as well as a flagged one
+    auto idr = TsCutter::plan(input, 5.0, 0.0);
+    CHECK(idr.ok);
+    CHECK_EQ(idr.range_offset, frame_packet(8) * packet_size);
+    CHECK_EQ(idr.range_offset + idr.range_length, uint64_t(bytes.size()));
+    CHECK_EQ(idr.start_seconds, 4.0);
+    CHECK_EQ(idr.end_seconds, 0.0);
+
+    // PAT and PMT go first; padding is whole null packets
+    CHECK_EQ(plan.min_prefix_size, uint64_t(2 * packet_size));
+    Bytes prefix = plan.build_prefix(plan.min_prefix_size);
+    size_t sync = packet_size - kPacket;
+    for (size_t at = 0; at < prefix.size(); at += packet_size) {
+        CHECK(slice(prefix, at + sync, kPacket) == slice(bytes, at + sync, kPacket));
+    }
+    CHECK(plan.build_prefix(plan.min_prefix_size + 4).empty());
+    CHECK(plan.build_prefix(packet_size).empty());
+    Bytes padded = plan.build_prefix(4 * packet_size);
+    CHECK_EQ(padded.size(), 4 * packet_size);
+    for (size_t at = 2 * packet_size; at < padded.size(); at += packet_size) {
+        CHECK(padded[at + sync] == 0x47 && padded[at + sync + 1] == 0x1f && padded[at + sync + 2] == 0xff);
+    }
+
+    auto result = plan.copy_to(input.parent_path() / ("cut" + input.extension().string()), {});
+    CHECK(result.ok);
+    Bytes output = read_file(input.parent_path() / ("cut" + input.extension().string()));
+    CHECK(output == cat({prefix, slice(bytes, plan.range_offset, plan.range_length)}));
+}
+
+void test_plan(const TempDir& dir) {
+    Bytes ts = transport_stream(900000);
+    write_file(dir / "plan.ts", ts);
+    check_plan(dir / "plan.ts", ts, kPacket);
+}
+
+void test_m2ts(const TempDir& dir) {
+    Bytes m2ts = to_m2ts(transport_stream(900000));
+    write_file(dir / "plan.m2ts", m2ts);
+    check_plan(dir / "plan.m2ts", m2ts, kM2tsPacket);
+
+    // Tables and padding take the arrival stamp of the first kept packet,
+    // so stamps stay monotonic
+    auto plan = TsCutter::plan(dir / "plan.m2ts", 3.0, 6.0);
+    Bytes stamp = slice(m2ts, plan.range_offset, 4);
+    Bytes prefix = plan.build_prefix(3 * kM2tsPacket);
+    for (size_t at = 0; at < prefix.size(); at += kM2tsPacket) {
+        CHECK(slice(prefix, at, 4) == stamp);
+    }
+}
+
+void test_pts_wrap(const TempDir& dir) {
+    // The 33-bit clock wraps 1.5 s in; times stay relative to the first frame
+    Bytes ts = transport_stream(kPtsWrap - 3 * kFrameTicks);
+    write_file(dir / "wrap.ts", ts);
+    auto plan = TsCutter::plan(dir / "wrap.ts", 3.0, 6.0);
+    CHECK(plan.ok);
+    CHECK_EQ(plan.range_offset, frame_packet(4) * kPacket);
+    CHECK_EQ(plan.start_seconds, 2.0);
+    CHECK_EQ(plan.end_seconds, 6.0);
+}
+
+void test_rejected_inputs(const TempDir& dir) {
+    write_file(dir / "text.ts", Bytes(4096, 'x'));
+    auto plan = TsCutter::plan(dir / "text.ts", 1.0, 0.0);
+    CHECK(!plan.ok);
+    CHECK_EQ(plan.error_message, std::string("Not an MPEG-TS file"));
+
+    // Only an audio stream (ADTS) in the PMT: nothing to cut on
+    write_file(dir / "audio.ts", transport_stream(0, 0x0f));
+    plan = TsCutter::plan(dir / "audio.ts", 1.0, 0.0);
+    CHECK(!plan.ok);
+    CHECK(plan.error_message.find("No PAT/PMT") == 0);
+
+    plan = TsCutter::plan(dir / "missing.ts", 1.0, 0.0);
+    CHECK(!plan.ok);
+    CHECK(!plan.copy_to(dir / "out.ts", {}).ok);
+}
+
+} // namespace
+
+int main() {
+    TempDir dir("ts-cutter");
+    test_detection(dir);
+    test_plan(dir);
+    test_m2ts(dir);
+    test_pts_wrap(dir);
+    test_rejected_inputs(dir);
+    return test::result();
+}
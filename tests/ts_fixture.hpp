@@ -0,0 +1,98 @@
+#pragma once
+
+#include "test_support.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+// A synthetic H.264 transport stream for the MPEG-TS tests: PAT, PMT, then
+// video frames with PES timestamps. Only the fields the code under test
+// reads are meaningful.
+
+namespace trimora {
+namespace test {
+
+constexpr size_t kPacket = 188;
+constexpr size_t kM2tsPacket = 192;
+constexpr uint16_t kPmtPid = 0x100;
+constexpr uint16_t kVideoPid = 0x101;
+constexpr uint16_t kAudioPid = 0x102;
+constexpr uint64_t kFrameTicks = 45000;  // Half a second of the 90 kHz clock
+constexpr uint64_t kPtsWrap = 1ULL << 33;
+constexpr size_t kFrames = 20;
+constexpr size_t kHeaderPackets = 2;
+constexpr size_t kPacketsPerFrame = 3;   // PES start, continuation, audio
+
+// One packet: header, optional adaptation field, payload, 0xff stuffing
+inline Bytes packet(uint16_t pid, bool unit_start, bool random_access, const Bytes& payload) {
+    Bytes out(kPacket, 0xff);
+    out[0] = 0x47;
+    out[1] = static_cast<uint8_t>((unit_start ? 0x40 : 0x00) | (pid >> 8));
+    out[2] = static_cast<uint8_t>(pid & 0xff);
+    out[3] = random_access ? 0x30 : 0x10;
+    size_t at = 4;
+    if (random_access) {
+        out[at++] = 0x01;
+        out[at++] = 0x40;
+    }
+    std::copy(payload.begin(), payload.end(), out.begin() + static_cast<std::ptrdiff_t>(at));
+    return out;
+}
+
+inline Bytes pat() {
+    return packet(0, true, false, {0x00,  // Pointer field
+                                   0x00, 0xb0, 13, 0x00, 0x01, 0xc1, 0x00, 0x00,
+                                   0x00, 0x01, 0xe0 | (kPmtPid >> 8), kPmtPid & 0xff,
+                                   0x00, 0x00, 0x00, 0x00});  // CRC, not checked
+}
+
+inline Bytes pmt(uint8_t stream_type) {
+    return packet(kPmtPid, true, false, {0x00,
+                                         0x02, 0xb0, 18, 0x00, 0x01, 0xc1, 0x00, 0x00,
+                                         0xe0 | (kVideoPid >> 8), kVideoPid & 0xff, 0xf0, 0x00,
+                                         stream_type, 0xe0 | (kVideoPid >> 8), kVideoPid & 0xff, 0xf0, 0x00,
+                                         0x00, 0x00, 0x00, 0x00});
+}
+
+// Video PES header with a PTS, then the start of one NAL unit
+inline Bytes pes(uint64_t pts, uint8_t nal_header) {
+    return {0x00, 0x00, 0x01, 0xe0, 0x00, 0x00, 0x80, 0x80, 0x05,
+            static_cast<uint8_t>(0x21 | ((pts >> 29) & 0x0e)),
+            static_cast<uint8_t>(pts >> 22),
+            static_cast<uint8_t>(((pts >> 14) & 0xfe) | 0x01),
+            static_cast<uint8_t>(pts >> 7),
+            static_cast<uint8_t>(((pts << 1) & 0xfe) | 0x01),
+            0x00, 0x00, 0x01, nal_header};
+}
+
+inline uint64_t frame_packet(size_t frame) {
+    return kHeaderPackets + frame * kPacketsPerFrame;
+}
+
+// PAT, PMT, then frames half a second apart from first_pts. Frames 0, 4,
+// 12 and 16 carry the random access flag; frame 8 is only recognisable as
+// a keyframe by its IDR NAL unit.
+inline Bytes transport_stream(uint64_t first_pts, uint8_t stream_type = 0x1b) {
+    Bytes out = cat({pat(), pmt(stream_type)});
+    for (size_t i = 0; i < kFrames; ++i) {
+        uint64_t pts = (first_pts + i * kFrameTicks) % kPtsWrap;
+        bool flagged = i % 4 == 0 && i != 8;
+        uint8_t nal = i == 8 ? 0x65 : 0x41;  // IDR slice, or a plain one
+        out = cat({out, packet(kVideoPid, true, flagged, pes(pts, nal)), packet(kVideoPid, false, false, {}),
+                   packet(kAudioPid, true, false, {})});
+    }
+    return out;
+}
+
+// The same packets with a 4-byte arrival timestamp in front of each
+inline Bytes to_m2ts(const Bytes& ts) {
+    Bytes out;
+    for (size_t at = 0, index = 0; at < ts.size(); at += kPacket, ++index) {
+        Bytes stamp = {0x00, 0x01, static_cast<uint8_t>(index), 0x00};
+        out = cat({out, stamp, slice(ts, at, kPacket)});
+    }
+    return out;
+}
+
+} // namespace test
+} // namespace trimora
@@ -0,0 +1,362 @@
+// Stand-in for the ffmpeg/ffprobe binaries, for load-testing the executor
+// and batch queue without real media or real encodes.
+//
+// Speaks the subset of the CLI Trimora uses: -version, -y, -progress pipe:1,
+// -ss/-to/-t, -i and any number of outputs; ffprobe's format=duration,
+// stream (index, codec, timebase, frame and sample rate) and packet=pts,flags
+// (with -read_intervals) queries when invoked as "ffprobe".
+// Output files are written incrementally so size-based progress works.
+//
+// Behaviour is controlled through the environment, since the executor owns
+// the command line:
+//   FAKE_FFMPEG_SPEED           processing speed, multiple of realtime (20)
+//   FAKE_FFMPEG_DURATION        wall seconds per job, overrides SPEED
+//   FAKE_FFMPEG_PROGRESS_HZ     progress blocks per second (2)
+//   FAKE_FFMPEG_CPU             fraction of one core to keep busy, 0-1 (0)
+//   FAKE_FFMPEG_OUTPUT_BYTES    bytes written per output (1048576)
+//   FAKE_FFMPEG_FAIL_RATE       probability that a job fails, 0-1 (0)
+//   FAKE_FFMPEG_FAIL_AT         progress fraction where failures happen (0.5)
+//   FAKE_FFMPEG_EXIT_CODE       exit code of an injected failure (1)
+//   FAKE_FFMPEG_SEED            varies which jobs fail (0)
+//   FAKE_FFMPEG_INPUT_DURATION  media duration reported for inputs (60)
+//   FAKE_FFMPEG_STREAMS         ffprobe streams, e.g. "video:h264,audio:aac"
+//   FAKE_FFMPEG_FRAME_RATE      video frame rate reported by ffprobe (30000/1001)
+//   FAKE_FFMPEG_GOP             frames from one keyframe to the next (60)
+//
+// Failures are a deterministic function of the first output path and the
+// seed, so a soak run can be replayed exactly.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+std::atomic<int> g_signal{0};
+
+void on_signal(int signal) {
+    g_signal.store(signal);
+}
+
+double env_double(const char* name, double fallback) {
+    const char* value = std::getenv(name);
+    if (!value || !*value) {
+        return fallback;
+    }
+    char* end = nullptr;
+    double parsed = std::strtod(value, &end);
+    return end != value ? parsed : fallback;
+}
+
+std::string env_string(const char* name, const std::string& fallback) {
+    const char* value = std::getenv(name);
+    return (value && *value) ? std::string(value) : fallback;
+}
+
+// HH:MM:SS.mmm, MM:SS or plain seconds
+double parse_time(const std::string& text) {
+    double total = 0.0;
+    std::istringstream parts(text);
+    std::string part;
+    while (std::getline(parts, part, ':')) {
+        total = total * 60.0 + std::atof(part.c_str());
+    }
+    return total;
+}
+
+// Options that never take a value; every other "-x" consumes the next arg
+bool is_flag(const std::string& arg) {
+    static const char* const kFlags[] = {
+        "-y", "-n", "-nostdin", "-hide_banner", "-shortest", "-an", "-vn",
+        "-sn", "-dn", "-copyts", "-stats", "-nostats", "-re", "-version"
+    };
+    return std::find_if(std::begin(kFlags), std::end(kFlags),
+        [&arg](const char* flag) { return arg == flag; }) != std::end(kFlags);
+}
+
+bool is_local_path(const std::string& path) {
+    return path != "-" && path.find(':') == std::string::npos;
+}
+
+uint64_t fnv1a(const std::string& text, uint64_t seed) {
+    uint64_t hash = 1469598103934665603ull ^ seed;
+    for (unsigned char c : text) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+void burn_cpu(std::chrono::steady_clock::duration budget) {
+    auto until = std::chrono::steady_clock::now() + budget;
+    volatile uint64_t sink = 0;
+    while (std::chrono::steady_clock::now() < until) {
+        for (int i = 0; i < 1000; ++i) {
+            sink = sink * 6364136223846793005ull + 1442695040888963407ull;
+        }
+    }
+}
+
+std::string format_out_time(double seconds) {
+    auto us = static_cast<long long>(seconds * 1000000.0);
+    char buffer[64];
+    std::snprintf(buffer, sizeof(buffer), "%02lld:%02lld:%02lld.%06lld",
+        us / 3600000000ll, (us / 60000000ll) % 60, (us / 1000000ll) % 60, us % 1000000ll);
+    return buffer;
+}
+
+int run_ffprobe(const std::vector<std::string>& args) {
+    std::string entries;
+    std::string intervals;
+    std::string input;
+    for (size_t i = 0; i < args.size(); ++i) {
+        if (args[i] == "-show_entries" && i + 1 < args.size()) {
+            entries = args[++i];
+        } else if (args[i] == "-read_intervals" && i + 1 < args.size()) {
+            intervals = args[++i];
+        } else if (!args[i].empty() && args[i][0] == '-') {
+            if (!is_flag(args[i]) && i + 1 < args.size()) {
+                ++i;
+            }
+        } else {
+            input = args[i];
+        }
+    }
+
+    if (input.empty()) {
+        std::fprintf(stderr, "You have to specify one input file.\n");
+        return 1;
+    }
+    if (is_local_path(input) && !fs::exists(input)) {
+        std::fprintf(stderr, "%s: No such file or directory\n", input.c_str());
+        return 1;
+    }
+
+    if (entries.rfind("format=", 0) == 0) {
+        std::printf("%.6f\n", env_double("FAKE_FFMPEG_INPUT_DURATION", 60.0));
+        return 0;
+    }
+
+    if (entries.rfind("stream=", 0) == 0) {
+        std::istringstream streams(env_string("FAKE_FFMPEG_STREAMS", "video:h264,audio:aac"));
+        std::string stream;
+        int index = 0;
+        while (std::getline(streams, stream, ',')) {
+            auto colon = stream.find(':');
+            std::string type = stream.substr(0, colon);
+            std::string codec = colon == std::string::npos ? "unknown" : stream.substr(colon + 1);
+            std::printf("index=%d|codec_name=%s|codec_type=%s", index++, codec.c_str(), type.c_str());
+            if (type == "video") {
+                std::string rate = env_string("FAKE_FFMPEG_FRAME_RATE", "30000/1001");
+                std::printf("|r_frame_rate=%s|avg_frame_rate=%s|time_base=1/90000", rate.c_str(), rate.c_str());
+            } else if (type == "audio") {
+                std::printf("|sample_rate=48000|time_base=1/48000");
+            }
+            std::printf("|start_time=0.000000\n");
+        }
+        return 0;
+    }
+
+    if (entries.rfind("packet=", 0) == 0) {
+        // Every frame of the first video stream in the interval, 90 kHz pts
+        std::string rate_text = env_string("FAKE_FFMPEG_FRAME_RATE", "30000/1001");
+        size_t slash = rate_text.find('/');
+        double rate = std::atof(rate_text.c_str());
+        if (slash != std::string::npos) {
+            rate /= std::atof(rate_text.c_str() + slash + 1);
+        }
+        long long gop = std::max(1LL, static_cast<long long>(env_double("FAKE_FFMPEG_GOP", 60)));
+        size_t percent = intervals.find('%');
+        double from = intervals.empty() ? 0.0 : parse_time(intervals.substr(0, percent));
+        double to = percent == std::string::npos ? env_double("FAKE_FFMPEG_INPUT_DURATION", 60.0)
+                                                 : parse_time(intervals.substr(percent + 1));
+        // Like a real seek, start at the keyframe before the interval
+        auto first = static_cast<long long>(from * rate) / gop * gop;
+        for (long long frame = first; frame / rate <= to; ++frame) {
+            auto pts = static_cast<long long>(std::llround(frame * 90000.0 / rate));
+            std::printf("%lld,%s\n", pts, frame % gop == 0 ? "K__" : "___");
+        }
+        return 0;
+    }
+
+    return 0;
+}
+
+int run_ffmpeg(const std::vector<std::string>& args) {
+    bool overwrite = false;
+    bool progress_to_stdout = false;
+    double start = 0.0;
+    double end = -1.0;
+    double limit = -1.0;
+    std::vector<std::string> inputs;
+    std::vector<std::string> outputs;
+
+    for (size_t i = 0; i < args.size(); ++i) {
+        const std::string& arg = args[i];
+        bool has_value = i + 1 < args.size();
+
+        if (arg == "-version") {
+            std::printf("ffmpeg version trimora-fake Copyright (c) the Trimora developers\n");
+            return 0;
+        } else if (arg == "-y") {
+            overwrite = true;
+        } else if (arg == "-progress" && has_value) {
+            progress_to_stdout = args[++i] == "pipe:1";
+        } else if (arg == "-ss" && has_value) {
+            start = parse_time(args[++i]);
+        } else if (arg == "-to" && has_value) {
+            end = parse_time(args[++i]);
+        } else if (arg == "-t" && has_value) {
+            limit = parse_time(args[++i]);
+        } else if (arg == "-i" && has_value) {
+            inputs.push_back(args[++i]);
+        } else if (!arg.empty() && arg[0] == '-' && arg != "-") {
+            if (!is_flag(arg) && has_value) {
+                ++i;
+            }
+        } else {
+            outputs.push_back(arg);
+        }
+    }
+
+    if (inputs.empty() || outputs.empty()) {
+        std::fprintf(stderr, "At least one output file must be specified\n");
+        return 1;
+    }
+
+    for (const auto& input : inputs) {
+        if (is_local_path(input) && !fs::exists(input)) {
+            std::fprintf(stderr, "%s: No such file or directory\n", input.c_str());
+            return 1;
+        }
+    }
+
+    // Open outputs up front, like ffmpeg does after probing inputs
+    std::vector<std::ofstream> files;
+    for (const auto& output : outputs) {
+        if (!is_local_path(output) || output == "/dev/null") {
+            continue;
+        }
+        if (!overwrite && fs::exists(output)) {
+            std::fprintf(stderr, "File '%s' already exists. Exiting.\n", output.c_str());
+            return 1;
+        }
+        files.emplace_back(output, std::ios::binary | std::ios::trunc);
+        if (!files.back()) {
+            std::fprintf(stderr, "%s: %s\n", output.c_str(), std::strerror(errno));
+            return 1;
+        }
+    }
+
+    double input_duration = env_double("FAKE_FFMPEG_INPUT_DURATION", 60.0);
+    double media_duration = input_duration - start;
+    if (end >= 0) {
+        media_duration = end - start;
+    }
+    if (limit >= 0) {
+        media_duration = std::min(media_duration, limit);
+    }
+    media_duration = std::max(media_duration, 0.0);
+
+    double speed = std::max(env_double("FAKE_FFMPEG_SPEED", 20.0), 0.001);
+    double wall_seconds = env_double("FAKE_FFMPEG_DURATION", media_duration / speed);
+    double hz = std::max(env_double("FAKE_FFMPEG_PROGRESS_HZ", 2.0), 0.1);
+    double cpu = std::clamp(env_double("FAKE_FFMPEG_CPU", 0.0), 0.0, 1.0);
+    auto output_bytes = static_cast<uint64_t>(std::max(env_double("FAKE_FFMPEG_OUTPUT_BYTES", 1048576.0), 0.0));
+
+    double fail_rate = std::clamp(env_double("FAKE_FFMPEG_FAIL_RATE", 0.0), 0.0, 1.0);
+    auto seed = static_cast<uint64_t>(env_double("FAKE_FFMPEG_SEED", 0.0));
+    double roll = (fnv1a(outputs.front(), seed) % 1000000) / 1000000.0;
+    bool will_fail = roll < fail_rate;
+    double fail_at = std::clamp(env_double("FAKE_FFMPEG_FAIL_AT", 0.5), 0.0, 1.0);
+
+    auto tick = std::chrono::duration<double>(1.0 / hz);
+    auto started = std::chrono::steady_clock::now();
+    uint64_t written = 0;
+    std::vector<char> chunk(64 * 1024, 'T');
+    int frame = 0;
+
+    while (true) {
+        if (int signal = g_signal.load()) {
+            std::fprintf(stderr, "Exiting normally, received signal %d.\n", signal);
+            return 255;
+        }
+
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+        double fraction = wall_seconds > 0 ? std::min(elapsed / wall_seconds, 1.0) : 1.0;
+
+        if (will_fail && fraction >= fail_at) {
+            std::fprintf(stderr, "[h264 @ 0x0] Invalid NAL unit size.\n");
+            std::fprintf(stderr, "Error while decoding stream #0:0: Invalid data found when processing input\n");
+            std::fprintf(stderr, "Conversion failed!\n");
+            return static_cast<int>(env_double("FAKE_FFMPEG_EXIT_CODE", 1.0));
+        }
+
+        // Grow every output to its share of the final size
+        auto target = static_cast<uint64_t>(output_bytes * fraction);
+        while (written < target) {
+            auto n = static_cast<std::streamsize>(std::min<uint64_t>(chunk.size(), target - written));
+            for (auto& file : files) {
+                file.write(chunk.data(), n);
+                file.flush();
+            }
+            written += static_cast<uint64_t>(n);
+        }
+
+        bool done = fraction >= 1.0;
+        if (progress_to_stdout) {
+            double out_time = media_duration * fraction;
+            frame = static_cast<int>(out_time * 30.0);
+            std::printf("frame=%d\nfps=%.2f\nstream_0_0_q=-1.0\nbitrate=N/A\ntotal_size=%llu\n",
+                frame, elapsed > 0 ? frame / elapsed : 0.0, static_cast<unsigned long long>(written));
+            std::printf("out_time_us=%lld\nout_time_ms=%lld\nout_time=%s\n",
+                static_cast<long long>(out_time * 1000000.0),
+                static_cast<long long>(out_time * 1000000.0),
+                format_out_time(out_time).c_str());
+            std::printf("dup_frames=0\ndrop_frames=0\nspeed=%.3gx\nprogress=%s\n",
+                elapsed > 0 ? out_time / elapsed : 0.0, done ? "end" : "continue");
+            std::fflush(stdout);
+        }
+
+        if (done) {
+            break;
+        }
+
+        // Keep the requested share of the tick busy, sleep the rest
+        auto busy = std::chrono::duration_cast<std::chrono::steady_clock::duration>(tick * cpu);
+        burn_cpu(busy);
+        std::this_thread::sleep_for(tick - busy);
+    }
+
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::signal(SIGINT, on_signal);
+    std::signal(SIGTERM, on_signal);
+
+    std::vector<std::string> args(argv + 1, argv + argc);
+    std::string name = fs::path(argv[0]).filename().string();
+
+    if (name.rfind("ffprobe", 0) == 0) {
+        return run_ffprobe(args);
+    }
+    return run_ffmpeg(args);
+}
@@ -0,0 +1,281 @@
+// Stand-in for an S3-compatible object store, for testing the upload sink
+// without a bucket. Plain HTTP, path-style addressing, one thread per
+// connection.
+//
+// Speaks the calls UploadSink makes: CreateMultipartUpload, UploadPart,
+// CompleteMultipartUpload, AbortMultipartUpload and PutObject. Signatures
+// are not checked, but every body is checked against its
+// x-amz-content-sha256 header, and completed objects are assembled from the
+// listed parts under $FAKE_S3_ROOT/<bucket>/<key>.
+//
+// Behaviour is controlled through the environment:
+//   FAKE_S3_ROOT        where objects are stored (./fake_s3)
+//   FAKE_S3_PORT        listening port on 127.0.0.1 (9000)
+//   FAKE_S3_FAIL_RATE   probability that a request gets a 503, 0-1 (0)
+//   FAKE_S3_LATENCY_MS  delay before each response (0)
+//
+// Each request is logged to stderr, and on exit (SIGINT/SIGTERM) a summary
+// reports the peak number of part uploads in flight.
+
+#include "output_digest.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/signal_set.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+
+namespace fs = std::filesystem;
+namespace net = boost::asio;
+namespace beast = boost::beast;
+namespace http = boost::beast::http;
+using tcp = boost::asio::ip::tcp;
+
+namespace {
+
+struct Store {
+    std::mutex mutex;
+    uint64_t next_upload = 1;
+    std::map<std::string, std::map<int, std::string>> uploads;  // Upload id -> parts
+    std::mt19937_64 random{12345};
+};
+
+std::atomic<int> g_parts_in_flight{0};
+std::atomic<int> g_peak_parts_in_flight{0};
+
+double env_double(const char* name, double fallback) {
+    const char* value = std::getenv(name);
+    if (!value || !*value) {
+        return fallback;
+    }
+    char* end = nullptr;
+    double parsed = std::strtod(value, &end);
+    return end != value ? parsed : fallback;
+}
+
+std::string env_string(const char* name, const std::string& fallback) {
+    const char* value = std::getenv(name);
+    return (value && *value) ? std::string(value) : fallback;
+}
+
+std::string url_decode(const std::string& text) {
+    std::string decoded;
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (text[i] == '%' && i + 2 < text.size()) {
+            decoded += static_cast<char>(std::stoi(text.substr(i + 1, 2), nullptr, 16));
+            i += 2;
+        } else {
+            decoded += text[i];
+        }
+    }
+    return decoded;
+}
+
+std::map<std::string, std::string> parse_query(const std::string& query) {
+    std::map<std::string, std::string> values;
+    size_t start = 0;
+    while (start < query.size()) {
+        size_t end = query.find('&', start);
+        std::string pair = query.substr(start, end == std::string::npos ? std::string::npos : end - start);
+        size_t equals = pair.find('=');
+        values[url_decode(pair.substr(0, equals))] =
+            equals == std::string::npos ? "" : url_decode(pair.substr(equals + 1));
+        if (end == std::string::npos) {
+            break;
+        }
+        start = end + 1;
+    }
+    return values;
+}
+
+std::string sha256_hex(const std::string& data) {
+    trimora::Sha256 hasher;
+    hasher.update(reinterpret_cast<const uint8_t*>(data.data()), data.size());
+    return hasher.hex_digest();
+}
+
+http::response<http::string_body> reply(http::status status, const std::string& body = "") {
+    http::response<http::string_body> response{status, 11};
+    response.set(http::field::server, "fake_s3");
+    response.body() = body;
+    response.prepare_payload();
+    return response;
+}
+
+http::response<http::string_body> error(http::status status, const std::string& code) {
+    return reply(status, "<Error><Code>" + code + "</Code><Message>" + code + "</Message></Error>");
+}
+
+bool write_object(const fs::path& root, const std::string& bucket, const std::string& key, const std::string& data) {
+    fs::path path = root / bucket / key;
+    std::error_code ec;
+    fs::create_directories(path.parent_path(), ec);
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(data.data(), static_cast<std::streamsize>(data.size()));
+    return static_cast<bool>(out);
+}
+
+http::response<http::string_body> handle(
+    Store& store,
+    const fs::path& root,
+    const http::request<http::string_body>& request
+) {
+    std::string target(request.target());
+    size_t question = target.find('?');
+    std::string path = url_decode(target.substr(0, question));
+    auto query = parse_query(question == std::string::npos ? "" : target.substr(question + 1));
+
+    size_t slash = path.find('/', 1);
+    if (path.size() < 2 || slash == std::string::npos || slash + 1 >= path.size()) {
+        return error(http::status::bad_request, "InvalidURI");
+    }
+    std::string bucket = path.substr(1, slash - 1);
+    std::string key = path.substr(slash + 1);
+
+    if (std::string(request["x-amz-content-sha256"]) != sha256_hex(request.body())) {
+        return error(http::status::bad_request, "XAmzContentSHA256Mismatch");
+    }
+
+    std::lock_guard<std::mutex> lock(store.mutex);
+    if (request.method() == http::verb::post && query.count("uploads")) {
+        std::string id = "upload-" + std::to_string(store.next_upload++);
+        store.uploads[id];
+        return reply(http::status::ok,
+                     "<InitiateMultipartUploadResult><Bucket>" + bucket + "</Bucket><Key>" + key +
+                     "</Key><UploadId>" + id + "</UploadId></InitiateMultipartUploadResult>");
+    }
+    if (request.method() == http::verb::put && query.count("uploadId")) {
+        auto upload = store.uploads.find(query["uploadId"]);
+        if (upload == store.uploads.end()) {
+            return error(http::status::not_found, "NoSuchUpload");
+        }
+        int part_number = std::atoi(query["partNumber"].c_str());
+        upload->second[part_number] = request.body();
+        auto response = reply(http::status::ok);
+        response.set(http::field::etag, "\"" + sha256_hex(request.body()).substr(0, 32) + "\"");
+        return response;
+    }
+    if (request.method() == http::verb::post && query.count("uploadId")) {
+        auto upload = store.uploads.find(query["uploadId"]);
+        if (upload == store.uploads.end()) {
+            return error(http::status::not_found, "NoSuchUpload");
+        }
+        // Parts in the order listed, each with the ETag it was given
+        std::string data;
+        const std::string& body = request.body();
+        size_t position = 0;
+        while ((position = body.find("<PartNumber>", position)) != std::string::npos) {
+            int part_number = std::atoi(body.c_str() + position + 12);
+            size_t etag_start = body.find("<ETag>", position) + 6;
+            std::string etag = body.substr(etag_start, body.find("</ETag>", etag_start) - etag_start);
+            auto part = upload->second.find(part_number);
+            if (part == upload->second.end() ||
+                etag != "\"" + sha256_hex(part->second).substr(0, 32) + "\"") {
+                return error(http::status::bad_request, "InvalidPart");
+            }
+            data += part->second;
+            position = etag_start;
+        }
+        store.uploads.erase(upload);
+        if (!write_object(root, bucket, key, data)) {
+            return error(http::status::internal_server_error, "InternalError");
+        }
+        return reply(http::status::ok, "<CompleteMultipartUploadResult><Key>" + key +
+                                       "</Key></CompleteMultipartUploadResult>");
+    }
+    if (request.method() == http::verb::delete_ && query.count("uploadId")) {
+        store.uploads.erase(query["uploadId"]);
+        return reply(http::status::no_content);
+    }
+    if (request.method() == http::verb::put) {
+        if (!write_object(root, bucket, key, request.body())) {
+            return error(http::status::internal_server_error, "InternalError");
+        }
+        return reply(http::status::ok);
+    }
+    return error(http::status::method_not_allowed, "MethodNotAllowed");
+}
+
+void serve(tcp::socket socket, Store& store, const fs::path& root, double fail_rate, int latency_ms) {
+    beast::flat_buffer buffer;
+    beast::error_code ec;
+    while (true) {
+        http::request_parser<http::string_body> parser;
+        parser.body_limit(std::numeric_limits<uint64_t>::max());
+        http::read(socket, buffer, parser, ec);
+        if (ec) {
+            return;
+        }
+        auto request = parser.release();
+        bool is_part = request.method() == http::verb::put && request.target().find("partNumber=") != beast::string_view::npos;
+        if (is_part) {
+            int in_flight = ++g_parts_in_flight;
+            int peak = g_peak_parts_in_flight.load();
+            while (in_flight > peak && !g_peak_parts_in_flight.compare_exchange_weak(peak, in_flight)) {
+            }
+        }
+        if (latency_ms > 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(latency_ms));
+        }
+
+        bool inject = false;
+        {
+            std::lock_guard<std::mutex> lock(store.mutex);
+            inject = std::uniform_real_distribution<double>(0.0, 1.0)(store.random) < fail_rate;
+        }
+        auto response = inject ? error(http::status::service_unavailable, "SlowDown") : handle(store, root, request);
+        if (is_part) {
+            --g_parts_in_flight;
+        }
+        std::fprintf(stderr, "%s %s %zu -> %d\n", std::string(request.method_string()).c_str(),
+                     std::string(request.target()).c_str(), request.body().size(), response.result_int());
+        response.keep_alive(request.keep_alive());
+        http::write(socket, response, ec);
+        if (ec || !request.keep_alive()) {
+            return;
+        }
+    }
+}
+
+} // namespace
+
+int main() {
+    fs::path root = env_string("FAKE_S3_ROOT", "fake_s3");
+    auto port = static_cast<unsigned short>(env_double("FAKE_S3_PORT", 9000));
+    double fail_rate = env_double("FAKE_S3_FAIL_RATE", 0.0);
+    int latency_ms = static_cast<int>(env_double("FAKE_S3_LATENCY_MS", 0));
+
+    Store store;
+    net::io_context ioc;
+    tcp::acceptor acceptor(ioc, {net::ip::make_address("127.0.0.1"), port});
+    std::fprintf(stderr, "fake_s3 listening on 127.0.0.1:%u, storing under %s\n", port, root.c_str());
+
+    net::signal_set signals(ioc, SIGINT, SIGTERM);
+    signals.async_wait([&](const beast::error_code&, int) {
+        std::fprintf(stderr, "peak part uploads in flight: %d\n", g_peak_parts_in_flight.load());
+        std::exit(0);
+    });
+    std::thread([&ioc] { ioc.run(); }).detach();
+
+    while (true) {
+        tcp::socket socket(ioc);
+        beast::error_code ec;
+        acceptor.accept(socket, ec);
+        if (ec) {
+            continue;
+        }
+        std::thread(serve, std::move(socket), std::ref(store), root, fail_rate, latency_ms).detach();
+    }
+}